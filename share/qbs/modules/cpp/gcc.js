@@ -1023,6 +1023,12 @@ function prepareCompiler(project, product, inputs, outputs, input, output, expli
     var pchOutput = output.fileTags.contains(compilerInfo.tag + "_pch");
 
     var args = compilerFlags(project, product, input, output, explicitlyDependsOn);
+    var dependencyFilePath;
+    if (input.cpp.dependencyTracking === "compiler") {
+        dependencyFilePath = output.filePath + ".d";
+        args.push(input.cpp.treatSystemHeadersAsDependencies ? "-MD" : "-MMD",
+                  "-MF", dependencyFilePath);
+    }
     var wrapperArgsLength = 0;
     var wrapperArgs = product.cpp.compilerWrapper;
     var extraEnv;
@@ -1061,6 +1067,8 @@ function prepareCompiler(project, product, inputs, outputs, input, output, expli
         cmd.environment = extraEnv;
     cmd.responseFileArgumentIndex = wrapperArgsLength;
     cmd.responseFileUsagePrefix = '@';
+    if (dependencyFilePath)
+        cmd.dependencyFilePath = dependencyFilePath;
     setResponseFileThreshold(cmd, product);
     return cmd;
 }
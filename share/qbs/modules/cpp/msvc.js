@@ -317,6 +317,10 @@ function prepareCompiler(project, product, inputs, outputs, input, output, expli
         }
     }
 
+    var reportIncludes = input.cpp.dependencyTracking === "compiler";
+    if (reportIncludes)
+        args.push("/showIncludes");
+
     args = args.concat(Cpp.collectMiscCompilerArguments(input, tag));
 
     var compilerPath = product.cpp.compilerPath;
@@ -340,6 +344,8 @@ function prepareCompiler(project, product, inputs, outputs, input, output, expli
     cmd.stdoutFilterFunction = function(output) {
         return output.split(inputFileName + "\r\n").join("");
     };
+    if (reportIncludes)
+        cmd.dependencyOutputPrefix = input.cpp.showIncludesPrefix;
     return [cmd];
 }
 
@@ -44,7 +44,7 @@ public class ArtifactListJsonWriter implements ArtifactListWriter {
     private static final int TAB_WIDTH = 4;
 
     // based on escapeString from qtbase/qjsonwriter.cpp
-    private static String escapeString(String s) {
+    public static String escapeString(String s) {
         String out = "";
         for (int i = 0; i < s.length();) {
             int u = s.codePointAt(i);
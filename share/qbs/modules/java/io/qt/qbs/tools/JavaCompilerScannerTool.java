@@ -31,6 +31,7 @@
 package io.qt.qbs.tools;
 
 import io.qt.qbs.tools.utils.JavaCompilerScanner;
+import io.qt.qbs.tools.utils.JavaCompilerWorker;
 
 import java.io.IOException;
 import java.util.ArrayList;
@@ -39,6 +40,8 @@ import java.util.Arrays;
 public class JavaCompilerScannerTool {
     public static void main(String[] args) {
         try {
+            if (args.length == 1 && args[0].equals("--persistent_worker"))
+                System.exit(new JavaCompilerWorker().run());
             JavaCompilerScanner scanner = new JavaCompilerScanner();
             int result = scanner.run(new ArrayList<String>(Arrays.asList(args)));
             scanner.write(System.out);
@@ -0,0 +1,85 @@
+/****************************************************************************
+ **
+ ** Copyright (C) 2022 The Qt Company Ltd.
+ ** Contact: https://www.qt.io/licensing/
+ **
+ ** This file is part of Qbs.
+ **
+ ** $QT_BEGIN_LICENSE:LGPL$
+ ** Commercial License Usage
+ ** Licensees holding valid commercial Qt licenses may use this file in
+ ** accordance with the commercial license agreement provided with the
+ ** Software or, alternatively, in accordance with the terms contained in
+ ** a written agreement between you and The Qt Company. For licensing terms
+ ** and conditions see https://www.qt.io/terms-conditions. For further
+ ** information use the contact form at https://www.qt.io/contact-us.
+ **
+ ** GNU Lesser General Public License Usage
+ ** Alternatively, this file may be used under the terms of the GNU Lesser
+ ** General Public License version 3 as published by the Free Software
+ ** Foundation and appearing in the file LICENSE.LGPL3 included in the
+ ** packaging of this file. Please review the following information to
+ ** ensure the GNU Lesser General Public License version 3 requirements
+ ** will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+ **
+ ** GNU General Public License Usage
+ ** Alternatively, this file may be used under the terms of the GNU
+ ** General Public License version 2.0 or (at your option) the GNU General
+ ** Public license version 3 or any later version approved by the KDE Free
+ ** Qt Foundation. The licenses are as published by the Free Software
+ ** Foundation and appearing in the file LICENSE.GPL2 and LICENSE.GPL3
+ ** included in the packaging of this file. Please review the following
+ ** information to ensure the GNU General Public License requirements will
+ ** be met: https://www.gnu.org/licenses/gpl-2.0.html and
+ ** https://www.gnu.org/licenses/gpl-3.0.html.
+ **
+ ** $QT_END_LICENSE$
+ **
+ ****************************************************************************/
+
+package io.qt.qbs.tools.utils;
+
+import io.qt.qbs.ArtifactListJsonWriter;
+
+import javax.tools.JavaCompiler;
+import javax.tools.ToolProvider;
+import java.io.*;
+
+/**
+ * Compiles Java sources in a long-running process, so that the JVM does not have to be started
+ * anew for every compiler invocation. This implements the JSON variant of the Bazel persistent
+ * worker protocol: Every line on standard input is a request of the form
+ * {"arguments": [...], "requestId": n} carrying the arguments of a javac invocation,
+ * and every request is answered with a line of the form
+ * {"exitCode": n, "output": "...", "requestId": n} on standard output.
+ */
+public class JavaCompilerWorker {
+    public int run() throws IOException {
+        // Annotation processors might print things, which must not end up between the responses.
+        PrintStream responseStream = new PrintStream(new FileOutputStream(FileDescriptor.out),
+                true, "UTF-8");
+        System.setOut(System.err);
+
+        JavaCompiler compiler = ToolProvider.getSystemJavaCompiler();
+        if (compiler == null) {
+            System.err.println("The Java compiler is not available in this JVM.");
+            return 1;
+        }
+
+        BufferedReader requestReader = new BufferedReader(new InputStreamReader(System.in,
+                "UTF-8"));
+        String line;
+        while ((line = requestReader.readLine()) != null) {
+            if (line.trim().isEmpty())
+                continue;
+            WorkRequest request = WorkRequest.parse(line);
+            ByteArrayOutputStream output = new ByteArrayOutputStream();
+            int exitCode = compiler.run(null, output, output, request.getArguments()
+                    .toArray(new String[request.getArguments().size()]));
+            responseStream.println("{\"exitCode\":" + exitCode
+                    + ",\"output\":\"" + ArtifactListJsonWriter.escapeString(output.toString())
+                    + "\",\"requestId\":" + request.getRequestId() + "}");
+        }
+        return 0;
+    }
+}
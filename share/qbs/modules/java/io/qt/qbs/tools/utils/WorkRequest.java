@@ -0,0 +1,215 @@
+/****************************************************************************
+ **
+ ** Copyright (C) 2022 The Qt Company Ltd.
+ ** Contact: https://www.qt.io/licensing/
+ **
+ ** This file is part of Qbs.
+ **
+ ** $QT_BEGIN_LICENSE:LGPL$
+ ** Commercial License Usage
+ ** Licensees holding valid commercial Qt licenses may use this file in
+ ** accordance with the commercial license agreement provided with the
+ ** Software or, alternatively, in accordance with the terms contained in
+ ** a written agreement between you and The Qt Company. For licensing terms
+ ** and conditions see https://www.qt.io/terms-conditions. For further
+ ** information use the contact form at https://www.qt.io/contact-us.
+ **
+ ** GNU Lesser General Public License Usage
+ ** Alternatively, this file may be used under the terms of the GNU Lesser
+ ** General Public License version 3 as published by the Free Software
+ ** Foundation and appearing in the file LICENSE.LGPL3 included in the
+ ** packaging of this file. Please review the following information to
+ ** ensure the GNU Lesser General Public License version 3 requirements
+ ** will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+ **
+ ** GNU General Public License Usage
+ ** Alternatively, this file may be used under the terms of the GNU
+ ** General Public License version 2.0 or (at your option) the GNU General
+ ** Public license version 3 or any later version approved by the KDE Free
+ ** Qt Foundation. The licenses are as published by the Free Software
+ ** Foundation and appearing in the file LICENSE.GPL2 and LICENSE.GPL3
+ ** included in the packaging of this file. Please review the following
+ ** information to ensure the GNU General Public License requirements will
+ ** be met: https://www.gnu.org/licenses/gpl-2.0.html and
+ ** https://www.gnu.org/licenses/gpl-3.0.html.
+ **
+ ** $QT_END_LICENSE$
+ **
+ ****************************************************************************/
+
+package io.qt.qbs.tools.utils;
+
+import java.io.IOException;
+import java.util.ArrayList;
+import java.util.List;
+
+/**
+ * A request sent to a persistent worker. The Java Standard Library does not have native support
+ * for JSON, so this contains a minimal parser for the requests. Members other than "arguments"
+ * and "requestId" are skipped.
+ */
+public class WorkRequest {
+    private final String json;
+    private int pos = 0;
+    private final List<String> arguments = new ArrayList<String>();
+    private int requestId = 0;
+
+    private WorkRequest(String json) {
+        this.json = json;
+    }
+
+    public static WorkRequest parse(String json) throws IOException {
+        WorkRequest request = new WorkRequest(json);
+        request.parseRequest();
+        return request;
+    }
+
+    public List<String> getArguments() {
+        return arguments;
+    }
+
+    public int getRequestId() {
+        return requestId;
+    }
+
+    private void parseRequest() throws IOException {
+        expect('{');
+        if (consumeIf('}'))
+            return;
+        do {
+            String key = parseString();
+            expect(':');
+            if (key.equals("arguments"))
+                parseArguments();
+            else if (key.equals("requestId"))
+                requestId = parseInt();
+            else
+                skipValue();
+        } while (consumeIf(','));
+        expect('}');
+    }
+
+    private void parseArguments() throws IOException {
+        expect('[');
+        if (consumeIf(']'))
+            return;
+        do {
+            arguments.add(parseString());
+        } while (consumeIf(','));
+        expect(']');
+    }
+
+    private void skipValue() throws IOException {
+        char c = peek();
+        if (c == '"') {
+            parseString();
+        } else if (c == '{' || c == '[') {
+            char close = c == '{' ? '}' : ']';
+            ++pos;
+            if (consumeIf(close))
+                return;
+            do {
+                if (c == '{') {
+                    parseString();
+                    expect(':');
+                }
+                skipValue();
+            } while (consumeIf(','));
+            expect(close);
+        } else {
+            // Numbers and literals.
+            while (pos < json.length() && ",]} \t\r\n".indexOf(json.charAt(pos)) == -1)
+                ++pos;
+        }
+    }
+
+    private int parseInt() throws IOException {
+        skipWhitespace();
+        int start = pos;
+        while (pos < json.length()
+                && (json.charAt(pos) == '-' || Character.isDigit(json.charAt(pos)))) {
+            ++pos;
+        }
+        try {
+            return Integer.parseInt(json.substring(start, pos));
+        } catch (NumberFormatException e) {
+            throw error("number expected");
+        }
+    }
+
+    private String parseString() throws IOException {
+        expect('"');
+        StringBuilder result = new StringBuilder();
+        while (pos < json.length()) {
+            char c = json.charAt(pos++);
+            if (c == '"')
+                return result.toString();
+            if (c != '\\') {
+                result.append(c);
+                continue;
+            }
+            if (pos >= json.length())
+                break;
+            c = json.charAt(pos++);
+            switch (c) {
+            case 'b':
+                result.append('\b');
+                break;
+            case 'f':
+                result.append('\f');
+                break;
+            case 'n':
+                result.append('\n');
+                break;
+            case 'r':
+                result.append('\r');
+                break;
+            case 't':
+                result.append('\t');
+                break;
+            case 'u':
+                // Characters outside of the BMP come as two escaped surrogates.
+                try {
+                    result.append((char) Integer.parseInt(json.substring(pos, pos + 4), 16));
+                } catch (RuntimeException e) {
+                    throw error("invalid escape sequence");
+                }
+                pos += 4;
+                break;
+            default: // '"', '\\' and '/'
+                result.append(c);
+                break;
+            }
+        }
+        throw error("unterminated string");
+    }
+
+    private void skipWhitespace() {
+        while (pos < json.length() && Character.isWhitespace(json.charAt(pos)))
+            ++pos;
+    }
+
+    private char peek() throws IOException {
+        skipWhitespace();
+        if (pos >= json.length())
+            throw error("unexpected end of input");
+        return json.charAt(pos);
+    }
+
+    private boolean consumeIf(char c) throws IOException {
+        if (peek() != c)
+            return false;
+        ++pos;
+        return true;
+    }
+
+    private void expect(char c) throws IOException {
+        if (!consumeIf(c))
+            throw error("'" + c + "' expected");
+    }
+
+    private IOException error(String message) {
+        return new IOException("Invalid work request: " + message + " at position " + pos
+                + " of " + json);
+    }
+}
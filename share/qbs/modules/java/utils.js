@@ -240,9 +240,11 @@ function helperFullyQualifiedNames(type) {
         "io/qt/qbs/tools/utils/JavaCompilerOptions",
         "io/qt/qbs/tools/utils/JavaCompilerScanner",
         "io/qt/qbs/tools/utils/JavaCompilerScanner$1",
+        "io/qt/qbs/tools/utils/JavaCompilerWorker",
         "io/qt/qbs/tools/utils/NullFileObject",
         "io/qt/qbs/tools/utils/NullFileObject$1",
         "io/qt/qbs/tools/utils/NullFileObject$2",
+        "io/qt/qbs/tools/utils/WorkRequest",
     ];
     if (type === "java") {
         return names.filter(function (name) {
@@ -297,6 +299,14 @@ function helperOverrideArgs(product, tool) {
     return overrides;
 }
 
+function helperClassPath(product) {
+    var classPaths = [ModUtils.moduleProperty(product, "internalClassFilesDir")];
+    var toolsJarPath = ModUtils.moduleProperty(product, "toolsJarPath");
+    if (toolsJarPath)
+        classPaths.push(toolsJarPath);
+    return classPaths.join(FileInfo.pathListSeparator());
+}
+
 function outputArtifacts(product, inputs) {
     // Handle the case where a product depends on Java but has no Java sources
     if (!inputs["java.java"] || inputs["java.java"].length === 0)
@@ -312,10 +322,8 @@ function outputArtifacts(product, inputs) {
         process.setWorkingDirectory(
                     FileInfo.joinPaths(ModUtils.moduleProperty(product, "internalClassFilesDir")));
 
-        var sep = FileInfo.pathListSeparator();
-        var toolsJarPath = ModUtils.moduleProperty(product, "toolsJarPath");
         var javaArgs = [
-            "-classpath", process.workingDirectory() + (toolsJarPath ? (sep + toolsJarPath) : ""),
+            "-classpath", helperClassPath(product),
             "io/qt/qbs/tools/JavaCompilerScannerTool",
         ];
         process.exec(ModUtils.moduleProperty(product, "interpreterFilePath"), javaArgs
@@ -329,6 +337,27 @@ function outputArtifacts(product, inputs) {
     }
 }
 
+/**
+  * Returns the command that compiles the product's Java sources. If requested, the compiler
+  * runs in a persistent worker provided by the helper tool. Options for the JVM running javac
+  * can only be passed to the javac executable, though.
+  */
+function compilerCommand(product, inputs) {
+    var args = javacArguments(product, inputs);
+    if (!ModUtils.moduleProperty(product, "usePersistentWorker")
+            || args.some(function(arg) { return arg.startsWith("-J"); })) {
+        return new Command(ModUtils.moduleProperty(product, "compilerFilePath"), args);
+    }
+    var cmd = new Command(ModUtils.moduleProperty(product, "interpreterFilePath"), args);
+    cmd.persistentWorker = true;
+    cmd.persistentWorkerArguments = [
+        "-classpath", helperClassPath(product),
+        "io/qt/qbs/tools/JavaCompilerScannerTool",
+        "--persistent_worker",
+    ];
+    return cmd;
+}
+
 function manifestContents(filePath) {
     if (filePath === undefined)
         return undefined;
@@ -48,6 +48,7 @@
 #include <qbs.h>
 #include <api/runenvironment.h>
 #include <logging/translator.h>
+#include <tools/actioncache.h>
 #include <tools/qbsassert.h>
 #include <tools/projectgeneratormanager.h>
 #include <tools/qttools.h>
@@ -135,6 +136,10 @@ void CommandLineFrontend::start()
             startSession();
             return;
         }
+        case ActionCacheCommandType:
+            showActionCacheStatistics();
+            qApp->quit();
+            return;
         default:
             break;
         }
@@ -154,6 +159,8 @@ void CommandLineFrontend::start()
         params.setWaitLockBuildGraph(m_parser.waitLockBuildGraph());
         params.setFallbackProviderEnabled(!m_parser.disableFallbackProvider());
         params.setLogElapsedTime(m_parser.logTime());
+        params.setTraceFilePath(m_parser.traceFilePath());
+        params.setMaxResolverJobCount(m_parser.resolverJobCount());
         params.setSettingsDirectory(m_settings->baseDirectory());
         params.setOverrideBuildGraphData(m_parser.command() == ResolveCommandType);
         params.setPropertyCheckingMode(ErrorHandlingMode::Strict);
@@ -179,6 +186,8 @@ void CommandLineFrontend::start()
                     + QLatin1String("/" QBS_RELATIVE_PLUGINS_PATH))));
             params.setLibexecPath(QDir::cleanPath(QCoreApplication::applicationDirPath()
                     + QLatin1String("/" QBS_RELATIVE_LIBEXEC_PATH)));
+            params.setParseCacheDirectory(prefs.parseCacheDirectory());
+            params.setProbeCacheDirectory(prefs.probeCacheDirectory());
             params.setTopLevelProfile(profileName);
             params.setConfigurationName(configurationName);
             params.setBuildRoot(buildDirectory(profileName));
@@ -314,17 +323,28 @@ void CommandLineFrontend::handleTaskProgress(int value, AbstractJob *job)
     }
 }
 
+void CommandLineFrontend::handleCommandOutputReport(const QString &executableFilePath,
+                                                    const QStringList &lines, bool stdErr)
+{
+    Q_UNUSED(executableFilePath);
+    qbsInfo() << lines.join(QLatin1Char('\n'))
+              << MessageTag(stdErr ? QStringLiteral("stdErr") : QString());
+}
+
 void CommandLineFrontend::handleProcessResultReport(const qbs::ProcessResult &result)
 {
-    bool hasOutput = !result.stdOut().empty() || !result.stdErr().empty();
+    // Forwarded output has already been printed while the process was running.
+    bool hasOutput = !result.outputForwarded()
+            && (!result.stdOut().empty() || !result.stdErr().empty());
     if (!hasOutput && result.success())
         return;
 
     LogWriter w = result.success() ? qbsInfo() : qbsError();
     w << shellQuote(QDir::toNativeSeparators(result.executableFilePath()), result.arguments())
       << (hasOutput ? QStringLiteral("\n") : QString())
-      << (result.stdOut().empty() ? QString() : result.stdOut().join(QLatin1Char('\n')));
-    if (!result.stdErr().empty())
+      << (!hasOutput || result.stdOut().empty()
+          ? QString() : result.stdOut().join(QLatin1Char('\n')));
+    if (hasOutput && !result.stdErr().empty())
         w << result.stdErr().join(QLatin1Char('\n')) << MessageTag(QStringLiteral("stdErr"));
 }
 
@@ -424,6 +444,7 @@ void CommandLineFrontend::handleProjectsResolved()
     case HelpCommandType:
     case VersionCommandType:
     case SessionCommandType:
+    case ActionCacheCommandType:
         Q_ASSERT_X(false, Q_FUNC_INFO, "Impossible.");
     }
 }
@@ -607,6 +628,30 @@ void CommandLineFrontend::listProducts()
     qbsInfo() << output.join(QLatin1Char('\n'));
 }
 
+void CommandLineFrontend::showActionCacheStatistics()
+{
+    QString directory = m_parser.actionCacheDirectory();
+    if (directory.isEmpty())
+        directory = Preferences(m_settings).actionCacheDirectory();
+    if (directory.isEmpty()) {
+        throw ErrorInfo(Tr::tr("No action cache directory given. Use the option '--action-cache' "
+                               "or set the preference 'actionCacheDirectory'."));
+    }
+    const Internal::ActionCache::Statistics stats = Internal::ActionCache::statistics(directory);
+    const qint64 lookups = stats.hits + stats.misses;
+    const QString hitRate = lookups > 0
+            ? QString::number(100.0 * stats.hits / lookups, 'f', 1) + QLatin1Char('%')
+            : Tr::tr("n/a");
+    const qint64 maxSize = Preferences(m_settings).actionCacheMaxSize();
+    qbsInfo() << Tr::tr("Action cache directory: %1").arg(QDir::toNativeSeparators(directory));
+    qbsInfo() << Tr::tr("Entries: %1").arg(stats.entryCount);
+    qbsInfo() << Tr::tr("Size: %1 MiB (limit: %2 MiB)")
+                 .arg(stats.totalSize / (1024 * 1024)).arg(maxSize / (1024 * 1024));
+    qbsInfo() << Tr::tr("Hits: %1, misses: %2, hit rate: %3")
+                 .arg(stats.hits).arg(stats.misses).arg(hitRate);
+    qbsInfo() << Tr::tr("Stores: %1, evictions: %2").arg(stats.stores).arg(stats.evictions);
+}
+
 void CommandLineFrontend::connectBuildJobs()
 {
     for (AbstractJob * const job : qAsConst(m_buildJobs))
@@ -623,6 +668,8 @@ void CommandLineFrontend::connectBuildJob(AbstractJob *job)
 
     connect(bjob, &BuildJob::reportCommandDescription,
             this, &CommandLineFrontend::handleCommandDescriptionReport);
+    connect(bjob, &BuildJob::reportCommandOutput,
+            this, &CommandLineFrontend::handleCommandOutputReport);
     connect(bjob, &BuildJob::reportProcessResult,
             this, &CommandLineFrontend::handleProcessResultReport);
 }
@@ -78,6 +78,8 @@ private:
     void handleNewTaskStarted(const QString &description, int totalEffort);
     void handleTotalEffortChanged(int totalEffort);
     void handleTaskProgress(int value, qbs::AbstractJob *job);
+    void handleCommandOutputReport(const QString &executableFilePath, const QStringList &lines,
+                                   bool stdErr);
     void handleProcessResultReport(const qbs::ProcessResult &result);
     void checkCancelStatus();
 
@@ -97,6 +99,7 @@ private:
     void updateTimestamps();
     void dumpNodesTree();
     void listProducts();
+    void showActionCacheStatistics();
     void connectBuildJobs();
     void connectBuildJob(AbstractJob *job);
     void connectJob(AbstractJob *job);
@@ -0,0 +1,275 @@
+/****************************************************************************
+**
+** Copyright (C) 2022 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of Qbs.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-2.0.html and
+** https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#include "filewatcher.h"
+
+#include <QtCore/qdir.h>
+#include <QtCore/qdiriterator.h>
+#include <QtCore/qfile.h>
+#include <QtCore/qhash.h>
+#include <QtCore/qset.h>
+#include <QtCore/qsocketnotifier.h>
+
+#ifdef Q_OS_LINUX
+#include <sys/inotify.h>
+#include <unistd.h>
+
+#include <cerrno>
+#endif
+
+namespace qbs {
+namespace Internal {
+
+// Beyond this, we stop remembering individual files and let the next build check everything.
+static const int maxChangedFiles = 100000;
+
+class FileWatcher::Private
+{
+public:
+    QSet<QString> changedFiles;
+    QSet<QString> watchedDirs;
+    QSet<QString> newDirs;
+    bool changesKnown = false; // Nothing is known about changes made before we started watching.
+    QSet<QString> lostDirs;
+    QSet<QString> incompleteTrees; // Changes in there might get missed.
+#ifdef Q_OS_LINUX
+    int fd = -1;
+    std::unique_ptr<QSocketNotifier> notifier;
+    QHash<int, QString> dirsByWatchDescriptor;
+    QHash<int, QString> treeRootsByWatchDescriptor;
+#endif
+};
+
+FileWatcher::FileWatcher(QObject *parent)
+    : QObject(parent)
+    , d(std::make_unique<Private>())
+{
+#ifdef Q_OS_LINUX
+    d->fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (d->fd == -1)
+        return;
+    d->notifier = std::make_unique<QSocketNotifier>(d->fd, QSocketNotifier::Read);
+    connect(d->notifier.get(), &QSocketNotifier::activated, this, &FileWatcher::readEvents);
+#endif
+}
+
+FileWatcher::~FileWatcher()
+{
+#ifdef Q_OS_LINUX
+    d->notifier.reset();
+    if (d->fd != -1)
+        close(d->fd);
+#endif
+}
+
+bool FileWatcher::isSupported()
+{
+#ifdef Q_OS_LINUX
+    return true;
+#else
+    return false;
+#endif
+}
+
+bool FileWatcher::watchDirectories(const QStringList &dirPaths)
+{
+    bool success = true;
+    for (const QString &dirPath : dirPaths) {
+        const QString cleanPath = QDir::cleanPath(dirPath);
+        if (!d->watchedDirs.contains(cleanPath) && !addWatch(cleanPath, QString()))
+            success = false;
+    }
+    return success;
+}
+
+bool FileWatcher::watchDirectoryTree(const QString &rootPath)
+{
+    const QString cleanRootPath = QDir::cleanPath(rootPath);
+    d->incompleteTrees.remove(cleanRootPath);
+    return addTreeWatches(cleanRootPath, cleanRootPath);
+}
+
+bool FileWatcher::addTreeWatches(const QString &dirPath, const QString &treeRoot)
+{
+    bool success = addWatch(dirPath, treeRoot);
+    QDirIterator it(dirPath, QDir::Dirs | QDir::NoDotAndDotDot | QDir::Hidden,
+                    QDirIterator::Subdirectories);
+    while (it.hasNext()) {
+        if (!addWatch(it.next(), treeRoot))
+            success = false;
+    }
+    return success;
+}
+
+bool FileWatcher::addWatch(const QString &dirPath, const QString &treeRoot)
+{
+#ifdef Q_OS_LINUX
+    if (d->fd == -1)
+        return false;
+    static const uint32_t mask = IN_ATTRIB | IN_CLOSE_WRITE | IN_CREATE | IN_DELETE
+            | IN_DELETE_SELF | IN_MODIFY | IN_MOVE_SELF | IN_MOVED_FROM | IN_MOVED_TO
+            | IN_ONLYDIR;
+    const int wd = inotify_add_watch(d->fd, QFile::encodeName(dirPath).constData(), mask);
+    if (wd == -1) {
+        // Directories that do not exist cannot contain files the build graph knows about.
+        if (errno == ENOENT || errno == ENOTDIR)
+            return true;
+        if (!treeRoot.isEmpty())
+            d->incompleteTrees.insert(treeRoot);
+        return false;
+    }
+    d->dirsByWatchDescriptor.insert(wd, dirPath);
+    if (!treeRoot.isEmpty())
+        d->treeRootsByWatchDescriptor.insert(wd, treeRoot);
+    if (!d->watchedDirs.contains(dirPath)) {
+        d->watchedDirs.insert(dirPath);
+        d->newDirs.insert(dirPath);
+    }
+    return true;
+#else
+    Q_UNUSED(dirPath);
+    Q_UNUSED(treeRoot);
+    return false;
+#endif
+}
+
+FileWatcher::Changes FileWatcher::takeChanges()
+{
+    // Events for modifications that happened before this call are already queued.
+    readEvents();
+
+    // Directories whose watches got lost are not in watchedDirs anymore, so the caller checks
+    // the files in there itself. The same goes for the roots of trees that are not fully
+    // watched, as these get reported as changed.
+    Changes changes;
+    changes.complete = isSupported() && d->fd != -1 && d->changesKnown;
+    changes.filePaths = QStringList(d->changedFiles.cbegin(), d->changedFiles.cend());
+    for (const QString &treeRoot : qAsConst(d->incompleteTrees)) {
+        if (!d->changedFiles.contains(treeRoot))
+            changes.filePaths << treeRoot;
+    }
+    d->changedFiles.clear();
+    for (const QString &dirPath : qAsConst(d->watchedDirs)) {
+        if (d->newDirs.contains(dirPath))
+            changes.newDirectories << dirPath;
+        else
+            changes.watchedDirectories << dirPath;
+    }
+    d->newDirs.clear();
+
+    // From now on, we see everything.
+    d->changesKnown = true;
+    return changes;
+}
+
+void FileWatcher::restoreChanges(const Changes &changes)
+{
+    if (!changes.complete)
+        d->changesKnown = false;
+    for (const QString &filePath : changes.filePaths)
+        d->changedFiles.insert(filePath);
+    for (const QString &dirPath : changes.newDirectories) {
+        if (d->watchedDirs.contains(dirPath))
+            d->newDirs.insert(dirPath);
+    }
+}
+
+QStringList FileWatcher::takeLostDirectories()
+{
+    readEvents();
+    const QStringList lostDirs(d->lostDirs.cbegin(), d->lostDirs.cend());
+    d->lostDirs.clear();
+    return lostDirs;
+}
+
+void FileWatcher::readEvents()
+{
+#ifdef Q_OS_LINUX
+    if (d->fd == -1)
+        return;
+    alignas(inotify_event) char buffer[16 * 1024];
+    while (true) {
+        const ssize_t length = read(d->fd, buffer, sizeof buffer);
+        if (length <= 0)
+            break;
+        for (const char *p = buffer; p < buffer + length; ) {
+            const auto event = reinterpret_cast<const inotify_event *>(p);
+            p += sizeof(inotify_event) + event->len;
+            if (event->mask & IN_Q_OVERFLOW) {
+                d->changesKnown = false;
+                continue;
+            }
+            if (event->mask & (IN_IGNORED | IN_DELETE_SELF | IN_MOVE_SELF)) {
+                const QString dirPath = d->dirsByWatchDescriptor.take(event->wd);
+                if (dirPath.isEmpty())
+                    continue;
+                d->watchedDirs.remove(dirPath);
+                d->newDirs.remove(dirPath);
+                d->lostDirs.insert(dirPath);
+                const QString treeRoot = d->treeRootsByWatchDescriptor.take(event->wd);
+                if (!treeRoot.isEmpty()) {
+                    d->incompleteTrees.insert(treeRoot);
+                    d->lostDirs.insert(treeRoot);
+                }
+                continue;
+            }
+            const auto it = d->dirsByWatchDescriptor.constFind(event->wd);
+            if (it == d->dirsByWatchDescriptor.constEnd() || event->len == 0)
+                continue;
+            const QString filePath = it.value() + QLatin1Char('/')
+                    + QFile::decodeName(QByteArray(event->name));
+            d->changedFiles.insert(filePath);
+            const auto rootIt = d->treeRootsByWatchDescriptor.constFind(event->wd);
+            if (rootIt == d->treeRootsByWatchDescriptor.constEnd())
+                continue;
+            const QString treeRoot = rootIt.value();
+            d->changedFiles.insert(treeRoot);
+            if ((event->mask & IN_ISDIR) && (event->mask & (IN_CREATE | IN_MOVED_TO)))
+                addTreeWatches(filePath, treeRoot);
+        }
+    }
+    if (d->changedFiles.size() > maxChangedFiles) {
+        d->changedFiles.clear();
+        d->changesKnown = false;
+    }
+#endif
+}
+
+} // namespace Internal
+} // namespace qbs
@@ -0,0 +1,103 @@
+/****************************************************************************
+**
+** Copyright (C) 2022 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of Qbs.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-2.0.html and
+** https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#ifndef QBS_FILEWATCHER_H
+#define QBS_FILEWATCHER_H
+
+#include <QtCore/qobject.h>
+#include <QtCore/qstringlist.h>
+
+#include <memory>
+
+namespace qbs {
+namespace Internal {
+
+// Collects the paths of files that change in a set of watched directories, so that
+// a long-running session can tell the executor which files it needs to look at.
+class FileWatcher : public QObject
+{
+    Q_OBJECT
+public:
+    explicit FileWatcher(QObject *parent = nullptr);
+    ~FileWatcher() override;
+
+    static bool isSupported();
+
+    // Returns false if not all directories could be watched. Directories that are
+    // already being watched are skipped.
+    bool watchDirectories(const QStringList &dirPaths);
+
+    // Like the above, but for the directory and everything below it. A change anywhere
+    // in the tree is reported as a change of rootPath itself.
+    bool watchDirectoryTree(const QString &rootPath);
+
+    struct Changes {
+        QStringList filePaths;
+        bool complete = false; // If false, the caller has to check all files itself.
+
+        // The list of changed files only covers files directly in these directories.
+        // Directories that started being watched after the last call to takeChanges()
+        // are not included, as changes made in there before might have been missed.
+        QStringList watchedDirectories;
+        QStringList newDirectories;
+    };
+
+    // Hands out the changes collected so far and starts collecting anew.
+    Changes takeChanges();
+
+    // Gives back changes that were taken, e.g. because the build they were meant for failed.
+    void restoreChanges(const Changes &changes);
+
+    // Returns the directories and tree roots whose watches got lost since the last call,
+    // e.g. because the directory was removed. They need to be watched again.
+    QStringList takeLostDirectories();
+
+private:
+    bool addWatch(const QString &dirPath, const QString &treeRoot);
+    bool addTreeWatches(const QString &dirPath, const QString &treeRoot);
+    void readEvents();
+
+    class Private;
+    const std::unique_ptr<Private> d;
+};
+
+} // namespace Internal
+} // namespace qbs
+
+#endif // Include guard
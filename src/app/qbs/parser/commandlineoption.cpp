@@ -40,6 +40,7 @@
 
 #include <logging/logger.h>
 #include <logging/translator.h>
+#include <tools/buildoptions.h>
 #include <tools/error.h>
 #include <tools/installoptions.h>
 #include <tools/qttools.h>
@@ -686,6 +687,133 @@ QString DisableFallbackProviderOption::longRepresentation() const
     return QStringLiteral("--no-fallback-module-provider");
 }
 
+QString ActionCacheOption::description(CommandType command) const
+{
+    if (command == ActionCacheCommandType) {
+        return Tr::tr("%1 <directory>\n"
+                      "\tShow statistics of the action cache in the given directory.\n"
+                      "\tThe default is the value of the preference 'actionCacheDirectory'.\n")
+                .arg(longRepresentation());
+    }
+    return Tr::tr("%1 <directory>\n"
+                  "\tReuse the outputs of commands that ran before with the same inputs.\n"
+                  "\tThe outputs are looked up in and stored to the given directory.\n"
+                  "\tThe default is the value of the preference 'actionCacheDirectory'.\n")
+            .arg(longRepresentation());
+}
+
+QString ActionCacheOption::longRepresentation() const
+{
+    return QStringLiteral("--action-cache");
+}
+
+void ActionCacheOption::doParse(const QString &representation, QStringList &input)
+{
+    if (input.empty()) {
+        throw ErrorInfo(Tr::tr("Invalid use of option '%1: Argument expected.\n"
+                           "Usage: %2").arg(representation, description(command())));
+    }
+    m_actionCacheDir = input.takeFirst();
+}
+
+QString MemoryBudgetOption::description(CommandType command) const
+{
+    Q_UNUSED(command);
+    return Tr::tr("%1 <MiB>|auto\n"
+                  "\tDelay commands that would make the expected memory usage of all\n"
+                  "\trunning commands exceed the given number of MiB.\n"
+                  "\tWith 'auto', the memory available at the start of the build is used.\n")
+            .arg(longRepresentation());
+}
+
+QString MemoryBudgetOption::longRepresentation() const
+{
+    return QStringLiteral("--memory-budget");
+}
+
+void MemoryBudgetOption::doParse(const QString &representation, QStringList &input)
+{
+    const QString budgetString = getArgument(representation, input);
+    if (budgetString == QLatin1String("auto")) {
+        m_memoryBudget = BuildOptions::automaticMemoryBudget();
+        return;
+    }
+    bool stringOk;
+    m_memoryBudget = budgetString.toInt(&stringOk);
+    if (!stringOk || m_memoryBudget <= 0)
+        throw ErrorInfo(Tr::tr("Invalid use of option '%1': Illegal memory budget '%2'.\n"
+                               "Usage: %3")
+                    .arg(representation, budgetString, description(command())));
+}
+
+QString MinJobsOption::description(CommandType command) const
+{
+    Q_UNUSED(command);
+    return Tr::tr("%1 <n>\n"
+                  "\tAdapt the number of concurrent build jobs to the system load,\n"
+                  "\tbut never use fewer than <n> of them. The maximum is given by --jobs.\n")
+            .arg(longRepresentation());
+}
+
+QString MinJobsOption::longRepresentation() const
+{
+    return QStringLiteral("--min-jobs");
+}
+
+void MinJobsOption::doParse(const QString &representation, QStringList &input)
+{
+    const QString jobCountString = getArgument(representation, input);
+    bool stringOk;
+    m_minJobCount = jobCountString.toInt(&stringOk);
+    if (!stringOk || m_minJobCount <= 0)
+        throw ErrorInfo(Tr::tr("Invalid use of option '%1': Illegal job count '%2'.\nUsage: %3")
+                    .arg(representation, jobCountString, description(command())));
+}
+
+QString TraceFileOption::description(CommandType command) const
+{
+    Q_UNUSED(command);
+    return Tr::tr("%1 <file>\n"
+                  "\tWrite a trace of module loading, probes, resolving, rule application,\n"
+                  "\tdependency scanning and all commands to the given file.\n"
+                  "\tThe file uses the Chrome trace event format.\n")
+            .arg(longRepresentation());
+}
+
+QString TraceFileOption::longRepresentation() const
+{
+    return QStringLiteral("--trace-file");
+}
+
+void TraceFileOption::doParse(const QString &representation, QStringList &input)
+{
+    m_traceFilePath = getArgument(representation, input);
+}
+
+QString ResolverJobsOption::description(CommandType command) const
+{
+    Q_UNUSED(command);
+    return Tr::tr("%1 <n>\n"
+                  "\tEvaluate the properties of up to <n> products concurrently\n"
+                  "\twhen resolving the project. The default is 1.\n")
+            .arg(longRepresentation());
+}
+
+QString ResolverJobsOption::longRepresentation() const
+{
+    return QStringLiteral("--resolver-jobs");
+}
+
+void ResolverJobsOption::doParse(const QString &representation, QStringList &input)
+{
+    const QString jobCountString = getArgument(representation, input);
+    bool stringOk;
+    m_jobCount = jobCountString.toInt(&stringOk);
+    if (!stringOk || m_jobCount <= 0)
+        throw ErrorInfo(Tr::tr("Invalid use of option '%1': Illegal job count '%2'.\nUsage: %3")
+                    .arg(representation, jobCountString, description(command())));
+}
+
 QString RunEnvConfigOption::description(CommandType command) const
 {
     Q_UNUSED(command);
@@ -76,6 +76,11 @@ public:
         WaitLockOptionType,
         RunEnvConfigOptionType,
         DisableFallbackProviderType,
+        ActionCacheOptionType,
+        MemoryBudgetOptionType,
+        MinJobsOptionType,
+        TraceFileOptionType,
+        ResolverJobsOptionType,
     };
 
     virtual ~CommandLineOption();
@@ -423,6 +428,81 @@ public:
     QString longRepresentation() const override;
 };
 
+class ActionCacheOption : public CommandLineOption
+{
+public:
+    QString actionCacheDir() const { return m_actionCacheDir; }
+
+    QString description(CommandType command) const override;
+    QString shortRepresentation() const override { return {}; }
+    QString longRepresentation() const override;
+
+private:
+    void doParse(const QString &representation, QStringList &input) override;
+
+    QString m_actionCacheDir;
+};
+
+class MemoryBudgetOption : public CommandLineOption
+{
+public:
+    int memoryBudget() const { return m_memoryBudget; }
+
+    QString description(CommandType command) const override;
+    QString shortRepresentation() const override { return {}; }
+    QString longRepresentation() const override;
+
+private:
+    void doParse(const QString &representation, QStringList &input) override;
+
+    int m_memoryBudget = 0;
+};
+
+class TraceFileOption : public CommandLineOption
+{
+public:
+    QString traceFilePath() const { return m_traceFilePath; }
+
+    QString description(CommandType command) const override;
+    QString shortRepresentation() const override { return {}; }
+    QString longRepresentation() const override;
+
+private:
+    void doParse(const QString &representation, QStringList &input) override;
+
+    QString m_traceFilePath;
+};
+
+class MinJobsOption : public CommandLineOption
+{
+public:
+    int minJobCount() const { return m_minJobCount; }
+
+    QString description(CommandType command) const override;
+    QString shortRepresentation() const override { return {}; }
+    QString longRepresentation() const override;
+
+private:
+    void doParse(const QString &representation, QStringList &input) override;
+
+    int m_minJobCount = 0;
+};
+
+class ResolverJobsOption : public CommandLineOption
+{
+public:
+    int jobCount() const { return m_jobCount; }
+
+    QString description(CommandType command) const override;
+    QString shortRepresentation() const override { return {}; }
+    QString longRepresentation() const override;
+
+private:
+    void doParse(const QString &representation, QStringList &input) override;
+
+    int m_jobCount = 1;
+};
+
 } // namespace qbs
 
 #endif // QBS_COMMANDLINEOPTION_H
@@ -134,6 +134,21 @@ CommandLineOption *CommandLineOptionPool::getOption(CommandLineOption::Type type
         case CommandLineOption::RunEnvConfigOptionType:
             option = new RunEnvConfigOption;
             break;
+        case CommandLineOption::ActionCacheOptionType:
+            option = new ActionCacheOption;
+            break;
+        case CommandLineOption::MemoryBudgetOptionType:
+            option = new MemoryBudgetOption;
+            break;
+        case CommandLineOption::MinJobsOptionType:
+            option = new MinJobsOption;
+            break;
+        case CommandLineOption::TraceFileOptionType:
+            option = new TraceFileOption;
+            break;
+        case CommandLineOption::ResolverJobsOptionType:
+            option = new ResolverJobsOption;
+            break;
         default:
             qFatal("Unknown option type %d", type);
         }
@@ -287,4 +302,30 @@ RunEnvConfigOption *CommandLineOptionPool::runEnvConfigOption() const
     return static_cast<RunEnvConfigOption *>(getOption(CommandLineOption::RunEnvConfigOptionType));
 }
 
+ActionCacheOption *CommandLineOptionPool::actionCacheOption() const
+{
+    return static_cast<ActionCacheOption *>(getOption(CommandLineOption::ActionCacheOptionType));
+}
+
+MemoryBudgetOption *CommandLineOptionPool::memoryBudgetOption() const
+{
+    return static_cast<MemoryBudgetOption *>(getOption(CommandLineOption::MemoryBudgetOptionType));
+}
+
+MinJobsOption *CommandLineOptionPool::minJobsOption() const
+{
+    return static_cast<MinJobsOption *>(getOption(CommandLineOption::MinJobsOptionType));
+}
+
+TraceFileOption *CommandLineOptionPool::traceFileOption() const
+{
+    return static_cast<TraceFileOption *>(getOption(CommandLineOption::TraceFileOptionType));
+}
+
+ResolverJobsOption *CommandLineOptionPool::resolverJobsOption() const
+{
+    return static_cast<ResolverJobsOption *>(
+                getOption(CommandLineOption::ResolverJobsOptionType));
+}
+
 } // namespace qbs
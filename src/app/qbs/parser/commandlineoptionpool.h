@@ -79,6 +79,11 @@ public:
     WaitLockOption *waitLockOption() const;
     DisableFallbackProviderOption *disableFallbackProviderOption() const;
     RunEnvConfigOption *runEnvConfigOption() const;
+    ActionCacheOption *actionCacheOption() const;
+    MemoryBudgetOption *memoryBudgetOption() const;
+    MinJobsOption *minJobsOption() const;
+    TraceFileOption *traceFileOption() const;
+    ResolverJobsOption *resolverJobsOption() const;
 
 private:
     mutable QHash<CommandLineOption::Type, CommandLineOption *> m_options;
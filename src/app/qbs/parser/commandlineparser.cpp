@@ -95,6 +95,8 @@ public:
     bool withNonDefaultProducts() const;
     bool dryRun() const;
     QString settingsDir() const { return  optionPool.settingsDirOption()->settingsDir(); }
+    QString actionCacheDir() const;
+    QString traceFilePath() const;
 
     CommandEchoMode echoMode() const;
 
@@ -166,6 +168,9 @@ BuildOptions CommandLineParser::buildOptions(const QString &profile) const
         d->buildOptions.setEchoMode(preferences.defaultEchoMode());
     }
 
+    if (d->buildOptions.actionCacheDirectory().isEmpty())
+        d->buildOptions.setActionCacheDirectory(preferences.actionCacheDirectory());
+
     return d->buildOptions;
 }
 
@@ -237,6 +242,16 @@ bool CommandLineParser::logTime() const
     return d->logTime;
 }
 
+QString CommandLineParser::traceFilePath() const
+{
+    return d->traceFilePath();
+}
+
+int CommandLineParser::resolverJobCount() const
+{
+    return d->optionPool.resolverJobsOption()->jobCount();
+}
+
 bool CommandLineParser::withNonDefaultProducts() const
 {
     return d->withNonDefaultProducts();
@@ -278,6 +293,11 @@ QString CommandLineParser::settingsDir() const
     return d->settingsDir();
 }
 
+QString CommandLineParser::actionCacheDirectory() const
+{
+    return d->actionCacheDir();
+}
+
 QString CommandLineParser::commandName() const
 {
     return d->command->representation();
@@ -346,8 +366,10 @@ void CommandLineParser::CommandLineParserPrivate::doParse()
     }
     command->parse(commandLine);
 
-    if (command->type() == HelpCommandType || command->type() == VersionCommandType)
+    if (command->type() == HelpCommandType || command->type() == VersionCommandType
+            || command->type() == ActionCacheCommandType) {
         return;
+    }
 
     setupBuildDirectory();
     setupBuildConfigurations();
@@ -382,6 +404,7 @@ QList<Command *> CommandLineParser::CommandLineParserPrivate::allCommands() cons
             commandPool.getCommand(ListProductsCommandType),
             commandPool.getCommand(VersionCommandType),
             commandPool.getCommand(SessionCommandType),
+            commandPool.getCommand(ActionCacheCommandType),
             commandPool.getCommand(HelpCommandType)};
 }
 
@@ -458,7 +481,9 @@ void CommandLineParser::CommandLineParserPrivate::setupBuildOptions()
     buildOptions.setForceOutputCheck(optionPool.forceOutputCheckOption()->enabled());
     const JobsOption * jobsOption = optionPool.jobsOption();
     buildOptions.setMaxJobCount(jobsOption->jobCount());
+    buildOptions.setMinJobCount(optionPool.minJobsOption()->minJobCount());
     buildOptions.setLogElapsedTime(logTime);
+    buildOptions.setTraceFilePath(traceFilePath());
     buildOptions.setEchoMode(echoMode());
     buildOptions.setInstall(!optionPool.noInstallOption()->enabled());
     buildOptions.setRemoveExistingInstallation(optionPool.removeFirstoption()->enabled());
@@ -466,6 +491,24 @@ void CommandLineParser::CommandLineParserPrivate::setupBuildOptions()
     buildOptions.setProjectJobLimitsTakePrecedence(
                 optionPool.respectProjectJobLimitsOption()->enabled());
     buildOptions.setSettingsDirectory(settingsDir());
+    buildOptions.setActionCacheDirectory(actionCacheDir());
+    buildOptions.setMemoryBudget(optionPool.memoryBudgetOption()->memoryBudget());
+}
+
+QString CommandLineParser::CommandLineParserPrivate::actionCacheDir() const
+{
+    const QString dir = optionPool.actionCacheOption()->actionCacheDir();
+    if (dir.isEmpty())
+        return dir;
+    return QDir::fromNativeSeparators(QDir::current().absoluteFilePath(dir));
+}
+
+QString CommandLineParser::CommandLineParserPrivate::traceFilePath() const
+{
+    const QString filePath = optionPool.traceFileOption()->traceFilePath();
+    if (filePath.isEmpty())
+        return filePath;
+    return QDir::fromNativeSeparators(QDir::current().absoluteFilePath(filePath));
 }
 
 void CommandLineParser::CommandLineParserPrivate::setupBuildConfigurations()
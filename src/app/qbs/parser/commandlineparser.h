@@ -80,6 +80,8 @@ public:
     bool waitLockBuildGraph() const;
     bool disableFallbackProvider() const;
     bool logTime() const;
+    QString traceFilePath() const;
+    int resolverJobCount() const;
     bool withNonDefaultProducts() const;
     bool buildBeforeInstalling() const;
     QStringList runArgs() const;
@@ -89,6 +91,7 @@ public:
     bool showProgress() const;
     bool showVersion() const;
     QString settingsDir() const;
+    QString actionCacheDirectory() const;
 
 private:
     class CommandLineParserPrivate;
@@ -98,6 +98,9 @@ qbs::Command *CommandPool::getCommand(CommandType type) const
         case SessionCommandType:
             command = new SessionCommand(m_optionPool);
             break;
+        case ActionCacheCommandType:
+            command = new ActionCacheCommand(m_optionPool);
+            break;
         }
     }
     return command;
@@ -208,6 +208,8 @@ static QList<CommandLineOption::Type> resolveOptions()
             CommandLineOption::DryRunOptionType,
             CommandLineOption::ForceProbesOptionType,
             CommandLineOption::LogTimeOptionType,
+            CommandLineOption::TraceFileOptionType,
+            CommandLineOption::ResolverJobsOptionType,
             CommandLineOption::DisableFallbackProviderType};
 }
 
@@ -284,7 +286,10 @@ static QList<CommandLineOption::Type> buildOptions()
             << CommandLineOption::RemoveFirstOptionType
             << CommandLineOption::JobLimitsOptionType
             << CommandLineOption::RespectProjectJobLimitsOptionType
-            << CommandLineOption::WaitLockOptionType;
+            << CommandLineOption::WaitLockOptionType
+            << CommandLineOption::ActionCacheOptionType
+            << CommandLineOption::MemoryBudgetOptionType
+            << CommandLineOption::MinJobsOptionType;
 }
 
 QList<CommandLineOption::Type> BuildCommand::supportedOptions() const
@@ -614,4 +619,34 @@ void SessionCommand::parseNext(QStringList &input)
     throwError(Tr::tr("This command takes no arguments."));
 }
 
+QString ActionCacheCommand::shortDescription() const
+{
+    return Tr::tr("Show statistics of the action cache.");
+}
+
+QString ActionCacheCommand::longDescription() const
+{
+    QString description = Tr::tr("qbs %1 [options]\n").arg(representation());
+    description += Tr::tr("Shows the hit rate and the disk usage of an action cache.\n");
+    return description += supportedOptionsDescription();
+}
+
+QString ActionCacheCommand::representation() const
+{
+    return QStringLiteral("action-cache");
+}
+
+QList<CommandLineOption::Type> ActionCacheCommand::supportedOptions() const
+{
+    return {CommandLineOption::ActionCacheOptionType};
+}
+
+void ActionCacheCommand::parseNext(QStringList &input)
+{
+    QBS_CHECK(!input.empty());
+    if (!input.front().startsWith(QLatin1Char('-')))
+        throwError(Tr::tr("This command takes no arguments."));
+    Command::parseNext(input);
+}
+
 } // namespace qbs
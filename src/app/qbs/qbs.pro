@@ -5,6 +5,7 @@ TARGET = qbs
 
 SOURCES += main.cpp \
     ctrlchandler.cpp \
+    filewatcher.cpp \
     application.cpp \
     session.cpp \
     sessionpacket.cpp \
@@ -17,6 +18,7 @@ SOURCES += main.cpp \
 
 HEADERS += \
     ctrlchandler.h \
+    filewatcher.h \
     application.h \
     session.h \
     sessionpacket.h \
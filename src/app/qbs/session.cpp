@@ -39,6 +39,7 @@
 
 #include "session.h"
 
+#include "filewatcher.h"
 #include "sessionpacket.h"
 #include "sessionpacketreader.h"
 
@@ -61,10 +62,12 @@
 
 #include <QtCore/qcoreapplication.h>
 #include <QtCore/qdir.h>
+#include <QtCore/qfileinfo.h>
 #include <QtCore/qjsonarray.h>
 #include <QtCore/qjsonobject.h>
 #include <QtCore/qobject.h>
 #include <QtCore/qprocess.h>
+#include <QtCore/qset.h>
 
 #include <algorithm>
 #include <cstdlib>
@@ -165,6 +168,10 @@ private:
     };
     FileUpdateData prepareFileUpdate(const QJsonObject &request);
 
+    void startWatchingFiles();
+    void watchInputFiles();
+    bool buildsAllProducts(const ProductSelection &productSelection) const;
+
     SessionPacketReader m_packetReader;
     Project m_project;
     ProjectData m_projectData;
@@ -173,6 +180,8 @@ private:
     QJsonObject m_resolveRequest;
     QStringList m_moduleProperties;
     AbstractJob *m_currentJob = nullptr;
+    std::unique_ptr<FileWatcher> m_fileWatcher;
+    QSet<QString> m_watchedInputFiles;
 };
 
 void startSession()
@@ -261,6 +270,7 @@ void Session::setupProject(const QJsonObject &request)
     m_moduleProperties = modulePropertiesFromRequest(request);
     auto params = SetupProjectParameters::fromJson(request);
     const ProjectDataMode dataMode = dataModeFromRequest(request);
+    const bool watchFiles = request.value(QLatin1String("watch-files")).toBool();
     m_settings = std::make_unique<Settings>(params.settingsDirectory());
     const Preferences prefs(m_settings.get());
     const QString appDir = QDir::cleanPath(QCoreApplication::applicationDirPath());
@@ -269,13 +279,17 @@ void Session::setupProject(const QJsonObject &request)
     params.setPluginPaths(prefs.pluginPaths(appDir + QLatin1String(
                                                 "/" QBS_RELATIVE_PLUGINS_PATH)));
     params.setLibexecPath(appDir + QLatin1String("/" QBS_RELATIVE_LIBEXEC_PATH));
+    if (!request.contains(QLatin1String("parse-cache-directory")))
+        params.setParseCacheDirectory(prefs.parseCacheDirectory());
+    if (!request.contains(QLatin1String("probe-cache-directory")))
+        params.setProbeCacheDirectory(prefs.probeCacheDirectory());
     params.setOverrideBuildGraphData(true);
     setLogLevelFromRequest(request);
     SetupProjectJob * const setupJob = m_project.setupProject(params, &m_logSink, this);
     m_currentJob = setupJob;
     connectProgressSignals(setupJob);
     connect(setupJob, &AbstractJob::finished, this,
-            [this, setupJob, dataMode](bool success) {
+            [this, setupJob, dataMode, watchFiles](bool success) {
         if (!m_resolveRequest.isEmpty()) { // Canceled job was superseded.
             const QJsonObject newRequest = std::move(m_resolveRequest);
             m_resolveRequest = QJsonObject();
@@ -287,6 +301,10 @@ void Session::setupProject(const QJsonObject &request)
         const ProjectData oldProjectData = m_projectData;
         m_project = setupJob->project();
         m_projectData = m_project.projectData();
+        m_fileWatcher.reset();
+        m_watchedInputFiles.clear();
+        if (success && watchFiles)
+            startWatchingFiles();
         QJsonObject reply;
         reply.insert(StringConstants::type(), QLatin1String("project-resolved"));
         if (success)
@@ -307,6 +325,16 @@ void Session::buildProject(const QJsonObject &request)
     setLogLevelFromRequest(request);
     auto options = BuildOptions::fromJson(request);
     options.setSettingsDirectory(m_settings->baseDirectory());
+    FileWatcher::Changes watchedChanges;
+    if (m_fileWatcher && !request.contains(QLatin1String("changed-files"))) {
+        watchedChanges = m_fileWatcher->takeChanges();
+        if (watchedChanges.complete && !watchedChanges.watchedDirectories.isEmpty()) {
+            options.setChangedFiles(watchedChanges.filePaths);
+            options.setChangedFilesComplete(true);
+            options.setWatchedDirectories(watchedChanges.watchedDirectories);
+        }
+    }
+    const bool buildsEverything = buildsAllProducts(productSelection);
     BuildJob * const buildJob = productSelection.products.empty()
             ? m_project.buildAllProducts(options, productSelection.selection, this)
             : m_project.buildSomeProducts(productSelection.products, options, this);
@@ -322,6 +350,15 @@ void Session::buildProject(const QJsonObject &request)
         descData.insert(StringConstants::messageKey(), message);
         sendPacket(descData);
     });
+    connect(buildJob, &BuildJob::reportCommandOutput, this,
+            [this](const QString &executableFilePath, const QStringList &lines, bool stdErr) {
+        QJsonObject outputData;
+        outputData.insert(StringConstants::type(), QLatin1String("process-output"));
+        outputData.insert(QLatin1String("executable-file-path"), executableFilePath);
+        outputData.insert(stdErr ? QLatin1String("stderr") : QLatin1String("stdout"),
+                          QJsonArray::fromStringList(lines));
+        sendPacket(outputData);
+    });
     connect(buildJob, &BuildJob::reportProcessResult, this, [this](const ProcessResult &result) {
         if (result.success() && result.stdOut().isEmpty() && result.stdErr().isEmpty())
             return;
@@ -330,11 +367,16 @@ void Session::buildProject(const QJsonObject &request)
         sendPacket(resultData);
     });
     connect(buildJob, &BuildJob::finished, this,
-            [this, dataMode](bool success) {
+            [this, dataMode, watchedChanges, buildsEverything](bool success) {
+        // Products that were not built have not seen the changes yet.
+        if (m_fileWatcher && (!success || !buildsEverything))
+            m_fileWatcher->restoreChanges(watchedChanges);
         QJsonObject reply;
         reply.insert(StringConstants::type(), QLatin1String("project-built"));
         const ProjectData oldProjectData = m_projectData;
         m_projectData = m_project.projectData();
+        if (m_fileWatcher)
+            watchInputFiles();
         if (success)
             insertProjectDataIfNecessary(reply, dataMode, oldProjectData, false);
         else
@@ -602,12 +644,94 @@ void Session::releaseProject()
     }
     m_project = Project();
     m_projectData = ProjectData();
+    m_fileWatcher.reset();
+    m_watchedInputFiles.clear();
     m_resolveRequest = QJsonObject();
     QJsonObject reply;
     reply.insert(StringConstants::type(), QLatin1String(replyType));
     sendPacket(reply);
 }
 
+void Session::startWatchingFiles()
+{
+    if (!FileWatcher::isSupported())
+        return;
+    QSet<QString> dirPaths;
+    static const char * const includePathProperties[] = {
+        "includePaths", "systemIncludePaths", "distributionIncludePaths", "compilerIncludePaths"
+    };
+    const QList<ProductData> products = m_projectData.allProducts();
+    for (const ProductData &product : products) {
+        for (const GroupData &group : product.groups()) {
+            const QStringList filePaths = group.allFilePaths();
+            for (const QString &filePath : filePaths)
+                dirPaths << QFileInfo(filePath).absolutePath();
+        }
+        for (const char * const property : includePathProperties) {
+            const QStringList includePaths = product.moduleProperties().getModuleProperty(
+                        QStringLiteral("cpp"), QLatin1String(property)).toStringList();
+            for (const QString &includePath : includePaths)
+                dirPaths << QDir::cleanPath(includePath);
+        }
+    }
+    m_fileWatcher = std::make_unique<FileWatcher>();
+    if (!m_fileWatcher->watchDirectories(QStringList(dirPaths.cbegin(), dirPaths.cend()))) {
+        m_logSink.printWarning(ErrorInfo(tr("Could not watch all project directories for "
+                                            "changes; builds will check all timestamps.")));
+    }
+    watchInputFiles();
+}
+
+// Source files and file dependencies can appear in the build graph with every build,
+// e.g. when a new header gets included, so this is called again after each build.
+void Session::watchInputFiles()
+{
+    // Directories can lose their watches, e.g. when they get removed and re-created.
+    // The files in there are then not skipped anymore below, so they get watched again.
+    const QStringList lostDirs = m_fileWatcher->takeLostDirectories();
+    QSet<QString> dirPaths(lostDirs.cbegin(), lostDirs.cend());
+    if (!dirPaths.isEmpty()) {
+        for (auto it = m_watchedInputFiles.begin(); it != m_watchedInputFiles.end();) {
+            if (dirPaths.contains(*it) || dirPaths.contains(QFileInfo(*it).absolutePath()))
+                it = m_watchedInputFiles.erase(it);
+            else
+                ++it;
+        }
+    }
+    bool success = true;
+    for (const QString &filePath : m_project.inputFilePaths()) {
+        if (m_watchedInputFiles.contains(filePath))
+            continue;
+        m_watchedInputFiles.insert(filePath);
+        const QFileInfo fileInfo(filePath);
+        dirPaths << fileInfo.absolutePath();
+
+        // The executor takes the timestamps of directories from their contents.
+        if (fileInfo.isDir() && !m_fileWatcher->watchDirectoryTree(filePath))
+            success = false;
+    }
+    if (!m_fileWatcher->watchDirectories(QStringList(dirPaths.cbegin(), dirPaths.cend())))
+        success = false;
+    if (!success) {
+        m_logSink.printWarning(ErrorInfo(tr("Could not watch all directories of source files "
+                                            "and dependencies for changes; builds will check "
+                                            "all timestamps.")));
+    }
+}
+
+bool Session::buildsAllProducts(const ProductSelection &productSelection) const
+{
+    if (!productSelection.products.empty())
+        return false;
+    if (productSelection.selection == Project::ProductSelectionWithNonDefault)
+        return true;
+    const QList<ProductData> products = m_projectData.allProducts();
+    return std::all_of(products.cbegin(), products.cend(), [](const ProductData &product) {
+        return !product.isEnabled() || product.properties().value(
+                    StringConstants::builtByDefaultProperty(), true).toBool();
+    });
+}
+
 void Session::cancelCurrentJob()
 {
     if (m_currentJob) {
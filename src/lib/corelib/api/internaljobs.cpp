@@ -58,6 +58,7 @@
 #include <tools/progressobserver.h>
 #include <tools/preferences.h>
 #include <tools/qbsassert.h>
+#include <tools/tracerecorder.h>
 
 #include <QtCore/qtimer.h>
 
@@ -82,8 +83,7 @@ private:
     void initialize(const QString &task, int maximum) override
     {
         QBS_ASSERT(!m_timedLogger, delete m_timedLogger);
-        if (m_job->timed())
-            m_timedLogger = new TimedActivityLogger(m_job->logger(), task, true);
+        m_timedLogger = new TimedActivityLogger(m_job->logger(), task, m_job->timed());
         m_value = 0;
         m_maximum = maximum;
         emit m_job->newTaskStarted(task, maximum, m_job);
@@ -168,6 +168,13 @@ void InternalJob::storeBuildGraph(const TopLevelProjectPtr &project)
     }
 }
 
+void InternalJob::writeTraceFile()
+{
+    QString errorMessage;
+    if (!TraceRecorder::instance().writeFile(&errorMessage))
+        m_logger.printWarning(ErrorInfo(errorMessage));
+}
+
 
 /**
  * Construct a new thread wrapper for a synchronous job.
@@ -247,6 +254,11 @@ TopLevelProjectPtr InternalSetupProjectJob::project() const
 
 void InternalSetupProjectJob::start()
 {
+    TraceRecorder &traceRecorder = TraceRecorder::instance();
+    traceRecorder.stop();
+    if (!m_parameters.traceFilePath().isEmpty())
+        traceRecorder.start(m_parameters.traceFilePath());
+
     BuildGraphLocker *bgLocker = m_existingProject ? m_existingProject->bgLocker : nullptr;
     bool deleteLocker = false;
     try {
@@ -281,6 +293,7 @@ void InternalSetupProjectJob::start()
         if (deleteLocker)
             delete bgLocker;
     }
+    writeTraceFile();
     emit finished(this);
 }
 
@@ -374,6 +387,12 @@ void InternalBuildJob::build(const TopLevelProjectPtr &project,
     setup(project, products, buildOptions.dryRun());
     setTimed(buildOptions.logElapsedTime());
 
+    // Continues the recording of a preceding setup job that used the same file.
+    if (buildOptions.traceFilePath().isEmpty())
+        TraceRecorder::instance().stop();
+    else
+        TraceRecorder::instance().start(buildOptions.traceFilePath());
+
     m_executor = new Executor(logger());
     m_executor->setProject(project);
     m_executor->setProducts(products);
@@ -381,9 +400,12 @@ void InternalBuildJob::build(const TopLevelProjectPtr &project,
     m_executor->setProgressObserver(observer());
 
     const auto executorThread = new QThread(this);
+    executorThread->setObjectName(QStringLiteral("Executor"));
     m_executor->moveToThread(executorThread);
     connect(m_executor, &Executor::reportCommandDescription,
             this, &BuildGraphTouchingJob::reportCommandDescription);
+    connect(m_executor, &Executor::reportCommandOutput,
+            this, &BuildGraphTouchingJob::reportCommandOutput);
     connect(m_executor, &Executor::reportProcessResult,
             this, &BuildGraphTouchingJob::reportProcessResult);
 
@@ -404,6 +426,8 @@ void InternalBuildJob::handleFinished()
 
 void InternalBuildJob::emitFinished()
 {
+    writeTraceFile();
+    TraceRecorder::instance().stop();
     emit finished(this);
 }
 
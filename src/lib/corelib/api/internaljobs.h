@@ -85,6 +85,7 @@ protected:
     JobObserver *observer() const { return m_observer; }
     void setTimed(bool timed) { m_timed = timed; }
     void storeBuildGraph(const TopLevelProjectPtr &project);
+    void writeTraceFile();
 
 signals:
     void finished(Internal::InternalJob *job);
@@ -156,6 +157,8 @@ public:
 
 signals:
     void reportCommandDescription(const QString &highlight, const QString &message);
+    void reportCommandOutput(const QString &executableFilePath, const QStringList &lines,
+                             bool stdErr);
     void reportProcessResult(const qbs::ProcessResult &result);
 
 protected:
@@ -291,6 +291,14 @@ void SetupProjectJob::finish()
  * The \a message parameter is the localized message to print.
  */
 
+/*!
+ * \fn void BuildJob::reportCommandOutput(const QString &executableFilePath, const QStringList &lines, bool stdErr)
+ * \brief Signals that an external command has written the given \a lines of output.
+ * The \a executableFilePath parameter identifies the program, and \a stdErr is true if the
+ * output went to the standard error channel. Only output that the command's ProcessResult
+ * will contain unchanged is reported this way; see ProcessResult::outputForwarded().
+ */
+
 /*!
  * \fn void BuildJob::reportProcessResult(const qbs::ProcessResult &result)
  * \brief Signals that an external command has finished.
@@ -305,6 +313,8 @@ BuildJob::BuildJob(const Logger &logger, QObject *parent)
     auto job = static_cast<InternalBuildJob *>(internalJob());
     connect(job, &BuildGraphTouchingJob::reportCommandDescription,
             this, &BuildJob::reportCommandDescription);
+    connect(job, &BuildGraphTouchingJob::reportCommandOutput,
+            this, &BuildJob::reportCommandOutput);
     connect(job, &BuildGraphTouchingJob::reportProcessResult,
             this, &BuildJob::reportProcessResult);
 }
@@ -314,7 +324,8 @@ void BuildJob::build(const TopLevelProjectPtr &project, const QVector<ResolvedPr
 {
     if (!lockProject(project))
         return;
-    LauncherInterface::startLauncher();
+    LauncherInterface::startLauncher(options.maxJobCount() > 0
+                                     ? options.maxJobCount() : BuildOptions::defaultMaxJobCount());
     qobject_cast<InternalBuildJob *>(internalJob())->build(project, products, options);
 }
 
@@ -130,6 +130,8 @@ class QBS_EXPORT BuildJob : public AbstractJob
 
 signals:
     void reportCommandDescription(const QString &highlight, const QString &message);
+    void reportCommandOutput(const QString &executableFilePath, const QStringList &lines,
+                             bool stdErr);
     void reportProcessResult(const qbs::ProcessResult &result);
 
 private:
@@ -666,7 +666,26 @@ void ProjectPrivate::retrieveProjectData(ProjectData &projectData,
             if (resolvedGroup->targetOfModule.isEmpty())
                 product.d->groups << createGroupDataFromGroup(resolvedGroup, resolvedProduct);
         }
-        if (resolvedProduct->enabled) {
+        if (resolvedProduct->enabled && !resolvedProduct->buildData.isLoaded()) {
+            // Do not load the build data just for this.
+            const auto addArtifacts = [this, &product, &resolvedProduct](
+                    const std::vector<ArtifactSummary> &artifacts) {
+                for (const ArtifactSummary &artifact : artifacts) {
+                    ArtifactData ta;
+                    ta.d->filePath = artifact.filePath;
+                    ta.d->fileTags = artifact.fileTags.toStringList();
+                    ta.d->properties.d->m_map = artifact.properties;
+                    ta.d->isGenerated = true;
+                    ta.d->isTargetArtifact = artifact.isTargetArtifact;
+                    ta.d->isValid = true;
+                    setupInstallData(ta, resolvedProduct);
+                    product.d->generatedArtifacts << ta;
+                }
+            };
+            const ProductBuildDataSummary * const summary = resolvedProduct->buildData.summary();
+            addArtifacts(summary->generatedArtifacts);
+            addArtifacts(summary->rescuedArtifacts);
+        } else if (resolvedProduct->enabled) {
             QBS_CHECK(resolvedProduct->buildData);
             const ArtifactSet targetArtifacts = resolvedProduct->targetArtifacts();
             for (Artifact * const a
@@ -961,6 +980,30 @@ std::set<QString> Project::buildSystemFiles() const
     return rangeTo<std::set<QString>>(d->internalProject->buildSystemFiles);
 }
 
+/*!
+ * \brief Returns the paths of the files whose timestamps qbs checks when building,
+ * that is all source files and file dependencies, such as included headers.
+ */
+std::set<QString> Project::inputFilePaths() const
+{
+    QBS_ASSERT(isValid(), return {});
+    std::set<QString> filePaths;
+    if (!d->internalProject->buildData)
+        return filePaths;
+    for (const FileDependency * const dep : d->internalProject->buildData->fileDependencies)
+        filePaths.insert(dep->filePath());
+    for (const ResolvedProductPtr &product : d->internalProject->allProducts()) {
+        if (!product->buildData)
+            continue;
+        for (const Artifact * const artifact
+             : filterByType<Artifact>(product->buildData->allNodes())) {
+            if (artifact->artifactType == Artifact::SourceFile)
+                filePaths.insert(artifact->filePath());
+        }
+    }
+    return filePaths;
+}
+
 RuleCommandList Project::ruleCommands(const ProductData &product,
         const QString &inputFilePath, const QString &outputFileTag, ErrorInfo *error) const
 {
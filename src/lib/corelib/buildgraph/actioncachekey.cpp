@@ -0,0 +1,196 @@
+/****************************************************************************
+**
+** Copyright (C) 2022 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of Qbs.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-2.0.html and
+** https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#include "actioncachekey.h"
+
+#include "artifact.h"
+#include "filedependency.h"
+#include "rulecommands.h"
+#include "transformer.h"
+
+#include <language/language.h>
+#include <logging/categories.h>
+#include <tools/executablefinder.h>
+#include <tools/fileinfo.h>
+#include <tools/qttools.h>
+
+#include <QtCore/qcryptographichash.h>
+#include <QtCore/qdatetime.h>
+#include <QtCore/qfile.h>
+#include <QtCore/qfileinfo.h>
+
+#include <algorithm>
+#include <vector>
+
+namespace qbs {
+namespace Internal {
+
+// Must be increased whenever the way keys are computed changes.
+static const int keyFormatVersion = 2;
+
+static void addToHash(QCryptographicHash &hash, const QString &s)
+{
+    hash.addData(s.toUtf8());
+    hash.addData("", 1); // Separator, so that ("ab", "c") and ("a", "bc") differ.
+}
+
+static void addToHash(QCryptographicHash &hash, qint64 n)
+{
+    addToHash(hash, QString::number(n));
+}
+
+ActionCacheKeyGenerator::ActionCacheKeyGenerator(QString buildDirectory)
+    : m_buildDirectory(std::move(buildDirectory))
+{
+}
+
+QString ActionCacheKeyGenerator::normalized(const QString &filePath) const
+{
+    QString s = filePath;
+    return s.replace(m_buildDirectory, QStringLiteral("${BUILD_DIR}"));
+}
+
+QByteArray ActionCacheKeyGenerator::fileHash(const QString &filePath)
+{
+    const FileTime timestamp = FileInfo(filePath).lastModified();
+    const auto it = m_fileHashes.constFind(filePath);
+    if (it != m_fileHashes.constEnd() && it->first == timestamp)
+        return it->second;
+    QFile file(filePath);
+    if (!file.open(QIODevice::ReadOnly))
+        return {};
+    QCryptographicHash hash(QCryptographicHash::Sha256);
+    if (!hash.addData(&file))
+        return {};
+    const QByteArray result = hash.result();
+    m_fileHashes.insert(filePath, std::make_pair(timestamp, result));
+    return result;
+}
+
+QByteArray ActionCacheKeyGenerator::key(const Transformer *transformer)
+{
+    if (transformer->alwaysRun || transformer->commands.empty())
+        return {};
+
+    // Commands that report their dependencies have not been scanned, so the dependencies
+    // are only known once the commands have run at least once.
+    if (transformer->commandsReportDependencies()
+            && !transformer->lastCommandExecutionTime.isValid()) {
+        return {};
+    }
+
+    QCryptographicHash hash(QCryptographicHash::Sha256);
+    addToHash(hash, keyFormatVersion);
+
+    const ResolvedProductPtr product = transformer->product();
+    for (const AbstractCommandPtr &command : transformer->commands.commands()) {
+        // JavaScriptCommands can do arbitrary things that we cannot capture in the key.
+        if (command->type() != AbstractCommand::ProcessCommandType)
+            return {};
+        const auto cmd = static_cast<const ProcessCommand *>(command.get());
+        const QString program = ExecutableFinder(product, product->buildEnvironment)
+                .findExecutable(cmd->program(), cmd->workingDir());
+        const QFileInfo programInfo(program);
+        if (!programInfo.exists())
+            return {};
+        addToHash(hash, normalized(program));
+        addToHash(hash, programInfo.lastModified().toMSecsSinceEpoch());
+        addToHash(hash, programInfo.size());
+        addToHash(hash, cmd->arguments().size());
+        for (const QString &arg : cmd->arguments())
+            addToHash(hash, normalized(arg));
+        addToHash(hash, normalized(cmd->workingDir()));
+        QStringList env = cmd->environment().toStringList();
+        env.sort();
+        for (const QString &var : qAsConst(env))
+            addToHash(hash, normalized(var));
+        for (const QString &var : cmd->relevantEnvVars())
+            addToHash(hash, var + QLatin1Char('=') + product->buildEnvironment.value(var));
+        addToHash(hash, cmd->maxExitCode());
+        addToHash(hash, cmd->stdoutFilterFunction());
+        addToHash(hash, cmd->stderrFilterFunction());
+        addToHash(hash, normalized(cmd->stdoutFilePath()));
+        addToHash(hash, normalized(cmd->stderrFilePath()));
+        addToHash(hash, normalized(cmd->dependencyFilePath()));
+        addToHash(hash, cmd->dependencyOutputPrefix());
+        addToHash(hash, cmd->responseFileThreshold());
+        addToHash(hash, cmd->responseFileArgumentIndex());
+        addToHash(hash, cmd->responseFileUsagePrefix());
+        addToHash(hash, cmd->responseFileSeparator());
+    }
+
+    // Everything the outputs depend on, including scanned dependencies.
+    std::vector<QString> inputFilePaths;
+    for (const Artifact * const output : transformer->outputs) {
+        for (const Artifact * const child : output->childArtifacts()) {
+            if (!transformer->outputs.contains(const_cast<Artifact *>(child)))
+                inputFilePaths.push_back(child->filePath());
+        }
+        for (const FileDependency * const dep : output->fileDependencies)
+            inputFilePaths.push_back(dep->filePath());
+    }
+    std::sort(inputFilePaths.begin(), inputFilePaths.end());
+    inputFilePaths.erase(std::unique(inputFilePaths.begin(), inputFilePaths.end()),
+                         inputFilePaths.end());
+    for (const QString &filePath : inputFilePaths) {
+        const QByteArray contentHash = fileHash(filePath);
+        if (contentHash.isEmpty()) {
+            qCDebug(lcExec) << "cannot hash input" << filePath << "for the action cache";
+            return {};
+        }
+        addToHash(hash, normalized(filePath));
+        hash.addData(contentHash);
+    }
+
+    for (const auto &output : outputs(transformer))
+        addToHash(hash, output.first);
+    return hash.result();
+}
+
+ActionCache::Outputs ActionCacheKeyGenerator::outputs(const Transformer *transformer) const
+{
+    ActionCache::Outputs outputs;
+    for (const Artifact * const output : transformer->outputs)
+        outputs.emplace_back(normalized(output->filePath()), output->filePath());
+    std::sort(outputs.begin(), outputs.end());
+    return outputs;
+}
+
+} // namespace Internal
+} // namespace qbs
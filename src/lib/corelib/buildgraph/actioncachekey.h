@@ -0,0 +1,83 @@
+/****************************************************************************
+**
+** Copyright (C) 2022 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of Qbs.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-2.0.html and
+** https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#ifndef QBS_ACTIONCACHEKEY_H
+#define QBS_ACTIONCACHEKEY_H
+
+#include <tools/actioncache.h>
+#include <tools/filetime.h>
+
+#include <QtCore/qbytearray.h>
+#include <QtCore/qhash.h>
+#include <QtCore/qstring.h>
+
+#include <utility>
+
+namespace qbs {
+namespace Internal {
+class Transformer;
+
+/*!
+ * Computes the keys under which the outputs of transformers are stored in the action cache.
+ * A key covers the command lines, the relevant parts of the environment, the programs and
+ * the contents of all input files. Paths in the build directory are replaced by a placeholder,
+ * so that different build directories of the same project can share cache entries.
+ */
+class ActionCacheKeyGenerator
+{
+public:
+    explicit ActionCacheKeyGenerator(QString buildDirectory);
+
+    // Returns an empty array if the transformer's commands cannot be cached.
+    QByteArray key(const Transformer *transformer);
+
+    ActionCache::Outputs outputs(const Transformer *transformer) const;
+
+private:
+    QString normalized(const QString &filePath) const;
+    QByteArray fileHash(const QString &filePath);
+
+    const QString m_buildDirectory;
+    QHash<QString, std::pair<FileTime, QByteArray>> m_fileHashes;
+};
+
+} // namespace Internal
+} // namespace qbs
+
+#endif // QBS_ACTIONCACHEKEY_H
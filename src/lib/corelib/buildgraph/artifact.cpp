@@ -134,6 +134,11 @@ const TypeFilter<Artifact> Artifact::childArtifacts() const
     return TypeFilter<Artifact>(children);
 }
 
+const FileTime &Artifact::lastContentChange() const
+{
+    return contentChangeTime.isValid() ? contentChangeTime : timestamp();
+}
+
 void Artifact::onChildDisconnected(BuildGraphNode *child)
 {
     if (child->type() != BuildGraphNode::ArtifactNodeType)
@@ -159,6 +164,8 @@ void Artifact::load(PersistentPool &pool)
     pool.load(m_fileTags);
     pool.load(pureFileTags);
     pool.load(pureProperties);
+    pool.load(contentHash);
+    pool.load(contentChangeTime);
     artifactType = static_cast<ArtifactType>(pool.load<quint8>());
     alwaysUpdated = pool.load<bool>();
     oldDataPossiblyPresent = pool.load<bool>();
@@ -178,6 +185,8 @@ void Artifact::store(PersistentPool &pool)
     pool.store(m_fileTags);
     pool.store(pureFileTags);
     pool.store(pureProperties);
+    pool.store(contentHash);
+    pool.store(contentChangeTime);
     pool.store(static_cast<quint8>(artifactType));
     pool.store(alwaysUpdated);
     pool.store(oldDataPossiblyPresent);
@@ -48,6 +48,7 @@
 #include <tools/filetime.h>
 #include <tools/set.h>
 
+#include <QtCore/qbytearray.h>
 #include <QtCore/qstring.h>
 
 #include <utility>
@@ -108,6 +109,13 @@ public:
         Generated = 4
     };
 
+    // Digest of the file contents and the time they last changed. If a transformer re-creates
+    // an artifact with identical contents, the latter stays behind timestamp(), so parents
+    // do not have to be rebuilt.
+    QByteArray contentHash;
+    FileTime contentChangeTime;
+    const FileTime &lastContentChange() const;
+
     ArtifactType artifactType;
     bool inputsScanned : 1;                 // Do not serialize. Will be refreshed for every build.
     bool timestampRetrieved : 1;            // Do not serialize. Will be refreshed for every build.
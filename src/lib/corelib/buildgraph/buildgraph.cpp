@@ -536,6 +536,7 @@ void disconnect(BuildGraphNode *u, BuildGraphNode *v)
     u->children.remove(v);
     v->parents.remove(u);
     u->onChildDisconnected(v);
+    u->product->topLevelProject()->buildData->setDirty();
 }
 
 void removeGeneratedArtifactFromDisk(Artifact *artifact, const Logger &logger)
@@ -2,6 +2,7 @@ include(../../../install_prefix.pri)
 
 SOURCES += \
     $$PWD/abstractcommandexecutor.cpp \
+    $$PWD/actioncachekey.cpp \
     $$PWD/artifact.cpp \
     $$PWD/artifactcleaner.cpp \
     $$PWD/artifactsscriptvalue.cpp \
@@ -17,12 +18,16 @@ SOURCES += \
     $$PWD/executor.cpp \
     $$PWD/executorjob.cpp \
     $$PWD/filedependency.cpp \
+    $$PWD/fileexistencecache.cpp \
     $$PWD/inputartifactscanner.cpp \
+    $$PWD/jobserver.cpp \
     $$PWD/jscommandexecutor.cpp \
     $$PWD/nodeset.cpp \
     $$PWD/nodetreedumper.cpp \
+    $$PWD/persistentworkerpool.cpp \
     $$PWD/processcommandexecutor.cpp \
     $$PWD/productbuilddata.cpp \
+    $$PWD/productbuilddataloader.cpp \
     $$PWD/productinstaller.cpp \
     $$PWD/projectbuilddata.cpp \
     $$PWD/qtmocscanner.cpp \
@@ -41,6 +46,7 @@ SOURCES += \
 
 HEADERS += \
     $$PWD/abstractcommandexecutor.h \
+    $$PWD/actioncachekey.h \
     $$PWD/artifact.h \
     $$PWD/artifactcleaner.h \
     $$PWD/artifactsscriptvalue.h \
@@ -57,13 +63,17 @@ HEADERS += \
     $$PWD/executor.h \
     $$PWD/executorjob.h \
     $$PWD/filedependency.h \
+    $$PWD/fileexistencecache.h \
     $$PWD/forward_decls.h \
     $$PWD/inputartifactscanner.h \
+    $$PWD/jobserver.h \
     $$PWD/jscommandexecutor.h \
     $$PWD/nodeset.h \
     $$PWD/nodetreedumper.h \
+    $$PWD/persistentworkerpool.h \
     $$PWD/processcommandexecutor.h \
     $$PWD/productbuilddata.h \
+    $$PWD/productbuilddataloader.h \
     $$PWD/productinstaller.h \
     $$PWD/projectbuilddata.h \
     $$PWD/qtmocscanner.h \
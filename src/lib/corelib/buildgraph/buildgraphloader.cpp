@@ -42,6 +42,7 @@
 #include "cycledetector.h"
 #include "emptydirectoriesremover.h"
 #include "productbuilddata.h"
+#include "productbuilddataloader.h"
 #include "projectbuilddata.h"
 #include "rulenode.h"
 #include "rulecommands.h"
@@ -67,6 +68,7 @@
 #include <tools/settings.h>
 #include <tools/stlutils.h>
 #include <tools/stringconstants.h>
+#include <tools/tracerecorder.h>
 
 #include <QtCore/qdir.h>
 #include <QtCore/qfileinfo.h>
@@ -89,19 +91,11 @@ BuildGraphLoader::~BuildGraphLoader()
     qDeleteAll(m_objectsToDelete);
 }
 
+// The back pointers of the build graph nodes get restored by the ProductBuildDataLoader.
 static void restoreBackPointers(const ResolvedProjectPtr &project)
 {
-    for (const ResolvedProductPtr &product : project->products) {
+    for (const ResolvedProductPtr &product : project->products)
         product->project = project;
-        if (!product->buildData)
-            continue;
-        for (BuildGraphNode * const n : qAsConst(product->buildData->allNodes())) {
-            if (n->type() == BuildGraphNode::ArtifactNodeType) {
-                project->topLevelProject()->buildData
-                        ->insertIntoLookupTable(static_cast<Artifact *>(n));
-            }
-        }
-    }
 
     for (const ResolvedProjectPtr &subProject : qAsConst(project->subProjects)) {
         subProject->parentProject = project;
@@ -158,23 +152,35 @@ TopLevelProjectConstPtr BuildGraphLoader::loadProject(const QString &bgFilePath)
     } dummySink;
     Logger dummyLogger(&dummySink);
     BuildGraphLocker bgLocker(bgFilePath, dummyLogger, false, nullptr);
-    PersistentPool pool(dummyLogger);
-    pool.load(bgFilePath);
+    const auto loader = std::make_shared<ProductBuildDataLoader>();
+    loader->pool().load(bgFilePath);
     const TopLevelProjectPtr project = TopLevelProject::create();
-    project->load(pool);
-    project->setBuildConfiguration(pool.headData().projectConfig);
+    project->load(loader->pool());
+    ProductBuildDataLoader::attach(loader, project);
+    project->setBuildConfiguration(loader->pool().headData().projectConfig);
     return project;
 }
 
 void BuildGraphLoader::loadBuildGraphFromDisk()
 {
+    TraceScope traceScope("build graph", Tr::tr("Loading build graph"));
     const QString projectId = TopLevelProject::deriveId(m_parameters.finalBuildConfigurationTree());
     const QString buildDir
             = TopLevelProject::deriveBuildDirectory(m_parameters.buildRoot(), projectId);
     const QString buildGraphFilePath
             = ProjectBuildData::deriveBuildGraphFilePath(buildDir, projectId);
 
-    PersistentPool pool(m_logger);
+    const auto handleLoadError = [this](const ErrorInfo &loadError) {
+        if (!m_parameters.overrideBuildGraphData()) {
+            ErrorInfo fullError = loadError;
+            fullError.append(Tr::tr("Use the 'resolve' command to set up a new build graph."));
+            throw fullError;
+        }
+        m_logger.qbsWarning() << loadError.toString();
+    };
+
+    const auto loader = std::make_shared<ProductBuildDataLoader>();
+    PersistentPool &pool = loader->pool();
     qCDebug(lcBuildGraph) << "trying to load:" << buildGraphFilePath;
     try {
         pool.load(buildGraphFilePath);
@@ -186,12 +192,7 @@ void BuildGraphLoader::loadBuildGraphFromDisk()
                           "Starting from scratch.").arg(m_parameters.configurationName());
         return;
     } catch (const ErrorInfo &loadError) {
-        if (!m_parameters.overrideBuildGraphData()) {
-            ErrorInfo fullError = loadError;
-            fullError.append(Tr::tr("Use the 'resolve' command to set up a new build graph."));
-            throw fullError;
-        }
-        m_logger.qbsWarning() << loadError.toString();
+        handleLoadError(loadError);
         return;
     }
 
@@ -201,6 +202,7 @@ void BuildGraphLoader::loadBuildGraphFromDisk()
     m_evalContext->initializeObserver(Tr::tr("Restoring build graph from disk"), 1);
 
     project->load(pool);
+    ProductBuildDataLoader::attach(loader, project);
     project->buildData->evaluationContext = m_evalContext;
     project->setBuildConfiguration(pool.headData().projectConfig);
     project->buildDirectory = buildDir;
@@ -208,6 +210,12 @@ void BuildGraphLoader::loadBuildGraphFromDisk()
         return;
     restoreBackPointers(project);
     project->buildData->setClean();
+    try {
+        project->loadChanges(pool, m_logger);
+    } catch (const ErrorInfo &loadError) {
+        handleLoadError(loadError);
+        return;
+    }
     project->location = CodeLocation(m_parameters.projectFilePath(), project->location.line(),
                                      project->location.column());
     m_result.loadedProject = project;
@@ -308,8 +316,14 @@ void BuildGraphLoader::trackProjectChanges()
     std::vector<ResolvedProductPtr> allRestoredProducts = restoredProject->allProducts();
     std::vector<ResolvedProductPtr> changedProducts;
     bool reResolvingNecessary = false;
-    if (!checkConfigCompatibility())
+
+    // Whether the values of properties can only have changed due to changes in project files.
+    bool onlyProjectFilesChanged = true;
+
+    if (!checkConfigCompatibility()) {
         reResolvingNecessary = true;
+        onlyProjectFilesChanged = false;
+    }
     if (hasProductFileChanged(allRestoredProducts, restoredProject->lastStartResolveTime,
                               buildSystemFiles, changedProducts)) {
         reResolvingNecessary = true;
@@ -320,13 +334,15 @@ void BuildGraphLoader::trackProjectChanges()
     // having been touched. In such a case, the build data for that product will have to be set up
     // anew.
     if (probeExecutionForced(restoredProject, allRestoredProducts)
-            || hasBuildSystemFileChanged(buildSystemFiles, restoredProject.get())
             || hasEnvironmentChanged(restoredProject)
             || hasCanonicalFilePathResultChanged(restoredProject)
             || hasFileExistsResultChanged(restoredProject)
             || hasDirectoryEntriesResultChanged(restoredProject)
             || hasFileLastModifiedResultChanged(restoredProject)) {
         reResolvingNecessary = true;
+        onlyProjectFilesChanged = false;
+    } else if (hasBuildSystemFileChanged(buildSystemFiles, restoredProject.get())) {
+        reResolvingNecessary = true;
     }
 
     if (!reResolvingNecessary) {
@@ -335,6 +351,7 @@ void BuildGraphLoader::trackProjectChanges()
         return;
     }
 
+    restoredProject->buildData->loadAllProductBuildData();
     restoredProject->buildData->setDirty();
     markTransformersForChangeTracking(allRestoredProducts);
     if (!m_parameters.overrideBuildGraphData())
@@ -352,7 +369,24 @@ void BuildGraphLoader::trackProjectChanges()
     ldr.setOldProductProbes(restoredProbes);
     if (!m_parameters.overrideBuildGraphData())
         ldr.setStoredProfiles(restoredProject->profileConfigs);
+
+    // If nothing but project files changed, the products that are not made from any of them
+    // do not need to have their properties evaluated again.
+    // Imported JavaScript files are not tracked per product, so we cannot tell which products
+    // a change in one of them affects.
+    bool reuseUnchangedProducts = false;
+    if (onlyProjectFilesChanged) {
+        const Set<QString> changedFiles = changedBuildSystemFiles(restoredProject.get(),
+                                                                  allRestoredProducts);
+        reuseUnchangedProducts = Internal::none_of(changedFiles, [](const QString &filePath) {
+            return filePath.endsWith(QLatin1String(".js"));
+        });
+        if (reuseUnchangedProducts)
+            ldr.setOldProducts(allRestoredProducts, changedFiles);
+    }
     m_result.newlyResolvedProject = ldr.loadProject(m_parameters);
+    if (reuseUnchangedProducts)
+        takeOverQueryResults(restoredProject.get());
 
     std::vector<ResolvedProductPtr> allNewlyResolvedProducts
             = m_result.newlyResolvedProject->allProducts();
@@ -626,6 +660,18 @@ bool BuildGraphLoader::hasProductFileChanged(const std::vector<ResolvedProductPt
     return hasChanged;
 }
 
+static FileTime buildSystemFileReferenceTime(const QString &file,
+                                             const TopLevelProject *restoredProject)
+{
+    const auto generatedChecker = [&file, restoredProject](const ModuleProviderInfo &mpi) {
+        return file.startsWith(mpi.outputDirPath(restoredProject->buildDirectory));
+    };
+    const bool fileWasCreatedByModuleProvider =
+            any_of(restoredProject->moduleProviderInfo.providers, generatedChecker);
+    return fileWasCreatedByModuleProvider
+            ? restoredProject->lastEndResolveTime : restoredProject->lastStartResolveTime;
+}
+
 bool BuildGraphLoader::hasBuildSystemFileChanged(const Set<QString> &buildSystemFiles,
                                                  const TopLevelProject *restoredProject)
 {
@@ -636,14 +682,7 @@ bool BuildGraphLoader::hasBuildSystemFileChanged(const Set<QString> &buildSystem
                                   << "no longer exists, must re-resolve project.";
             return true;
         }
-        const auto generatedChecker = [&file, restoredProject](const ModuleProviderInfo &mpi) {
-            return file.startsWith(mpi.outputDirPath(restoredProject->buildDirectory));
-        };
-        const bool fileWasCreatedByModuleProvider =
-                any_of(restoredProject->moduleProviderInfo.providers, generatedChecker);
-        const FileTime referenceTime = fileWasCreatedByModuleProvider
-                ? restoredProject->lastEndResolveTime : restoredProject->lastStartResolveTime;
-        if (referenceTime < fi.lastModified()) {
+        if (buildSystemFileReferenceTime(file, restoredProject) < fi.lastModified()) {
             qCDebug(lcBuildGraph) << "Project file" << file << "changed, must re-resolve project.";
             return true;
         }
@@ -651,6 +690,40 @@ bool BuildGraphLoader::hasBuildSystemFileChanged(const Set<QString> &buildSystem
     return false;
 }
 
+Set<QString> BuildGraphLoader::changedBuildSystemFiles(
+        const TopLevelProject *restoredProject,
+        const std::vector<ResolvedProductPtr> &restoredProducts)
+{
+    Set<QString> files = restoredProject->buildSystemFiles;
+    for (const ResolvedProductPtr &product : restoredProducts)
+        files.insert(product->location.filePath());
+    Set<QString> changedFiles;
+    for (const QString &file : qAsConst(files)) {
+        const FileInfo fi(file);
+        if (!fi.exists() || buildSystemFileReferenceTime(file, restoredProject) < fi.lastModified())
+            changedFiles.insert(file);
+    }
+    qCDebug(lcBuildGraph) << "changed project files:" << changedFiles.toStringList();
+    return changedFiles;
+}
+
+// The properties of the products that were taken over from the restored project were evaluated
+// using these results, and we know they are still valid.
+void BuildGraphLoader::takeOverQueryResults(const TopLevelProject *restoredProject)
+{
+    TopLevelProject * const newProject = m_result.newlyResolvedProject.get();
+    const auto takeOver = [](const auto &restoredResults, auto &newResults) {
+        for (auto it = restoredResults.cbegin(); it != restoredResults.cend(); ++it) {
+            if (!newResults.contains(it.key()))
+                newResults.insert(it.key(), it.value());
+        }
+    };
+    takeOver(restoredProject->canonicalFilePathResults, newProject->canonicalFilePathResults);
+    takeOver(restoredProject->fileExistsResults, newProject->fileExistsResults);
+    takeOver(restoredProject->directoryEntriesResults, newProject->directoryEntriesResults);
+    takeOver(restoredProject->fileLastModifiedResults, newProject->fileLastModifiedResults);
+}
+
 void BuildGraphLoader::markTransformersForChangeTracking(
         const std::vector<ResolvedProductPtr> &restoredProducts)
 {
@@ -937,6 +1010,8 @@ void BuildGraphLoader::rescueOldBuildData(const ResolvedProductConstPtr &restore
         if (!newArtifact) {
             RescuableArtifactData rad;
             rad.timeStamp = oldArtifact->timestamp();
+            rad.contentHash = oldArtifact->contentHash;
+            rad.contentChangeTime = oldArtifact->contentChangeTime;
             rad.knownOutOfDate = oldArtifact->transformer->markedForRerun;
             rad.fileTags = oldArtifact->fileTags();
             rad.properties = oldArtifact->properties;
@@ -964,6 +1039,9 @@ void BuildGraphLoader::rescueOldBuildData(const ResolvedProductConstPtr &restore
             rad.exportedModulesAccessedInCommands
                     = oldArtifact->transformer->exportedModulesAccessedInCommands;
             rad.lastCommandExecutionTime = oldArtifact->transformer->lastCommandExecutionTime;
+            rad.lastCommandExecutionDuration
+                    = oldArtifact->transformer->lastCommandExecutionDuration;
+            rad.peakMemoryUsage = oldArtifact->transformer->peakMemoryUsage;
             rad.lastPrepareScriptExecutionTime
                     = oldArtifact->transformer->lastPrepareScriptExecutionTime;
             const ChildrenInfo &childrenInfo = childLists.value(oldArtifact);
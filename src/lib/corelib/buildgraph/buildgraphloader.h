@@ -98,6 +98,9 @@ private:
                                std::vector<ResolvedProductPtr> &productsWithChangedFiles);
     bool hasBuildSystemFileChanged(const Set<QString> &buildSystemFiles,
                                    const TopLevelProject *restoredProject);
+    Set<QString> changedBuildSystemFiles(const TopLevelProject *restoredProject,
+                                         const std::vector<ResolvedProductPtr> &restoredProducts);
+    void takeOverQueryResults(const TopLevelProject *restoredProject);
     void markTransformersForChangeTracking(const std::vector<ResolvedProductPtr> &restoredProducts);
     void checkAllProductsForChanges(const std::vector<ResolvedProductPtr> &restoredProducts,
             std::vector<ResolvedProductPtr> &changedProducts);
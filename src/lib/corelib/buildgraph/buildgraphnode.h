@@ -70,6 +70,10 @@ public:
 
     BuildState buildState;                  // Do not serialize. Will be refreshed for every build.
 
+    // The estimated time it takes to build this node and everything that depends on it.
+    // Do not serialize. Will be refreshed for every build.
+    qint64 criticalPathCost = -1;
+
     enum Type
     {
         ArtifactNodeType,
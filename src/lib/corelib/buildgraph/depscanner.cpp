@@ -135,6 +135,11 @@ bool PluginDependencyScanner::recursive() const
     return m_plugin->flags & ScannerRecursiveDependencies;
 }
 
+bool PluginDependencyScanner::isReentrant() const
+{
+    return m_plugin->flags & ScannerReentrant;
+}
+
 const void *PluginDependencyScanner::key() const
 {
     return m_plugin;
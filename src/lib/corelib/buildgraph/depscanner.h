@@ -69,6 +69,7 @@ public:
     virtual QStringList collectDependencies(Artifact *artifact, FileResourceBase *file,
                                             const char *fileTags) = 0;
     virtual bool recursive() const = 0;
+    virtual bool isReentrant() const = 0;
     virtual const void *key() const = 0;
     virtual bool areModulePropertiesCompatible(const PropertyMapConstPtr &m1,
                                                const PropertyMapConstPtr &m2) const = 0;
@@ -90,6 +91,7 @@ private:
     QStringList collectDependencies(Artifact *artifact, FileResourceBase *file,
                                     const char *fileTags) override;
     bool recursive() const override;
+    bool isReentrant() const override;
     const void *key() const override;
     QString createId() const override;
     bool areModulePropertiesCompatible(const PropertyMapConstPtr &m1,
@@ -109,6 +111,7 @@ private:
     QStringList collectDependencies(Artifact *artifact, FileResourceBase *file,
                                     const char *fileTags) override;
     bool recursive() const override;
+    bool isReentrant() const override { return false; }
     const void *key() const override;
     QString createId() const override;
     bool areModulePropertiesCompatible(const PropertyMapConstPtr &m1,
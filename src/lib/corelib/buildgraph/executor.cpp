@@ -38,6 +38,7 @@
 ****************************************************************************/
 #include "executor.h"
 
+#include "actioncachekey.h"
 #include "buildgraph.h"
 #include "emptydirectoriesremover.h"
 #include "environmentscriptrunner.h"
@@ -46,6 +47,8 @@
 #include "cycledetector.h"
 #include "executorjob.h"
 #include "inputartifactscanner.h"
+#include "jobserver.h"
+#include "persistentworkerpool.h"
 #include "productinstaller.h"
 #include "rescuableartifactdata.h"
 #include "rulecommands.h"
@@ -69,6 +72,8 @@
 #include <tools/settings.h>
 #include <tools/stlutils.h>
 #include <tools/stringconstants.h>
+#include <tools/systemresources.h>
+#include <tools/tracerecorder.h>
 
 #include <QtCore/qdir.h>
 #include <QtCore/qtimer.h>
@@ -83,6 +88,10 @@ namespace Internal {
 
 bool Executor::ComparePriority::operator() (const BuildGraphNode *x, const BuildGraphNode *y) const
 {
+    // Nodes on the longest remaining path to the roots go first, so that long-running
+    // commands such as big links do not start late and stretch the build.
+    if (x->criticalPathCost != y->criticalPathCost)
+        return x->criticalPathCost < y->criticalPathCost;
     return x->product->buildData->buildPriority() < y->product->buildData->buildPriority();
 }
 
@@ -94,11 +103,21 @@ Executor::Executor(Logger logger, QObject *parent)
     , m_progressObserver(nullptr)
     , m_state(ExecutorIdle)
     , m_cancelationTimer(new QTimer(this))
+    , m_jobSlotTimer(new QTimer(this))
+    , m_jobServer(new JobServer(this))
+    , m_workerPool(new PersistentWorkerPool(this))
 {
     m_inputArtifactScanContext = new InputArtifactScannerContext;
     m_cancelationTimer->setSingleShot(false);
     m_cancelationTimer->setInterval(1000);
     connect(m_cancelationTimer, &QTimer::timeout, this, &Executor::checkForCancellation);
+    m_jobSlotTimer->setSingleShot(false);
+    m_jobSlotTimer->setInterval(2000);
+    connect(m_jobSlotTimer, &QTimer::timeout, this, &Executor::adaptJobSlots);
+    connect(m_jobServer, &JobServer::tokenAvailable, this, [this] {
+        if (m_state == ExecutorRunning)
+            scheduleJobs();
+    });
 }
 
 Executor::~Executor()
@@ -135,18 +154,39 @@ void Executor::retrieveSourceFileTimestamp(Artifact *artifact) const
 {
     QBS_CHECK(artifact->artifactType == Artifact::SourceFile);
 
-    if (m_buildOptions.changedFiles().empty())
+    const FileTime oldTimestamp = artifact->timestamp();
+    if (m_buildOptions.changedFilesComplete()) {
+        if (mustCheckTimestamp(artifact->filePath(), artifact->timestamp()))
+            artifact->setTimestamp(recursiveFileTime(artifact->filePath()));
+    } else if (m_changedFiles.empty()) {
         artifact->setTimestamp(recursiveFileTime(artifact->filePath()));
-    else if (m_buildOptions.changedFiles().contains(artifact->filePath()))
+    } else if (m_changedFiles.contains(artifact->filePath())) {
         artifact->setTimestamp(FileTime::currentTime());
-    else if (!artifact->timestamp().isValid())
+    } else if (!artifact->timestamp().isValid()) {
         artifact->setTimestamp(recursiveFileTime(artifact->filePath()));
+    }
+    if (artifact->timestamp() != oldTimestamp)
+        m_project->buildData->recordChangedFile(artifact);
 
     artifact->timestampRetrieved = true;
     if (!artifact->timestamp().isValid())
         throw ErrorInfo(Tr::tr("Source file '%1' has disappeared.").arg(artifact->filePath()));
 }
 
+// If the caller told us that its list of changed files is complete, we trust the stored
+// timestamps of all other files and do not have to touch the file system for them.
+bool Executor::mustCheckTimestamp(const QString &filePath, const FileTime &storedTimestamp) const
+{
+    if (!m_buildOptions.changedFilesComplete() || !storedTimestamp.isValid()
+            || m_changedFiles.contains(filePath)) {
+        return true;
+    }
+
+    // Changes in directories the caller did not watch may have gone unnoticed.
+    return !m_watchedDirectories.empty()
+            && !m_watchedDirectories.contains(FileInfo::path(filePath));
+}
+
 void Executor::build()
 {
     try {
@@ -208,7 +248,7 @@ private:
             return;
         for (const ResolvedProductPtr &dependency : qAsConst(product->dependencies))
             traverse(dependency);
-        if (!product->buildData)
+        if (!product->buildData || !product->buildData.isLoaded())
             return;
         product->buildData->setBuildPriority(m_priority--);
     }
@@ -231,8 +271,11 @@ void Executor::doBuild()
     m_productsOfFilesToConsider.clear();
     m_artifactsRemovedFromDisk.clear();
     m_jobCountPerPool.clear();
+    m_project->buildData->fileExistenceCache.startNewBuild();
 
     setupJobLimits();
+    setupActionCache();
+    setupMemoryBudget();
 
     // TODO: The "filesToConsider" thing is badly designed; we should know exactly which artifact
     //       it is. Remove this from the BuildOptions class and introduce Project::buildSomeFiles()
@@ -265,6 +308,9 @@ void Executor::doBuild()
     QBS_CHECK(!m_project->buildData->evaluationContext);
     m_project->buildData->evaluationContext = std::make_shared<RulesEvaluationContext>(m_logger);
     m_evalContext = m_project->buildData->evaluationContext;
+    Settings settings(m_buildOptions.settingsDirectory());
+    if (Preferences(&settings).parallelPrepareScripts())
+        m_evalContext->setMaxConcurrentPrepareScripts(m_buildOptions.maxJobCount());
 
     m_elapsedTimeRules = m_elapsedTimeScanners = m_elapsedTimeInstalling = 0;
     m_evalContext->engine()->enableProfiling(m_buildOptions.logElapsedTime());
@@ -280,6 +326,8 @@ void Executor::doBuild()
         m_productInstaller->removeInstallRoot();
 
     addExecutorJobs();
+    setupAdaptiveJobCount();
+    setupJobServer();
     syncFileDependencies();
     prepareAllNodes();
     prepareProducts();
@@ -298,6 +346,10 @@ void Executor::doBuild()
 void Executor::setBuildOptions(const BuildOptions &buildOptions)
 {
     m_buildOptions = buildOptions;
+    const QStringList changedFiles = m_buildOptions.changedFiles();
+    m_changedFiles = Set<QString>(changedFiles.cbegin(), changedFiles.cend());
+    const QStringList watchedDirectories = m_buildOptions.watchedDirectories();
+    m_watchedDirectories = Set<QString>(watchedDirectories.cbegin(), watchedDirectories.cend());
 }
 
 
@@ -328,6 +380,8 @@ void Executor::updateLeaves(BuildGraphNode *node, NodeSet &seenNodes)
                 retrieveSourceFileTimestamp(artifact);
         }
     }
+    if (node->criticalPathCost < 0)
+        computeCriticalPathCost(node);
 
     bool isLeaf = true;
     for (BuildGraphNode *child : qAsConst(node->children)) {
@@ -348,7 +402,7 @@ bool Executor::scheduleJobs()
 {
     QBS_CHECK(m_state == ExecutorRunning);
     std::vector<BuildGraphNode *> delayedLeaves;
-    while (!m_leaves.empty() && !m_availableJobs.empty()) {
+    while (!m_leaves.empty() && hasFreeJobSlot()) {
         BuildGraphNode * const nodeToBuild = m_leaves.top();
         m_leaves.pop();
 
@@ -365,6 +419,10 @@ bool Executor::scheduleJobs()
                 qCDebug(lcExec).noquote() << "node delayed due to occupied job pool:"
                                           << nodeToBuild->toString();
                 delayedLeaves.push_back(nodeToBuild);
+            } else if (schedulingBlockedByMemoryBudget(nodeToBuild)) {
+                qCDebug(lcExec).noquote() << "node delayed due to memory budget:"
+                                          << nodeToBuild->toString();
+                delayedLeaves.push_back(nodeToBuild);
             } else {
                 nodeToBuild->accept(this);
             }
@@ -381,6 +439,8 @@ bool Executor::scheduleJobs()
     }
     for (BuildGraphNode * const delayedLeaf : delayedLeaves)
         m_leaves.push(delayedLeaf);
+    if (m_jobServer->isRunning())
+        m_jobServer->releaseSpareTokens();
     return !m_leaves.empty() || !m_processingJobs.empty();
 }
 
@@ -424,6 +484,57 @@ bool Executor::schedulingBlockedByJobLimit(const BuildGraphNode *node)
     return false;
 }
 
+void Executor::setupMemoryBudget()
+{
+    m_memoryBudget = 0;
+    m_reservedMemory = 0;
+    m_memoryReservations.clear();
+    const int budget = m_buildOptions.memoryBudget();
+    if (budget == BuildOptions::automaticMemoryBudget()) {
+        m_memoryBudget = std::max<qint64>(availablePhysicalMemory(), 0);
+        if (m_memoryBudget == 0) {
+            m_logger.printWarning(ErrorInfo(Tr::tr("Cannot determine the amount of available "
+                                                   "memory. Building without a memory budget.")));
+        }
+    } else if (budget > 0) {
+        m_memoryBudget = qint64(budget) * 1024 * 1024;
+    }
+    if (m_memoryBudget > 0)
+        qCDebug(lcExec) << "memory budget is" << m_memoryBudget / (1024 * 1024) << "MiB";
+}
+
+// The memory usage a transformer had in the previous build is our estimate for this one.
+void Executor::reserveMemory(const Transformer *transformer)
+{
+    if (m_memoryBudget == 0 || transformer->peakMemoryUsage <= 0)
+        return;
+    m_memoryReservations[transformer] = transformer->peakMemoryUsage;
+    m_reservedMemory += transformer->peakMemoryUsage;
+}
+
+void Executor::releaseMemory(const Transformer *transformer)
+{
+    const auto it = m_memoryReservations.find(transformer);
+    if (it == m_memoryReservations.end())
+        return;
+    m_reservedMemory -= it->second;
+    m_memoryReservations.erase(it);
+}
+
+bool Executor::schedulingBlockedByMemoryBudget(const BuildGraphNode *node) const
+{
+    // If nothing with a known memory usage is running, we have to build the node anyway.
+    if (m_memoryBudget == 0 || m_reservedMemory == 0)
+        return false;
+    if (node->type() != BuildGraphNode::ArtifactNodeType)
+        return false;
+    const auto artifact = static_cast<const Artifact *>(node);
+    if (artifact->artifactType == Artifact::SourceFile)
+        return false;
+    const qint64 expectedMemoryUsage = artifact->transformer->peakMemoryUsage;
+    return expectedMemoryUsage > 0 && m_reservedMemory + expectedMemoryUsage > m_memoryBudget;
+}
+
 bool Executor::isUpToDate(Artifact *artifact) const
 {
     QBS_CHECK(artifact->artifactType == Artifact::Generated);
@@ -432,9 +543,12 @@ bool Executor::isUpToDate(Artifact *artifact) const
                              << artifact->timestamp().toString();
 
     if (m_buildOptions.forceTimestampCheck()) {
+        const FileTime oldTimestamp = artifact->timestamp();
         artifact->setTimestamp(FileInfo(artifact->filePath()).lastModified());
         qCDebug(lcUpToDateCheck) << "timestamp retrieved from filesystem:"
                                  << artifact->timestamp().toString();
+        if (artifact->timestamp() != oldTimestamp)
+            m_project->buildData->recordChangedFile(artifact);
     }
 
     if (!artifact->timestamp().isValid()) {
@@ -444,10 +558,14 @@ bool Executor::isUpToDate(Artifact *artifact) const
 
     for (Artifact *childArtifact : filterByType<Artifact>(artifact->children)) {
         QBS_CHECK(!childArtifact->alwaysUpdated || childArtifact->timestamp().isValid());
+        // A child that was re-created with identical contents does not make us out of date,
+        // unless the user explicitly asked us to look at the file system.
+        const FileTime &childTime = m_buildOptions.forceTimestampCheck()
+                ? childArtifact->timestamp() : childArtifact->lastContentChange();
         qCDebug(lcUpToDateCheck) << "child timestamp"
-                                 << childArtifact->timestamp().toString()
+                                 << childTime.toString()
                                  << childArtifact->filePath();
-        if (artifact->timestamp() < childArtifact->timestamp())
+        if (artifact->timestamp() < childTime)
             return false;
     }
 
@@ -533,6 +651,13 @@ void Executor::executeRuleNode(RuleNode *ruleNode)
     if (!checkNodeProduct(ruleNode))
         return;
 
+    TraceScope traceScope("rule");
+    if (traceScope.isActive()) {
+        traceScope.setName(Tr::tr("Applying rule %1 in product '%2'")
+                           .arg(ruleNode->rule()->toString(),
+                                ruleNode->product->fullDisplayName()));
+    }
+
     QBS_CHECK(!m_evalContext->engine()->isActive());
 
     RuleNode::ApplicationResult result;
@@ -564,34 +689,19 @@ void Executor::finishJob(ExecutorJob *job, bool success)
     const TransformerPtr transformer = it.value();
     m_processingJobs.erase(it);
     m_availableJobs.push_back(job);
+    if (m_jobServerTokens > 0 && m_jobServerTokens >= m_processingJobs.size()) {
+        m_jobServer->releaseToken();
+        --m_jobServerTokens;
+    }
     updateJobCounts(transformer.get(), -1);
+    releaseMemory(transformer.get());
+    const QByteArray actionCacheKey = m_actionCacheKeys.take(transformer.get());
     if (success) {
-        m_project->buildData->setDirty();
-        for (Artifact * const artifact : qAsConst(transformer->outputs)) {
-            if (artifact->alwaysUpdated) {
-                artifact->setTimestamp(FileTime::currentTime());
-                for (Artifact * const parent : artifact->parentArtifacts())
-                    parent->transformer->markedForRerun = true;
-                if (m_buildOptions.forceOutputCheck()
-                        && !m_buildOptions.dryRun() && !FileInfo(artifact->filePath()).exists()) {
-                    if (transformer->rule) {
-                        if (!transformer->rule->name.isEmpty()) {
-                            throw ErrorInfo(tr("Rule '%1' declares artifact '%2', "
-                                               "but the artifact was not produced.")
-                                            .arg(transformer->rule->name, artifact->filePath()));
-                        }
-                        throw ErrorInfo(tr("Rule declares artifact '%1', "
-                                           "but the artifact was not produced.")
-                                        .arg(artifact->filePath()));
-                    }
-                    throw ErrorInfo(tr("Transformer declares artifact '%1', "
-                                       "but the artifact was not produced.")
-                                    .arg(artifact->filePath()));
-                }
-            } else {
-                artifact->setTimestamp(FileInfo(artifact->filePath()).lastModified());
-            }
-        }
+        updateOutputs(transformer, job->outputHashes());
+        if (transformer->dependenciesReported)
+            setReportedDependencies(transformer);
+        if (!actionCacheKey.isEmpty())
+            storeInActionCache(transformer, actionCacheKey);
         finishTransformer(transformer);
     }
 
@@ -618,6 +728,69 @@ void Executor::finishJob(ExecutorJob *job, bool success)
     }
 }
 
+void Executor::setReportedDependencies(const TransformerPtr &transformer)
+{
+    for (Artifact * const output : qAsConst(transformer->outputs)) {
+        InputArtifactScanner(output, m_inputArtifactScanContext, m_logger)
+                .setReportedDependencies(transformer->reportedDependencies);
+    }
+    transformer->reportedDependencies.clear();
+    transformer->dependenciesReported = false;
+}
+
+void Executor::updateOutputs(const TransformerPtr &transformer,
+                             const ExecutorJob::OutputHashes &outputHashes)
+{
+    for (Artifact * const artifact : qAsConst(transformer->outputs)) {
+        m_project->buildData->recordChangedFile(artifact);
+        const QByteArray contentHash = outputHashes.value(artifact);
+        if (artifact->alwaysUpdated) {
+            artifact->setTimestamp(FileTime::currentTime());
+            if (updateContentHash(artifact, contentHash)) {
+                for (Artifact * const parent : artifact->parentArtifacts()) {
+                    parent->transformer->markedForRerun = true;
+                    m_project->buildData->recordChangedTransformer(parent->transformer.get());
+                }
+            }
+            if (m_buildOptions.forceOutputCheck()
+                    && !m_buildOptions.dryRun() && !FileInfo(artifact->filePath()).exists()) {
+                if (transformer->rule) {
+                    if (!transformer->rule->name.isEmpty()) {
+                        throw ErrorInfo(tr("Rule '%1' declares artifact '%2', "
+                                           "but the artifact was not produced.")
+                                        .arg(transformer->rule->name, artifact->filePath()));
+                    }
+                    throw ErrorInfo(tr("Rule declares artifact '%1', "
+                                       "but the artifact was not produced.")
+                                    .arg(artifact->filePath()));
+                }
+                throw ErrorInfo(tr("Transformer declares artifact '%1', "
+                                   "but the artifact was not produced.")
+                                .arg(artifact->filePath()));
+            }
+        } else {
+            artifact->setTimestamp(FileInfo(artifact->filePath()).lastModified());
+            updateContentHash(artifact, contentHash);
+        }
+    }
+}
+
+// Returns false if the contents of the artifact are the same as before the transformer ran,
+// in which case its parents do not need to be rebuilt because of it.
+bool Executor::updateContentHash(Artifact *artifact, const QByteArray &newHash) const
+{
+    const bool changed = newHash.isEmpty() || newHash != artifact->contentHash;
+    artifact->contentHash = newHash;
+    if (changed || !artifact->contentChangeTime.isValid())
+        artifact->contentChangeTime = artifact->timestamp();
+    if (!changed) {
+        qCDebug(lcUpToDateCheck) << "contents of" << artifact->filePath()
+                                 << "did not change, keeping timestamp"
+                                 << artifact->contentChangeTime.toString() << "for parents";
+    }
+    return changed;
+}
+
 static bool allChildrenBuilt(BuildGraphNode *node)
 {
     return Internal::all_of(node->children, std::mem_fn(&BuildGraphNode::isBuilt));
@@ -710,6 +883,71 @@ void Executor::setupJobLimits()
     }
 }
 
+void Executor::setupActionCache()
+{
+    m_actionCache.reset();
+    m_actionCacheKeyGenerator.reset();
+    m_actionCacheKeys.clear();
+    if (m_buildOptions.actionCacheDirectory().isEmpty() || m_buildOptions.dryRun()
+            || m_buildOptions.executeRulesOnly()) {
+        return;
+    }
+    Settings settings(m_buildOptions.settingsDirectory());
+    m_actionCache = std::make_unique<ActionCache>(m_buildOptions.actionCacheDirectory(),
+                                                  Preferences(&settings).actionCacheMaxSize());
+    m_actionCacheKeyGenerator = std::make_unique<ActionCacheKeyGenerator>(
+                m_project->buildDirectory);
+}
+
+bool Executor::restoreFromActionCache(const TransformerPtr &transformer)
+{
+    const QByteArray key = m_actionCacheKeyGenerator->key(transformer.get());
+    if (key.isEmpty())
+        return false;
+    if (!m_actionCache->restore(key, m_actionCacheKeyGenerator->outputs(transformer.get()))) {
+        m_actionCacheKeys.insert(transformer.get(), key);
+        return false;
+    }
+
+    qCDebug(lcExec) << "outputs restored from action cache";
+    const ResolvedProductPtr product = transformer->product();
+    for (const AbstractCommandPtr &command : transformer->commands.commands()) {
+        // Keep the change tracking data in sync with what an actual run would have recorded.
+        const auto processCommand = static_cast<ProcessCommand *>(command.get());
+        processCommand->clearRelevantEnvValues();
+        const auto envVars = processCommand->relevantEnvVars();
+        for (const QString &envVar : envVars)
+            processCommand->addRelevantEnvValue(envVar, product->buildEnvironment.value(envVar));
+        if (!command->isSilent() && !command->description().isEmpty()
+                && m_buildOptions.echoMode() != CommandEchoModeSilent) {
+            emit reportCommandDescription(command->highlight(), Tr::tr("%1 (cached)").arg(
+                                              command->fullDescription(
+                                                  product->fullDisplayName())));
+        }
+    }
+    transformer->lastCommandExecutionTime = FileTime::currentTime();
+    m_project->buildData->recordChangedTransformer(transformer.get());
+
+    // The restored files were just copied on this thread, so hashing them here is affordable.
+    ExecutorJob::OutputHashes outputHashes;
+    for (const Artifact * const output : qAsConst(transformer->outputs))
+        outputHashes.insert(output, ExecutorJob::fileContentHash(output->filePath()));
+    updateOutputs(transformer, outputHashes);
+    finishTransformer(transformer);
+    return true;
+}
+
+void Executor::storeInActionCache(const TransformerPtr &transformer, const QByteArray &key)
+{
+    const ActionCache::Outputs outputs = m_actionCacheKeyGenerator->outputs(transformer.get());
+    for (const auto &output : outputs) {
+        if (!FileInfo(output.second).exists())
+            return; // Rules are allowed to not produce some of their outputs.
+    }
+    if (!m_actionCache->store(key, outputs))
+        qCDebug(lcExec) << "failed to store outputs in action cache";
+}
+
 void Executor::updateJobCounts(const Transformer *transformer, int diff)
 {
     for (const QString &jobPool : transformer->jobPools())
@@ -725,6 +963,7 @@ void Executor::cancelJobs()
     const auto jobs = m_processingJobs.keys();
     for (ExecutorJob *job : jobs)
         job->cancel();
+    m_workerPool->stopWorkers();
 }
 
 void Executor::setupProgressObserver()
@@ -765,6 +1004,10 @@ void Executor::addExecutorJobs()
 {
     const int count = m_buildOptions.maxJobCount();
     qCDebug(lcExec) << "preparing executor for" << count << "jobs in parallel";
+    m_inputArtifactScanContext->setMaxConcurrentScans(count);
+    m_workerPool->setMaxIdleWorkers(count);
+    Settings settings(m_buildOptions.settingsDirectory());
+    const qint64 maxProcessOutputSize = Preferences(&settings).maxProcessOutputSize();
     m_allJobs.reserve(count);
     m_availableJobs.reserve(count);
     for (int i = 1; i <= count; i++) {
@@ -774,15 +1017,112 @@ void Executor::addExecutorJobs()
         job->setObjectName(QStringLiteral("J%1").arg(i));
         job->setDryRun(m_buildOptions.dryRun());
         job->setEchoMode(m_buildOptions.echoMode());
+        job->setMaxProcessOutputSize(maxProcessOutputSize);
+        job->setPersistentWorkerPool(m_workerPool);
+        if (TraceScope::isTracing()) {
+            job->setTraceLane(TraceRecorder::instance().namedLane(
+                                  QStringLiteral("Job slot %1").arg(i)));
+        }
         m_availableJobs.push_back(job);
         connect(job, &ExecutorJob::reportCommandDescription,
                 this, &Executor::reportCommandDescription);
+        connect(job, &ExecutorJob::reportCommandOutput, this, &Executor::reportCommandOutput);
         connect(job, &ExecutorJob::reportProcessResult, this, &Executor::reportProcessResult);
         connect(job, &ExecutorJob::finished,
                 this, &Executor::onJobFinished, Qt::QueuedConnection);
     }
 }
 
+void Executor::setupAdaptiveJobCount()
+{
+    m_jobSlots = int(m_allJobs.size());
+    m_minJobSlots = std::min(m_buildOptions.minJobCount(), m_jobSlots);
+    if (m_minJobSlots <= 0 || m_minJobSlots == m_jobSlots)
+        return;
+    const double loadAverage = systemLoadAverage();
+    if (loadAverage < 0 && cpuPressure() < 0) {
+        m_logger.printWarning(ErrorInfo(Tr::tr("Cannot determine the system load. Using a "
+                                               "fixed number of %1 jobs.").arg(m_jobSlots)));
+        return;
+    }
+    if (loadAverage >= 0) {
+        const int idleCores = BuildOptions::defaultMaxJobCount() - qRound(loadAverage);
+        m_jobSlots = qBound(m_minJobSlots, idleCores, m_jobSlots);
+    }
+    qCDebug(lcExec) << "adapting number of jobs to system load, starting with" << m_jobSlots;
+    m_jobSlotTimer->start();
+}
+
+void Executor::setupJobServer()
+{
+    m_jobServerTokens = 0;
+    QString makeFlags;
+    Settings settings(m_buildOptions.settingsDirectory());
+    if (!m_buildOptions.dryRun() && JobServer::isSupported()
+            && Preferences(&settings).useJobServer()) {
+        QString errorMessage;
+        // The token budget follows the job slots, which adaptJobSlots() adjusts to the load.
+        if (m_jobServer->start(m_jobSlots, &errorMessage)) {
+            makeFlags = m_jobServer->makeFlags();
+            qCDebug(lcExec) << "job server started, MAKEFLAGS:" << makeFlags;
+        } else {
+            m_logger.printWarning(ErrorInfo(Tr::tr("Cannot create job server: %1")
+                                            .arg(errorMessage)));
+        }
+    }
+    for (const auto &job : m_allJobs)
+        job->setMakeFlags(makeFlags);
+}
+
+bool Executor::hasFreeJobSlot()
+{
+    if (m_availableJobs.empty() || m_processingJobs.size() >= m_jobSlots)
+        return false;
+
+    // Our first job runs on the implicit job server token.
+    return !m_jobServer->isRunning() || m_processingJobs.empty()
+            || m_jobServer->tryAcquireToken();
+}
+
+// Adjusts the current number of job slots by at most one, so that short load spikes
+// do not make the number oscillate.
+int Executor::jobSlotsForSystemLoad() const
+{
+    static const double highCpuPressure = 40;
+    static const double lowCpuPressure = 10;
+    const int coreCount = BuildOptions::defaultMaxJobCount();
+    const double loadAverage = systemLoadAverage();
+    const double pressure = cpuPressure();
+
+    // Our own commands contribute to the load average, but we are only interested in
+    // how busy the rest of the system keeps the processors.
+    const double foreignLoad = loadAverage < 0
+            ? 0 : std::max(loadAverage - m_processingJobs.size(), 0.0);
+    int jobSlots = m_jobSlots;
+    if (pressure >= highCpuPressure || foreignLoad + jobSlots > coreCount + 1)
+        --jobSlots;
+    else if (pressure < lowCpuPressure && foreignLoad + jobSlots + 1 <= coreCount)
+        ++jobSlots;
+    return qBound(m_minJobSlots, jobSlots, int(m_allJobs.size()));
+}
+
+void Executor::adaptJobSlots()
+{
+    if (m_state != ExecutorRunning)
+        return;
+    const int jobSlots = jobSlotsForSystemLoad();
+    if (jobSlots == m_jobSlots)
+        return;
+    qCDebug(lcExec) << "system load changed, adapting number of jobs from" << m_jobSlots
+                    << "to" << jobSlots;
+    const bool moreJobs = jobSlots > m_jobSlots;
+    m_jobSlots = jobSlots;
+    if (m_jobServer->isRunning())
+        m_jobServer->setJobCount(m_jobSlots);
+    if (moreJobs)
+        scheduleJobs();
+}
+
 void Executor::rescueOldBuildData(Artifact *artifact, bool *childrenAdded = nullptr)
 {
     if (childrenAdded)
@@ -790,6 +1130,7 @@ void Executor::rescueOldBuildData(Artifact *artifact, bool *childrenAdded = null
     if (!artifact->oldDataPossiblyPresent)
         return;
     artifact->oldDataPossiblyPresent = false;
+    m_project->buildData->recordChangedFile(artifact);
     if (artifact->artifactType != Artifact::Generated)
         return;
 
@@ -798,6 +1139,7 @@ void Executor::rescueOldBuildData(Artifact *artifact, bool *childrenAdded = null
             = product->buildData->removeFromRescuableArtifactData(artifact->filePath());
     if (!rad.isValid())
         return;
+    m_project->buildData->setDirty();
     qCDebug(lcBuildGraph) << "Attempting to rescue data of artifact" << artifact->fileName();
 
     std::vector<Artifact *> childrenToConnect;
@@ -892,9 +1234,13 @@ void Executor::rescueOldBuildData(Artifact *artifact, bool *childrenAdded = null
         artifact->transformer->exportedModulesAccessedInCommands
                 = rad.exportedModulesAccessedInCommands;
         artifact->transformer->lastCommandExecutionTime = rad.lastCommandExecutionTime;
+        artifact->transformer->lastCommandExecutionDuration = rad.lastCommandExecutionDuration;
+        artifact->transformer->peakMemoryUsage = rad.peakMemoryUsage;
         artifact->transformer->lastPrepareScriptExecutionTime = rad.lastPrepareScriptExecutionTime;
         artifact->transformer->commandsNeedChangeTracking = true;
         artifact->setTimestamp(rad.timeStamp);
+        artifact->contentHash = rad.contentHash;
+        artifact->contentChangeTime = rad.contentChangeTime;
         artifact->transformer->markedForRerun
                 = artifact->transformer->markedForRerun || rad.knownOutOfDate;
         if (childrenAdded && !childrenToConnect.empty())
@@ -968,14 +1314,24 @@ void Executor::potentiallyRunTransformer(const TransformerPtr &transformer)
     }
 
     const bool mustExecute = mustExecuteTransformer(transformer);
-    if (mustExecute || m_buildOptions.forceTimestampCheck()) {
+
+    // If the commands report what they read, we take the dependencies from there afterwards.
+    if ((mustExecute || m_buildOptions.forceTimestampCheck())
+            && !transformer->commandsReportDependencies()) {
         for (Artifact * const output : qAsConst(transformer->outputs)) {
             // Scan all input artifacts. If new dependencies were found during scanning, delay
             // execution of this transformer.
             InputArtifactScanner scanner(output, m_inputArtifactScanContext, m_logger);
             AccumulatingTimer scanTimer(m_buildOptions.logElapsedTime()
                                         ? &m_elapsedTimeScanners : nullptr);
-            scanner.scan();
+            {
+                TraceScope traceScope("scan");
+                if (traceScope.isActive()) {
+                    traceScope.setName(Tr::tr("Scanning inputs of %1")
+                                       .arg(relativeArtifactFileName(output)));
+                }
+                scanner.scan();
+            }
             scanTimer.stop();
             if (scanner.newDependencyAdded() && checkForUnbuiltDependencies(output))
                 return;
@@ -1009,18 +1365,33 @@ void Executor::runTransformer(const TransformerPtr &transformer)
         }
     }
 
+    if (m_actionCache && restoreFromActionCache(transformer))
+        return;
+
     QBS_CHECK(!m_availableJobs.empty());
+    transformer->reportedDependencies.clear();
+    transformer->dependenciesReported = false;
     ExecutorJob *job = m_availableJobs.takeFirst();
     for (Artifact * const artifact : qAsConst(transformer->outputs))
         artifact->buildState = BuildGraphNode::Building;
+    if (m_jobServer->isRunning() && !m_processingJobs.empty()
+            && m_jobServer->tryAcquireToken()) {
+        m_jobServer->useToken();
+        ++m_jobServerTokens;
+    }
     m_processingJobs.insert(job, transformer);
     updateJobCounts(transformer.get(), 1);
+    reserveMemory(transformer.get());
+    m_project->buildData->recordChangedTransformer(transformer.get());
     job->run(transformer.get());
 }
 
 void Executor::finishTransformer(const TransformerPtr &transformer)
 {
-    transformer->markedForRerun = false;
+    if (transformer->markedForRerun) {
+        transformer->markedForRerun = false;
+        m_project->buildData->recordChangedTransformer(transformer.get());
+    }
     for (Artifact * const artifact : qAsConst(transformer->outputs)) {
         possiblyInstallArtifact(artifact);
         finishArtifact(artifact);
@@ -1044,6 +1415,9 @@ void Executor::possiblyInstallArtifact(const Artifact *artifact)
             && (m_activeFileTags.empty() || artifactHasMatchingOutputTags(artifact))
             && artifact->properties->qbsPropertyValue(StringConstants::installProperty())
                     .toBool()) {
+            TraceScope traceScope("install");
+            if (traceScope.isActive())
+                traceScope.setName(Tr::tr("Installing %1").arg(artifact->fileName()));
             m_productInstaller->copyFile(artifact);
     }
 }
@@ -1095,6 +1469,8 @@ void Executor::checkForUnbuiltProducts()
             // Any element still left after a successful build has not been re-created
             // by any rule and therefore does not exist anymore as an artifact.
             const AllRescuableArtifactData rad = product->buildData->rescuableArtifactData();
+            if (!rad.isEmpty())
+                m_project->buildData->setDirty();
             for (auto it = rad.cbegin(); it != rad.cend(); ++it) {
                 removeGeneratedArtifactFromDisk(it.key(), m_logger);
                 product->buildData->removeFromRescuableArtifactData(it.key());
@@ -1141,6 +1517,9 @@ void Executor::finish()
         m_error.append(Tr::tr("%1%2.").arg(message, configString()));
     }
     setState(ExecutorIdle);
+    m_jobSlotTimer->stop();
+    m_jobServer->stop();
+    m_workerPool->stopWorkers();
     if (m_progressObserver) {
         m_progressObserver->setFinished();
         m_cancelationTimer->stop();
@@ -1149,6 +1528,13 @@ void Executor::finish()
     EmptyDirectoriesRemover(m_project.get(), m_logger)
             .removeEmptyParentDirectories(m_artifactsRemovedFromDisk);
 
+    if (m_actionCache) {
+        m_actionCache->finish();
+        m_actionCache.reset();
+        m_actionCacheKeyGenerator.reset();
+        m_actionCacheKeys.clear();
+    }
+
     if (m_buildOptions.logElapsedTime()) {
         m_logger.qbsLog(LoggerInfo, true) << "\t" << Tr::tr("Rule execution took %1.")
                                              .arg(elapsedTimeString(m_elapsedTimeRules));
@@ -1196,10 +1582,13 @@ bool Executor::visit(RuleNode *ruleNode)
 void Executor::prepareAllNodes()
 {
     for (const ResolvedProductPtr &product : m_allProducts) {
-        if (product->enabled) {
+        // Nodes that get loaded later on are in the initial state already.
+        if (product->enabled && product->buildData.isLoaded()) {
             QBS_CHECK(product->buildData);
-            for (BuildGraphNode * const node : qAsConst(product->buildData->allNodes()))
+            for (BuildGraphNode * const node : qAsConst(product->buildData->allNodes())) {
                 node->buildState = BuildGraphNode::Untouched;
+                node->criticalPathCost = -1;
+            }
         }
     }
     for (const ResolvedProductPtr &product : qAsConst(m_productsToBuild)) {
@@ -1214,19 +1603,34 @@ void Executor::syncFileDependencies()
     Set<FileDependency *> &globalFileDepList = m_project->buildData->fileDependencies;
     for (auto it = globalFileDepList.begin(); it != globalFileDepList.end(); ) {
         FileDependency * const dep = *it;
+        if (!mustCheckTimestamp(dep->filePath(), dep->timestamp())) {
+            ++it;
+            continue;
+        }
         FileInfo fi(dep->filePath());
         if (fi.exists()) {
-            dep->setTimestamp(fi.lastModified());
+            const FileTime lastModified = fi.lastModified();
+            if (lastModified != dep->timestamp()) {
+                dep->setTimestamp(lastModified);
+                m_project->buildData->recordChangedFile(dep);
+            }
             ++it;
             continue;
         }
         qCDebug(lcBuildGraph()) << "file dependency" << dep->filePath() << "no longer exists; "
                                    "removing from lookup table";
         m_project->buildData->removeFromLookupTable(dep);
+        m_project->buildData->setDirty();
         bool isReferencedByArtifact = false;
         for (const auto &product : m_allProducts) {
             if (!product->buildData)
                 continue;
+
+            // The dependency is kept for the artifacts that have not been loaded yet.
+            if (!product->buildData.isLoaded()) {
+                isReferencedByArtifact = true;
+                break;
+            }
             const auto artifactList = filterByType<Artifact>(product->buildData->allNodes());
             isReferencedByArtifact = Internal::any_of(artifactList, [dep](const Artifact *a) {
                 return a->fileDependencies.contains(dep); });
@@ -1302,6 +1706,34 @@ void Executor::prepareReachableNodes_impl(BuildGraphNode *node)
         prepareReachableNodes_impl(child);
 }
 
+/**
+ * The critical path cost of a node is the duration of its own commands, as measured in the
+ * previous build, plus the highest cost among the buildable nodes depending on it.
+ * Transformers that have never run count as one millisecond, so that in the absence of
+ * historical data, nodes with long dependency chains above them are still preferred.
+ */
+qint64 Executor::computeCriticalPathCost(BuildGraphNode *node)
+{
+    if (node->criticalPathCost >= 0)
+        return node->criticalPathCost;
+    node->criticalPathCost = 0; // Guards against cycles, which are reported elsewhere.
+
+    qint64 ownCost = 0;
+    if (node->type() == BuildGraphNode::ArtifactNodeType) {
+        const auto artifact = static_cast<const Artifact *>(node);
+        if (artifact->transformer)
+            ownCost = std::max<qint64>(artifact->transformer->lastCommandExecutionDuration, 1);
+    }
+    qint64 maxParentCost = 0;
+    for (BuildGraphNode * const parent : qAsConst(node->parents)) {
+        if (parent->buildState == BuildGraphNode::Untouched)
+            continue;
+        maxParentCost = std::max(maxParentCost, computeCriticalPathCost(parent));
+    }
+    node->criticalPathCost = ownCost + maxParentCost;
+    return node->criticalPathCost;
+}
+
 void Executor::prepareProducts()
 {
     ProductPrioritySetter prioritySetter(m_allProducts);
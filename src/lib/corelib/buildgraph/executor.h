@@ -42,6 +42,7 @@
 
 #include "forward_decls.h"
 #include "buildgraphvisitor.h"
+#include "executorjob.h"
 #include <buildgraph/artifact.h>
 #include <language/forward_decls.h>
 
@@ -49,6 +50,7 @@
 #include <tools/buildoptions.h>
 #include <tools/error.h>
 #include <tools/qttools.h>
+#include <tools/set.h>
 
 #include <QtCore/qobject.h>
 
@@ -63,9 +65,12 @@ namespace qbs {
 class ProcessResult;
 
 namespace Internal {
-class ExecutorJob;
+class ActionCache;
+class ActionCacheKeyGenerator;
 class FileTime;
 class InputArtifactScannerContext;
+class JobServer;
+class PersistentWorkerPool;
 class ProductInstaller;
 class ProgressObserver;
 class RuleNode;
@@ -89,6 +94,8 @@ public:
 
 signals:
     void reportCommandDescription(const QString &highlight, const QString &message);
+    void reportCommandOutput(const QString &executableFilePath, const QStringList &lines,
+                             bool stdErr);
     void reportProcessResult(const qbs::ProcessResult &result);
 
     void finished();
@@ -97,6 +104,7 @@ private:
     void onJobFinished(const qbs::ErrorInfo &err);
     void finish();
     void checkForCancellation();
+    void adaptJobSlots();
 
     // BuildGraphVisitor implementation
     bool visit(Artifact *artifact) override;
@@ -121,6 +129,7 @@ private:
     void prepareReachableNodes_impl(BuildGraphNode *node);
     void prepareProducts();
     void setupRootNodes();
+    qint64 computeCriticalPathCost(BuildGraphNode *node);
     void initLeaves();
     void updateLeaves(const NodeSet &nodes);
     void updateLeaves(BuildGraphNode *node, NodeSet &seenNodes);
@@ -132,6 +141,10 @@ private:
     void finishArtifact(Artifact *artifact);
     void setState(ExecutorState);
     void addExecutorJobs();
+    void setupAdaptiveJobCount();
+    void setupJobServer();
+    bool hasFreeJobSlot();
+    int jobSlotsForSystemLoad() const;
     void cancelJobs();
     void setupProgressObserver();
     void doSanityChecks();
@@ -148,6 +161,7 @@ private:
     bool mustExecuteTransformer(const TransformerPtr &transformer) const;
     bool isUpToDate(Artifact *artifact) const;
     void retrieveSourceFileTimestamp(Artifact *artifact) const;
+    bool mustCheckTimestamp(const QString &filePath, const FileTime &storedTimestamp) const;
     FileTime recursiveFileTime(const QString &filePath) const;
     QString configString() const;
     bool transformerHasMatchingOutputTags(const TransformerConstPtr &transformer) const;
@@ -155,15 +169,32 @@ private:
     bool transformerHasMatchingInputFiles(const TransformerConstPtr &transformer) const;
 
     void setupJobLimits();
+    void setupActionCache();
+    bool restoreFromActionCache(const TransformerPtr &transformer);
+    void storeInActionCache(const TransformerPtr &transformer, const QByteArray &key);
+    void updateOutputs(const TransformerPtr &transformer,
+                       const ExecutorJob::OutputHashes &outputHashes);
+    void setReportedDependencies(const TransformerPtr &transformer);
+    bool updateContentHash(Artifact *artifact, const QByteArray &newHash) const;
     void updateJobCounts(const Transformer *transformer, int diff);
     bool schedulingBlockedByJobLimit(const BuildGraphNode *node);
+    void setupMemoryBudget();
+    void reserveMemory(const Transformer *transformer);
+    void releaseMemory(const Transformer *transformer);
+    bool schedulingBlockedByMemoryBudget(const BuildGraphNode *node) const;
 
     using JobMap = QHash<ExecutorJob *, TransformerPtr>;
     JobMap m_processingJobs;
 
+    std::unique_ptr<ActionCache> m_actionCache;
+    std::unique_ptr<ActionCacheKeyGenerator> m_actionCacheKeyGenerator;
+    QHash<const Transformer *, QByteArray> m_actionCacheKeys;
+
     ProductInstaller *m_productInstaller;
     RulesEvaluationContextPtr m_evalContext;
     BuildOptions m_buildOptions;
+    Set<QString> m_changedFiles;
+    Set<QString> m_watchedDirectories;
     Logger m_logger;
     ProgressObserver *m_progressObserver;
     std::vector<std::unique_ptr<ExecutorJob>> m_allJobs;
@@ -176,6 +207,9 @@ private:
     std::unordered_map<QString, const ResolvedProject *> m_projectsByName;
     std::unordered_map<QString, int> m_jobCountPerPool;
     std::unordered_map<const ResolvedProduct *, JobLimits> m_jobLimitsPerProduct;
+    qint64 m_memoryBudget = 0; // In bytes; 0 if there is no budget.
+    qint64 m_reservedMemory = 0;
+    std::unordered_map<const Transformer *, qint64> m_memoryReservations;
     std::unordered_map<const Rule *, int> m_pendingTransformersPerRule;
     NodeSet m_roots;
     Leaves m_leaves;
@@ -187,6 +221,12 @@ private:
     FileTags m_tagsNeededForFilesToConsider;
     QList<ResolvedProductPtr> m_productsOfFilesToConsider;
     QTimer * const m_cancelationTimer;
+    QTimer * const m_jobSlotTimer;
+    JobServer * const m_jobServer;
+    int m_jobServerTokens = 0; // Taken by our own jobs, in addition to the implicit one.
+    PersistentWorkerPool * const m_workerPool;
+    int m_jobSlots = 0;
+    int m_minJobSlots = 0;
     QStringList m_artifactsRemovedFromDisk;
     bool m_partialBuild = false;
     qint64 m_elapsedTimeRules = 0;
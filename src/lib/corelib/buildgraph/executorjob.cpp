@@ -46,10 +46,19 @@
 #include "transformer.h"
 #include <language/language.h>
 #include <tools/error.h>
+#include <tools/functionrunnable.h>
+#include <tools/processresult.h>
 #include <tools/qbsassert.h>
+#include <tools/tracerecorder.h>
 
+#include <QtCore/qcryptographichash.h>
+#include <QtCore/qfile.h>
 #include <QtCore/qthread.h>
 
+#include <algorithm>
+#include <utility>
+#include <vector>
+
 namespace qbs {
 namespace Internal {
 
@@ -60,18 +69,28 @@ ExecutorJob::ExecutorJob(const Logger &logger, QObject *parent)
 {
     connect(m_processCommandExecutor, &AbstractCommandExecutor::reportCommandDescription,
             this, &ExecutorJob::reportCommandDescription);
+    connect(m_processCommandExecutor, &ProcessCommandExecutor::reportCommandOutput,
+            this, &ExecutorJob::reportCommandOutput);
     connect(m_processCommandExecutor, &ProcessCommandExecutor::reportProcessResult,
             this, &ExecutorJob::reportProcessResult);
+    connect(m_processCommandExecutor, &ProcessCommandExecutor::reportProcessResult,
+            this, [this](const ProcessResult &result) {
+        m_peakMemoryUsage = std::max(m_peakMemoryUsage, result.peakMemoryUsage());
+    });
     connect(m_processCommandExecutor, &AbstractCommandExecutor::finished,
             this, &ExecutorJob::onCommandFinished);
     connect(m_jsCommandExecutor, &AbstractCommandExecutor::reportCommandDescription,
             this, &ExecutorJob::reportCommandDescription);
     connect(m_jsCommandExecutor, &AbstractCommandExecutor::finished,
             this, &ExecutorJob::onCommandFinished);
+    m_hashThreadPool.setMaxThreadCount(1);
     reset();
 }
 
-ExecutorJob::~ExecutorJob() = default;
+ExecutorJob::~ExecutorJob()
+{
+    m_hashThreadPool.waitForDone();
+}
 
 void ExecutorJob::setMainThreadScriptEngine(ScriptEngine *engine)
 {
@@ -83,6 +102,7 @@ void ExecutorJob::setDryRun(bool enabled)
 {
     m_processCommandExecutor->setDryRunEnabled(enabled);
     m_jsCommandExecutor->setDryRunEnabled(enabled);
+    m_dryRun = enabled;
 }
 
 void ExecutorJob::setEchoMode(CommandEchoMode echoMode)
@@ -91,10 +111,26 @@ void ExecutorJob::setEchoMode(CommandEchoMode echoMode)
     m_jsCommandExecutor->setEchoMode(echoMode);
 }
 
+void ExecutorJob::setMaxProcessOutputSize(qint64 maxSize)
+{
+    m_processCommandExecutor->setMaxOutputSize(maxSize);
+}
+
+void ExecutorJob::setMakeFlags(const QString &makeFlags)
+{
+    m_processCommandExecutor->setMakeFlags(makeFlags);
+}
+
+void ExecutorJob::setPersistentWorkerPool(PersistentWorkerPool *pool)
+{
+    m_processCommandExecutor->setPersistentWorkerPool(pool);
+}
+
 void ExecutorJob::run(Transformer *t)
 {
     QBS_ASSERT(m_currentCommandIdx == -1, return);
 
+    m_outputHashes.clear();
     if (t->commands.empty()) {
         setFinished();
         return;
@@ -112,6 +148,8 @@ void ExecutorJob::run(Transformer *t)
                 (*t->outputs.cbegin())->product->buildEnvironment);
     m_transformer = t;
     m_jobPools = t->jobPools();
+    m_peakMemoryUsage = -1;
+    m_elapsedTimer.start();
     runNextCommand();
 }
 
@@ -144,12 +182,15 @@ void ExecutorJob::runNextCommand()
         qFatal("Missing implementation for command type %d", command->type());
     }
 
+    if (m_traceLane >= 0 && TraceScope::isTracing())
+        m_commandTraceStartTime = TraceRecorder::instance().currentTime();
     m_currentCommandExecutor->start(m_transformer, command.get());
 }
 
 void ExecutorJob::onCommandFinished(const ErrorInfo &err)
 {
     QBS_ASSERT(m_transformer, return);
+    traceCurrentCommand();
     if (m_error.hasError()) { // Canceled?
         setFinished();
     } else if (err.hasError()) {
@@ -161,12 +202,75 @@ void ExecutorJob::onCommandFinished(const ErrorInfo &err)
 }
 
 void ExecutorJob::setFinished()
+{
+    m_currentCommandExecutor = nullptr;
+
+    // The duration is used by the executor to find the critical path in subsequent builds,
+    // the memory usage to decide how many commands can run in parallel.
+    if (m_transformer && !m_error.hasError() && !m_dryRun) {
+        m_transformer->lastCommandExecutionDuration = m_elapsedTimer.elapsed();
+        if (m_peakMemoryUsage >= 0)
+            m_transformer->peakMemoryUsage = m_peakMemoryUsage;
+        hashOutputs();
+        return;
+    }
+    emitFinished();
+}
+
+QByteArray ExecutorJob::fileContentHash(const QString &filePath)
+{
+    QFile file(filePath);
+    if (!file.open(QIODevice::ReadOnly))
+        return {};
+    QCryptographicHash hash(QCryptographicHash::Sha1);
+    if (!hash.addData(&file))
+        return {};
+    return hash.result();
+}
+
+// The executor compares the hashes with the ones from the previous run to find out whether
+// dependents of the outputs need to be rebuilt. Outputs can be big, so we read them in
+// a separate thread instead of blocking the executor.
+void ExecutorJob::hashOutputs()
+{
+    std::vector<std::pair<const Artifact *, QString>> outputs;
+    for (const Artifact * const output : qAsConst(m_transformer->outputs))
+        outputs.emplace_back(output, output->filePath());
+    m_hashThreadPool.start(new FunctionRunnable([this, outputs] {
+        OutputHashes hashes;
+        for (const auto &[output, filePath] : outputs)
+            hashes.insert(output, fileContentHash(filePath));
+        QMetaObject::invokeMethod(this, [this, hashes] {
+            m_outputHashes = hashes;
+            emitFinished();
+        }, Qt::QueuedConnection);
+    }));
+}
+
+void ExecutorJob::emitFinished()
 {
     const ErrorInfo err = m_error;
     reset();
     emit finished(err);
 }
 
+void ExecutorJob::traceCurrentCommand()
+{
+    if (m_commandTraceStartTime < 0)
+        return;
+    const AbstractCommandPtr &command = m_transformer->commands.commandAt(m_currentCommandIdx);
+    QString name = command->description();
+    if (name.isEmpty()) {
+        name = command->type() == AbstractCommand::ProcessCommandType
+                ? static_cast<const ProcessCommand *>(command.get())->program()
+                : tr("JavaScript command");
+    }
+    TraceRecorder &recorder = TraceRecorder::instance();
+    recorder.addEvent("command", name, m_commandTraceStartTime,
+                      recorder.currentTime() - m_commandTraceStartTime, m_traceLane);
+    m_commandTraceStartTime = -1;
+}
+
 void ExecutorJob::reset()
 {
     m_transformer = nullptr;
@@ -45,8 +45,11 @@
 #include <tools/error.h>
 #include <tools/set.h>
 
+#include <QtCore/qelapsedtimer.h>
+#include <QtCore/qhash.h>
 #include <QtCore/qobject.h>
 #include <QtCore/qstring.h>
+#include <QtCore/qthreadpool.h>
 
 namespace qbs {
 class CodeLocation;
@@ -54,9 +57,11 @@ class ProcessResult;
 
 namespace Internal {
 class AbstractCommandExecutor;
+class Artifact;
 class ProductBuildData;
 class JsCommandExecutor;
 class Logger;
+class PersistentWorkerPool;
 class ProcessCommandExecutor;
 class ScriptEngine;
 class Transformer;
@@ -71,13 +76,24 @@ public:
     void setMainThreadScriptEngine(ScriptEngine *engine);
     void setDryRun(bool enabled);
     void setEchoMode(CommandEchoMode echoMode);
+    void setMaxProcessOutputSize(qint64 maxSize);
+    void setMakeFlags(const QString &makeFlags);
+    void setPersistentWorkerPool(PersistentWorkerPool *pool);
+    void setTraceLane(int lane) { m_traceLane = lane; }
     void run(Transformer *t);
     void cancel();
     const Transformer *transformer() const { return m_transformer; }
     Set<QString> jobPools() const { return m_jobPools; }
 
+    // The content hashes of the outputs of the last successful run. Empty for dry runs.
+    using OutputHashes = QHash<const Artifact *, QByteArray>;
+    const OutputHashes &outputHashes() const { return m_outputHashes; }
+    static QByteArray fileContentHash(const QString &filePath);
+
 signals:
     void reportCommandDescription(const QString &highlight, const QString &message);
+    void reportCommandOutput(const QString &executableFilePath, const QStringList &lines,
+                             bool stdErr);
     void reportProcessResult(const qbs::ProcessResult &result);
     void finished(const qbs::ErrorInfo &error = ErrorInfo()); // !hasError() <=> command successful
 
@@ -86,7 +102,10 @@ private:
     void onCommandFinished(const qbs::ErrorInfo &err);
 
     void setFinished();
+    void hashOutputs();
+    void emitFinished();
     void reset();
+    void traceCurrentCommand();
 
     AbstractCommandExecutor *m_currentCommandExecutor = nullptr;
     ProcessCommandExecutor *m_processCommandExecutor = nullptr;
@@ -95,6 +114,13 @@ private:
     Set<QString> m_jobPools;
     int m_currentCommandIdx = 0;
     ErrorInfo m_error;
+    QElapsedTimer m_elapsedTimer;
+    qint64 m_peakMemoryUsage = -1;
+    qint64 m_commandTraceStartTime = -1;
+    int m_traceLane = -1;
+    bool m_dryRun = false;
+    OutputHashes m_outputHashes;
+    QThreadPool m_hashThreadPool;
 };
 
 } // namespace Internal
@@ -0,0 +1,130 @@
+/****************************************************************************
+**
+** Copyright (C) 2022 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of Qbs.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-2.0.html and
+** https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#include "fileexistencecache.h"
+
+#include <tools/fileinfo.h>
+
+namespace qbs {
+namespace Internal {
+
+FileExistenceCache::FileExistenceCache(const FileExistenceCache &other)
+    : m_directories(other.m_directories)
+{
+}
+
+FileExistenceCache &FileExistenceCache::operator=(const FileExistenceCache &other)
+{
+    m_directories = other.m_directories;
+    m_checkedDirectories.clear();
+    m_usedDirectories.clear();
+    return *this;
+}
+
+bool FileExistenceCache::fileExists(const QString &dirPath, const QString &fileName)
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (!m_checkedDirectories.contains(dirPath)) {
+            m_checkedDirectories.insert(dirPath);
+            m_usedDirectories.insert(dirPath);
+            const FileTime timestamp = FileInfo(dirPath).lastModified();
+            DirectoryData &dirData = m_directories[dirPath];
+            if (dirData.timestamp != timestamp) {
+                dirData.timestamp = timestamp;
+                dirData.files.clear();
+                m_changedDirectories.insert(dirPath);
+            }
+        }
+        const DirectoryData &dirData = m_directories[dirPath];
+        if (!dirData.timestamp.isValid())
+            return false;
+        const auto it = dirData.files.constFind(fileName);
+        if (it != dirData.files.constEnd())
+            return it.value();
+    }
+
+    const QString filePath = dirPath + QLatin1Char('/') + fileName;
+    const FileInfo fi(filePath);
+    const bool exists = fi.exists() && !fi.isDir();
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_directories[dirPath].files.insert(fileName, exists);
+    m_changedDirectories.insert(dirPath);
+    return exists;
+}
+
+void FileExistenceCache::startNewBuild()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_checkedDirectories.clear();
+}
+
+// Without any look-ups, e.g. when only resolving the project, there is nothing to go by,
+// so everything is kept then.
+QHash<QString, FileExistenceCache::DirectoryData> FileExistenceCache::usedDirectories()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_usedDirectories.empty())
+        return m_directories;
+    QHash<QString, DirectoryData> directories;
+    for (auto it = m_directories.cbegin(); it != m_directories.cend(); ++it) {
+        if (m_usedDirectories.contains(it.key()))
+            directories.insert(it.key(), it.value());
+    }
+    return directories;
+}
+
+void FileExistenceCache::storeChanges(PersistentPool &pool)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    pool.store(int(m_changedDirectories.size()));
+    for (const QString &dirPath : qAsConst(m_changedDirectories))
+        pool.store(dirPath, m_directories.value(dirPath));
+}
+
+void FileExistenceCache::loadChanges(PersistentPool &pool)
+{
+    for (int i = pool.load<int>(); --i >= 0;) {
+        const auto dirPath = pool.load<QString>();
+        pool.load(m_directories[dirPath]);
+    }
+}
+
+} // namespace Internal
+} // namespace qbs
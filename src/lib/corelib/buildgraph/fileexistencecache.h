@@ -0,0 +1,111 @@
+/****************************************************************************
+**
+** Copyright (C) 2022 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of Qbs.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-2.0.html and
+** https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#ifndef QBS_FILEEXISTENCECACHE_H
+#define QBS_FILEEXISTENCECACHE_H
+
+#include <tools/filetime.h>
+#include <tools/persistence.h>
+
+#include <QtCore/qhash.h>
+#include <QtCore/qset.h>
+#include <QtCore/qstring.h>
+
+#include <mutex>
+
+namespace qbs {
+namespace Internal {
+
+// Remembers which files exist in the directories that the dependency scanners look into,
+// so that include paths do not have to be probed anew in every build.
+// The information about a directory is discarded when the directory's timestamp changes,
+// which happens whenever a file is added to or removed from it. When the complete build graph
+// is stored, directories that were not looked into by the builds since loading are left out.
+class FileExistenceCache
+{
+public:
+    FileExistenceCache() = default;
+    FileExistenceCache(const FileExistenceCache &other);
+    FileExistenceCache &operator=(const FileExistenceCache &other);
+
+    // Thread-safe. Returns true if dirPath/fileName exists and is not a directory.
+    bool fileExists(const QString &dirPath, const QString &fileName);
+
+    // Makes the next look-up in each directory check the directory's timestamp.
+    void startNewBuild();
+
+    // For incremental storage of the build graph, see ProjectBuildData::storeChanges().
+    bool hasChanges() const { return !m_changedDirectories.empty(); }
+    void clearChanges() { m_changedDirectories.clear(); }
+    void storeChanges(PersistentPool &pool);
+    void loadChanges(PersistentPool &pool);
+
+    template<PersistentPool::OpType opType> void completeSerializationOp(PersistentPool &pool)
+    {
+        if constexpr (opType == PersistentPool::Store)
+            pool.store(usedDirectories());
+        else
+            pool.load(m_directories);
+    }
+
+private:
+    struct DirectoryData
+    {
+        FileTime timestamp;
+        QHash<QString, bool> files;
+
+        template<PersistentPool::OpType opType> void completeSerializationOp(PersistentPool &pool)
+        {
+            pool.serializationOp<opType>(timestamp, files);
+        }
+    };
+
+    QHash<QString, DirectoryData> usedDirectories();
+
+    QHash<QString, DirectoryData> m_directories;
+    QSet<QString> m_checkedDirectories;
+    QSet<QString> m_usedDirectories; // By all builds since loading.
+    QSet<QString> m_changedDirectories;
+    std::mutex m_mutex;
+};
+
+} // namespace Internal
+} // namespace qbs
+
+#endif // Include guard
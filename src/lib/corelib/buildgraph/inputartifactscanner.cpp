@@ -45,12 +45,14 @@
 #include "projectbuilddata.h"
 #include "transformer.h"
 #include "depscanner.h"
+#include "rawscanresults.h"
 #include "rulesevaluationcontext.h"
 
 #include <language/language.h>
 #include <logging/categories.h>
 #include <tools/error.h>
 #include <tools/fileinfo.h>
+#include <tools/functionrunnable.h>
 #include <tools/qbsassert.h>
 #include <tools/qttools.h>
 #include <tools/scannerpluginmanager.h>
@@ -60,6 +62,9 @@
 #include <QtCore/qstringlist.h>
 #include <QtCore/qvariant.h>
 
+#include <algorithm>
+#include <atomic>
+
 namespace qbs {
 namespace Internal {
 
@@ -123,9 +128,10 @@ static void resolveDepencency(const RawScannedDependency &dependency,
             : absDirPath + QLatin1Char('/') + dependency.fileName();
 
     // TODO: We probably need a flag that tells us whether directories are allowed.
-    const FileInfo fi(absFilePath);
-    if (fi.exists(absFilePath) && !fi.isDir())
+    if (project->topLevelProject()->buildData->fileExistenceCache.fileExists(
+                absDirPath, dependency.fileName())) {
         result->filePath = absFilePath;
+    }
 }
 
 InputArtifactScanner::InputArtifactScanner(Artifact *artifact, InputArtifactScannerContext *ctx,
@@ -138,6 +144,38 @@ InputArtifactScanner::InputArtifactScanner(Artifact *artifact, InputArtifactScan
 {
 }
 
+// Re-scanning usually yields the dependencies we already had. We do not want to consider
+// the structure of the build graph as changed in that case, as that would make us store
+// the complete build graph after every build.
+class DependencyChangeDetector
+{
+public:
+    DependencyChangeDetector(Artifact *artifact)
+        : m_artifact(artifact),
+          m_buildData(artifact->product->topLevelProject()->buildData.get()),
+          m_wasDirty(m_buildData->isDirty()),
+          m_fileDependencies(artifact->fileDependencies),
+          m_childrenAddedByScanner(artifact->childrenAddedByScanner)
+    {
+    }
+
+    ~DependencyChangeDetector()
+    {
+        if (!m_wasDirty && m_buildData->isDirty()
+                && m_artifact->fileDependencies == m_fileDependencies
+                && m_artifact->childrenAddedByScanner == m_childrenAddedByScanner) {
+            m_buildData->setClean();
+        }
+    }
+
+private:
+    Artifact * const m_artifact;
+    ProjectBuildData * const m_buildData;
+    const bool m_wasDirty;
+    const Set<FileDependency *> m_fileDependencies;
+    const ArtifactSet m_childrenAddedByScanner;
+};
+
 void InputArtifactScanner::scan()
 {
     if (m_artifact->inputsScanned)
@@ -147,7 +185,34 @@ void InputArtifactScanner::scan()
                        << "in product" << m_artifact->product->name;
 
     m_artifact->inputsScanned = true;
+    const DependencyChangeDetector changeDetector(m_artifact);
+    clearDependencies();
+    for (Artifact * const inputArtifact : qAsConst(m_artifact->transformer->inputs))
+        scanForFileDependencies(inputArtifact);
+}
+
+// Takes the dependencies from the list of files the transformer's commands have reported
+// to have read, instead of scanning for them.
+void InputArtifactScanner::setReportedDependencies(const std::vector<QString> &filePaths)
+{
+    qCDebug(lcDepScan) << "set reported dependencies for" << m_artifact->filePath();
+
+    m_artifact->inputsScanned = true;
+    const DependencyChangeDetector changeDetector(m_artifact);
+    clearDependencies();
+    const ResolvedProduct * const product = m_artifact->product.get();
+    for (const QString &filePath : filePaths) {
+        ResolvedDependency resolvedDependency;
+        resolveDepencency(RawScannedDependency(filePath), product, &resolvedDependency);
+        if (resolvedDependency.isValid())
+            handleDependency(resolvedDependency);
+        else
+            qCDebug(lcDepScan) << "ignoring non-existing reported dependency" << filePath;
+    }
+}
 
+void InputArtifactScanner::clearDependencies()
+{
     // clear file dependencies; they will be regenerated
     m_artifact->fileDependencies.clear();
 
@@ -157,9 +222,6 @@ void InputArtifactScanner::scan()
     m_artifact->childrenAddedByScanner.clear();
     for (Artifact * const dependency : childrenAddedByScanner)
         disconnect(m_artifact, dependency);
-
-    for (Artifact * const inputArtifact : qAsConst(m_artifact->transformer->inputs))
-        scanForFileDependencies(inputArtifact);
 }
 
 void InputArtifactScanner::scanForFileDependencies(Artifact *inputArtifact)
@@ -167,37 +229,65 @@ void InputArtifactScanner::scanForFileDependencies(Artifact *inputArtifact)
     qCDebug(lcDepScan) << "input artifact" << inputArtifact->filePath()
                        << inputArtifact->fileTags();
 
-    Set<QString> visitedFilePaths;
-    QList<FileResourceBase *> filesToScan;
-    filesToScan.push_back(inputArtifact);
     const Set<DependencyScanner *> scanners = scannersForArtifact(inputArtifact);
     if (scanners.empty())
         return;
     m_fileTagsForScanner
             = inputArtifact->fileTags().toStringList().join(QLatin1Char(',')).toLatin1();
-    InputArtifactScannerContext::CacheItem *lastPerFileCacheItem = nullptr;
-    InputArtifactScannerContext::CacheItem *lastPerPropsCacheItem = nullptr;
-    while (!filesToScan.empty()) {
-        FileResourceBase *fileToBeScanned = filesToScan.takeFirst();
-        const QString &filePathToBeScanned = fileToBeScanned->filePath();
-        if (!visitedFilePaths.insert(filePathToBeScanned).second)
-            continue;
 
-        for (DependencyScanner * const scanner : scanners) {
-            InputArtifactScannerContext::CacheItem *cacheItem;
-            if (scanner->cacheIsPerFile()) {
-                if (!lastPerFileCacheItem)
-                    lastPerFileCacheItem = &m_context->cachePerFile[inputArtifact];
-                cacheItem = lastPerFileCacheItem;
-            } else {
-                if (!lastPerPropsCacheItem) {
-                    lastPerPropsCacheItem = &m_context->cachePerProperties
-                            [inputArtifact->properties];
-                }
-                cacheItem = lastPerPropsCacheItem;
+    // Look up the caches before taking their addresses, as insertions could invalidate them.
+    for (DependencyScanner * const scanner : scanners) {
+        InputArtifactScannerContext::CacheItem &cacheItem = scanner->cacheIsPerFile()
+                ? m_context->cachePerFile[inputArtifact]
+                : m_context->cachePerProperties[inputArtifact->properties];
+        cacheItem[scanner->key()];
+    }
+    std::vector<std::pair<DependencyScanner *,
+            InputArtifactScannerContext::ScannerResolvedDependenciesCache *>> scannersAndCaches;
+    for (DependencyScanner * const scanner : scanners) {
+        InputArtifactScannerContext::CacheItem &cacheItem = scanner->cacheIsPerFile()
+                ? m_context->cachePerFile[inputArtifact]
+                : m_context->cachePerProperties[inputArtifact->properties];
+        InputArtifactScannerContext::ScannerResolvedDependenciesCache &cache
+                = cacheItem[scanner->key()];
+        const bool cacheHit = cache.valid;
+        if (!cacheHit) {
+            cache.valid = true;
+            cache.searchPaths = scanner->collectSearchPaths(inputArtifact);
+        }
+        qCDebug(lcDepScan) << "include paths for scanner" << scanner->id()
+                           << "(cache" << (cacheHit ? "hit)" : "miss)");
+        for (const QString &s : qAsConst(cache.searchPaths))
+            qCDebug(lcDepScan) << "    " << s;
+        scannersAndCaches.emplace_back(scanner, &cache);
+    }
+
+    // We walk the include closure breadth-first. The files of one level are scanned
+    // concurrently, while the dependencies are resolved and applied to the build graph
+    // on this thread, in the same order as a sequential walk would do it.
+    Set<QString> visitedFilePaths;
+    std::vector<FileResourceBase *> filesToScan{inputArtifact};
+    while (!filesToScan.empty()) {
+        std::vector<ScanTask> tasks;
+        for (FileResourceBase * const fileToBeScanned : filesToScan) {
+            if (!visitedFilePaths.insert(fileToBeScanned->filePath()).second)
+                continue;
+            for (const auto &scannerAndCache : scannersAndCaches) {
+                ScanTask task;
+                task.scanner = scannerAndCache.first;
+                task.fileToBeScanned = fileToBeScanned;
+                task.cache = scannerAndCache.second;
+                tasks.push_back(std::move(task));
             }
-            scanForScannerFileDependencies(scanner, inputArtifact, fileToBeScanned,
-                scanner->recursive() ? &filesToScan : nullptr, (*cacheItem)[scanner->key()]);
+        }
+        filesToScan.clear();
+        runScanTasks(inputArtifact, tasks);
+
+        for (const ScanTask &task : tasks) {
+            if (task.error.hasError())
+                m_logger.printWarning(task.error);
+            else
+                resolveScanResultDependencies(inputArtifact, task, filesToScan);
         }
     }
 }
@@ -230,97 +320,108 @@ Set<DependencyScanner *> InputArtifactScanner::scannersForArtifact(const Artifac
     return scanners;
 }
 
-void InputArtifactScanner::scanForScannerFileDependencies(DependencyScanner *scanner,
-        Artifact *inputArtifact, FileResourceBase *fileToBeScanned,
-        QList<FileResourceBase *> *filesToScan,
-        InputArtifactScannerContext::ScannerResolvedDependenciesCache &cache)
+void InputArtifactScanner::runScanTasks(Artifact *inputArtifact, std::vector<ScanTask> &tasks)
 {
-    qCDebug(lcDepScan) << "file" << fileToBeScanned->filePath();
-
-    const bool cacheHit = cache.valid;
-    if (!cacheHit) {
-        cache.valid = true;
-        cache.searchPaths = scanner->collectSearchPaths(inputArtifact);
-    }
-    qCDebug(lcDepScan) << "include paths (cache" << (cacheHit ? "hit)" : "miss)");
-    for (const QString &s : qAsConst(cache.searchPaths))
-        qCDebug(lcDepScan) << "    " << s;
-
-    const QString &filePathToBeScanned = fileToBeScanned->filePath();
-    RawScanResults::ScanData &scanData = m_rawScanResults.findScanData(fileToBeScanned, scanner,
-                                                                       m_artifact->properties);
-    if (scanData.lastScanTime < fileToBeScanned->timestamp()) {
+    const auto runTask = [this, inputArtifact](ScanTask &task) {
         try {
-            qCDebug(lcDepScan) << "scanning" << FileInfo::fileName(filePathToBeScanned);
-            scanWithScannerPlugin(scanner, inputArtifact, fileToBeScanned, &scanData.rawScanResult);
-            scanData.lastScanTime = FileTime::currentTime();
+            scanFile(inputArtifact, task);
         } catch (const ErrorInfo &error) {
-            m_logger.printWarning(error);
-            return;
+            task.error = error;
         }
+    };
+
+    // Scanners that are not reentrant, such as the ones implemented in JavaScript,
+    // must run on this thread.
+    std::vector<ScanTask *> concurrentTasks;
+    std::vector<ScanTask *> localTasks;
+    for (ScanTask &task : tasks)
+        (task.scanner->isReentrant() ? concurrentTasks : localTasks).push_back(&task);
+    if (concurrentTasks.size() < 2) {
+        for (ScanTask &task : tasks)
+            runTask(task);
+        return;
     }
 
-    resolveScanResultDependencies(inputArtifact, scanData.rawScanResult, filesToScan, cache);
+    std::atomic_size_t nextTask(0);
+    const auto runConcurrentTasks = [&runTask, &concurrentTasks, &nextTask] {
+        for (std::size_t i = nextTask++; i < concurrentTasks.size(); i = nextTask++)
+            runTask(*concurrentTasks.at(i));
+    };
+    const int workerCount = std::min(int(concurrentTasks.size()) - 1,
+                                     m_context->threadPool.maxThreadCount());
+    for (int i = 0; i < workerCount; ++i)
+        m_context->threadPool.start(new FunctionRunnable(runConcurrentTasks));
+    runConcurrentTasks();
+    m_context->threadPool.waitForDone();
+    for (ScanTask * const task : localTasks)
+        runTask(*task);
 }
 
-void InputArtifactScanner::resolveScanResultDependencies(const Artifact *inputArtifact,
-        const RawScanResult &scanResult, QList<FileResourceBase *> *artifactsToScan,
-        InputArtifactScannerContext::ScannerResolvedDependenciesCache &cache)
+// Called concurrently for different tasks. Only the file is read here; the build graph
+// is not touched, as the look-ups there are not thread-safe.
+void InputArtifactScanner::scanFile(Artifact *inputArtifact, ScanTask &task)
 {
-    auto getResolvedDependency = [inputArtifact, &cache](const RawScannedDependency &dependency)
-            -> ResolvedDependency*
-    {
-        const QString &dependencyFilePath = dependency.filePath();
-        InputArtifactScannerContext::ResolvedDependencyCacheItem &cachedResolvedDependencyItem
-                = cache.resolvedDependenciesCache[dependency.dirPath()][dependency.fileName()];
-        ResolvedDependency &resolvedDependency = cachedResolvedDependencyItem.resolvedDependency;
-        if (cachedResolvedDependencyItem.valid) {
-            if (resolvedDependency.filePath.isEmpty())
-                return nullptr;
-            return &resolvedDependency;
-        }
-        cachedResolvedDependencyItem.valid = true;
+    FileResourceBase * const fileToBeScanned = task.fileToBeScanned;
+    qCDebug(lcDepScan) << "file" << fileToBeScanned->filePath();
 
-        if (FileInfo::isAbsolute(dependencyFilePath)) {
-            resolveDepencency(dependency, inputArtifact->product.get(), &resolvedDependency);
-            if (resolvedDependency.filePath.isEmpty())
-                return nullptr;
-            return &resolvedDependency;
-        }
+    if (!m_rawScanResults.findUpToDateScanResult(fileToBeScanned, task.scanner,
+                                                 m_artifact->properties, &task.scanResult)) {
+        qCDebug(lcDepScan) << "scanning" << FileInfo::fileName(fileToBeScanned->filePath());
+        scanWithScannerPlugin(task.scanner, inputArtifact, fileToBeScanned, &task.scanResult);
+        m_rawScanResults.storeScanResult(fileToBeScanned, task.scanner, m_artifact->properties,
+                                         task.scanResult);
+    }
+}
 
-        // try include paths
-        for (const QString &includePath : qAsConst(cache.searchPaths)) {
-            resolveDepencency(dependency, inputArtifact->product.get(),
-                              &resolvedDependency, includePath);
-            if (resolvedDependency.isValid())
-                return &resolvedDependency;
+void InputArtifactScanner::resolveScanResultDependencies(const Artifact *inputArtifact,
+        const ScanTask &task, std::vector<FileResourceBase *> &filesToScan)
+{
+    for (const RawScannedDependency &dependency : task.scanResult.deps) {
+        ResolvedDependency * const resolvedDependency
+                = resolveScannedDependency(inputArtifact, dependency, *task.cache);
+        if (!resolvedDependency) {
+            qCWarning(lcDepScan) << "unresolved dependency " << dependency.filePath();
+            continue;
         }
-        return nullptr;
-    };
 
-    for (const RawScannedDependency &dependency : scanResult.deps) {
-        const auto maybeResolvedDependency = getResolvedDependency(dependency);
-        if (!maybeResolvedDependency) {
-            qCWarning(lcDepScan) << "unresolved dependency " << dependency.filePath();
+        handleDependency(*resolvedDependency);
+        if (!task.scanner->recursive() || !resolvedDependency->file)
             continue;
+        if (resolvedDependency->file->fileType() == FileResourceBase::FileTypeArtifact) {
+            // Do not scan an artifact that is not built yet: Its contents might still change.
+            auto const artifactDependency = static_cast<Artifact *>(resolvedDependency->file);
+            if (artifactDependency->artifactType == Artifact::SourceFile
+                    || artifactDependency->buildState == BuildGraphNode::Built) {
+                filesToScan.push_back(artifactDependency);
+            }
+        } else {
+            // Add file dependency to the next round of scanning.
+            filesToScan.push_back(resolvedDependency->file);
         }
-        auto &resolvedDependency = *maybeResolvedDependency;
-
-        handleDependency(resolvedDependency);
-        if (artifactsToScan && resolvedDependency.file) {
-            if (resolvedDependency.file->fileType() == FileResourceBase::FileTypeArtifact) {
-                // Do not scan an artifact that is not built yet: Its contents might still change.
-                auto const artifactDependency = static_cast<Artifact *>(resolvedDependency.file);
-                if (artifactDependency->artifactType == Artifact::SourceFile
-                        || artifactDependency->buildState == BuildGraphNode::Built) {
-                    artifactsToScan->push_back(artifactDependency);
-                }
-            } else {
-                // Add file dependency to the next round of scanning.
-                artifactsToScan->push_back(resolvedDependency.file);
+    }
+}
+
+ResolvedDependency *InputArtifactScanner::resolveScannedDependency(const Artifact *inputArtifact,
+        const RawScannedDependency &dependency,
+        InputArtifactScannerContext::ScannerResolvedDependenciesCache &cache)
+{
+    InputArtifactScannerContext::ResolvedDependencyCacheItem &cachedResolvedDependencyItem
+            = cache.resolvedDependenciesCache[dependency.dirPath()][dependency.fileName()];
+    ResolvedDependency &resolvedDependency = cachedResolvedDependencyItem.resolvedDependency;
+    if (!cachedResolvedDependencyItem.valid) {
+        cachedResolvedDependencyItem.valid = true;
+        if (FileInfo::isAbsolute(dependency.filePath())) {
+            resolveDepencency(dependency, inputArtifact->product.get(), &resolvedDependency);
+        } else {
+            for (const QString &includePath : qAsConst(cache.searchPaths)) {
+                resolveDepencency(dependency, inputArtifact->product.get(),
+                                  &resolvedDependency, includePath);
+                if (resolvedDependency.isValid())
+                    break;
             }
         }
     }
+    return resolvedDependency.filePath.isEmpty() ? nullptr : &resolvedDependency;
 }
 
 void InputArtifactScanner::handleDependency(ResolvedDependency &dependency)
@@ -373,8 +474,10 @@ void InputArtifactScanner::handleDependency(ResolvedDependency &dependency)
 
     if (fileDependency) {
         m_artifact->fileDependencies << fileDependency;
-        if (!fileDependency->timestamp().isValid())
+        if (!fileDependency->timestamp().isValid()) {
             fileDependency->setTimestamp(FileInfo(fileDependency->filePath()).lastModified());
+            product->topLevelProject()->buildData->recordChangedFile(fileDependency);
+        }
     } else {
         if (m_artifact->children.contains(artifactDependency))
             return;
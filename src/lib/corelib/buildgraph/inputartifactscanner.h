@@ -40,13 +40,19 @@
 #ifndef QBS_INPUTARTIFACTSCANNER_H
 #define QBS_INPUTARTIFACTSCANNER_H
 
+#include "rawscanresults.h"
+
 #include <language/filetags.h>
 #include <language/forward_decls.h>
 #include <logging/logger.h>
+#include <tools/error.h>
 #include <tools/set.h>
 
 #include <QtCore/qhash.h>
 #include <QtCore/qstringlist.h>
+#include <QtCore/qthreadpool.h>
+
+#include <vector>
 
 class ScannerPlugin;
 
@@ -55,8 +61,6 @@ namespace Internal {
 
 class Artifact;
 class FileResourceBase;
-class RawScanResult;
-class RawScanResults;
 class PropertyMapInternal;
 
 class DependencyScanner;
@@ -73,6 +77,10 @@ public:
 
 class InputArtifactScannerContext
 {
+public:
+    void setMaxConcurrentScans(int count) { threadPool.setMaxThreadCount(count); }
+
+private:
     struct ResolvedDependencyCacheItem
     {
         ResolvedDependencyCacheItem()
@@ -111,6 +119,8 @@ class InputArtifactScannerContext
     QHash<Artifact *, CacheItem> cachePerFile;
     QHash<ResolvedProduct*, QHash<FileTag, DependencyScannerCacheItem>> scannersCache;
 
+    QThreadPool threadPool; // For the reentrant scanners. They only ever read files.
+
     friend class InputArtifactScanner;
 };
 
@@ -120,17 +130,28 @@ public:
     InputArtifactScanner(Artifact *artifact, InputArtifactScannerContext *ctx,
                          Logger logger);
     void scan();
+    void setReportedDependencies(const std::vector<QString> &filePaths);
     bool newDependencyAdded() const { return m_newDependencyAdded; }
 
 private:
+    struct ScanTask
+    {
+        DependencyScanner *scanner = nullptr;
+        FileResourceBase *fileToBeScanned = nullptr;
+        InputArtifactScannerContext::ScannerResolvedDependenciesCache *cache = nullptr;
+        RawScanResult scanResult;
+        ErrorInfo error;
+    };
+
+    void clearDependencies();
     void scanForFileDependencies(Artifact *inputArtifact);
     Set<DependencyScanner *> scannersForArtifact(const Artifact *artifact) const;
-    void scanForScannerFileDependencies(DependencyScanner *scanner,
-            Artifact *inputArtifact, FileResourceBase *fileToBeScanned,
-            QList<FileResourceBase *> *filesToScan,
-            InputArtifactScannerContext::ScannerResolvedDependenciesCache &cache);
-    void resolveScanResultDependencies(const Artifact *inputArtifact,
-            const RawScanResult &scanResult, QList<FileResourceBase *> *artifactsToScan,
+    void runScanTasks(Artifact *inputArtifact, std::vector<ScanTask> &tasks);
+    void scanFile(Artifact *inputArtifact, ScanTask &task);
+    void resolveScanResultDependencies(const Artifact *inputArtifact, const ScanTask &task,
+                                       std::vector<FileResourceBase *> &filesToScan);
+    ResolvedDependency *resolveScannedDependency(const Artifact *inputArtifact,
+            const RawScannedDependency &dependency,
             InputArtifactScannerContext::ScannerResolvedDependenciesCache &cache);
     void handleDependency(ResolvedDependency &dependency);
     void scanWithScannerPlugin(DependencyScanner *scanner, Artifact *inputArtifact,
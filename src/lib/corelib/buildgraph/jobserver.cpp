@@ -0,0 +1,245 @@
+/****************************************************************************
+**
+** Copyright (C) 2022 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of Qbs.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-2.0.html and
+** https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#include "jobserver.h"
+
+#include <logging/translator.h>
+#include <tools/qbsassert.h>
+
+#include <QtCore/qcoreapplication.h>
+#include <QtCore/qdir.h>
+#include <QtCore/qfile.h>
+#include <QtCore/qsocketnotifier.h>
+
+#include <algorithm>
+
+#if defined(Q_OS_UNIX)
+#   include <cerrno>
+#   include <cstring>
+#   include <fcntl.h>
+#   include <sys/stat.h>
+#   include <unistd.h>
+#endif
+
+namespace qbs {
+namespace Internal {
+
+JobServer::JobServer(QObject *parent) : QObject(parent)
+{
+}
+
+JobServer::~JobServer()
+{
+    stop();
+}
+
+bool JobServer::isSupported()
+{
+#if defined(Q_OS_UNIX)
+    return true;
+#else
+    return false;
+#endif
+}
+
+bool JobServer::start(int jobCount, QString *errorMessage)
+{
+    QBS_CHECK(!isRunning());
+    QBS_CHECK(jobCount > 0);
+#if defined(Q_OS_UNIX)
+    static int serverCount = 0;
+    m_fifoPath = QDir::tempPath() + QStringLiteral("/qbs-jobserver-%1-%2")
+            .arg(QCoreApplication::applicationPid()).arg(++serverCount);
+    const QByteArray nativeFifoPath = QFile::encodeName(m_fifoPath);
+    if (mkfifo(nativeFifoPath.constData(), 0600) != 0) {
+        *errorMessage = QString::fromLocal8Bit(std::strerror(errno));
+        return false;
+    }
+
+    // Opening for reading and writing means we neither block here nor ever see end-of-file.
+    m_fd = ::open(nativeFifoPath.constData(), O_RDWR | O_NONBLOCK | O_CLOEXEC);
+    if (m_fd == -1) {
+        *errorMessage = QString::fromLocal8Bit(std::strerror(errno));
+        unlink(nativeFifoPath.constData());
+        return false;
+    }
+    m_jobCount = jobCount;
+    m_spareTokens = 0;
+    m_tokensToWithdraw = 0;
+    writeTokens(jobCount - 1);
+    m_notifier = new QSocketNotifier(m_fd, QSocketNotifier::Read, this);
+    m_notifier->setEnabled(false);
+    connect(m_notifier, &QSocketNotifier::activated, this, &JobServer::handleReadyRead);
+    return true;
+#else
+    Q_UNUSED(jobCount);
+    *errorMessage = Tr::tr("Job servers are not supported on this platform.");
+    return false;
+#endif
+}
+
+void JobServer::stop()
+{
+    if (!isRunning())
+        return;
+    delete m_notifier;
+    m_notifier = nullptr;
+#if defined(Q_OS_UNIX)
+    ::close(m_fd);
+    unlink(QFile::encodeName(m_fifoPath).constData());
+#endif
+    m_fd = -1;
+    m_spareTokens = 0;
+    m_tokensToWithdraw = 0;
+}
+
+QString JobServer::makeFlags() const
+{
+    QBS_CHECK(isRunning());
+    return QStringLiteral("-j%1 --jobserver-auth=fifo:%2").arg(m_jobCount).arg(m_fifoPath);
+}
+
+bool JobServer::tryAcquireToken()
+{
+    QBS_CHECK(isRunning());
+    if (m_spareTokens > 0)
+        return true;
+    withdrawTokens();
+    if (readToken()) {
+        ++m_spareTokens;
+        m_notifier->setEnabled(false);
+        return true;
+    }
+    // All tokens are taken, either by our own jobs or by the tools they run.
+    m_notifier->setEnabled(true);
+    return false;
+}
+
+void JobServer::useToken()
+{
+    QBS_CHECK(m_spareTokens > 0);
+    --m_spareTokens;
+}
+
+void JobServer::releaseToken()
+{
+    returnTokens(1);
+}
+
+void JobServer::releaseSpareTokens()
+{
+    returnTokens(m_spareTokens);
+    m_spareTokens = 0;
+}
+
+void JobServer::setJobCount(int jobCount)
+{
+    QBS_CHECK(isRunning());
+    QBS_CHECK(jobCount > 0);
+    if (jobCount > m_jobCount) {
+        returnTokens(jobCount - m_jobCount);
+    } else {
+        m_tokensToWithdraw += m_jobCount - jobCount;
+        withdrawTokens();
+    }
+    m_jobCount = jobCount;
+}
+
+void JobServer::handleReadyRead()
+{
+    // The notifier is level-triggered, so keep it quiet until someone actually waits for a token.
+    m_notifier->setEnabled(false);
+    withdrawTokens();
+    emit tokenAvailable();
+}
+
+bool JobServer::readToken()
+{
+#if defined(Q_OS_UNIX)
+    char token;
+    ssize_t bytesRead;
+    do {
+        bytesRead = ::read(m_fd, &token, 1);
+    } while (bytesRead == -1 && errno == EINTR);
+    return bytesRead == 1;
+#else
+    return false;
+#endif
+}
+
+// Tokens that are to be withdrawn are simply not put back.
+void JobServer::returnTokens(int count)
+{
+    const int withdrawnCount = std::min(count, m_tokensToWithdraw);
+    m_tokensToWithdraw -= withdrawnCount;
+    writeTokens(count - withdrawnCount);
+}
+
+// Takes as many of the tokens to be withdrawn out of the pipe as are there right now.
+// The tools hold on to the others for the time being; they are taken when they come back.
+void JobServer::withdrawTokens()
+{
+    while (m_tokensToWithdraw > 0 && readToken())
+        --m_tokensToWithdraw;
+    if (m_tokensToWithdraw > 0)
+        m_notifier->setEnabled(true);
+}
+
+void JobServer::writeTokens(int count)
+{
+    QBS_CHECK(isRunning());
+#if defined(Q_OS_UNIX)
+    const QByteArray tokens(count, '+');
+    qsizetype offset = 0;
+    while (offset < tokens.size()) {
+        const ssize_t bytesWritten = ::write(m_fd, tokens.constData() + offset,
+                                             tokens.size() - offset);
+        if (bytesWritten == -1) {
+            QBS_ASSERT(errno == EINTR, return);
+            continue;
+        }
+        offset += bytesWritten;
+    }
+#else
+    Q_UNUSED(count);
+#endif
+}
+
+} // namespace Internal
+} // namespace qbs
@@ -0,0 +1,107 @@
+/****************************************************************************
+**
+** Copyright (C) 2022 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of Qbs.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-2.0.html and
+** https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#ifndef QBS_JOBSERVER_H
+#define QBS_JOBSERVER_H
+
+#include <QtCore/qobject.h>
+#include <QtCore/qstring.h>
+
+QT_BEGIN_NAMESPACE
+class QSocketNotifier;
+QT_END_NAMESPACE
+
+namespace qbs {
+namespace Internal {
+
+// Implements the server side of the GNU make jobserver protocol, so that tools with
+// parallelism of their own (make, ninja, gcc -flto=jobserver) share our job budget.
+// The tokens live in a named pipe, as the commands are not started by our process and
+// therefore cannot inherit anonymous pipe handles.
+// As with make itself, our first running job uses an implicit token; every further one has
+// to take a token out of the pipe, competing with the tools that are currently running.
+class JobServer : public QObject
+{
+    Q_OBJECT
+public:
+    explicit JobServer(QObject *parent = nullptr);
+    ~JobServer() override;
+
+    static bool isSupported();
+
+    bool start(int jobCount, QString *errorMessage);
+    void stop();
+    bool isRunning() const { return m_fd != -1; }
+
+    // The flags to put into MAKEFLAGS in the environment of commands.
+    QString makeFlags() const;
+
+    // Returns true if a token is ready to be used by the next job. Otherwise,
+    // tokenAvailable() will be emitted when it makes sense to try again.
+    bool tryAcquireToken();
+    void useToken();
+    void releaseToken();
+    void releaseSpareTokens();
+
+    // Changes the number of jobs, counting the implicit token. Tokens beyond the new count
+    // are taken out of circulation as soon as they show up in the pipe.
+    void setJobCount(int jobCount);
+
+signals:
+    void tokenAvailable();
+
+private:
+    void handleReadyRead();
+    bool readToken();
+    void returnTokens(int count);
+    void withdrawTokens();
+    void writeTokens(int count);
+
+    QString m_fifoPath;
+    QSocketNotifier *m_notifier = nullptr;
+    int m_fd = -1;
+    int m_jobCount = 0;
+    int m_spareTokens = 0;
+    int m_tokensToWithdraw = 0;
+};
+
+} // namespace Internal
+} // namespace qbs
+
+#endif // QBS_JOBSERVER_H
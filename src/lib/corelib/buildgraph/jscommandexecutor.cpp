@@ -250,7 +250,14 @@ bool JsCommandExecutor::doStart()
         return false;
     }
 
-    m_thread->start();
+    // Every ExecutorJob owns one of these threads, so the JavaScriptCommands of a build are
+    // spread over maxJobCount script engines. Naming the thread makes that visible in
+    // debuggers and profilers.
+    if (!m_thread->isRunning()) {
+        if (parent())
+            m_thread->setObjectName(QStringLiteral("qbs-js-%1").arg(parent()->objectName()));
+        m_thread->start();
+    }
     m_running = true;
     emit startRequested(jsCommand(), transformer());
     return true;
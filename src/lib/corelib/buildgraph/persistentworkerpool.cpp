@@ -0,0 +1,252 @@
+/****************************************************************************
+**
+** Copyright (C) 2022 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of Qbs.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-2.0.html and
+** https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#include "persistentworkerpool.h"
+
+#include <logging/categories.h>
+#include <logging/translator.h>
+#include <tools/qbsassert.h>
+
+#include <QtCore/qdir.h>
+#include <QtCore/qjsonarray.h>
+#include <QtCore/qjsondocument.h>
+#include <QtCore/qjsonobject.h>
+#include <QtCore/qtimer.h>
+
+namespace qbs {
+namespace Internal {
+
+static const int maxStderrSize = 64 * 1024;
+
+PersistentWorker::PersistentWorker(QString key, QObject *parent)
+    : QObject(parent), m_key(std::move(key))
+{
+    connect(&m_process, &QbsProcess::errorOccurred, this, &PersistentWorker::handleProcessError);
+    connect(&m_process, &QbsProcess::readyReadStandardOutput,
+            this, &PersistentWorker::handleStandardOutput);
+    connect(&m_process, &QbsProcess::readyReadStandardError,
+            this, &PersistentWorker::handleStandardError);
+    connect(&m_process, static_cast<void (QbsProcess::*)(int)>(&QbsProcess::finished),
+            this, &PersistentWorker::handleProcessFinished);
+}
+
+void PersistentWorker::start(const QString &program, const QStringList &arguments,
+                             const QString &workingDir, const QProcessEnvironment &environment)
+{
+    qCDebug(lcExec) << "starting persistent worker" << program << arguments;
+    m_program = program;
+    m_process.setProcessEnvironment(environment);
+    m_process.setWorkingDirectory(workingDir);
+    m_process.start(program, arguments);
+}
+
+void PersistentWorker::stop()
+{
+    m_process.cancel();
+}
+
+void PersistentWorker::sendRequest(const QStringList &arguments)
+{
+    QBS_ASSERT(!m_busy, return);
+    if (m_broken) {
+        // Don't call back on the caller.
+        QTimer::singleShot(0, this, [this] { emit failed(m_errorString); });
+        return;
+    }
+    m_busy = true;
+    QJsonObject request;
+    request.insert(QStringLiteral("arguments"), QJsonArray::fromStringList(arguments));
+    request.insert(QStringLiteral("requestId"), ++m_requestId);
+    m_process.write(QJsonDocument(request).toJson(QJsonDocument::Compact) + '\n');
+}
+
+void PersistentWorker::handleStandardOutput()
+{
+    m_pendingOutput += m_process.readAllStandardOutput();
+    int lineEnd;
+    while (!m_broken && (lineEnd = m_pendingOutput.indexOf('\n')) != -1) {
+        const QByteArray line = m_pendingOutput.left(lineEnd).trimmed();
+        m_pendingOutput.remove(0, lineEnd + 1);
+        if (!line.isEmpty())
+            handleResponse(line);
+    }
+}
+
+void PersistentWorker::handleStandardError()
+{
+    m_stderr += m_process.readAllStandardError();
+    if (m_stderr.size() > maxStderrSize)
+        m_stderr.remove(0, m_stderr.size() - maxStderrSize);
+}
+
+void PersistentWorker::handleProcessError()
+{
+    if (m_process.error() == QProcess::FailedToStart) {
+        fail(Tr::tr("The worker '%1' could not be started: %2")
+             .arg(QDir::toNativeSeparators(m_program), m_process.errorString()));
+    }
+}
+
+void PersistentWorker::handleProcessFinished(int exitCode)
+{
+    // The final output comes with the finished notification.
+    handleStandardOutput();
+    handleStandardError();
+    QString message = Tr::tr("The worker '%1' exited unexpectedly with code %2.")
+            .arg(QDir::toNativeSeparators(m_program)).arg(exitCode);
+    if (!m_stderr.isEmpty())
+        message.append(QLatin1Char('\n')).append(QString::fromLocal8Bit(m_stderr));
+    fail(message);
+}
+
+void PersistentWorker::handleResponse(const QByteArray &line)
+{
+    QJsonParseError parseError;
+    const QJsonDocument response = QJsonDocument::fromJson(line, &parseError);
+    if (parseError.error != QJsonParseError::NoError || !response.isObject()) {
+        fail(Tr::tr("The worker '%1' sent an invalid response: %2")
+             .arg(QDir::toNativeSeparators(m_program), QString::fromLocal8Bit(line)));
+        return;
+    }
+    const QJsonObject responseObject = response.object();
+    if (!m_busy || responseObject.value(QStringLiteral("requestId")).toInt() != m_requestId) {
+        fail(Tr::tr("The worker '%1' sent a response to an unknown request.")
+             .arg(QDir::toNativeSeparators(m_program)));
+        return;
+    }
+    m_busy = false;
+    m_stderr.clear();
+    emit requestFinished(responseObject.value(QStringLiteral("exitCode")).toInt(),
+                         responseObject.value(QStringLiteral("output")).toString().toLocal8Bit());
+}
+
+void PersistentWorker::fail(const QString &errorMessage)
+{
+    if (m_broken)
+        return;
+    qCDebug(lcExec) << "persistent worker failed:" << errorMessage;
+    m_broken = true;
+    m_errorString = errorMessage;
+    m_process.cancel();
+    if (m_busy) {
+        m_busy = false;
+        emit failed(errorMessage);
+    }
+}
+
+
+PersistentWorkerPool::PersistentWorkerPool(QObject *parent) : QObject(parent)
+{
+}
+
+PersistentWorkerPool::~PersistentWorkerPool()
+{
+    stopWorkers();
+}
+
+static QString workerKey(const QString &program, const QStringList &arguments,
+                         const QString &workingDir, const QProcessEnvironment &environment)
+{
+    QStringList environmentList = environment.toStringList();
+    environmentList.sort();
+    return QStringList{program, arguments.join(QChar()), workingDir,
+                       environmentList.join(QChar())}.join(QLatin1Char('\n'));
+}
+
+PersistentWorker *PersistentWorkerPool::acquireWorker(const QString &program,
+        const QStringList &arguments, const QString &workingDir,
+        const QProcessEnvironment &environment)
+{
+    const QString key = workerKey(program, arguments, workingDir, environment);
+    for (std::size_t i = m_idleWorkers.size(); i-- > 0;) {
+        PersistentWorker * const worker = m_idleWorkers.at(i);
+        if (worker->key() != key)
+            continue;
+        m_idleWorkers.erase(m_idleWorkers.begin() + i);
+        if (worker->isBroken()) {
+            worker->deleteLater();
+            continue;
+        }
+        m_busyWorkers.insert(worker);
+        return worker;
+    }
+    const auto worker = new PersistentWorker(key, this);
+    worker->start(program, arguments, workingDir, environment);
+    m_busyWorkers.insert(worker);
+    return worker;
+}
+
+void PersistentWorkerPool::releaseWorker(PersistentWorker *worker)
+{
+    m_busyWorkers.remove(worker);
+    if (worker->isBroken()) {
+        worker->deleteLater();
+        return;
+    }
+    m_idleWorkers.push_back(worker);
+
+    // Workers whose commands are done for this build would otherwise keep their
+    // resources until the end of it.
+    if (m_maxIdleWorkers > 0 && int(m_idleWorkers.size()) > m_maxIdleWorkers) {
+        qCDebug(lcExec) << "stopping least recently used persistent worker";
+        stopIdleWorker(0);
+    }
+}
+
+void PersistentWorkerPool::stopIdleWorker(std::size_t index)
+{
+    PersistentWorker * const worker = m_idleWorkers.at(index);
+    m_idleWorkers.erase(m_idleWorkers.begin() + index);
+    worker->stop();
+    worker->deleteLater();
+}
+
+// Busy workers report the failure of their current request to their user,
+// who then hands them back to us.
+void PersistentWorkerPool::stopWorkers()
+{
+    const Set<PersistentWorker *> busyWorkers = m_busyWorkers; // Might get modified.
+    for (PersistentWorker * const worker : busyWorkers)
+        worker->stop();
+    while (!m_idleWorkers.empty())
+        stopIdleWorker(m_idleWorkers.size() - 1);
+}
+
+} // namespace Internal
+} // namespace qbs
@@ -0,0 +1,135 @@
+/****************************************************************************
+**
+** Copyright (C) 2022 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of Qbs.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-2.0.html and
+** https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#ifndef QBS_PERSISTENTWORKERPOOL_H
+#define QBS_PERSISTENTWORKERPOOL_H
+
+#include <tools/qbsprocess.h>
+#include <tools/qttools.h>
+#include <tools/set.h>
+
+#include <QtCore/qbytearray.h>
+#include <QtCore/qobject.h>
+#include <QtCore/qprocess.h>
+#include <QtCore/qstringlist.h>
+
+#include <vector>
+
+namespace qbs {
+namespace Internal {
+
+// A long-running instance of a tool that handles one request at a time, using the JSON
+// variant of the Bazel persistent worker protocol: Each request is a line on the worker's
+// standard input of the form {"arguments": [...], "requestId": <n>}, and the worker answers
+// with a line on its standard output of the form {"exitCode": <n>, "output": "...",
+// "requestId": <n>}.
+class PersistentWorker : public QObject
+{
+    Q_OBJECT
+public:
+    PersistentWorker(QString key, QObject *parent);
+
+    const QString &key() const { return m_key; }
+    void start(const QString &program, const QStringList &arguments, const QString &workingDir,
+               const QProcessEnvironment &environment);
+    void stop();
+
+    // A broken worker has died or violated the protocol and must not be used anymore.
+    bool isBroken() const { return m_broken; }
+
+    void sendRequest(const QStringList &arguments);
+
+signals:
+    void requestFinished(int exitCode, const QByteArray &output);
+    void failed(const QString &errorMessage);
+
+private:
+    void handleStandardOutput();
+    void handleStandardError();
+    void handleProcessError();
+    void handleProcessFinished(int exitCode);
+    void handleResponse(const QByteArray &line);
+    void fail(const QString &errorMessage);
+
+    const QString m_key;
+    QString m_program;
+    QbsProcess m_process;
+    QByteArray m_pendingOutput;
+    QByteArray m_stderr; // The most recent diagnostics of the worker itself.
+    QString m_errorString;
+    int m_requestId = 0;
+    bool m_busy = false;
+    bool m_broken = false;
+};
+
+// Keeps the workers for the process commands of a build alive between commands.
+// Workers are keyed by their program, startup arguments, working directory and environment.
+// There is at most one request per worker at any time; if all workers for a key are busy,
+// another one is started. Of the idle workers, only the most recently used ones are kept.
+class PersistentWorkerPool : public QObject
+{
+    Q_OBJECT
+public:
+    explicit PersistentWorkerPool(QObject *parent = nullptr);
+    ~PersistentWorkerPool() override;
+
+    // Reserves an idle worker for the caller, starting a new one if necessary.
+    // It has to be handed back via releaseWorker().
+    PersistentWorker *acquireWorker(const QString &program, const QStringList &arguments,
+                                    const QString &workingDir,
+                                    const QProcessEnvironment &environment);
+    void releaseWorker(PersistentWorker *worker);
+
+    // 0 means no limit.
+    void setMaxIdleWorkers(int count) { m_maxIdleWorkers = count; }
+
+    void stopWorkers();
+
+private:
+    void stopIdleWorker(std::size_t index);
+
+    std::vector<PersistentWorker *> m_idleWorkers; // In the order they were released.
+    Set<PersistentWorker *> m_busyWorkers;
+    int m_maxIdleWorkers = 0;
+};
+
+} // namespace Internal
+} // namespace qbs
+
+#endif // QBS_PERSISTENTWORKERPOOL_H
@@ -41,6 +41,7 @@
 #include "processcommandexecutor.h"
 
 #include "artifact.h"
+#include "persistentworkerpool.h"
 #include "rulecommands.h"
 #include "transformer.h"
 
@@ -75,6 +76,10 @@ ProcessCommandExecutor::ProcessCommandExecutor(const Logger &logger, QObject *pa
 {
     connect(&m_process, &QbsProcess::errorOccurred,
             this, &ProcessCommandExecutor::onProcessError);
+    connect(&m_process, &QbsProcess::readyReadStandardOutput,
+            this, [this] { collectProcessOutput(true, false); });
+    connect(&m_process, &QbsProcess::readyReadStandardError,
+            this, [this] { collectProcessOutput(false, false); });
     connect(&m_process, static_cast<void (QbsProcess::*)(int)>(&QbsProcess::finished),
             this, &ProcessCommandExecutor::onProcessFinished);
 }
@@ -115,6 +120,12 @@ void ProcessCommandExecutor::doSetup()
         cmd->addRelevantEnvValue(key, transformer()->product()->buildEnvironment.value(key));
 
     m_commandEnvironment = mergeEnvironments(m_buildEnvironment, cmd->environment());
+    if (!m_makeFlags.isEmpty()) {
+        const QString makeFlagsKey = QStringLiteral("MAKEFLAGS");
+        const QString makeFlags = m_commandEnvironment.value(makeFlagsKey);
+        m_commandEnvironment.insert(makeFlagsKey, makeFlags.isEmpty()
+                                    ? m_makeFlags : makeFlags + QLatin1Char(' ') + m_makeFlags);
+    }
     m_program = program;
     m_arguments = cmd->arguments();
     m_shellInvocation = shellQuote(QDir::toNativeSeparators(m_program), m_arguments);
@@ -147,6 +158,18 @@ bool ProcessCommandExecutor::doStart()
         }
     }
 
+    // Workers get their arguments via the request, so there is no need for a response file.
+    if (cmd->persistentWorker() && m_workerPool) {
+        qCDebug(lcExec) << "Sending request to persistent worker; full command line is:"
+                        << m_shellInvocation;
+        setupOutputChannel(true);
+        setupOutputChannel(false);
+        m_process.setWorkingDirectory(workingDir);
+        m_workerRetried = false;
+        sendWorkerRequest();
+        return true;
+    }
+
     // Automatically use response files, if the command line gets to long.
     if (!cmd->responseFileUsagePrefix().isEmpty()) {
         const int commandLineLength = m_shellInvocation.length();
@@ -194,6 +217,8 @@ bool ProcessCommandExecutor::doStart()
     qCDebug(lcExec) << "Running external process; full command line is:" << m_shellInvocation;
     const QProcessEnvironment &additionalVariables = cmd->environment();
     qCDebug(lcExec) << "Additional environment:" << additionalVariables.toStringList();
+    setupOutputChannel(true);
+    setupOutputChannel(false);
     m_process.setWorkingDirectory(workingDir);
     m_process.start(m_program, arguments);
     return true;
@@ -205,7 +230,28 @@ void ProcessCommandExecutor::cancel(const qbs::ErrorInfo &reason)
     disconnect(this, &ProcessCommandExecutor::reportProcessResult, nullptr, nullptr);
 
     m_cancelReason = reason;
-    m_process.cancel();
+    if (m_worker)
+        m_worker->stop();
+    else
+        m_process.cancel();
+}
+
+void ProcessCommandExecutor::sendWorkerRequest()
+{
+    const ProcessCommand * const cmd = processCommand();
+    m_worker = m_workerPool->acquireWorker(m_program, cmd->persistentWorkerArguments(),
+                                           m_process.workingDirectory(), m_commandEnvironment);
+    connect(m_worker, &PersistentWorker::requestFinished,
+            this, &ProcessCommandExecutor::onWorkerRequestFinished);
+    connect(m_worker, &PersistentWorker::failed, this, &ProcessCommandExecutor::onWorkerFailed);
+    m_worker->sendRequest(m_arguments);
+}
+
+void ProcessCommandExecutor::releaseWorker()
+{
+    m_worker->disconnect(this);
+    m_workerPool->releaseWorker(m_worker);
+    m_worker = nullptr;
 }
 
 QString ProcessCommandExecutor::filterProcessOutput(const QByteArray &_output,
@@ -259,23 +305,132 @@ static QProcess::ProcessError saveToFile(const QString &filePath, const QByteArr
     return f.error() == QFileDevice::NoError ? QProcess::UnknownError : QProcess::WriteError;
 }
 
+// Output is passed on while the process is running only if it ends up unchanged in the
+// ProcessResult, so that clients know they do not have to show the latter again.
+bool ProcessCommandExecutor::forwardsOutput() const
+{
+    const ProcessCommand * const cmd = processCommand();
+    return cmd->stdoutFilterFunction().isEmpty() && cmd->stderrFilterFunction().isEmpty()
+            && cmd->stdoutFilePath().isEmpty() && cmd->stderrFilePath().isEmpty();
+}
+
+void ProcessCommandExecutor::setupOutputChannel(bool stdOut)
+{
+    const ProcessCommand * const cmd = processCommand();
+    OutputChannel &channel = stdOut ? m_stdout : m_stderr;
+    channel = OutputChannel();
+    channel.forwardOutput = forwardsOutput();
+    const QString filterFunction = stdOut ? cmd->stdoutFilterFunction()
+                                          : cmd->stderrFilterFunction();
+    if (filterFunction.isEmpty())
+        channel.filePath = stdOut ? cmd->stdoutFilePath() : cmd->stderrFilePath();
+}
+
+// Called whenever the process has written something, so that we only ever hold a bounded
+// amount of its output, and once more after it has finished.
+void ProcessCommandExecutor::collectProcessOutput(bool stdOut, bool processFinished)
+{
+    addProcessOutput(stdOut, stdOut ? m_process.readAllStandardOutput()
+                                    : m_process.readAllStandardError(), processFinished);
+}
+
+void ProcessCommandExecutor::addProcessOutput(bool stdOut, QByteArray content,
+                                              bool processFinished)
+{
+    OutputChannel &channel = stdOut ? m_stdout : m_stderr;
+    if (stdOut && !processCommand()->dependencyOutputPrefix().isEmpty()) {
+        // Dependency lines can only be recognized once they are complete.
+        content.prepend(channel.incompleteLine);
+        const int completeSize = processFinished ? content.size()
+                                                 : content.lastIndexOf('\n') + 1;
+        channel.incompleteLine = content.mid(completeSize);
+        content = extractReportedDependencies(content.left(completeSize));
+    }
+    if (channel.forwardOutput)
+        forwardProcessOutput(stdOut, content, processFinished);
+    if (!channel.filePath.isEmpty()) {
+        writeOutputToFile(channel, content);
+        return;
+    }
+    channel.data += content;
+
+    // Trimming only at twice the limit keeps the cost of moving the data around linear.
+    if (m_maxOutputSize > 0 && channel.data.size() > 2 * m_maxOutputSize)
+        discardOldOutput(channel, m_maxOutputSize);
+}
+
+// Only complete lines are passed on, so that output of concurrently running commands
+// does not get mixed up within a line.
+void ProcessCommandExecutor::forwardProcessOutput(bool stdOut, const QByteArray &content,
+                                                  bool processFinished)
+{
+    OutputChannel &channel = stdOut ? m_stdout : m_stderr;
+    QByteArray data = channel.unforwardedLine + content;
+    const int completeSize = processFinished ? data.size() : data.lastIndexOf('\n') + 1;
+    channel.unforwardedLine = data.mid(completeSize);
+    data.truncate(completeSize);
+    const QStringList lines = QString::fromLocal8Bit(data).split(QLatin1Char('\n'),
+                                                                 QBS_SKIP_EMPTY_PARTS);
+    if (!lines.empty())
+        emit reportCommandOutput(m_program, lines, !stdOut);
+}
+
+void ProcessCommandExecutor::writeOutputToFile(OutputChannel &channel, const QByteArray &content)
+{
+    if (!channel.file) {
+        channel.file = std::make_unique<QFile>(channel.filePath);
+        if (!channel.file->open(QIODevice::WriteOnly))
+            channel.writeError = true;
+    }
+    if (!channel.writeError && channel.file->write(content) != content.size())
+        channel.writeError = true;
+}
+
+void ProcessCommandExecutor::discardOldOutput(OutputChannel &channel, qint64 maxSize)
+{
+    if (channel.data.size() <= maxSize)
+        return;
+    int discardSize = channel.data.size() - int(maxSize);
+
+    // Do not start in the middle of a line, if possible.
+    const int lineEnd = channel.data.indexOf('\n', discardSize - 1);
+    if (lineEnd != -1)
+        discardSize = lineEnd + 1;
+    channel.data.remove(0, discardSize);
+    channel.discardedSize += discardSize;
+}
+
 void ProcessCommandExecutor::getProcessOutput(bool stdOut, ProcessResult &result)
 {
-    QByteArray content;
     QString filterFunction;
     QString redirectPath;
     QStringList *target;
     if (stdOut) {
-        content = m_process.readAllStandardOutput();
         filterFunction = processCommand()->stdoutFilterFunction();
         redirectPath = processCommand()->stdoutFilePath();
         target = &result.d->stdOut;
     } else {
-        content = m_process.readAllStandardError();
         filterFunction = processCommand()->stderrFilterFunction();
         redirectPath = processCommand()->stderrFilePath();
         target = &result.d->stdErr;
     }
+    collectProcessOutput(stdOut, true);
+    OutputChannel &channel = stdOut ? m_stdout : m_stderr;
+    if (channel.file) {
+        // The output went into the file while the process was running.
+        channel.file->close();
+        const bool writeError = channel.writeError
+                || channel.file->error() != QFileDevice::NoError;
+        channel.file.reset();
+        if (result.error() == QProcess::UnknownError && writeError)
+            result.d->error = QProcess::WriteError;
+        return;
+    }
+
+    if (m_maxOutputSize > 0)
+        discardOldOutput(channel, m_maxOutputSize);
+    const QByteArray content = channel.data;
+    channel.data.clear();
     QString contentString = filterProcessOutput(content, filterFunction);
     if (!redirectPath.isEmpty()) {
         const QByteArray dataToWrite = filterFunction.isEmpty() ? content
@@ -283,33 +438,156 @@ void ProcessCommandExecutor::getProcessOutput(bool stdOut, ProcessResult &result
         const QProcess::ProcessError error = saveToFile(redirectPath, dataToWrite);
         if (result.error() == QProcess::UnknownError && error != QProcess::UnknownError)
             result.d->error = error;
+        if (channel.discardedSize > 0) {
+            logger().printWarning(ErrorInfo(Tr::tr("The first %1 bytes of the output of '%2' "
+                                                   "were discarded.")
+                                            .arg(channel.discardedSize)
+                                            .arg(QDir::toNativeSeparators(m_program))));
+        }
     } else {
         if (!contentString.isEmpty() && contentString.endsWith(QLatin1Char('\n')))
             contentString.chop(1);
         *target = contentString.split(QLatin1Char('\n'), QBS_SKIP_EMPTY_PARTS);
+        if (channel.discardedSize > 0) {
+            target->prepend(Tr::tr("[%1 bytes of earlier output were discarded]")
+                            .arg(channel.discardedSize));
+        }
     }
 }
 
-void ProcessCommandExecutor::sendProcessOutput()
+// Returns the output without the lines that name dependencies, collecting the latter.
+QByteArray ProcessCommandExecutor::extractReportedDependencies(const QByteArray &output)
+{
+    const QByteArray prefix = processCommand()->dependencyOutputPrefix().toLocal8Bit();
+    QByteArray remainingOutput;
+    int lineStart = 0;
+    while (lineStart < output.size()) {
+        const int newlinePos = output.indexOf('\n', lineStart);
+        const int lineEnd = newlinePos == -1 ? output.size() : newlinePos + 1;
+        const QByteArray line = output.mid(lineStart, lineEnd - lineStart);
+        if (line.startsWith(prefix))
+            addReportedDependency(QString::fromLocal8Bit(line.mid(prefix.size()).trimmed()));
+        else
+            remainingOutput += line;
+        lineStart = lineEnd;
+    }
+    transformer()->dependenciesReported = true;
+    return remainingOutput;
+}
+
+// Parses a dependency file in Makefile syntax, as written e.g. by gcc's -MD option.
+static QStringList prerequisitesFromDependencyFile(const QByteArray &content)
+{
+    QStringList prerequisites;
+    QByteArray token;
+    bool inPrerequisites = false;
+    const auto finishToken = [&] {
+        if (token.isEmpty())
+            return;
+        if (inPrerequisites)
+            prerequisites << QString::fromLocal8Bit(token);
+        else if (token.endsWith(':'))
+            inPrerequisites = true;
+        token.clear();
+    };
+    for (int i = 0; i < content.size(); ++i) {
+        const char c = content.at(i);
+        const char next = i + 1 < content.size() ? content.at(i + 1) : '\0';
+        if (c == '\\' && (next == '\n' || (next == '\r' && i + 2 < content.size()
+                                             && content.at(i + 2) == '\n'))) {
+            finishToken(); // Line continuation.
+            i += next == '\n' ? 1 : 2;
+        } else if (c == '\\' && (next == ' ' || next == '#')) {
+            token += next;
+            ++i;
+        } else if (c == '$' && next == '$') {
+            token += c;
+            ++i;
+        } else if (c == '\n') {
+            finishToken();
+            inPrerequisites = false;
+        } else if (c == ' ' || c == '\t' || c == '\r') {
+            finishToken();
+        } else {
+            token += c;
+        }
+    }
+    finishToken();
+    return prerequisites;
+}
+
+QString ProcessCommandExecutor::dependencyFilePath() const
+{
+    return FileInfo::resolvePath(workingDirectory(), QDir::fromNativeSeparators(
+                                     processCommand()->dependencyFilePath()));
+}
+
+void ProcessCommandExecutor::readDependencyFile()
+{
+    const QString filePath = dependencyFilePath();
+    QFile dependencyFile(filePath);
+    if (!dependencyFile.open(QIODevice::ReadOnly)) {
+        logger().printWarning(ErrorInfo(Tr::tr("Cannot read dependency file '%1': %2")
+                                        .arg(QDir::toNativeSeparators(filePath),
+                                             dependencyFile.errorString())));
+        return;
+    }
+    const QStringList prerequisites = prerequisitesFromDependencyFile(dependencyFile.readAll());
+    for (const QString &prerequisite : prerequisites)
+        addReportedDependency(prerequisite);
+    transformer()->dependenciesReported = true;
+}
+
+// The file is not an output of the command, so nothing else would ever remove it.
+void ProcessCommandExecutor::removeDependencyFile()
+{
+    QFile::remove(dependencyFilePath());
+}
+
+void ProcessCommandExecutor::addReportedDependency(const QString &filePath)
+{
+    if (filePath.isEmpty())
+        return;
+    transformer()->reportedDependencies.push_back(
+                QDir::cleanPath(FileInfo::resolvePath(workingDirectory(),
+                                                      QDir::fromNativeSeparators(filePath))));
+}
+
+QString ProcessCommandExecutor::workingDirectory() const
+{
+    const QString workingDir = m_process.workingDirectory();
+    return workingDir.isEmpty() ? QDir::currentPath() : workingDir;
+}
+
+void ProcessCommandExecutor::sendProcessOutput(int exitCode, QProcess::ProcessError error,
+                                               const QString &errorString,
+                                               const ProcessResourceUsage &resourceUsage)
 {
     ProcessResult result;
     result.d->executableFilePath = m_program;
     result.d->arguments = m_arguments;
-    result.d->workingDirectory = m_process.workingDirectory();
-    if (result.workingDirectory().isEmpty())
-        result.d->workingDirectory = QDir::currentPath();
-    result.d->exitCode = m_process.exitCode();
-    result.d->error = m_process.error();
-    QString errorString = m_process.errorString();
+    result.d->workingDirectory = workingDirectory();
+    result.d->exitCode = exitCode;
+    result.d->error = error;
+    result.d->userTime = resourceUsage.userTime;
+    result.d->systemTime = resourceUsage.systemTime;
+    result.d->peakMemoryUsage = resourceUsage.peakMemoryUsage;
+    result.d->blockInputOperations = resourceUsage.blockInputOperations;
+    result.d->blockOutputOperations = resourceUsage.blockOutputOperations;
+    result.d->outputForwarded = m_stdout.forwardOutput;
 
     getProcessOutput(true, result);
     getProcessOutput(false, result);
 
     const bool processError = result.error() != QProcess::UnknownError;
-    const bool failureExit = quint32(m_process.exitCode())
-            > quint32(processCommand()->maxExitCode());
+    const bool failureExit = quint32(exitCode) > quint32(processCommand()->maxExitCode());
     const bool cancelledWithError = m_cancelReason.hasError();
     result.d->success = !processError && !failureExit && !cancelledWithError;
+    if (!processCommand()->dependencyFilePath().isEmpty()) {
+        if (result.success())
+            readDependencyFile();
+        removeDependencyFile();
+    }
     emit reportProcessResult(result);
 
     if (Q_UNLIKELY(cancelledWithError)) {
@@ -317,8 +595,7 @@ void ProcessCommandExecutor::sendProcessOutput()
     } else if (Q_UNLIKELY(processError)) {
         emit finished(ErrorInfo(errorString));
     } else if (Q_UNLIKELY(failureExit)) {
-        emit finished(ErrorInfo(Tr::tr("Process failed with exit code %1.")
-                                .arg(m_process.exitCode())));
+        emit finished(ErrorInfo(Tr::tr("Process failed with exit code %1.").arg(exitCode)));
     } else {
         emit finished();
     }
@@ -369,7 +646,48 @@ void ProcessCommandExecutor::onProcessFinished()
         return;
     }
     removeResponseFile();
-    sendProcessOutput();
+    sendProcessOutput(m_process.exitCode(), m_process.error(), m_process.errorString(),
+                      m_process.resourceUsage());
+}
+
+void ProcessCommandExecutor::onWorkerRequestFinished(int exitCode, const QByteArray &output)
+{
+    if (m_worker)
+        releaseWorker();
+    if (scriptEngine()->isActive()) {
+        qCDebug(lcExec) << "Worker request finished while rule execution is pausing. "
+                           "Delaying slot execution.";
+        QTimer::singleShot(0, this, [this, exitCode, output] {
+            onWorkerRequestFinished(exitCode, output);
+        });
+        return;
+    }
+
+    // Workers have no separate channels; their output is treated like the standard output
+    // of a process.
+    addProcessOutput(true, output, false);
+    sendProcessOutput(exitCode, QProcess::UnknownError, QString(), ProcessResourceUsage());
+}
+
+void ProcessCommandExecutor::onWorkerFailed(const QString &errorMessage)
+{
+    releaseWorker();
+    if (m_cancelReason.hasError()) {
+        emit finished(m_cancelReason);
+        return;
+    }
+
+    // A worker that has died might just have hit some internal limit, so give it another go.
+    if (!m_workerRetried) {
+        qCDebug(lcExec) << "Persistent worker failed, retrying with a new one.";
+        m_workerRetried = true;
+        setupOutputChannel(true);
+        setupOutputChannel(false);
+        sendWorkerRequest();
+        return;
+    }
+    emit finished(ErrorInfo(Tr::tr("%1\nThe full command line invocation was: %2")
+                            .arg(errorMessage, m_shellInvocation)));
 }
 
 static QString environmentVariableString(const QString &key, const QString &value)
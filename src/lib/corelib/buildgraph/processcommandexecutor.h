@@ -45,12 +45,17 @@
 
 #include <tools/qbsprocess.h>
 
+#include <QtCore/qfile.h>
 #include <QtCore/qstring.h>
 
+#include <memory>
+
 namespace qbs {
 class ProcessResult;
 
 namespace Internal {
+class PersistentWorker;
+class PersistentWorkerPool;
 class ProcessCommand;
 
 class ProcessCommandExecutor : public AbstractCommandExecutor
@@ -63,12 +68,38 @@ public:
         m_buildEnvironment = processEnvironment;
     }
 
+    // The number of bytes per output channel that is kept in memory. 0 means no limit.
+    void setMaxOutputSize(qint64 maxSize) { m_maxOutputSize = maxSize; }
+
+    // Gets appended to MAKEFLAGS in the environment of the process.
+    void setMakeFlags(const QString &makeFlags) { m_makeFlags = makeFlags; }
+
+    // Used for commands that have the persistentWorker property set.
+    void setPersistentWorkerPool(PersistentWorkerPool *pool) { m_workerPool = pool; }
+
 signals:
+    void reportCommandOutput(const QString &executableFilePath, const QStringList &lines,
+                             bool stdErr);
     void reportProcessResult(const qbs::ProcessResult &result);
 
 private:
+    class OutputChannel
+    {
+    public:
+        QByteArray data;
+        QByteArray incompleteLine;
+        QByteArray unforwardedLine;
+        QString filePath; // Set if the output goes to a file unfiltered.
+        std::unique_ptr<QFile> file;
+        qint64 discardedSize = 0;
+        bool writeError = false;
+        bool forwardOutput = false;
+    };
+
     void onProcessError();
     void onProcessFinished();
+    void onWorkerRequestFinished(int exitCode, const QByteArray &output);
+    void onWorkerFailed(const QString &errorMessage);
 
     void doSetup() override;
     void doReportCommandDescription(const QString &productName) override;
@@ -76,10 +107,26 @@ private:
     void cancel(const qbs::ErrorInfo &reason) override;
 
     void startProcessCommand();
+    void sendWorkerRequest();
+    void releaseWorker();
     QString filterProcessOutput(const QByteArray &output, const QString &filterFunctionSource);
+    bool forwardsOutput() const;
+    void setupOutputChannel(bool stdOut);
+    void collectProcessOutput(bool stdOut, bool processFinished);
+    void addProcessOutput(bool stdOut, QByteArray content, bool processFinished);
+    void forwardProcessOutput(bool stdOut, const QByteArray &content, bool processFinished);
+    void writeOutputToFile(OutputChannel &channel, const QByteArray &content);
+    void discardOldOutput(OutputChannel &channel, qint64 maxSize);
     void getProcessOutput(bool stdOut, ProcessResult &result);
-
-    void sendProcessOutput();
+    QByteArray extractReportedDependencies(const QByteArray &output);
+    QString dependencyFilePath() const;
+    void readDependencyFile();
+    void removeDependencyFile();
+    void addReportedDependency(const QString &filePath);
+    QString workingDirectory() const;
+
+    void sendProcessOutput(int exitCode, QProcess::ProcessError error, const QString &errorString,
+                           const ProcessResourceUsage &resourceUsage);
     void removeResponseFile();
     ProcessCommand *processCommand() const;
 
@@ -89,8 +136,15 @@ private:
     QString m_shellInvocation;
 
     QbsProcess m_process;
+    OutputChannel m_stdout;
+    OutputChannel m_stderr;
+    qint64 m_maxOutputSize = 0;
     QProcessEnvironment m_buildEnvironment;
     QProcessEnvironment m_commandEnvironment;
+    QString m_makeFlags;
+    PersistentWorkerPool *m_workerPool = nullptr;
+    PersistentWorker *m_worker = nullptr;
+    bool m_workerRetried = false;
     QString m_responseFileName;
     qbs::ErrorInfo m_cancelReason;
 };
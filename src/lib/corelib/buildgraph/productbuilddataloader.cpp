@@ -0,0 +1,330 @@
+/****************************************************************************
+**
+** Copyright (C) 2022 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of Qbs.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-2.0.html and
+** https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#include "productbuilddataloader.h"
+
+#include "artifact.h"
+#include "productbuilddata.h"
+#include "projectbuilddata.h"
+
+#include <language/language.h>
+#include <logging/categories.h>
+#include <logging/translator.h>
+#include <tools/error.h>
+#include <tools/fileinfo.h>
+#include <tools/qbsassert.h>
+#include <tools/stlutils.h>
+
+#include <algorithm>
+
+namespace qbs {
+namespace Internal {
+
+ProductBuildDataPtr::ProductBuildDataPtr() = default;
+ProductBuildDataPtr::~ProductBuildDataPtr() = default;
+
+ProductBuildDataPtr &ProductBuildDataPtr::operator=(std::unique_ptr<ProductBuildData> data)
+{
+    reset(data.release());
+    return *this;
+}
+
+ProductBuildData *ProductBuildDataPtr::get() const
+{
+    if (const int section = m_section) {
+        const std::shared_ptr<ProductBuildDataLoader> loader = m_loader.lock();
+        QBS_CHECK(loader);
+        loader->loadSection(section);
+        QBS_CHECK(m_section == 0);
+    }
+    return m_data.get();
+}
+
+void ProductBuildDataPtr::reset(ProductBuildData *data)
+{
+    get(); // Sections referring to the nodes of the old build data need it to be loaded.
+    setLoaded(std::unique_ptr<ProductBuildData>(data));
+}
+
+void ProductBuildDataPtr::swap(ProductBuildDataPtr &other)
+{
+    get();
+    other.get();
+    std::swap(m_data, other.m_data);
+}
+
+// The loader is not released here, as other threads might just be about to call into it.
+void ProductBuildDataPtr::setLoaded(std::unique_ptr<ProductBuildData> data)
+{
+    m_data = std::move(data);
+    m_summary.reset();
+    m_section = 0;
+}
+
+
+ProductBuildDataLoader::ProductBuildDataLoader() : m_pool(m_logger)
+{
+}
+
+ProductBuildDataLoader::~ProductBuildDataLoader() = default;
+
+static void addInStorageOrder(const ResolvedProductPtr &product,
+                              Set<const ResolvedProduct *> &seenProducts,
+                              std::vector<ResolvedProductPtr> &orderedProducts)
+{
+    if (!seenProducts.insert(product.get()).second)
+        return;
+    for (const ResolvedProductPtr &dependency : qAsConst(product->dependencies))
+        addInStorageOrder(dependency, seenProducts, orderedProducts);
+    orderedProducts.push_back(product);
+}
+
+static ProductBuildDataSummary createSummary(const ResolvedProduct *product)
+{
+    ProductBuildDataSummary summary;
+    const ProductBuildData * const buildData = product->buildData.get();
+    for (Artifact * const artifact : filterByType<Artifact>(buildData->allNodes())) {
+        if (artifact->artifactType != Artifact::Generated) {
+            summary.sourceFilePaths.push_back(artifact->filePath());
+            continue;
+        }
+        ArtifactSummary artifactSummary;
+        artifactSummary.filePath = artifact->filePath();
+        artifactSummary.fileTags = artifact->fileTags();
+        artifactSummary.properties = artifact->properties;
+        artifactSummary.isTargetArtifact = buildData->rootNodes().contains(artifact);
+        summary.generatedArtifacts.push_back(artifactSummary);
+    }
+    const AllRescuableArtifactData rad = buildData->rescuableArtifactData();
+    for (auto it = rad.cbegin(); it != rad.cend(); ++it) {
+        ArtifactSummary artifactSummary;
+        artifactSummary.filePath = it.key();
+        artifactSummary.fileTags = it.value().fileTags;
+        artifactSummary.properties = it.value().properties;
+        artifactSummary.isTargetArtifact = product->fileTags.intersects(it.value().fileTags);
+        summary.rescuedArtifacts.push_back(artifactSummary);
+    }
+    return summary;
+}
+
+// The product table goes into section 0, followed by one section per product with build data.
+void ProductBuildDataLoader::store(PersistentPool &pool,
+                                   const std::vector<ResolvedProductPtr> &allProducts)
+{
+    // Dependencies come first, as their nodes are the children of the dependents' nodes.
+    std::vector<ResolvedProductPtr> products;
+    Set<const ResolvedProduct *> seenProducts;
+    for (const ResolvedProductPtr &product : allProducts)
+        addInStorageOrder(product, seenProducts, products);
+
+    pool.store(int(products.size()));
+    int section = 0;
+    for (const ResolvedProductPtr &product : products) {
+        if (!product->buildData) {
+            pool.store(product, 0);
+            continue;
+        }
+        pool.store(product, ++section, createSummary(product.get()));
+    }
+
+    section = 0;
+    for (const ResolvedProductPtr &product : products) {
+        if (!product->buildData)
+            continue;
+        QBS_CHECK(pool.beginSection() == ++section);
+        pool.store(product->buildData.get());
+    }
+
+    // A node that got stored as part of another product's section is only complete
+    // once its own product has been loaded as well.
+    section = 0;
+    for (const ResolvedProductPtr &product : products) {
+        if (!product->buildData)
+            continue;
+        ++section;
+        for (BuildGraphNode * const node : qAsConst(product->buildData->allNodes())) {
+            const int nodeSection = pool.sectionOfStoredObject(node);
+            if (nodeSection != 0)
+                pool.addSectionCompanion(nodeSection, section);
+        }
+    }
+}
+
+void ProductBuildDataLoader::loadProducts(PersistentPool &pool)
+{
+    for (int i = pool.load<int>(); --i >= 0;) {
+        const auto product = pool.load<ResolvedProductPtr>();
+        const auto section = pool.load<int>();
+        if (!product || section < 0 || section >= pool.sectionCount())
+            throw ErrorInfo(Tr::tr("Build graph is corrupt: Invalid product table."));
+        if (section == 0)
+            continue;
+        product->buildData.m_section = section;
+        product->buildData.m_summary = std::make_unique<ProductBuildDataSummary>(
+                    pool.load<ProductBuildDataSummary>());
+    }
+}
+
+void ProductBuildDataLoader::attach(const std::shared_ptr<ProductBuildDataLoader> &loader,
+                                    const TopLevelProjectPtr &project)
+{
+    loader->m_projectBuildData = project->buildData.get();
+    loader->m_products.resize(loader->m_pool.sectionCount());
+    bool hasUnloadedProducts = false;
+    for (const ResolvedProductPtr &product : project->allProducts()) {
+        loader->m_productsByName.insert(std::make_pair(product->uniqueName(), product.get()));
+        ProductBuildDataPtr &buildData = product->buildData;
+        if (buildData.isLoaded())
+            continue;
+        buildData.m_loader = loader;
+        loader->m_products.at(buildData.m_section) = product;
+        hasUnloadedProducts = true;
+    }
+    if (hasUnloadedProducts)
+        project->buildData->m_productBuildDataLoader = loader;
+}
+
+void ProductBuildDataLoader::loadAll()
+{
+    std::lock_guard<std::recursive_mutex> lock(m_mutex);
+    for (int section = 1; section < int(m_products.size()); ++section)
+        loadSection(section);
+}
+
+// To be called before looking up a file in the build graph, which is incomplete
+// as long as there are products that have not been loaded.
+void ProductBuildDataLoader::loadProductsWithFile(const QString &dirPath, const QString &fileName)
+{
+    std::lock_guard<std::recursive_mutex> lock(m_mutex);
+    if (!m_hasFileIndex)
+        createFileIndex();
+    const auto it = m_sectionsByFile.find({fileName, dirPath});
+    if (it == m_sectionsByFile.end())
+        return;
+    const std::vector<int> sections = std::move(it->second);
+    m_sectionsByFile.erase(it);
+    for (const int section : sections)
+        loadSection(section);
+}
+
+// To be called before nodes of the product get removed. The sections that refer to these nodes
+// have to be loaded first, as the ids in there would otherwise resolve to dangling pointers,
+// and the nodes in there would be missing from the parents of the removed ones.
+void ProductBuildDataLoader::loadProductsReferencing(const ResolvedProduct *product)
+{
+    std::lock_guard<std::recursive_mutex> lock(m_mutex);
+    const auto it = std::find_if(m_products.cbegin(), m_products.cend(),
+                                 [product](const std::weak_ptr<ResolvedProduct> &p) {
+        return p.lock().get() == product;
+    });
+    if (it == m_products.cend())
+        return;
+    const int productSection = int(it - m_products.cbegin());
+
+    // The nodes of the product are stored in its own section, and maybe in the sections
+    // that have it as a companion.
+    std::vector<int> nodeSections{productSection};
+    for (int section = 1; section < int(m_products.size()); ++section) {
+        if (contains(m_pool.sectionCompanions(section), productSection))
+            nodeSections.push_back(section);
+    }
+    for (int section = 1; section < int(m_products.size()); ++section) {
+        const std::vector<int> &references = m_pool.sectionReferences(section);
+        if (Internal::any_of(nodeSections, [&references](int nodeSection) {
+                             return contains(references, nodeSection); })) {
+            loadSection(section);
+        }
+    }
+}
+
+void ProductBuildDataLoader::loadSection(int section)
+{
+    std::lock_guard<std::recursive_mutex> lock(m_mutex);
+    const ResolvedProductPtr product = m_products.at(section).lock();
+    if (!product || product->buildData.isLoaded())
+        return;
+    for (const int reference : m_pool.sectionReferences(section))
+        loadSection(reference);
+    if (product->buildData.isLoaded())
+        return; // As a companion of one of the referenced sections.
+
+    qCDebug(lcBuildGraph) << "loading build data of product" << product->uniqueName();
+    m_pool.loadSection(section);
+    std::unique_ptr<ProductBuildData> buildData(m_pool.load<ProductBuildData *>());
+    if (!buildData)
+        throw ErrorInfo(Tr::tr("Build graph is corrupt: Invalid section %1.").arg(section));
+    product->buildData.setLoaded(std::move(buildData));
+    for (BuildGraphNode * const node : qAsConst(product->buildData->allNodes())) {
+        node->product = product;
+        for (BuildGraphNode * const child : qAsConst(node->children))
+            child->parents.insert(node);
+        if (node->type() == BuildGraphNode::ArtifactNodeType)
+            m_projectBuildData->insertLoadedArtifact(static_cast<Artifact *>(node));
+    }
+    m_projectBuildData->loadPendingChanges(product.get(), m_productsByName);
+
+    for (const int companion : m_pool.sectionCompanions(section))
+        loadSection(companion);
+    for (const ResolvedProductPtr &dependency : qAsConst(product->dependencies))
+        dependency->buildData.get();
+}
+
+void ProductBuildDataLoader::createFileIndex()
+{
+    m_hasFileIndex = true;
+    for (int section = 1; section < int(m_products.size()); ++section) {
+        const ResolvedProductPtr product = m_products.at(section).lock();
+        if (!product || product->buildData.isLoaded())
+            continue;
+        const auto addFile = [this, section](const QString &filePath) {
+            QString dirPath;
+            QString fileName;
+            FileInfo::splitIntoDirectoryAndFileName(filePath, &dirPath, &fileName);
+            m_sectionsByFile[{fileName, dirPath}].push_back(section);
+        };
+        const ProductBuildDataSummary * const summary = product->buildData.summary();
+        for (const QString &filePath : summary->sourceFilePaths)
+            addFile(filePath);
+        for (const ArtifactSummary &artifact : summary->generatedArtifacts)
+            addFile(artifact.filePath);
+    }
+}
+
+} // namespace Internal
+} // namespace qbs
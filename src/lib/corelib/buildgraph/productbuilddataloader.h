@@ -0,0 +1,169 @@
+/****************************************************************************
+**
+** Copyright (C) 2022 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of Qbs.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-2.0.html and
+** https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#ifndef QBS_PRODUCTBUILDDATALOADER_H
+#define QBS_PRODUCTBUILDDATALOADER_H
+
+#include "forward_decls.h"
+
+#include <language/filetags.h>
+#include <language/forward_decls.h>
+#include <logging/logger.h>
+#include <tools/persistence.h>
+#include <tools/qbs_export.h>
+#include <tools/qttools.h>
+
+#include <QtCore/qstring.h>
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+namespace qbs {
+namespace Internal {
+
+class ProductBuildDataLoader;
+
+// What the API needs to know about the build data of a product that has not been loaded.
+class ArtifactSummary
+{
+public:
+    template<PersistentPool::OpType opType> void completeSerializationOp(PersistentPool &pool)
+    {
+        pool.serializationOp<opType>(filePath, fileTags, properties, isTargetArtifact);
+    }
+
+    QString filePath;
+    FileTags fileTags;
+    PropertyMapPtr properties;
+    bool isTargetArtifact = false;
+};
+
+class ProductBuildDataSummary
+{
+public:
+    template<PersistentPool::OpType opType> void completeSerializationOp(PersistentPool &pool)
+    {
+        pool.serializationOp<opType>(generatedArtifacts, rescuedArtifacts, sourceFilePaths);
+    }
+
+    std::vector<ArtifactSummary> generatedArtifacts;
+    std::vector<ArtifactSummary> rescuedArtifacts; // See ProductBuildData::rescuableArtifactData()
+    std::vector<QString> sourceFilePaths;
+};
+
+// Holds the build data of a product. Build data restored from disk is loaded from its
+// section of the build graph file on first access.
+class QBS_AUTOTEST_EXPORT ProductBuildDataPtr
+{
+public:
+    ProductBuildDataPtr();
+    ~ProductBuildDataPtr();
+
+    ProductBuildDataPtr &operator=(std::unique_ptr<ProductBuildData> data);
+
+    ProductBuildData *get() const;
+    ProductBuildData *operator->() const { return get(); }
+    explicit operator bool() const { return m_data || m_section != 0; }
+    void reset(ProductBuildData *data = nullptr);
+    void swap(ProductBuildDataPtr &other);
+
+    bool isLoaded() const { return m_section == 0; }
+
+    // Only available while the build data has not been loaded.
+    const ProductBuildDataSummary *summary() const { return m_summary.get(); }
+
+private:
+    void setLoaded(std::unique_ptr<ProductBuildData> data);
+
+    std::unique_ptr<ProductBuildData> m_data;
+    std::weak_ptr<ProductBuildDataLoader> m_loader;
+    std::unique_ptr<ProductBuildDataSummary> m_summary;
+    std::atomic_int m_section{0}; // Set to 0 only after the other members have been set up.
+
+    friend class ProductBuildDataLoader;
+};
+
+// The build data of each product is stored in its own section of the build graph file,
+// so that building a subset of the products does not require deserializing the build data
+// of all the others. Loading a product's build data also loads the one of its dependencies.
+// Loading can get triggered by look-ups from several threads, so it is serialized.
+class ProductBuildDataLoader
+{
+public:
+    ProductBuildDataLoader();
+    ~ProductBuildDataLoader();
+
+    PersistentPool &pool() { return m_pool; }
+
+    // For callers that need a look-up of the artifacts to be atomic with the loading.
+    std::recursive_mutex &mutex() { return m_mutex; }
+
+    static void store(PersistentPool &pool, const std::vector<ResolvedProductPtr> &allProducts);
+    static void loadProducts(PersistentPool &pool);
+    static void attach(const std::shared_ptr<ProductBuildDataLoader> &loader,
+                       const TopLevelProjectPtr &project);
+
+    void loadAll();
+    void loadProductsWithFile(const QString &dirPath, const QString &fileName);
+    void loadProductsReferencing(const ResolvedProduct *product);
+
+private:
+    void loadSection(int section);
+    void createFileIndex();
+
+    Logger m_logger;
+    PersistentPool m_pool;
+    ProjectBuildData *m_projectBuildData = nullptr;
+    std::vector<std::weak_ptr<ResolvedProduct>> m_products; // Indexed by section.
+    std::unordered_map<QString, const ResolvedProduct *> m_productsByName;
+    std::unordered_map<std::pair<QString /*fileName*/, QString /*dirPath*/>, std::vector<int>>
+            m_sectionsByFile; // Of the products not loaded yet, see loadProductsWithFile().
+    bool m_hasFileIndex = false;
+    std::recursive_mutex m_mutex;
+
+    friend class ProductBuildDataPtr;
+};
+
+} // namespace Internal
+} // namespace qbs
+
+#endif // QBS_PRODUCTBUILDDATALOADER_H
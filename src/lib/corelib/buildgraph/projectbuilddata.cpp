@@ -42,6 +42,7 @@
 #include "buildgraph.h"
 #include "buildgraphvisitor.h"
 #include "productbuilddata.h"
+#include "productbuilddataloader.h"
 #include "rulecommands.h"
 #include "rulegraph.h"
 #include "rulenode.h"
@@ -60,6 +61,7 @@
 #include <tools/qttools.h>
 #include <tools/stlutils.h>
 
+#include <algorithm>
 #include <memory>
 
 namespace qbs {
@@ -98,9 +100,11 @@ QString ProjectBuildData::deriveBuildGraphFilePath(const QString &buildDir, cons
 
 void ProjectBuildData::insertIntoLookupTable(FileResourceBase *fileres)
 {
-    auto &lst = m_artifactLookupTable[{fileres->fileName(), fileres->dirPath()}];
     const auto * const artifact = fileres->fileType() == FileResourceBase::FileTypeArtifact
             ? static_cast<Artifact *>(fileres) : nullptr;
+    if (artifact && artifact->artifactType == Artifact::Generated && m_productBuildDataLoader)
+        m_productBuildDataLoader->loadProductsWithFile(fileres->dirPath(), fileres->fileName());
+    auto &lst = m_artifactLookupTable[{fileres->fileName(), fileres->dirPath()}];
     if (artifact && artifact->artifactType == Artifact::Generated) {
         for (const auto *file : lst) {
             if (file->fileType() != FileResourceBase::FileTypeArtifact)
@@ -123,6 +127,15 @@ void ProjectBuildData::insertIntoLookupTable(FileResourceBase *fileres)
     m_isDirty = true;
 }
 
+// For the artifacts of a product whose build data has just been loaded. These are known
+// not to conflict with other artifacts, and the build graph does not change by them.
+void ProjectBuildData::insertLoadedArtifact(Artifact *artifact)
+{
+    auto &lst = m_artifactLookupTable[{artifact->fileName(), artifact->dirPath()}];
+    QBS_CHECK(!contains(lst, artifact));
+    lst.push_back(artifact);
+}
+
 void ProjectBuildData::removeFromLookupTable(FileResourceBase *fileres)
 {
     removeOne(m_artifactLookupTable[{fileres->fileName(), fileres->dirPath()}], fileres);
@@ -138,9 +151,13 @@ const std::vector<FileResourceBase *> &ProjectBuildData::lookupFiles(const QStri
 const std::vector<FileResourceBase *> &ProjectBuildData::lookupFiles(const QString &dirPath,
         const QString &fileName) const
 {
-    static const std::vector<FileResourceBase *> emptyResult;
-    const auto it = m_artifactLookupTable.find({fileName, dirPath});
-    return it != m_artifactLookupTable.end() ? it->second : emptyResult;
+    if (!m_productBuildDataLoader)
+        return lookupLoadedFiles(dirPath, fileName);
+
+    // Loading inserts into the lookup table, so the look-up must not overlap with it.
+    std::lock_guard<std::recursive_mutex> lock(m_productBuildDataLoader->mutex());
+    m_productBuildDataLoader->loadProductsWithFile(dirPath, fileName);
+    return lookupLoadedFiles(dirPath, fileName);
 }
 
 const std::vector<FileResourceBase *> &ProjectBuildData::lookupFiles(const Artifact *artifact) const
@@ -148,6 +165,22 @@ const std::vector<FileResourceBase *> &ProjectBuildData::lookupFiles(const Artif
     return lookupFiles(artifact->dirPath(), artifact->fileName());
 }
 
+const std::vector<FileResourceBase *> &ProjectBuildData::lookupLoadedFiles(
+        const QString &filePath) const
+{
+    QString dirPath, fileName;
+    FileInfo::splitIntoDirectoryAndFileName(filePath, &dirPath, &fileName);
+    return lookupLoadedFiles(dirPath, fileName);
+}
+
+const std::vector<FileResourceBase *> &ProjectBuildData::lookupLoadedFiles(
+        const QString &dirPath, const QString &fileName) const
+{
+    static const std::vector<FileResourceBase *> emptyResult;
+    const auto it = m_artifactLookupTable.find({fileName, dirPath});
+    return it != m_artifactLookupTable.end() ? it->second : emptyResult;
+}
+
 void ProjectBuildData::insertFileDependency(FileDependency *dependency)
 {
     fileDependencies += dependency;
@@ -195,6 +228,8 @@ void ProjectBuildData::removeArtifactAndExclusiveDependents(Artifact *artifact,
         const Logger &logger, bool removeFromProduct,
         ArtifactSet *removedArtifacts)
 {
+    if (m_productBuildDataLoader)
+        m_productBuildDataLoader->loadProductsReferencing(artifact->product.get());
     if (removedArtifacts)
         removedArtifacts->insert(artifact);
 
@@ -231,6 +266,8 @@ void ProjectBuildData::removeArtifact(Artifact *artifact,
         const Logger &logger, bool removeFromDisk, bool removeFromProduct)
 {
     qCDebug(lcBuildGraph) << "remove artifact" << relativeArtifactFileName(artifact);
+    if (m_productBuildDataLoader)
+        m_productBuildDataLoader->loadProductsReferencing(artifact->product.get());
     if (removeFromDisk)
         removeGeneratedArtifactFromDisk(artifact, logger);
     removeFromLookupTable(artifact);
@@ -240,7 +277,7 @@ void ProjectBuildData::removeArtifact(Artifact *artifact,
         artifact->transformer->outputs.remove(artifact);
     if (removeFromProduct)
         artifact->product->buildData->removeArtifact(artifact);
-    m_isDirty = false;
+    m_isDirty = true;
 }
 
 void ProjectBuildData::setDirty()
@@ -255,6 +292,184 @@ void ProjectBuildData::setClean()
     m_isDirty = false;
 }
 
+void ProjectBuildData::recordChangedFile(const FileResourceBase *file)
+{
+    m_changedFiles.insert(file->filePath());
+}
+
+void ProjectBuildData::recordChangedTransformer(const Transformer *transformer)
+{
+    QBS_CHECK(!transformer->outputs.empty());
+    m_changedTransformers.insert((*transformer->outputs.cbegin())->filePath());
+}
+
+bool ProjectBuildData::hasChanges() const
+{
+    return !m_changedFiles.empty() || !m_changedTransformers.empty()
+            || rawScanResults.hasChanges() || fileExistenceCache.hasChanges();
+}
+
+void ProjectBuildData::clearChanges()
+{
+    m_changedFiles.clear();
+    m_changedTransformers.clear();
+    rawScanResults.clearChanges();
+    fileExistenceCache.clearChanges();
+}
+
+static Artifact *generatedArtifact(const std::vector<FileResourceBase *> &files)
+{
+    for (FileResourceBase * const file : files) {
+        if (file->fileType() != FileResourceBase::FileTypeArtifact)
+            continue;
+        const auto artifact = static_cast<Artifact *>(file);
+        if (artifact->artifactType == Artifact::Generated)
+            return artifact;
+    }
+    return nullptr;
+}
+
+static QString productName(const FileResourceBase *file)
+{
+    return file->fileType() == FileResourceBase::FileTypeArtifact
+            ? static_cast<const Artifact *>(file)->product->uniqueName() : QString();
+}
+
+// Returns false if the changes cannot be mapped onto the build graph anymore, in which case
+// the caller has to store the complete build graph.
+// The changes are grouped by product, so that the ones for products that have not been loaded
+// can be put aside when loading them, see loadChanges().
+bool ProjectBuildData::storeChanges(PersistentPool &pool)
+{
+    class ProductChanges
+    {
+    public:
+        std::vector<const FileResourceBase *> files;
+        std::vector<const Artifact *> outputs; // Of the changed transformers.
+    };
+    std::unordered_map<QString, ProductChanges> changesByProduct;
+    for (const QString &filePath : qAsConst(m_changedFiles)) {
+        for (const FileResourceBase * const file : lookupLoadedFiles(filePath))
+            changesByProduct[productName(file)].files.push_back(file);
+    }
+    for (const QString &filePath : qAsConst(m_changedTransformers)) {
+        const Artifact * const output = generatedArtifact(lookupLoadedFiles(filePath));
+        if (!output)
+            return false;
+        changesByProduct[productName(output)].outputs.push_back(output);
+    }
+
+    Logger logger;
+    pool.store(int(changesByProduct.size()));
+    for (const auto &productChanges : changesByProduct) {
+        PersistentPool productPool(logger);
+        productPool.setupRecordWriteStream();
+        productPool.store(int(productChanges.second.files.size()));
+        for (const FileResourceBase * const file : productChanges.second.files) {
+            productPool.store(file->filePath(), static_cast<quint8>(file->fileType()),
+                              file->timestamp());
+            if (file->fileType() == FileResourceBase::FileTypeArtifact) {
+                const auto artifact = static_cast<const Artifact *>(file);
+                productPool.store(artifact->contentHash, artifact->contentChangeTime,
+                                  bool(artifact->oldDataPossiblyPresent));
+            }
+        }
+        productPool.store(int(productChanges.second.outputs.size()));
+        for (const Artifact * const output : productChanges.second.outputs) {
+            productPool.store(output->filePath());
+            output->transformer->storeExecutionState(productPool);
+        }
+        pool.store(productChanges.first, productPool.takeRecord());
+    }
+
+    rawScanResults.storeChanges(pool);
+    fileExistenceCache.storeChanges(pool);
+    return true;
+}
+
+void ProjectBuildData::loadChanges(PersistentPool &pool,
+        const std::unordered_map<QString, const ResolvedProduct *> &productsByName)
+{
+    for (int i = pool.load<int>(); --i >= 0;) {
+        const auto productName = pool.load<QString>();
+        const auto changes = pool.load<QByteArray>();
+        if (!productName.isEmpty()) {
+            const auto it = productsByName.find(productName);
+            if (it == productsByName.cend()) {
+                throw ErrorInfo(Tr::tr("Build graph is corrupt: Unknown product '%1'.")
+                                .arg(productName));
+            }
+            if (!it->second->buildData.isLoaded()) {
+                m_pendingChanges[productName].push_back(changes);
+                continue;
+            }
+        }
+        loadProductChanges(productName, changes, productsByName);
+    }
+
+    rawScanResults.loadChanges(pool);
+    fileExistenceCache.loadChanges(pool);
+}
+
+void ProjectBuildData::loadPendingChanges(const ResolvedProduct *product,
+        const std::unordered_map<QString, const ResolvedProduct *> &productsByName)
+{
+    const auto it = m_pendingChanges.find(product->uniqueName());
+    if (it == m_pendingChanges.end())
+        return;
+    const std::vector<QByteArray> pendingChanges = std::move(it->second);
+    m_pendingChanges.erase(it);
+    for (const QByteArray &changes : pendingChanges)
+        loadProductChanges(product->uniqueName(), changes, productsByName);
+}
+
+void ProjectBuildData::loadProductChanges(const QString &productName, const QByteArray &changes,
+        const std::unordered_map<QString, const ResolvedProduct *> &productsByName)
+{
+    const auto unknownFileError = [](const QString &filePath) {
+        return ErrorInfo(Tr::tr("Build graph is corrupt: Unknown file '%1'.").arg(filePath));
+    };
+
+    Logger logger;
+    PersistentPool pool(logger);
+    pool.setupRecordReadStream(changes);
+    for (int i = pool.load<int>(); --i >= 0;) {
+        const auto filePath = pool.load<QString>();
+        const auto fileType = static_cast<FileResourceBase::FileType>(pool.load<quint8>());
+        const auto &files = lookupLoadedFiles(filePath);
+        const auto it = std::find_if(files.cbegin(), files.cend(),
+                                     [fileType, &productName](const FileResourceBase *file) {
+            return file->fileType() == fileType && Internal::productName(file) == productName;
+        });
+        if (it == files.cend())
+            throw unknownFileError(filePath);
+        (*it)->setTimestamp(pool.load<FileTime>());
+        if (fileType == FileResourceBase::FileTypeArtifact) {
+            const auto artifact = static_cast<Artifact *>(*it);
+            pool.load(artifact->contentHash, artifact->contentChangeTime);
+            artifact->oldDataPossiblyPresent = pool.load<bool>();
+        }
+    }
+
+    for (int i = pool.load<int>(); --i >= 0;) {
+        const auto filePath = pool.load<QString>();
+        Artifact * const output = generatedArtifact(lookupLoadedFiles(filePath));
+        if (!output)
+            throw unknownFileError(filePath);
+        output->transformer->loadExecutionState(pool, productsByName);
+    }
+}
+
+void ProjectBuildData::loadAllProductBuildData()
+{
+    if (!m_productBuildDataLoader)
+        return;
+
+    // Releases the build graph file once everything is loaded.
+    const std::shared_ptr<ProductBuildDataLoader> loader = std::move(m_productBuildDataLoader);
+    loader->loadAll();
+}
+
 void ProjectBuildData::load(PersistentPool &pool)
 {
     serializationOp<PersistentPool::Load>(pool);
@@ -40,6 +40,7 @@
 #define QBS_PROJECTBUILDDATA_H
 
 #include "forward_decls.h"
+#include "fileexistencecache.h"
 #include "rawscanresults.h"
 #include <language/forward_decls.h>
 #include <logging/logger.h>
@@ -48,10 +49,12 @@
 #include <tools/qttools.h>
 
 #include <QtCore/qlist.h>
+#include <QtCore/qset.h>
 #include <QtCore/qstring.h>
 
 #include <QtScript/qscriptvalue.h>
 
+#include <memory>
 #include <unordered_map>
 
 namespace qbs {
@@ -59,6 +62,7 @@ namespace Internal {
 class BuildGraphNode;
 class FileDependency;
 class FileResourceBase;
+class ProductBuildDataLoader;
 class ScriptEngine;
 
 class QBS_AUTOTEST_EXPORT ProjectBuildData
@@ -81,16 +85,35 @@ public:
     void removeArtifact(Artifact *artifact, const Logger &logger, bool removeFromDisk = true,
                         bool removeFromProduct = true);
 
+    // The build graph is dirty if its structure has changed, i.e. if it has to be
+    // stored completely.
     void setDirty();
     void setClean();
     bool isDirty() const { return m_isDirty; }
 
+    // Changes to the state of files and transformers, as they happen when building.
+    // If the build graph is not dirty, only these get stored, see TopLevelProject::store().
+    // Not thread-safe.
+    void recordChangedFile(const FileResourceBase *file);
+    void recordChangedTransformer(const Transformer *transformer);
+    bool hasChanges() const;
+    void clearChanges();
+    bool storeChanges(PersistentPool &pool);
+    void loadChanges(PersistentPool &pool,
+                     const std::unordered_map<QString, const ResolvedProduct *> &productsByName);
+
+    // The build data of products restored from disk is loaded on demand,
+    // see ProductBuildDataLoader.
+    void loadAllProductBuildData();
 
     Set<FileDependency *> fileDependencies;
     RawScanResults rawScanResults;
+    FileExistenceCache fileExistenceCache;
 
     // do not serialize:
     RulesEvaluationContextPtr evaluationContext;
+    qint64 storedDataSize = 0; // Of the complete build graph in the build graph file.
+    qint64 storedChangesSize = 0; // Of the changes appended to it.
 
     void load(PersistentPool &pool);
     void store(PersistentPool &pool);
@@ -98,15 +121,33 @@ public:
 private:
     template<PersistentPool::OpType opType> void serializationOp(PersistentPool &pool)
     {
-        pool.serializationOp<opType>(fileDependencies, rawScanResults);
+        pool.serializationOp<opType>(fileDependencies, rawScanResults, fileExistenceCache);
     }
 
+    const std::vector<FileResourceBase *> &lookupLoadedFiles(const QString &filePath) const;
+    const std::vector<FileResourceBase *> &lookupLoadedFiles(const QString &dirPath,
+                                                             const QString &fileName) const;
+    void insertLoadedArtifact(Artifact *artifact);
+    void loadPendingChanges(const ResolvedProduct *product,
+            const std::unordered_map<QString, const ResolvedProduct *> &productsByName);
+    void loadProductChanges(const QString &productName, const QByteArray &changes,
+            const std::unordered_map<QString, const ResolvedProduct *> &productsByName);
+
     using ArtifactKey = std::pair<QString /*fileName*/, QString /*dirName*/>;
     using ArtifactLookupTable = std::unordered_map<ArtifactKey, std::vector<FileResourceBase *>>;
     ArtifactLookupTable m_artifactLookupTable;
 
+    QSet<QString> m_changedFiles;
+    QSet<QString> m_changedTransformers; // Identified by the file path of an output.
+
+    // The recorded changes for products that have not been loaded yet, keyed by product name.
+    std::unordered_map<QString, std::vector<QByteArray>> m_pendingChanges;
+
+    std::shared_ptr<ProductBuildDataLoader> m_productBuildDataLoader;
     bool m_doCleanupInDestructor = true;
     bool m_isDirty = true;
+
+    friend class ProductBuildDataLoader;
 };
 
 
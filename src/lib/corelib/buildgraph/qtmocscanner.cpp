@@ -172,6 +172,7 @@ static RawScanResult runScanner(ScannerPlugin *scanner, const Artifact *artifact
 
         scanner->close(opaq);
         scanData.lastScanTime = FileTime::currentTime();
+        rawScanResults.recordChange(filepath);
     }
     return scanData.rawScanResult;
 }
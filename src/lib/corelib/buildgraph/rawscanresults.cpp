@@ -47,6 +47,16 @@
 namespace qbs {
 namespace Internal {
 
+RawScanResults::RawScanResults(const RawScanResults &other) : m_rawScanData(other.m_rawScanData)
+{
+}
+
+RawScanResults &RawScanResults::operator=(const RawScanResults &other)
+{
+    m_rawScanData = other.m_rawScanData;
+    return *this;
+}
+
 RawScanResults::ScanData &RawScanResults::findScanData(
         const FileResourceBase *file,
         const DependencyScanner *scanner,
@@ -68,5 +78,63 @@ RawScanResults::ScanData &RawScanResults::findScanData(
     return scanDataForFile.back();
 }
 
+bool RawScanResults::findUpToDateScanResult(
+        const FileResourceBase *file,
+        const DependencyScanner *scanner,
+        const PropertyMapConstPtr &moduleProperties,
+        RawScanResult *result)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    const ScanData &scanData = findScanData(file, scanner, moduleProperties);
+    if (scanData.lastScanTime < file->timestamp())
+        return false;
+    *result = scanData.rawScanResult;
+    return true;
+}
+
+void RawScanResults::storeScanResult(
+        const FileResourceBase *file,
+        const DependencyScanner *scanner,
+        const PropertyMapConstPtr &moduleProperties,
+        const RawScanResult &result)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    ScanData &scanData = findScanData(file, scanner, moduleProperties);
+    scanData.rawScanResult = result;
+    scanData.lastScanTime = FileTime::currentTime();
+    m_changedFilePaths.insert(file->filePath());
+}
+
+void RawScanResults::storeChanges(PersistentPool &pool)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    pool.store(int(m_changedFilePaths.size()));
+    for (const QString &filePath : qAsConst(m_changedFilePaths))
+        pool.store(filePath, m_rawScanData.value(filePath));
+}
+
+void RawScanResults::loadChanges(PersistentPool &pool)
+{
+    for (int i = pool.load<int>(); --i >= 0;) {
+        const auto filePath = pool.load<QString>();
+        std::vector<ScanData> &scanDataForFile = m_rawScanData[filePath];
+        auto newScanDataForFile = pool.load<std::vector<ScanData>>();
+
+        // Share the module properties with the existing entries where possible, as the record
+        // has its own copies of them.
+        for (ScanData &newScanData : newScanDataForFile) {
+            for (const ScanData &scanData : scanDataForFile) {
+                if (scanData.scannerId == newScanData.scannerId && scanData.moduleProperties
+                        && newScanData.moduleProperties
+                        && *scanData.moduleProperties == *newScanData.moduleProperties) {
+                    newScanData.moduleProperties = scanData.moduleProperties;
+                    break;
+                }
+            }
+        }
+        scanDataForFile = std::move(newScanDataForFile);
+    }
+}
+
 } // namespace Internal
 } // namespace qbs
@@ -49,8 +49,10 @@
 #include <tools/persistence.h>
 
 #include <QtCore/qhash.h>
+#include <QtCore/qset.h>
 #include <QtCore/qstring.h>
 
+#include <mutex>
 #include <vector>
 
 namespace qbs {
@@ -73,6 +75,10 @@ public:
 class RawScanResults
 {
 public:
+    RawScanResults() = default;
+    RawScanResults(const RawScanResults &other);
+    RawScanResults &operator=(const RawScanResults &other);
+
     struct ScanData
     {
         QString scannerId;
@@ -86,11 +92,35 @@ public:
         }
     };
 
+    // Not thread-safe. Must not be called while files are being scanned concurrently.
     ScanData &findScanData(
             const FileResourceBase *file,
             const DependencyScanner *scanner,
             const PropertyMapConstPtr &moduleProperties);
 
+    // Thread-safe.
+    bool findUpToDateScanResult(
+            const FileResourceBase *file,
+            const DependencyScanner *scanner,
+            const PropertyMapConstPtr &moduleProperties,
+            RawScanResult *result);
+    void storeScanResult(
+            const FileResourceBase *file,
+            const DependencyScanner *scanner,
+            const PropertyMapConstPtr &moduleProperties,
+            const RawScanResult &result);
+
+    // For incremental storage of the build graph, see ProjectBuildData::storeChanges().
+    bool hasChanges() const { return !m_changedFilePaths.empty(); }
+    void clearChanges() { m_changedFilePaths.clear(); }
+    void recordChange(const QString &filePath)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_changedFilePaths.insert(filePath);
+    }
+    void storeChanges(PersistentPool &pool);
+    void loadChanges(PersistentPool &pool);
+
     template<PersistentPool::OpType opType> void completeSerializationOp(PersistentPool &pool)
     {
         pool.serializationOp<opType>(m_rawScanData);
@@ -98,6 +128,8 @@ public:
 
 private:
     QHash<QString, std::vector<ScanData>> m_rawScanData;
+    QSet<QString> m_changedFilePaths;
+    std::mutex m_mutex;
 };
 
 } // namespace Internal
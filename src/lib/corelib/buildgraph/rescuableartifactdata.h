@@ -65,7 +65,8 @@ class QBS_AUTOTEST_EXPORT RescuableArtifactData
 public:
     template<PersistentPool::OpType opType> void completeSerializationOp(PersistentPool &pool)
     {
-        pool.serializationOp<opType>(timeStamp, children, fileDependencies, knownOutOfDate,
+        pool.serializationOp<opType>(timeStamp, contentHash, contentChangeTime, children,
+                                     fileDependencies, knownOutOfDate,
                                      propertiesRequestedInPrepareScript,
                                      propertiesRequestedInCommands,
                                      propertiesRequestedFromArtifactInPrepareScript,
@@ -77,7 +78,8 @@ public:
                                      exportedModulesAccessedInPrepareScript,
                                      exportedModulesAccessedInCommands,
                                      lastPrepareScriptExecutionTime,
-                                     lastCommandExecutionTime, fileTags, properties);
+                                     lastCommandExecutionTime, lastCommandExecutionDuration,
+                                     peakMemoryUsage, fileTags, properties);
     }
 
     bool isValid() const { return !!properties; }
@@ -105,6 +107,8 @@ public:
     };
 
     FileTime timeStamp;
+    QByteArray contentHash;
+    FileTime contentChangeTime;
     std::vector<ChildData> children;
     std::vector<QString> fileDependencies;
 
@@ -122,6 +126,8 @@ public:
     RequestedArtifacts artifactsMapRequestedInCommands;
     FileTime lastPrepareScriptExecutionTime;
     FileTime lastCommandExecutionTime;
+    qint64 lastCommandExecutionDuration = -1;
+    qint64 peakMemoryUsage = -1;
     std::unordered_map<QString, ExportedModule> exportedModulesAccessedInPrepareScript;
     std::unordered_map<QString, ExportedModule> exportedModulesAccessedInCommands;
     bool knownOutOfDate = false;
@@ -55,11 +55,21 @@ namespace qbs {
 namespace Internal {
 
 static QString argumentsProperty() { return QStringLiteral("arguments"); }
+static QString dependencyFilePathProperty() { return QStringLiteral("dependencyFilePath"); }
+static QString dependencyOutputPrefixProperty()
+{
+    return QStringLiteral("dependencyOutputPrefix");
+}
 static QString environmentProperty() { return QStringLiteral("environment"); }
 static QString extendedDescriptionProperty() { return QStringLiteral("extendedDescription"); }
 static QString highlightProperty() { return QStringLiteral("highlight"); }
 static QString ignoreDryRunProperty() { return QStringLiteral("ignoreDryRun"); }
 static QString maxExitCodeProperty() { return QStringLiteral("maxExitCode"); }
+static QString persistentWorkerProperty() { return QStringLiteral("persistentWorker"); }
+static QString persistentWorkerArgumentsProperty()
+{
+    return QStringLiteral("persistentWorkerArguments");
+}
 static QString programProperty() { return QStringLiteral("program"); }
 static QString responseFileArgumentIndexProperty()
 {
@@ -223,6 +233,14 @@ static QScriptValue js_Command(QScriptContext *context, QScriptEngine *engine)
                     engine->toScriptValue(commandPrototype->stdoutFilePath()));
     cmd.setProperty(stderrFilePathProperty(),
                     engine->toScriptValue(commandPrototype->stderrFilePath()));
+    cmd.setProperty(dependencyFilePathProperty(),
+                    engine->toScriptValue(commandPrototype->dependencyFilePath()));
+    cmd.setProperty(dependencyOutputPrefixProperty(),
+                    engine->toScriptValue(commandPrototype->dependencyOutputPrefix()));
+    cmd.setProperty(persistentWorkerProperty(),
+                    engine->toScriptValue(commandPrototype->persistentWorker()));
+    cmd.setProperty(persistentWorkerArgumentsProperty(),
+                    engine->toScriptValue(commandPrototype->persistentWorkerArguments()));
     cmd.setProperty(environmentProperty(),
                     engine->toScriptValue(commandPrototype->environment().toStringList()));
     cmd.setProperty(ignoreDryRunProperty(),
@@ -243,6 +261,7 @@ ProcessCommand::ProcessCommand()
     , m_responseFileThreshold(defaultResponseFileThreshold())
     , m_responseFileArgumentIndex(0)
     , m_responseFileSeparator(QStringLiteral("\n"))
+    , m_persistentWorker(false)
 {
 }
 
@@ -284,6 +303,10 @@ bool ProcessCommand::equals(const AbstractCommand *otherAbstractCommand) const
             && m_responseFileSeparator == other->m_responseFileSeparator
             && m_stdoutFilePath == other->m_stdoutFilePath
             && m_stderrFilePath == other->m_stderrFilePath
+            && m_dependencyFilePath == other->m_dependencyFilePath
+            && m_dependencyOutputPrefix == other->m_dependencyOutputPrefix
+            && m_persistentWorker == other->m_persistentWorker
+            && m_persistentWorkerArguments == other->m_persistentWorkerArguments
             && m_relevantEnvVars == other->m_relevantEnvVars
             && m_relevantEnvValues == other->m_relevantEnvValues
             && m_environment == other->m_environment;
@@ -323,6 +346,11 @@ void ProcessCommand::fillFromScriptValue(const QScriptValue *scriptValue, const
     getEnvironmentFromList(envList);
     m_stdoutFilePath = scriptValue->property(stdoutFilePathProperty()).toString();
     m_stderrFilePath = scriptValue->property(stderrFilePathProperty()).toString();
+    m_dependencyFilePath = scriptValue->property(dependencyFilePathProperty()).toString();
+    m_dependencyOutputPrefix = scriptValue->property(dependencyOutputPrefixProperty()).toString();
+    m_persistentWorker = scriptValue->property(persistentWorkerProperty()).toBool();
+    m_persistentWorkerArguments = scriptValue->property(persistentWorkerArgumentsProperty())
+            .toVariant().toStringList();
 
     m_predefinedProperties
             << programProperty()
@@ -336,10 +364,19 @@ void ProcessCommand::fillFromScriptValue(const QScriptValue *scriptValue, const
             << responseFileUsagePrefixProperty()
             << environmentProperty()
             << stdoutFilePathProperty()
-            << stderrFilePathProperty();
+            << stderrFilePathProperty()
+            << dependencyFilePathProperty()
+            << dependencyOutputPrefixProperty()
+            << persistentWorkerProperty()
+            << persistentWorkerArgumentsProperty();
     applyCommandProperties(scriptValue);
 }
 
+bool ProcessCommand::reportsDependencies() const
+{
+    return !m_dependencyFilePath.isEmpty() || !m_dependencyOutputPrefix.isEmpty();
+}
+
 QStringList ProcessCommand::relevantEnvVars() const
 {
     QStringList vars = m_relevantEnvVars;
@@ -142,8 +142,15 @@ public:
     void clearRelevantEnvValues() { m_relevantEnvValues.clear(); }
     void addRelevantEnvValue(const QString &key, const QString &value);
     QString relevantEnvValue(const QString &key) const { return m_relevantEnvValues.value(key); }
+    const QProcessEnvironment &relevantEnvValues() const { return m_relevantEnvValues; }
+    void setRelevantEnvValues(const QProcessEnvironment &env) { m_relevantEnvValues = env; }
     QString stdoutFilePath() const { return m_stdoutFilePath; }
     QString stderrFilePath() const { return m_stderrFilePath; }
+    QString dependencyFilePath() const { return m_dependencyFilePath; }
+    QString dependencyOutputPrefix() const { return m_dependencyOutputPrefix; }
+    bool reportsDependencies() const;
+    bool persistentWorker() const { return m_persistentWorker; }
+    QStringList persistentWorkerArguments() const { return m_persistentWorkerArguments; }
 
     void load(PersistentPool &pool) override;
     void store(PersistentPool &pool) override;
@@ -162,7 +169,9 @@ private:
                                      m_responseFileUsagePrefix, m_responseFileSeparator,
                                      m_maxExitCode, m_responseFileThreshold,
                                      m_responseFileArgumentIndex, m_relevantEnvVars,
-                                     m_relevantEnvValues, m_stdoutFilePath, m_stderrFilePath);
+                                     m_relevantEnvValues, m_stdoutFilePath, m_stderrFilePath,
+                                     m_dependencyFilePath, m_dependencyOutputPrefix,
+                                     m_persistentWorker, m_persistentWorkerArguments);
     }
 
     QString m_program;
@@ -180,6 +189,10 @@ private:
     QProcessEnvironment m_relevantEnvValues;
     QString m_stdoutFilePath;
     QString m_stderrFilePath;
+    QString m_dependencyFilePath;
+    QString m_dependencyOutputPrefix;
+    bool m_persistentWorker;
+    QStringList m_persistentWorkerArguments;
 };
 
 class JavaScriptCommand : public AbstractCommand
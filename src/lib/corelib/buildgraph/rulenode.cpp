@@ -282,17 +282,17 @@ ArtifactSet RuleNode::changedInputArtifacts(const ArtifactSet &allCompatibleInpu
         return changedInputArtifacts;
 
     for (Artifact * const artifact : explicitlyDependsOn) {
-        if (artifact->timestamp() > m_lastApplicationTime)
+        if (artifact->lastContentChange() > m_lastApplicationTime)
             return allCompatibleInputs;
     }
     if (auxiliaryInputs != m_oldAuxiliaryInputs)
         return allCompatibleInputs;
     for (Artifact * const artifact : auxiliaryInputs) {
-        if (artifact->timestamp() > m_lastApplicationTime)
+        if (artifact->lastContentChange() > m_lastApplicationTime)
             return allCompatibleInputs;
     }
     for (Artifact * const artifact : allCompatibleInputs) {
-        if (artifact->timestamp() > m_lastApplicationTime)
+        if (artifact->lastContentChange() > m_lastApplicationTime)
             changedInputArtifacts.insert(artifact);
     }
     return changedInputArtifacts;
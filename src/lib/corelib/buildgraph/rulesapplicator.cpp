@@ -62,15 +62,19 @@
 #include <logging/translator.h>
 #include <tools/error.h>
 #include <tools/fileinfo.h>
+#include <tools/functionrunnable.h>
 #include <tools/scripttools.h>
 #include <tools/qbsassert.h>
 #include <tools/qttools.h>
+#include <tools/stlutils.h>
 #include <tools/stringconstants.h>
 
 #include <QtCore/qcryptographichash.h>
 #include <QtCore/qdir.h>
 #include <QtScript/qscriptvalueiterator.h>
 
+#include <algorithm>
+#include <atomic>
 #include <memory>
 #include <vector>
 
@@ -123,14 +127,22 @@ void RulesApplicator::applyRule(RuleNode *ruleNode, const ArtifactSet &inputArti
                                 prepareScriptContext, true);
 
     engine()->clearUsesIo();
+    m_pendingPrepareScripts.clear();
+    m_deferPrepareScripts = false;
     if (m_rule->multiplex) { // apply the rule once for a set of inputs
         doApply(inputArtifacts, prepareScriptContext);
     } else { // apply the rule once for each input
+        // The output artifacts have to be created one after the other, but the prepare
+        // scripts of the resulting transformers are independent of each other.
+        m_deferPrepareScripts = inputArtifacts.size() > 1
+                && evalContext()->maxConcurrentPrepareScripts() > 1;
         for (Artifact * const inputArtifact : inputArtifacts) {
             ArtifactSet lst;
             lst += inputArtifact;
             doApply(lst, prepareScriptContext);
         }
+        if (m_deferPrepareScripts)
+            runPendingPrepareScripts();
     }
     if (engine()->usesIo())
         m_ruleUsesIo = true;
@@ -299,24 +311,157 @@ void RulesApplicator::doApply(const ArtifactSet &inputArtifacts, QScriptValue &p
     if (!ruleArtifactArtifactMap.empty())
         engine()->setGlobalObject(prepareScriptContext.prototype());
 
+    if (m_deferPrepareScripts) {
+        PendingPrepareScript pending;
+        pending.transformer = m_transformer;
+        pending.oldTransformer = m_oldTransformer;
+        pending.outputArtifacts = outputArtifacts;
+        pending.requests = takeScriptRequests(engine());
+        m_pendingPrepareScripts.push_back(std::move(pending));
+        return;
+    }
+
     m_transformer->setupOutputs(prepareScriptContext);
     m_transformer->createCommands(engine(), m_rule->prepareScript,
             ScriptEngine::argumentList(Rule::argumentNamesForPrepare(), prepareScriptContext));
-    if (Q_UNLIKELY(m_transformer->commands.empty()))
+    handleCreatedCommands(m_transformer.get(), m_oldTransformer.get(), outputArtifacts);
+}
+
+void RulesApplicator::runPendingPrepareScripts()
+{
+    if (engine()->usesIo())
+        m_ruleUsesIo = true;
+    std::vector<PendingPrepareScript> pendingScripts;
+    std::swap(pendingScripts, m_pendingPrepareScripts);
+    std::atomic_size_t nextScript(0);
+
+    // Every participating thread sets up its engine once and then takes scripts from the list
+    // until there are none left. The build graph is not modified while this is going on.
+    const auto runScripts = [this, &pendingScripts, &nextScript](RulesEvaluationContext *context) {
+        RulesEvaluationContext::Scope s(context);
+        ScriptEngine * const scriptEngine = context->engine();
+        QScriptValue prepareScriptContext = scriptEngine->newObject();
+        prepareScriptContext.setPrototype(scriptEngine->globalObject());
+        QScriptValue prepareFunction;
+        try {
+            setupScriptEngineForFile(scriptEngine, m_rule->prepareScript.fileContext(),
+                                     context->scope(), ObserveMode::Enabled);
+            setupScriptEngineForProduct(scriptEngine, m_product.get(), m_rule->module.get(),
+                                        prepareScriptContext, true);
+        } catch (const ErrorInfo &error) {
+            for (std::size_t i = nextScript++; i < pendingScripts.size(); i = nextScript++)
+                pendingScripts.at(i).error = error;
+            return;
+        }
+        for (std::size_t i = nextScript++; i < pendingScripts.size(); i = nextScript++) {
+            PendingPrepareScript &pending = pendingScripts.at(i);
+            try {
+                runPrepareScript(scriptEngine, prepareScriptContext, prepareFunction, pending);
+            } catch (const ErrorInfo &error) {
+                pending.error = error;
+            }
+        }
+    };
+
+    QThreadPool &threadPool = evalContext()->prepareScriptThreadPool();
+    const int workerCount = std::min(int(pendingScripts.size()) - 1,
+                                     evalContext()->maxConcurrentPrepareScripts() - 1);
+    for (int i = 0; i < workerCount; ++i) {
+        threadPool.start(new FunctionRunnable([this, &runScripts] {
+            runScripts(evalContext()->workerContext());
+        }));
+    }
+    runScripts(evalContext().get());
+    threadPool.waitForDone();
+
+    for (const PendingPrepareScript &pending : pendingScripts) {
+        if (pending.error.hasError())
+            throw pending.error;
+        addScriptRequests(pending.transformer.get(), pending.requests);
+        if (pending.usesIo)
+            m_ruleUsesIo = true;
+        handleCreatedCommands(pending.transformer.get(), pending.oldTransformer.get(),
+                              pending.outputArtifacts);
+    }
+}
+
+// Called concurrently for different transformers.
+void RulesApplicator::runPrepareScript(ScriptEngine *scriptEngine,
+                                       const QScriptValue &prepareScriptContext,
+                                       QScriptValue &prepareFunction,
+                                       PendingPrepareScript &pending) const
+{
+    const PrivateScriptFunction &script = m_rule->prepareScript;
+    if (!prepareFunction.isValid()) {
+        prepareFunction = scriptEngine->evaluate(script.sourceCode(),
+                                                 script.location().filePath(),
+                                                 script.location().line());
+        if (Q_UNLIKELY(!prepareFunction.isFunction()))
+            throw ErrorInfo(Tr::tr("Invalid prepare script."), script.location());
+    }
+    scriptEngine->clearUsesIo();
+    scriptEngine->clearRequestedProperties();
+    Transformer * const transformer = pending.transformer.get();
+    transformer->setupInputs(prepareScriptContext);
+    transformer->setupExplicitlyDependsOn(prepareScriptContext);
+    transformer->setupOutputs(prepareScriptContext);
+    transformer->createCommands(scriptEngine, prepareFunction, script.location(),
+            ScriptEngine::argumentList(Rule::argumentNamesForPrepare(), prepareScriptContext));
+    pending.usesIo = scriptEngine->usesIo();
+}
+
+void RulesApplicator::handleCreatedCommands(Transformer *transformer,
+                                            const Transformer *oldTransformer,
+                                            const QList<Artifact *> &outputArtifacts)
+{
+    if (Q_UNLIKELY(transformer->commands.empty()))
         throw ErrorInfo(Tr::tr("There is a rule without commands: %1.")
                         .arg(m_rule->toString()), m_rule->prepareScript.location());
-    if (!m_oldTransformer || m_oldTransformer->outputs != m_transformer->outputs
-            || m_oldTransformer->inputs != m_transformer->inputs
-            || m_oldTransformer->explicitlyDependsOn != m_transformer->explicitlyDependsOn
-            || m_oldTransformer->commands != m_transformer->commands
-            || commandsNeedRerun(m_transformer.get(), m_product.get(), m_productsByName,
+    if (!oldTransformer || oldTransformer->outputs != transformer->outputs
+            || oldTransformer->inputs != transformer->inputs
+            || oldTransformer->explicitlyDependsOn != transformer->explicitlyDependsOn
+            || oldTransformer->commands != transformer->commands
+            || commandsNeedRerun(transformer, m_product.get(), m_productsByName,
                                  m_projectsByName)) {
-        for (Artifact * const output : qAsConst(outputArtifacts)) {
+        for (Artifact * const output : outputArtifacts) {
             output->clearTimestamp();
             m_invalidatedArtifacts += output;
         }
     }
-    m_transformer->commandsNeedChangeTracking = false;
+    transformer->commandsNeedChangeTracking = false;
+}
+
+RulesApplicator::ScriptRequests RulesApplicator::takeScriptRequests(ScriptEngine *scriptEngine)
+{
+    ScriptRequests requests;
+    requests.properties = scriptEngine->propertiesRequestedInScript();
+    requests.propertiesFromArtifact = scriptEngine->propertiesRequestedFromArtifact();
+    requests.importedFiles = scriptEngine->importedFilesUsedInScript();
+    requests.productsWithRequestedDependencies
+            = scriptEngine->productsWithRequestedDependencies();
+    requests.artifacts = scriptEngine->requestedArtifacts();
+    requests.exports = scriptEngine->requestedExports();
+    scriptEngine->clearRequestedProperties();
+    return requests;
+}
+
+void RulesApplicator::addScriptRequests(Transformer *transformer, const ScriptRequests &requests)
+{
+    transformer->propertiesRequestedInPrepareScript += requests.properties;
+    for (auto it = requests.propertiesFromArtifact.cbegin();
+         it != requests.propertiesFromArtifact.cend(); ++it) {
+        transformer->propertiesRequestedFromArtifactInPrepareScript[it.key()] += it.value();
+    }
+    for (const QString &filePath : requests.importedFiles) {
+        if (!contains(transformer->importedFilesUsedInPrepareScript, filePath))
+            transformer->importedFilesUsedInPrepareScript.push_back(filePath);
+    }
+    transformer->depsRequestedInPrepareScript.add(requests.productsWithRequestedDependencies);
+    transformer->artifactsMapRequestedInPrepareScript.unite(requests.artifacts);
+    for (const ResolvedProduct * const p : requests.exports) {
+        transformer->exportedModulesAccessedInPrepareScript.insert(
+                    std::make_pair(p->uniqueName(), p->exportedModule));
+    }
 }
 
 ArtifactSet RulesApplicator::collectOldOutputArtifacts(const ArtifactSet &inputArtifacts) const
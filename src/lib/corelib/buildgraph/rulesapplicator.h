@@ -42,9 +42,13 @@
 #include "artifact.h"
 #include "forward_decls.h"
 #include "nodeset.h"
+#include "requestedartifacts.h"
 #include <language/filetags.h>
 #include <language/forward_decls.h>
+#include <language/property.h>
 #include <logging/logger.h>
+#include <tools/error.h>
+#include <tools/set.h>
 
 #include <QtCore/qflags.h>
 #include <QtCore/qhash.h>
@@ -52,6 +56,7 @@
 #include <QtScript/qscriptvalue.h>
 
 #include <unordered_map>
+#include <vector>
 
 namespace qbs {
 namespace Internal {
@@ -103,6 +108,36 @@ private:
             const QScriptValueList &args);
     Artifact *createOutputArtifactFromScriptValue(const QScriptValue &obj,
             const ArtifactSet &inputArtifacts);
+    // What the outputArtifacts script and the artifact bindings accessed. Normally, this gets
+    // recorded together with what the prepare script accesses.
+    struct ScriptRequests
+    {
+        PropertySet properties;
+        QHash<QString, PropertySet> propertiesFromArtifact;
+        std::vector<QString> importedFiles;
+        Set<const ResolvedProduct *> productsWithRequestedDependencies;
+        RequestedArtifacts artifacts;
+        Set<const ResolvedProduct *> exports;
+    };
+
+    struct PendingPrepareScript
+    {
+        TransformerPtr transformer;
+        TransformerConstPtr oldTransformer;
+        QList<Artifact *> outputArtifacts;
+        ScriptRequests requests;
+        ErrorInfo error;
+        bool usesIo = false;
+    };
+
+    void runPendingPrepareScripts();
+    void runPrepareScript(ScriptEngine *scriptEngine, const QScriptValue &prepareScriptContext,
+                          QScriptValue &prepareFunction, PendingPrepareScript &pending) const;
+    void handleCreatedCommands(Transformer *transformer, const Transformer *oldTransformer,
+                               const QList<Artifact *> &outputArtifacts);
+    static ScriptRequests takeScriptRequests(ScriptEngine *scriptEngine);
+    static void addScriptRequests(Transformer *transformer, const ScriptRequests &requests);
+
     QString resolveOutPath(const QString &path) const;
     const RulesEvaluationContextPtr &evalContext() const;
     ScriptEngine *engine() const;
@@ -126,6 +161,8 @@ private:
     TransformerConstPtr m_oldTransformer;
     QtMocScanner *m_mocScanner;
     Logger m_logger;
+    std::vector<PendingPrepareScript> m_pendingPrepareScripts;
+    bool m_deferPrepareScripts = false;
     bool m_ruleUsesIo = false;
 };
 
@@ -48,8 +48,11 @@
 #include <tools/progressobserver.h>
 #include <tools/qbsassert.h>
 
+#include <QtCore/qthread.h>
 #include <QtCore/qvariant.h>
 
+#include <algorithm>
+
 namespace qbs {
 namespace Internal {
 
@@ -63,6 +66,9 @@ RulesEvaluationContext::RulesEvaluationContext(Logger logger)
     m_prepareScriptScope.setPrototype(m_engine->globalObject());
     ProcessCommand::setupForJavaScript(m_prepareScriptScope);
     JavaScriptCommand::setupForJavaScript(m_prepareScriptScope);
+
+    // The pool threads keep their engines, so they must live as long as we do.
+    m_prepareScriptThreadPool.setExpiryTimeout(-1);
 }
 
 RulesEvaluationContext::~RulesEvaluationContext() = default;
@@ -85,6 +91,21 @@ void RulesEvaluationContext::checkForCancelation()
         throw ErrorInfo(Tr::tr("Build canceled."));
 }
 
+void RulesEvaluationContext::setMaxConcurrentPrepareScripts(int count)
+{
+    m_maxConcurrentPrepareScripts = std::max(count, 1);
+    m_prepareScriptThreadPool.setMaxThreadCount(std::max(count - 1, 1));
+}
+
+RulesEvaluationContext *RulesEvaluationContext::workerContext()
+{
+    std::lock_guard<std::mutex> lock(m_workerContextsMutex);
+    std::unique_ptr<RulesEvaluationContext> &context = m_workerContexts[QThread::currentThread()];
+    if (!context)
+        context = std::make_unique<RulesEvaluationContext>(m_logger);
+    return context.get();
+}
+
 void RulesEvaluationContext::initScope()
 {
     if (m_initScopeCalls++ > 0)
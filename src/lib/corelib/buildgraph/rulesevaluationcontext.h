@@ -44,10 +44,18 @@
 
 #include <QtCore/qhash.h>
 #include <QtCore/qstring.h>
+#include <QtCore/qthreadpool.h>
 
 #include <QtScript/qscriptprogram.h>
 #include <QtScript/qscriptvalue.h>
 
+#include <mutex>
+#include <unordered_map>
+
+QT_BEGIN_NAMESPACE
+class QThread;
+QT_END_NAMESPACE
+
 namespace qbs {
 namespace Internal {
 class ProgressObserver;
@@ -78,6 +86,18 @@ public:
     void incrementProgressValue();
     void checkForCancelation();
 
+    const Logger &logger() const { return m_logger; }
+
+    // The number of script engines that may run the prepare scripts of a rule concurrently.
+    // The thread pool provides all but the first one, which is ours.
+    void setMaxConcurrentPrepareScripts(int count);
+    int maxConcurrentPrepareScripts() const { return m_maxConcurrentPrepareScripts; }
+    QThreadPool &prepareScriptThreadPool() { return m_prepareScriptThreadPool; }
+
+    // The context for the calling thread of the pool. It is created on first use and then
+    // serves all rules, so that every pool thread has only one script engine.
+    RulesEvaluationContext *workerContext();
+
 private:
     friend class Scope;
 
@@ -90,6 +110,10 @@ private:
     unsigned int m_initScopeCalls;
     QScriptValue m_scope;
     QScriptValue m_prepareScriptScope;
+    std::mutex m_workerContextsMutex;
+    std::unordered_map<QThread *, std::unique_ptr<RulesEvaluationContext>> m_workerContexts;
+    QThreadPool m_prepareScriptThreadPool; // Its threads must end before their contexts go.
+    int m_maxConcurrentPrepareScripts = 1;
 };
 
 } // namespace Internal
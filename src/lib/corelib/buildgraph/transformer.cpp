@@ -257,8 +257,13 @@ void Transformer::createCommands(ScriptEngine *engine, const PrivateScriptFuncti
         if (Q_UNLIKELY(!script.scriptFunction.isFunction()))
             throw ErrorInfo(Tr::tr("Invalid prepare script."), script.location());
     }
+    createCommands(engine, script.scriptFunction, script.location(), args);
+}
 
-    QScriptValue scriptValue = script.scriptFunction.call(QScriptValue(), args);
+void Transformer::createCommands(ScriptEngine *engine, const QScriptValue &prepareFunction,
+                                 const CodeLocation &location, const QScriptValueList &args)
+{
+    QScriptValue scriptValue = prepareFunction.call(QScriptValue(), args);
     engine->releaseResourcesOfScriptObjects();
     propertiesRequestedInPrepareScript = engine->propertiesRequestedInScript();
     propertiesRequestedFromArtifactInPrepareScript = engine->propertiesRequestedFromArtifact();
@@ -272,22 +277,20 @@ void Transformer::createCommands(ScriptEngine *engine, const PrivateScriptFuncti
     }
     engine->clearRequestedProperties();
     if (Q_UNLIKELY(engine->hasErrorOrException(scriptValue)))
-        throw engine->lastError(scriptValue, script.location());
+        throw engine->lastError(scriptValue, location);
     commands.clear();
     if (scriptValue.isArray()) {
         const int count = scriptValue.property(StringConstants::lengthProperty()).toInt32();
         for (qint32 i = 0; i < count; ++i) {
             QScriptValue item = scriptValue.property(i);
             if (item.isValid() && !item.isUndefined()) {
-                const AbstractCommandPtr cmd
-                        = createCommandFromScriptValue(item, script.location());
+                const AbstractCommandPtr cmd = createCommandFromScriptValue(item, location);
                 if (cmd)
                     commands.addCommand(cmd);
             }
         }
     } else {
-        const AbstractCommandPtr cmd = createCommandFromScriptValue(scriptValue,
-                                                                    script.location());
+        const AbstractCommandPtr cmd = createCommandFromScriptValue(scriptValue, location);
         if (cmd)
             commands.addCommand(cmd);
     }
@@ -309,6 +312,8 @@ void Transformer::rescueChangeTrackingData(const TransformerConstPtr &other)
     artifactsMapRequestedInPrepareScript = other->artifactsMapRequestedInPrepareScript;
     artifactsMapRequestedInCommands = other->artifactsMapRequestedInCommands;
     lastCommandExecutionTime = other->lastCommandExecutionTime;
+    lastCommandExecutionDuration = other->lastCommandExecutionDuration;
+    peakMemoryUsage = other->peakMemoryUsage;
     lastPrepareScriptExecutionTime = other->lastPrepareScriptExecutionTime;
     prepareScriptNeedsChangeTracking = other->prepareScriptNeedsChangeTracking;
     commandsNeedChangeTracking = other->commandsNeedChangeTracking;
@@ -317,6 +322,56 @@ void Transformer::rescueChangeTrackingData(const TransformerConstPtr &other)
     exportedModulesAccessedInCommands = other->exportedModulesAccessedInCommands;
 }
 
+void Transformer::storeExecutionState(PersistentPool &pool) const
+{
+    // The exported modules are the ones of the products and therefore not stored again.
+    std::vector<QString> exportingProducts;
+    for (const auto &exportedModule : exportedModulesAccessedInCommands)
+        exportingProducts.push_back(exportedModule.first);
+    std::vector<QProcessEnvironment> relevantEnvValues;
+    for (const AbstractCommandPtr &command : commands.commands()) {
+        relevantEnvValues.push_back(command->type() == AbstractCommand::ProcessCommandType
+                ? static_cast<const ProcessCommand *>(command.get())->relevantEnvValues()
+                : QProcessEnvironment());
+    }
+    pool.store(propertiesRequestedInCommands, propertiesRequestedFromArtifactInCommands,
+               importedFilesUsedInCommands, depsRequestedInCommands,
+               artifactsMapRequestedInCommands, exportingProducts, relevantEnvValues,
+               lastCommandExecutionTime, lastCommandExecutionDuration, peakMemoryUsage,
+               prepareScriptNeedsChangeTracking, commandsNeedChangeTracking, markedForRerun);
+}
+
+void Transformer::loadExecutionState(PersistentPool &pool,
+        const std::unordered_map<QString, const ResolvedProduct *> &productsByName)
+{
+    std::vector<QString> exportingProducts;
+    std::vector<QProcessEnvironment> relevantEnvValues;
+    pool.load(propertiesRequestedInCommands, propertiesRequestedFromArtifactInCommands,
+              importedFilesUsedInCommands, depsRequestedInCommands,
+              artifactsMapRequestedInCommands, exportingProducts, relevantEnvValues,
+              lastCommandExecutionTime, lastCommandExecutionDuration, peakMemoryUsage,
+              prepareScriptNeedsChangeTracking, commandsNeedChangeTracking, markedForRerun);
+    exportedModulesAccessedInCommands.clear();
+    for (const QString &productName : exportingProducts) {
+        const auto it = productsByName.find(productName);
+        if (it == productsByName.cend()) {
+            throw ErrorInfo(Tr::tr("Build graph is corrupt: Unknown product '%1'.")
+                            .arg(productName));
+        }
+        exportedModulesAccessedInCommands.insert(
+                    std::make_pair(productName, it->second->exportedModule));
+    }
+    if (int(relevantEnvValues.size()) != commands.size())
+        throw ErrorInfo(Tr::tr("Build graph is corrupt: Unexpected number of commands."));
+    for (int i = 0; i < commands.size(); ++i) {
+        const AbstractCommandPtr &command = commands.commandAt(i);
+        if (command->type() == AbstractCommand::ProcessCommandType) {
+            static_cast<ProcessCommand *>(command.get())
+                    ->setRelevantEnvValues(relevantEnvValues.at(i));
+        }
+    }
+}
+
 Set<QString> Transformer::jobPools() const
 {
     Set<QString> pools;
@@ -327,5 +382,14 @@ Set<QString> Transformer::jobPools() const
     return pools;
 }
 
+bool Transformer::commandsReportDependencies() const
+{
+    const auto &cmds = commands.commands();
+    return std::any_of(cmds.cbegin(), cmds.cend(), [](const AbstractCommandPtr &c) {
+        return c->type() == AbstractCommand::ProcessCommandType
+                && static_cast<const ProcessCommand *>(c.get())->reportsDependencies();
+    });
+}
+
 } // namespace Internal
 } // namespace qbs
@@ -84,6 +84,8 @@ public:
     RequestedArtifacts artifactsMapRequestedInCommands;
     FileTime lastPrepareScriptExecutionTime;
     FileTime lastCommandExecutionTime;
+    qint64 lastCommandExecutionDuration = -1; // In milliseconds; -1 if unknown.
+    qint64 peakMemoryUsage = -1; // Of the most demanding command, in bytes; -1 if unknown.
     std::unordered_map<QString, ExportedModule> exportedModulesAccessedInPrepareScript;
     std::unordered_map<QString, ExportedModule> exportedModulesAccessedInCommands;
     bool alwaysRun;
@@ -91,6 +93,11 @@ public:
     bool commandsNeedChangeTracking = false;
     bool markedForRerun = false;
 
+    // Transient. Filled by commands that report the files they read, see
+    // ProcessCommand::reportsDependencies().
+    std::vector<QString> reportedDependencies;
+    bool dependenciesReported = false;
+
     static QScriptValue translateFileConfig(ScriptEngine *scriptEngine,
                                             const Artifact *artifact,
                                             const QString &defaultModuleName);
@@ -100,9 +107,18 @@ public:
     void setupExplicitlyDependsOn(QScriptValue targetScriptValue);
     void createCommands(ScriptEngine *engine, const PrivateScriptFunction &script,
                         const QScriptValueList &args);
+    void createCommands(ScriptEngine *engine, const QScriptValue &prepareFunction,
+                        const CodeLocation &location, const QScriptValueList &args);
     void rescueChangeTrackingData(const TransformerConstPtr &other);
 
+    // The data that changes when the transformer is run, as opposed to the data set up
+    // by the rule. See ProjectBuildData::storeChanges().
+    void storeExecutionState(PersistentPool &pool) const;
+    void loadExecutionState(PersistentPool &pool,
+            const std::unordered_map<QString, const ResolvedProduct *> &productsByName);
+
     Set<QString> jobPools() const;
+    bool commandsReportDependencies() const;
 
     template<PersistentPool::OpType opType> void completeSerializationOp(PersistentPool &pool)
     {
@@ -116,6 +132,7 @@ public:
                                      commands, artifactsMapRequestedInPrepareScript,
                                      artifactsMapRequestedInCommands,
                                      lastPrepareScriptExecutionTime, lastCommandExecutionTime,
+                                     lastCommandExecutionDuration, peakMemoryUsage,
                                      exportedModulesAccessedInPrepareScript,
                                      exportedModulesAccessedInCommands,
                                      alwaysRun, prepareScriptNeedsChangeTracking,
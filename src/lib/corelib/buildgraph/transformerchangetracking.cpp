@@ -360,6 +360,7 @@ bool prepareScriptNeedsRerun(
     if (!transformer->prepareScriptNeedsChangeTracking)
         return false;
     transformer->prepareScriptNeedsChangeTracking = false;
+    product->topLevelProject()->buildData->recordChangedTransformer(transformer);
     return TrafoChangeTracker(transformer, product, productsByName, projectsByName)
             .prepareScriptNeedsRerun();
 }
@@ -371,6 +372,7 @@ bool commandsNeedRerun(Transformer *transformer, const ResolvedProduct *product,
     if (!transformer->commandsNeedChangeTracking)
         return false;
     transformer->commandsNeedChangeTracking = false;
+    product->topLevelProject()->buildData->recordChangedTransformer(transformer);
     return TrafoChangeTracker(transformer, product, productsByName, projectsByName)
             .commandsNeedRerun();
 }
@@ -86,13 +86,15 @@ QScriptValue EnvironmentExtension::js_getEnv(QScriptContext *context, QScriptEng
     if (Q_UNLIKELY(context->argumentCount() != 1))
         return context->throwError(QScriptContext::SyntaxError,
                                    QStringLiteral("getEnv expects 1 argument"));
-    const QProcessEnvironment env = static_cast<ScriptEngine *>(engine)->environment();
+    const auto se = static_cast<ScriptEngine *>(engine);
+    const QProcessEnvironment env = se->environment();
     const QProcessEnvironment *procenv = getProcessEnvironment(context, engine,
                                                                QStringLiteral("getEnv"), false);
-    if (!procenv)
-        procenv = &env;
-
     const QString name = context->argument(0).toString();
+    if (!procenv) {
+        procenv = &env;
+        se->addEnvironmentResult(name, env.value(name));
+    }
     const QString value = procenv->value(name);
     return value.isNull() ? engine->undefinedValue() : value;
 }
@@ -121,7 +123,8 @@ QScriptValue EnvironmentExtension::js_unsetEnv(QScriptContext *context, QScriptE
 QScriptValue EnvironmentExtension::js_currentEnv(QScriptContext *context, QScriptEngine *engine)
 {
     Q_UNUSED(context);
-    const QProcessEnvironment env = static_cast<ScriptEngine *>(engine)->environment();
+    const auto se = static_cast<ScriptEngine *>(engine);
+    const QProcessEnvironment env = se->environment();
     const QProcessEnvironment *procenv = getProcessEnvironment(context, engine,
                                                                QStringLiteral("currentEnv"), false);
     if (!procenv)
@@ -130,7 +133,10 @@ QScriptValue EnvironmentExtension::js_currentEnv(QScriptContext *context, QScrip
     const auto keys = procenv->keys();
     for (const QString &key : keys) {
         const QString keyName = HostOsInfo::isWindowsHost() ? key.toUpper() : key;
-        envObject.setProperty(keyName, QScriptValue(procenv->value(key)));
+        const QString value = procenv->value(key);
+        envObject.setProperty(keyName, QScriptValue(value));
+        if (procenv == &env)
+            se->addEnvironmentResult(key, value);
     }
     return envObject;
 }
@@ -40,6 +40,8 @@
 #include <language/scriptengine.h>
 #include <logging/translator.h>
 #include <tools/executablefinder.h>
+#include <tools/fileinfo.h>
+#include <tools/filetime.h>
 #include <tools/hostosinfo.h>
 #include <tools/shellutils.h>
 #include <tools/stringconstants.h>
@@ -183,8 +185,15 @@ bool Process::start(const QString &program, const QStringList &arguments)
     if (!m_workingDirectory.isEmpty())
         m_qProcess->setWorkingDirectory(m_workingDirectory);
 
+    // What a process does depends on its executable and potentially on every variable
+    // of its environment.
+    const auto se = static_cast<ScriptEngine *>(engine());
+    const QString executableFilePath = findExecutable(program);
+    se->addFileLastModifiedResult(executableFilePath, FileInfo(executableFilePath).lastModified());
+    se->addCompleteEnvironmentResult();
+
     m_qProcess->setProcessEnvironment(m_environment);
-    m_qProcess->start(findExecutable(program), arguments, QIODevice::ReadWrite | QIODevice::Text);
+    m_qProcess->start(executableFilePath, arguments, QIODevice::ReadWrite | QIODevice::Text);
     return m_qProcess->waitForStarted();
 }
 
@@ -38,7 +38,6 @@
 ****************************************************************************/
 #include "astimportshandler.h"
 
-#include "asttools.h"
 #include "builtindeclarations.h"
 #include "filecontext.h"
 #include "itemreadervisitorstate.h"
@@ -46,7 +45,6 @@
 
 #include <logging/logger.h>
 #include <logging/translator.h>
-#include <parser/qmljsast_p.h>
 #include <tools/error.h>
 #include <tools/fileinfo.h>
 #include <tools/qttools.h>
@@ -67,7 +65,7 @@ ASTImportsHandler::ASTImportsHandler(ItemReaderVisitorState &visitorState, Logge
 {
 }
 
-void ASTImportsHandler::handleImports(const QbsQmlJS::AST::UiImportList *uiImportList)
+void ASTImportsHandler::handleImports(const std::vector<CompactAst::Import> &imports)
 {
     const auto searchPaths = m_file->searchPaths();
     for (const QString &searchPath : searchPaths)
@@ -77,58 +75,56 @@ void ASTImportsHandler::handleImports(const QbsQmlJS::AST::UiImportList *uiImpor
     collectPrototypes(m_directory, QString());
 
     bool baseImported = false;
-    for (const auto *it = uiImportList; it; it = it->next)
-        handleImport(it->import, &baseImported);
+    for (const CompactAst::Import &import : imports)
+        handleImport(import, &baseImported);
     if (!baseImported) {
-        QStringRef qbsref(&StringConstants::qbsModule());
-        QbsQmlJS::AST::UiQualifiedId qbsURI(qbsref);
-        qbsURI.finish();
-        QbsQmlJS::AST::UiImport imp(&qbsURI);
-        handleImport(&imp, &baseImported);
+        CompactAst::Import imp;
+        imp.uri = QStringList(StringConstants::qbsModule());
+        handleImport(imp, &baseImported);
     }
 
     for (auto it = m_jsImports.constBegin(); it != m_jsImports.constEnd(); ++it)
         m_file->addJsImport(it.value());
 }
 
-void ASTImportsHandler::handleImport(const QbsQmlJS::AST::UiImport *import, bool *baseImported)
+void ASTImportsHandler::handleImport(const CompactAst::Import &import, bool *baseImported)
 {
     QStringList importUri;
     bool isBase = false;
-    if (import->importUri) {
-        importUri = toStringList(import->importUri);
+    if (!import.uri.empty()) {
+        importUri = import.uri;
         isBase = (importUri.size() == 1 && importUri.front() == StringConstants::qbsModule())
                 || (importUri.size() == 2 && importUri.front() == StringConstants::qbsModule()
                     && importUri.last() == StringConstants::baseVar());
         if (isBase) {
             *baseImported = true;
-            checkImportVersion(import->versionToken);
-        } else if (import->versionToken.length) {
+            checkImportVersion(import);
+        } else if (!import.version.isEmpty()) {
             m_logger.printWarning(ErrorInfo(Tr::tr("Superfluous version specification."),
-                    toCodeLocation(m_file->filePath(), import->versionToken)));
+                    import.versionToken.toCodeLocation(m_file->filePath())));
         }
     }
 
     QString as;
     if (isBase) {
-        if (Q_UNLIKELY(!import->importId.isNull())) {
+        if (Q_UNLIKELY(!import.id.isNull())) {
             throw ErrorInfo(Tr::tr("Import of qbs.base must have no 'as <Name>'"),
-                        toCodeLocation(m_file->filePath(), import->importIdToken));
+                        import.idToken.toCodeLocation(m_file->filePath()));
         }
     } else {
         if (importUri.size() == 2 && importUri.front() == StringConstants::qbsModule()) {
             const QString extensionName = importUri.last();
             if (JsExtensions::hasExtension(extensionName)) {
-                if (Q_UNLIKELY(!import->importId.isNull())) {
+                if (Q_UNLIKELY(!import.id.isNull())) {
                     throw ErrorInfo(Tr::tr("Import of built-in extension '%1' "
                                            "must not have 'as' specifier.").arg(extensionName),
-                                    toCodeLocation(m_file->filePath(), import->asToken));
+                                    import.asToken.toCodeLocation(m_file->filePath()));
                 }
                 if (Q_UNLIKELY(m_file->jsExtensions().contains(extensionName))) {
                     m_logger.printWarning(ErrorInfo(Tr::tr("Built-in extension '%1' already "
                                                            "imported.").arg(extensionName),
-                                                    toCodeLocation(m_file->filePath(),
-                                                                   import->importToken)));
+                                                    import.importToken.toCodeLocation(
+                                                        m_file->filePath())));
                 } else {
                     m_file->addJsExtension(extensionName);
                 }
@@ -136,55 +132,53 @@ void ASTImportsHandler::handleImport(const QbsQmlJS::AST::UiImport *import, bool
             }
         }
 
-        if (import->importId.isNull()) {
-            if (!import->fileName.isNull()) {
+        if (import.id.isNull()) {
+            if (!import.fileName.isNull()) {
                 throw ErrorInfo(Tr::tr("File imports require 'as <Name>'"),
-                                toCodeLocation(m_file->filePath(), import->importToken));
+                                import.importToken.toCodeLocation(m_file->filePath()));
             }
             if (importUri.empty()) {
                 throw ErrorInfo(Tr::tr("Invalid import URI."),
-                                toCodeLocation(m_file->filePath(), import->importToken));
+                                import.importToken.toCodeLocation(m_file->filePath()));
             }
             as = importUri.last();
         } else {
-            as = import->importId.toString();
+            as = import.id;
         }
 
         if (Q_UNLIKELY(JsExtensions::hasExtension(as)))
             throw ErrorInfo(Tr::tr("Cannot reuse the name of built-in extension '%1'.").arg(as),
-                            toCodeLocation(m_file->filePath(), import->importIdToken));
+                            import.idToken.toCodeLocation(m_file->filePath()));
         if (Q_UNLIKELY(!m_importAsNames.insert(as).second)) {
             throw ErrorInfo(Tr::tr("Cannot import into the same name more than once."),
-                        toCodeLocation(m_file->filePath(), import->importIdToken));
+                        import.idToken.toCodeLocation(m_file->filePath()));
         }
     }
 
-    if (!import->fileName.isNull()) {
-        QString filePath = FileInfo::resolvePath(m_directory, import->fileName.toString());
+    if (!import.fileName.isNull()) {
+        QString filePath = FileInfo::resolvePath(m_directory, import.fileName);
 
         QFileInfo fi(filePath);
         if (Q_UNLIKELY(!fi.exists()))
             throw ErrorInfo(Tr::tr("Cannot find imported file %0.")
                             .arg(QDir::toNativeSeparators(filePath)),
-                            CodeLocation(m_file->filePath(), import->fileNameToken.startLine,
-                                         import->fileNameToken.startColumn));
+                            import.fileNameToken.toCodeLocation(m_file->filePath()));
         filePath = fi.canonicalFilePath();
         if (fi.isDir()) {
             collectPrototypesAndJsCollections(filePath, as,
-                    toCodeLocation(m_file->filePath(), import->fileNameToken));
+                    import.fileNameToken.toCodeLocation(m_file->filePath()));
         } else {
             if (filePath.endsWith(QStringLiteral(".js"), Qt::CaseInsensitive)) {
                 JsImport &jsImport = m_jsImports[as];
                 jsImport.scopeName = as;
                 jsImport.filePaths.push_back(filePath);
                 jsImport.location
-                        = toCodeLocation(m_file->filePath(), import->firstSourceLocation());
+                        = import.importToken.toCodeLocation(m_file->filePath());
             } else if (filePath.endsWith(QStringLiteral(".qbs"), Qt::CaseInsensitive)) {
                 m_typeNameToFile.insert(QStringList(as), filePath);
             } else {
                 throw ErrorInfo(Tr::tr("Can only import .qbs and .js files"),
-                            CodeLocation(m_file->filePath(), import->fileNameToken.startLine,
-                                         import->fileNameToken.startColumn));
+                            import.fileNameToken.toCodeLocation(m_file->filePath()));
             }
         }
     } else if (!importUri.empty()) {
@@ -202,7 +196,7 @@ void ASTImportsHandler::handleImport(const QbsQmlJS::AST::UiImport *import, bool
                     // ### versioning, qbsdir file, etc.
                     const QString &resultPath = fi.absoluteFilePath();
                     collectPrototypesAndJsCollections(resultPath, as,
-                            toCodeLocation(m_file->filePath(), import->fileNameToken));
+                            import.fileNameToken.toCodeLocation(m_file->filePath()));
                     found = true;
                     break;
                 }
@@ -211,7 +205,7 @@ void ASTImportsHandler::handleImport(const QbsQmlJS::AST::UiImport *import, bool
         if (Q_UNLIKELY(!found)) {
             throw ErrorInfo(Tr::tr("import %1 not found")
                             .arg(importUri.join(QLatin1Char('.'))),
-                            toCodeLocation(m_file->filePath(), import->fileNameToken));
+                            import.fileNameToken.toCodeLocation(m_file->filePath()));
         }
     }
 }
@@ -249,19 +243,17 @@ bool ASTImportsHandler::addPrototype(const QString &fileName, const QString &fil
     return true;
 }
 
-void ASTImportsHandler::checkImportVersion(const QbsQmlJS::AST::SourceLocation &versionToken) const
+void ASTImportsHandler::checkImportVersion(const CompactAst::Import &import) const
 {
-    if (!versionToken.length)
+    if (import.version.isEmpty())
         return;
-    const QString importVersionString
-            = m_file->content().mid(versionToken.offset, versionToken.length);
-    const Version importVersion = readImportVersion(importVersionString,
-                                                    toCodeLocation(m_file->filePath(), versionToken));
+    const CodeLocation versionLocation = import.versionToken.toCodeLocation(m_file->filePath());
+    const Version importVersion = readImportVersion(import.version, versionLocation);
     if (Q_UNLIKELY(importVersion != BuiltinDeclarations::instance().languageVersion()))
         throw ErrorInfo(Tr::tr("Incompatible qbs language version %1. This is version %2.").arg(
-                            importVersionString,
+                            import.version,
                             BuiltinDeclarations::instance().languageVersion().toString()),
-                        toCodeLocation(m_file->filePath(), versionToken));
+                        versionLocation);
 
 }
 
@@ -0,0 +1,384 @@
+/****************************************************************************
+**
+** Copyright (C) 2022 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of Qbs.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-2.0.html and
+** https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#include "compactast.h"
+
+#include "asttools.h"
+#include "identifiersearch.h"
+
+#include <parser/qmljsast_p.h>
+#include <parser/qmljsastvisitor_p.h>
+#include <tools/qbsassert.h>
+#include <tools/stringconstants.h>
+
+#include <QtCore/qdatastream.h>
+
+using namespace QbsQmlJS;
+
+namespace qbs {
+namespace Internal {
+
+// Increase this when changing the serialization format or the meaning of the data.
+static const quint32 compactAstFormatVersion = 1;
+
+static CompactAst::Location toLocation(const AST::SourceLocation &location)
+{
+    CompactAst::Location result;
+    result.line = int(location.startLine);
+    result.column = int(location.startColumn);
+    return result;
+}
+
+// Collects the information that ItemReaderASTVisitor needs from the syntax tree.
+// The default traversal is used for all other node types, so members nested in them
+// are attributed to the enclosing item.
+class CompactAstBuilder : public AST::Visitor
+{
+public:
+    CompactAstBuilder(CompactAst &ast, const QString &sourceCode)
+        : m_ast(ast), m_sourceCode(sourceCode)
+    {
+    }
+
+private:
+    bool visit(AST::UiProgram *uiProgram) override
+    {
+        for (const AST::UiImportList *it = uiProgram->imports; it; it = it->next)
+            m_ast.imports.push_back(createImport(it->import));
+        return true;
+    }
+
+    bool visit(AST::UiObjectDefinition *ast) override
+    {
+        const int itemIndex = int(m_ast.items.size());
+        CompactAst::Item item;
+        item.typeName = toStringList(ast->qualifiedTypeNameId);
+        item.location = toLocation(ast->qualifiedTypeNameId->identifierToken);
+        m_ast.items.push_back(std::move(item));
+        if (m_currentItem != -1) {
+            CompactAst::Member member;
+            member.type = CompactAst::Member::ChildItem;
+            member.childItem = itemIndex;
+            addMember(std::move(member));
+        }
+        if (ast->initializer) {
+            const int parentItem = m_currentItem;
+            m_currentItem = itemIndex;
+            ast->initializer->accept(this);
+            m_currentItem = parentItem;
+        }
+        return false;
+    }
+
+    bool visit(AST::UiPublicMember *ast) override
+    {
+        CompactAst::Member member;
+        member.type = CompactAst::Member::PropertyDeclaration;
+        member.name = QStringList(ast->name.toString());
+        member.memberType = ast->memberType.toString();
+        member.typeModifier = ast->typeModifier.toString();
+        member.isSignal = ast->type == AST::UiPublicMember::Signal;
+        member.isReadOnly = ast->isReadonlyMember;
+        member.location = toLocation(ast->typeToken);
+        member.colonToken = toLocation(ast->colonToken);
+        if (ast->statement) {
+            member.hasStatement = true;
+            member.statement = createStatement(ast->statement);
+        }
+        addMember(std::move(member));
+        return false;
+    }
+
+    bool visit(AST::UiScriptBinding *ast) override
+    {
+        QBS_CHECK(ast->qualifiedId);
+        QBS_CHECK(!ast->qualifiedId->name.isEmpty());
+
+        CompactAst::Member member;
+        member.name = toStringList(ast->qualifiedId);
+        member.location = toLocation(ast->qualifiedId->identifierToken);
+        if (member.name.size() == 1 && member.name.front() == QStringLiteral("id")) {
+            member.type = CompactAst::Member::IdBinding;
+            member.name.clear();
+            const auto * const expStmt = AST::cast<AST::ExpressionStatement *>(ast->statement);
+            const auto * const idExp = expStmt
+                    ? AST::cast<AST::IdentifierExpression *>(expStmt->expression) : nullptr;
+            if (idExp && !idExp->name.isEmpty())
+                member.name.push_back(idExp->name.toString());
+        } else {
+            QBS_CHECK(ast->statement);
+            member.type = CompactAst::Member::Binding;
+            member.hasStatement = true;
+            member.statement = createStatement(ast->statement);
+        }
+        addMember(std::move(member));
+        return false;
+    }
+
+    CompactAst::Import createImport(const AST::UiImport *import) const
+    {
+        CompactAst::Import result;
+        if (import->importUri)
+            result.uri = toStringList(import->importUri);
+        result.fileName = import->fileName.toString();
+        if (import->versionToken.length) {
+            result.version = m_sourceCode.mid(import->versionToken.offset,
+                                              import->versionToken.length);
+        }
+        result.id = import->importId.toString();
+        result.importToken = toLocation(import->importToken);
+        result.fileNameToken = toLocation(import->fileNameToken);
+        result.versionToken = toLocation(import->versionToken);
+        result.asToken = toLocation(import->asToken);
+        result.idToken = toLocation(import->importIdToken);
+        return result;
+    }
+
+    static CompactAst::Statement createStatement(AST::Statement *statement)
+    {
+        CompactAst::Statement result;
+        const AST::SourceLocation firstLocation = statement->firstSourceLocation();
+        result.sourceOffset = int(firstLocation.begin());
+        result.sourceLength = int(statement->lastSourceLocation().end() - firstLocation.begin());
+        result.location = toLocation(firstLocation);
+        result.isBlock = AST::cast<AST::Block *>(statement) != nullptr;
+
+        IdentifierSearch idsearch;
+        idsearch.add(StringConstants::baseVar(), &result.usesBase);
+        idsearch.add(StringConstants::outerVar(), &result.usesOuter);
+        idsearch.add(StringConstants::originalVar(), &result.usesOriginal);
+        idsearch.start(statement);
+        return result;
+    }
+
+    void addMember(CompactAst::Member &&member)
+    {
+        QBS_CHECK(m_currentItem != -1);
+        m_ast.items.at(m_currentItem).members.push_back(std::move(member));
+    }
+
+    CompactAst &m_ast;
+    const QString &m_sourceCode;
+    int m_currentItem = -1;
+};
+
+CompactAst CompactAst::create(AST::UiProgram *program, const QString &sourceCode)
+{
+    CompactAst ast;
+    CompactAstBuilder builder(ast, sourceCode);
+    program->accept(&builder);
+    QBS_CHECK(!ast.items.empty());
+    return ast;
+}
+
+static void write(QDataStream &s, const CompactAst::Location &location)
+{
+    s << location.line << location.column;
+}
+
+static void read(QDataStream &s, CompactAst::Location &location)
+{
+    s >> location.line >> location.column;
+}
+
+static void write(QDataStream &s, const CompactAst::Import &import)
+{
+    s << import.uri << import.fileName << import.version << import.id;
+    write(s, import.importToken);
+    write(s, import.fileNameToken);
+    write(s, import.versionToken);
+    write(s, import.asToken);
+    write(s, import.idToken);
+}
+
+static void read(QDataStream &s, CompactAst::Import &import)
+{
+    s >> import.uri >> import.fileName >> import.version >> import.id;
+    read(s, import.importToken);
+    read(s, import.fileNameToken);
+    read(s, import.versionToken);
+    read(s, import.asToken);
+    read(s, import.idToken);
+}
+
+static void write(QDataStream &s, const CompactAst::Statement &statement)
+{
+    s << statement.sourceOffset << statement.sourceLength;
+    write(s, statement.location);
+    s << statement.isBlock << statement.usesBase << statement.usesOuter << statement.usesOriginal;
+}
+
+static void read(QDataStream &s, CompactAst::Statement &statement)
+{
+    s >> statement.sourceOffset >> statement.sourceLength;
+    read(s, statement.location);
+    s >> statement.isBlock >> statement.usesBase >> statement.usesOuter >> statement.usesOriginal;
+}
+
+static void write(QDataStream &s, const CompactAst::Member &member)
+{
+    s << qint32(member.type) << member.childItem << member.name << member.memberType
+      << member.typeModifier << member.isSignal << member.isReadOnly;
+    write(s, member.location);
+    write(s, member.colonToken);
+    s << member.hasStatement;
+    if (member.hasStatement)
+        write(s, member.statement);
+}
+
+static void read(QDataStream &s, CompactAst::Member &member)
+{
+    qint32 type;
+    s >> type;
+    if (type < CompactAst::Member::ChildItem || type > CompactAst::Member::IdBinding) {
+        s.setStatus(QDataStream::ReadCorruptData);
+        return;
+    }
+    member.type = static_cast<CompactAst::Member::Type>(type);
+    s >> member.childItem >> member.name >> member.memberType >> member.typeModifier
+      >> member.isSignal >> member.isReadOnly;
+    read(s, member.location);
+    read(s, member.colonToken);
+    s >> member.hasStatement;
+    if (member.hasStatement)
+        read(s, member.statement);
+}
+
+template<typename T> static void writeList(QDataStream &s, const std::vector<T> &list)
+{
+    s << quint32(list.size());
+    for (const T &element : list)
+        write(s, element);
+}
+
+template<typename T> static void readList(QDataStream &s, std::vector<T> &list)
+{
+    quint32 size;
+    s >> size;
+    if (s.status() != QDataStream::Ok)
+        return;
+    if (size > quint64(s.device()->bytesAvailable())) {
+        s.setStatus(QDataStream::ReadCorruptData);
+        return;
+    }
+    list.resize(size);
+    for (T &element : list) {
+        read(s, element);
+        if (s.status() != QDataStream::Ok)
+            return;
+    }
+}
+
+static void write(QDataStream &s, const CompactAst::Item &item)
+{
+    s << item.typeName;
+    write(s, item.location);
+    writeList(s, item.members);
+}
+
+static void read(QDataStream &s, CompactAst::Item &item)
+{
+    s >> item.typeName;
+    read(s, item.location);
+    readList(s, item.members);
+}
+
+QByteArray CompactAst::serialize() const
+{
+    QByteArray data;
+    QDataStream stream(&data, QIODevice::WriteOnly);
+    stream.setVersion(QDataStream::Qt_4_8);
+    stream << compactAstFormatVersion;
+    writeList(stream, imports);
+    writeList(stream, items);
+    return data;
+}
+
+static bool isValidStatement(const CompactAst::Statement &statement, int sourceCodeLength)
+{
+    return statement.sourceOffset >= 0 && statement.sourceLength >= 0
+            && statement.sourceOffset <= sourceCodeLength - statement.sourceLength;
+}
+
+bool CompactAst::deserialize(const QByteArray &data, const QString &sourceCode, CompactAst &ast)
+{
+    QDataStream stream(data);
+    stream.setVersion(QDataStream::Qt_4_8);
+    quint32 formatVersion;
+    stream >> formatVersion;
+    if (stream.status() != QDataStream::Ok || formatVersion != compactAstFormatVersion)
+        return false;
+    CompactAst result;
+    readList(stream, result.imports);
+    readList(stream, result.items);
+    if (stream.status() != QDataStream::Ok || !stream.atEnd() || result.items.empty())
+        return false;
+
+    // Make sure that the data cannot send us out of bounds or into cycles.
+    for (std::size_t i = 0; i < result.items.size(); ++i) {
+        const Item &item = result.items.at(i);
+        if (item.typeName.empty())
+            return false;
+        for (const Member &member : item.members) {
+            switch (member.type) {
+            case Member::ChildItem:
+                if (member.childItem <= int(i) || member.childItem >= int(result.items.size()))
+                    return false;
+                break;
+            case Member::Binding:
+                if (!member.hasStatement)
+                    return false;
+                Q_FALLTHROUGH();
+            case Member::PropertyDeclaration:
+                if (member.name.empty())
+                    return false;
+                break;
+            case Member::IdBinding:
+                break;
+            }
+            if (member.hasStatement && !isValidStatement(member.statement, sourceCode.size()))
+                return false;
+        }
+    }
+    ast = std::move(result);
+    return true;
+}
+
+} // namespace Internal
+} // namespace qbs
@@ -0,0 +1,135 @@
+/****************************************************************************
+**
+** Copyright (C) 2022 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of Qbs.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-2.0.html and
+** https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#ifndef QBS_COMPACTAST_H
+#define QBS_COMPACTAST_H
+
+#include <parser/qmljsastfwd_p.h>
+#include <tools/codelocation.h>
+
+#include <QtCore/qbytearray.h>
+#include <QtCore/qstringlist.h>
+
+#include <vector>
+
+namespace qbs {
+namespace Internal {
+
+/*
+ * The parts of the syntax tree of a qbs file that are needed to create Item objects from it.
+ * In contrast to the syntax tree created by the QML/JS parser, this representation does not
+ * reference the parser's memory pool and can therefore be stored on disk.
+ * Locations refer to the source code of the file, which is not part of this data.
+ */
+class CompactAst
+{
+public:
+    struct Location
+    {
+        CodeLocation toCodeLocation(const QString &filePath) const
+        {
+            return CodeLocation(filePath, line, column);
+        }
+
+        int line = 0;
+        int column = 0;
+    };
+
+    struct Import
+    {
+        QStringList uri;
+        QString fileName;   // Null for imports via URI.
+        QString version;    // Empty if no version was given.
+        QString id;         // Null if there was no "as" clause.
+        Location importToken;
+        Location fileNameToken;
+        Location versionToken;
+        Location asToken;
+        Location idToken;
+    };
+
+    // The right-hand side of a binding.
+    struct Statement
+    {
+        int sourceOffset = 0;
+        int sourceLength = 0;
+        Location location;
+        bool isBlock = false;
+        bool usesBase = false;
+        bool usesOuter = false;
+        bool usesOriginal = false;
+    };
+
+    struct Member
+    {
+        enum Type { ChildItem, PropertyDeclaration, Binding, IdBinding };
+
+        Type type = Binding;
+        int childItem = -1;         // Index into CompactAst::items.
+        QStringList name;           // Qualified binding name, property name or id.
+        QString memberType;
+        QString typeModifier;
+        bool isSignal = false;
+        bool isReadOnly = false;
+        Location location;          // Type of a property declaration or name of a binding.
+        Location colonToken;
+        bool hasStatement = false;
+        Statement statement;
+    };
+
+    struct Item
+    {
+        QStringList typeName;
+        Location location;
+        std::vector<Member> members;
+    };
+
+    static CompactAst create(QbsQmlJS::AST::UiProgram *program, const QString &sourceCode);
+
+    QByteArray serialize() const;
+    static bool deserialize(const QByteArray &data, const QString &sourceCode, CompactAst &ast);
+
+    std::vector<Import> imports;
+    std::vector<Item> items; // The first one is the root item.
+};
+
+} // namespace Internal
+} // namespace qbs
+
+#endif // QBS_COMPACTAST_H
@@ -175,7 +175,8 @@ QScriptValue Evaluator::scriptValue(const Item *item)
     const auto edata = new EvaluationData;
     edata->evaluator = this;
     edata->item = item;
-    edata->item->setObserver(this);
+    if (m_observeItems)
+        edata->item->setObserver(this);
 
     scriptValue = m_scriptEngine->newObject(m_scriptClass);
     attachPointerTo(scriptValue, edata);
@@ -256,6 +257,11 @@ void Evaluator::clearPropertyDependencies()
     m_scriptClass->clearPropertyDependencies();
 }
 
+void Evaluator::addPropertyDependencies(const PropertyDependencies &deps)
+{
+    m_scriptClass->addPropertyDependencies(deps);
+}
+
 void throwOnEvaluationError(ScriptEngine *engine, const QScriptValue &scriptValue,
                             const std::function<CodeLocation()> &provideFallbackCodeLocation)
 {
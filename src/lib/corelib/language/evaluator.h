@@ -99,6 +99,7 @@ public:
 
     PropertyDependencies propertyDependencies() const;
     void clearPropertyDependencies();
+    void addPropertyDependencies(const PropertyDependencies &deps);
 
     void handleEvaluationError(const Item *item, const QString &name,
             const QScriptValue &scriptValue);
@@ -107,6 +108,12 @@ public:
     void clearPathPropertiesBaseDir();
 
     bool isNonDefaultValue(const Item *item, const QString &name) const;
+
+    // An item can only have one observer. Additional evaluators that work on the same items
+    // only temporarily, such as the ones used for resolving products concurrently,
+    // must not register themselves.
+    void disableItemObservation() { m_observeItems = false; }
+
 private:
     void onItemPropertyChanged(Item *item) override;
     bool evaluateProperty(QScriptValue *result, const Item *item, const QString &name,
@@ -116,6 +123,7 @@ private:
     EvaluatorScriptClass *m_scriptClass;
     mutable QHash<const Item *, QScriptValue> m_scriptValueMap;
     mutable QHash<FileContextConstPtr, FileContextScopes> m_fileContextScopesMap;
+    bool m_observeItems = true;
 };
 
 void throwOnEvaluationError(ScriptEngine *engine, const QScriptValue &scriptValue,
@@ -344,7 +344,7 @@ private:
                 return result;
             }
             if (sv.toBool())
-                elseCaseValue->setIsExclusiveListValue();
+                scriptClass->setIsExclusiveListValue(elseCaseValue);
         }
         result.scriptValue = engine->evaluate(value->sourceCodeForEvaluation(),
                                               value->file()->filePath(), value->line());
@@ -467,8 +467,7 @@ void EvaluatorScriptClass::collectValuesFromNextChain(const EvaluationData *data
         if (v.isUndefined())
             continue;
         lst << v;
-        if (next->type() == Value::JSSourceValueType
-                && std::static_pointer_cast<JSSourceValue>(next)->isExclusiveListValue()) {
+        if (isExclusiveListValue(next.get())) {
             lst = lst.mid(lst.length() - 2);
             break;
         }
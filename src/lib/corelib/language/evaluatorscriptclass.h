@@ -79,10 +79,23 @@ public:
 
     PropertyDependencies propertyDependencies() const { return m_propertyDependencies; }
     void clearPropertyDependencies() { m_propertyDependencies.clear(); }
+    void addPropertyDependencies(const PropertyDependencies &deps)
+    {
+        for (auto it = deps.cbegin(); it != deps.cend(); ++it)
+            m_propertyDependencies[it.key()] += it.value();
+    }
 
     void setPathPropertiesBaseDir(const QString &dirPath) { m_pathPropertiesBaseDir = dirPath; }
     void clearPathPropertiesBaseDir() { m_pathPropertiesBaseDir.clear(); }
 
+    // Recorded here rather than in the value, which is shared between evaluators that
+    // run concurrently.
+    void setIsExclusiveListValue(const Value *value) { m_exclusiveListValues.insert(value); }
+    bool isExclusiveListValue(const Value *value) const
+    {
+        return m_exclusiveListValues.contains(value);
+    }
+
 private:
     QueryFlags queryItemProperty(const EvaluationData *data,
                                  const QString &name,
@@ -122,6 +135,7 @@ private:
     QueryResult m_queryResult;
     bool m_valueCacheEnabled;
     Set<Value *> m_currentNextChain;
+    Set<const Value *> m_exclusiveListValues;
     PropertyDependencies m_propertyDependencies;
     std::stack<QualifiedId> m_requestedProperties;
     QString m_pathPropertiesBaseDir;
@@ -138,6 +138,21 @@ Set<QString> ItemReader::filesRead() const
     return m_visitorState->filesRead();
 }
 
+void ItemReader::setParseCacheDirectory(const QString &directory)
+{
+    m_visitorState->setParseCacheDirectory(directory);
+}
+
+bool ItemReader::isParseCacheEnabled() const
+{
+    return m_visitorState->isParseCacheEnabled();
+}
+
+int ItemReader::parseCacheHits() const
+{
+    return m_visitorState->parseCacheHits();
+}
+
 void ItemReader::setEnableTiming(bool on)
 {
     m_elapsedTime = on ? 0 : -1;
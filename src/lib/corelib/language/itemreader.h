@@ -59,8 +59,9 @@ class ItemReaderVisitorState;
  * Reads a qbs file and creates a tree of Item objects.
  *
  * In this stage the following steps are performed:
- *    - The QML/JS parser creates the AST.
- *    - The AST is converted to a tree of Item objects.
+ *    - The QML/JS parser creates the AST, which is turned into a compact form that
+ *      can be taken from the on-disk parse cache next time.
+ *    - The compact AST is converted to a tree of Item objects.
  *
  * This class is also responsible for the QMLish inheritance semantics.
  */
@@ -84,6 +85,10 @@ public:
 
     Set<QString> filesRead() const;
 
+    void setParseCacheDirectory(const QString &directory);
+    bool isParseCacheEnabled() const;
+    int parseCacheHits() const;
+
     void setEnableTiming(bool on);
     qint64 elapsedTime() const { return m_elapsedTime; }
 
@@ -41,17 +41,14 @@
 
 #include "astimportshandler.h"
 #include "astpropertiesitemhandler.h"
-#include "asttools.h"
 #include "builtindeclarations.h"
 #include "filecontext.h"
-#include "identifiersearch.h"
 #include "item.h"
 #include "itemreadervisitorstate.h"
 #include "value.h"
 
 #include <api/languageinfo.h>
 #include <jsextensions/jsextensions.h>
-#include <parser/qmljsast_p.h>
 #include <tools/codelocation.h>
 #include <tools/error.h>
 #include <tools/qbsassert.h>
@@ -61,8 +58,6 @@
 
 #include <algorithm>
 
-using namespace QbsQmlJS;
-
 namespace qbs {
 namespace Internal {
 
@@ -75,12 +70,13 @@ ItemReaderASTVisitor::ItemReaderASTVisitor(ItemReaderVisitorState &visitorState,
 {
 }
 
-bool ItemReaderASTVisitor::visit(AST::UiProgram *uiProgram)
+void ItemReaderASTVisitor::visit(const CompactAst &ast)
 {
+    m_ast = &ast;
     ASTImportsHandler importsHandler(m_visitorState, m_logger, m_file);
-    importsHandler.handleImports(uiProgram->imports);
+    importsHandler.handleImports(ast.imports);
     m_typeNameToFile = importsHandler.typeNameFileMap();
-    return true;
+    visitItem(ast.items.front());
 }
 
 static ItemValuePtr findItemProperty(const Item *container, const Item *item)
@@ -96,10 +92,10 @@ static ItemValuePtr findItemProperty(const Item *container, const Item *item)
     return itemValue;
 }
 
-bool ItemReaderASTVisitor::visit(AST::UiObjectDefinition *ast)
+void ItemReaderASTVisitor::visitItem(const CompactAst::Item &astItem)
 {
-    const QString typeName = ast->qualifiedTypeNameId->name.toString();
-    const CodeLocation itemLocation = toCodeLocation(ast->qualifiedTypeNameId->identifierToken);
+    const QString typeName = astItem.typeName.front();
+    const CodeLocation itemLocation = toCodeLocation(astItem.location);
     const Item *baseItem = nullptr;
     Item *mostDerivingItem = nullptr;
 
@@ -109,7 +105,7 @@ bool ItemReaderASTVisitor::visit(AST::UiObjectDefinition *ast)
 
     // Inheritance resolving, part 1: Find out our actual type name (needed for setting
     // up children and alternatives).
-    const QStringList fullTypeName = toStringList(ast->qualifiedTypeNameId);
+    const QStringList &fullTypeName = astItem.typeName;
     const QString baseTypeFileName = m_typeNameToFile.value(fullTypeName);
     ItemType itemType;
     if (!baseTypeFileName.isEmpty()) {
@@ -140,14 +136,15 @@ bool ItemReaderASTVisitor::visit(AST::UiObjectDefinition *ast)
     else
         m_item = item; // This is the root item.
 
-    if (ast->initializer) {
+    if (!astItem.members.empty()) {
         Item *mdi = m_visitorState.mostDerivingItem();
         m_visitorState.setMostDerivingItem(nullptr);
         qSwap(m_item, item);
         const ItemType oldInstanceItemType = m_instanceItemType;
         if (itemType == ItemType::Parameters || itemType == ItemType::Depends)
             m_instanceItemType = ItemType::ModuleParameters;
-        ast->initializer->accept(this);
+        for (const CompactAst::Member &member : astItem.members)
+            visitMember(member);
         m_instanceItemType = oldInstanceItemType;
         qSwap(m_item, item);
         m_visitorState.setMostDerivingItem(mdi);
@@ -175,124 +172,121 @@ bool ItemReaderASTVisitor::visit(AST::UiObjectDefinition *ast)
         // bindings.
         item->setupForBuiltinType(m_logger);
     }
+}
 
-    return false;
+void ItemReaderASTVisitor::visitMember(const CompactAst::Member &member)
+{
+    switch (member.type) {
+    case CompactAst::Member::ChildItem:
+        visitItem(m_ast->items.at(member.childItem));
+        break;
+    case CompactAst::Member::PropertyDeclaration:
+        visitPropertyDeclaration(member);
+        break;
+    case CompactAst::Member::Binding:
+        visitBinding(member);
+        break;
+    case CompactAst::Member::IdBinding:
+        visitIdBinding(member);
+        break;
+    }
 }
 
 void ItemReaderASTVisitor::checkDuplicateBinding(Item *item, const QStringList &bindingName,
-                                                 const AST::SourceLocation &sourceLocation)
+                                                 const CompactAst::Location &location)
 {
     if (Q_UNLIKELY(item->hasOwnProperty(bindingName.last()))) {
         QString msg = Tr::tr("Duplicate binding for '%1'");
-        throw ErrorInfo(msg.arg(bindingName.join(QLatin1Char('.'))),
-                    toCodeLocation(sourceLocation));
+        throw ErrorInfo(msg.arg(bindingName.join(QLatin1Char('.'))), toCodeLocation(location));
     }
 }
 
-bool ItemReaderASTVisitor::visit(AST::UiPublicMember *ast)
+void ItemReaderASTVisitor::visitPropertyDeclaration(const CompactAst::Member &member)
 {
     PropertyDeclaration p;
-    if (Q_UNLIKELY(ast->name.isEmpty()))
+    if (Q_UNLIKELY(member.name.front().isEmpty()))
         throw ErrorInfo(Tr::tr("public member without name"));
-    if (Q_UNLIKELY(ast->memberType.isEmpty()))
+    if (Q_UNLIKELY(member.memberType.isEmpty()))
         throw ErrorInfo(Tr::tr("public member without type"));
-    if (Q_UNLIKELY(ast->type == AST::UiPublicMember::Signal))
+    if (Q_UNLIKELY(member.isSignal))
         throw ErrorInfo(Tr::tr("public member with signal type not supported"));
-    p.setName(ast->name.toString());
-    p.setType(PropertyDeclaration::propertyTypeFromString(ast->memberType.toString()));
+    p.setName(member.name.front());
+    p.setType(PropertyDeclaration::propertyTypeFromString(member.memberType));
     if (p.type() == PropertyDeclaration::UnknownType) {
         throw ErrorInfo(Tr::tr("Unknown type '%1' in property declaration.")
-                        .arg(ast->memberType.toString()), toCodeLocation(ast->typeToken));
+                        .arg(member.memberType), toCodeLocation(member.location));
     }
-    if (Q_UNLIKELY(!ast->typeModifier.isEmpty())) {
+    if (Q_UNLIKELY(!member.typeModifier.isEmpty())) {
         throw ErrorInfo(Tr::tr("public member with type modifier '%1' not supported").arg(
-                        ast->typeModifier.toString()));
+                        member.typeModifier));
     }
-    if (ast->isReadonlyMember)
+    if (member.isReadOnly)
         p.setFlags(PropertyDeclaration::ReadOnlyFlag);
 
     m_item->m_propertyDeclarations.insert(p.name(), p);
 
     const JSSourceValuePtr value = JSSourceValue::create();
     value->setFile(m_file);
-    if (ast->statement) {
-        handleBindingRhs(ast->statement, value);
+    if (member.hasStatement) {
+        handleBindingRhs(member.statement, value);
         const QStringList bindingName(p.name());
-        checkDuplicateBinding(m_item, bindingName, ast->colonToken);
+        checkDuplicateBinding(m_item, bindingName, member.colonToken);
     }
 
     m_item->setProperty(p.name(), value);
-    return false;
 }
 
-bool ItemReaderASTVisitor::visit(AST::UiScriptBinding *ast)
+void ItemReaderASTVisitor::visitIdBinding(const CompactAst::Member &member)
 {
-    QBS_CHECK(ast->qualifiedId);
-    QBS_CHECK(!ast->qualifiedId->name.isEmpty());
-
-    const QStringList bindingName = toStringList(ast->qualifiedId);
-
-    if (bindingName.length() == 1 && bindingName.front() == QStringLiteral("id")) {
-        const auto * const expStmt = AST::cast<AST::ExpressionStatement *>(ast->statement);
-        if (Q_UNLIKELY(!expStmt))
-            throw ErrorInfo(Tr::tr("id: must be followed by identifier"));
-        const auto * const idExp = AST::cast<AST::IdentifierExpression *>(expStmt->expression);
-        if (Q_UNLIKELY(!idExp || idExp->name.isEmpty()))
-            throw ErrorInfo(Tr::tr("id: must be followed by identifier"));
-        m_item->m_id = idExp->name.toString();
-        m_file->ensureIdScope(m_itemPool);
-        ItemValueConstPtr existingId = m_file->idScope()->itemProperty(m_item->id());
-        if (existingId) {
-            ErrorInfo e(Tr::tr("The id '%1' is not unique.").arg(m_item->id()));
-            e.append(Tr::tr("First occurrence is here."), existingId->item()->location());
-            e.append(Tr::tr("Next occurrence is here."), m_item->location());
-            throw e;
-        }
-        m_file->idScope()->setProperty(m_item->id(), ItemValue::create(m_item));
-        return false;
+    if (Q_UNLIKELY(member.name.empty()))
+        throw ErrorInfo(Tr::tr("id: must be followed by identifier"));
+    m_item->m_id = member.name.front();
+    m_file->ensureIdScope(m_itemPool);
+    ItemValueConstPtr existingId = m_file->idScope()->itemProperty(m_item->id());
+    if (existingId) {
+        ErrorInfo e(Tr::tr("The id '%1' is not unique.").arg(m_item->id()));
+        e.append(Tr::tr("First occurrence is here."), existingId->item()->location());
+        e.append(Tr::tr("Next occurrence is here."), m_item->location());
+        throw e;
     }
+    m_file->idScope()->setProperty(m_item->id(), ItemValue::create(m_item));
+}
 
+void ItemReaderASTVisitor::visitBinding(const CompactAst::Member &member)
+{
+    const QStringList &bindingName = member.name;
     const JSSourceValuePtr value = JSSourceValue::create();
-    handleBindingRhs(ast->statement, value);
+    handleBindingRhs(member.statement, value);
 
     Item * const targetItem = targetItemForBinding(bindingName, value);
-    checkDuplicateBinding(targetItem, bindingName, ast->qualifiedId->identifierToken);
+    checkDuplicateBinding(targetItem, bindingName, member.location);
     targetItem->setProperty(bindingName.last(), value);
-    return false;
 }
 
-bool ItemReaderASTVisitor::handleBindingRhs(AST::Statement *statement,
+void ItemReaderASTVisitor::handleBindingRhs(const CompactAst::Statement &statement,
                                             const JSSourceValuePtr &value)
 {
-    QBS_CHECK(statement);
     QBS_CHECK(value);
 
-    if (AST::cast<AST::Block *>(statement))
+    if (statement.isBlock)
         value->m_flags |= JSSourceValue::HasFunctionForm;
 
     value->setFile(m_file);
-    value->setSourceCode(textViewOf(m_file->content(), statement));
-    value->setLocation(statement->firstSourceLocation().startLine,
-                       statement->firstSourceLocation().startColumn);
-
-    bool usesBase, usesOuter, usesOriginal;
-    IdentifierSearch idsearch;
-    idsearch.add(StringConstants::baseVar(), &usesBase);
-    idsearch.add(StringConstants::outerVar(), &usesOuter);
-    idsearch.add(StringConstants::originalVar(), &usesOriginal);
-    idsearch.start(statement);
-    if (usesBase)
+    value->setSourceCode(QStringView(m_file->content()).mid(statement.sourceOffset,
+                                                            statement.sourceLength));
+    value->setLocation(statement.location.line, statement.location.column);
+
+    if (statement.usesBase)
         value->m_flags |= JSSourceValue::SourceUsesBase;
-    if (usesOuter)
+    if (statement.usesOuter)
         value->m_flags |= JSSourceValue::SourceUsesOuter;
-    if (usesOriginal)
+    if (statement.usesOriginal)
         value->m_flags |= JSSourceValue::SourceUsesOriginal;
-    return false;
 }
 
-CodeLocation ItemReaderASTVisitor::toCodeLocation(const AST::SourceLocation &location) const
+CodeLocation ItemReaderASTVisitor::toCodeLocation(const CompactAst::Location &location) const
 {
-    return CodeLocation(m_file->filePath(), location.startLine, location.startColumn);
+    return location.toCodeLocation(m_file->filePath());
 }
 
 Item *ItemReaderASTVisitor::targetItemForBinding(const QStringList &bindingName,
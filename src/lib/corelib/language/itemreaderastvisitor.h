@@ -40,11 +40,11 @@
 #ifndef QBS_ITEMREADERASTVISITOR_H
 #define QBS_ITEMREADERASTVISITOR_H
 
+#include "compactast.h"
 #include "forward_decls.h"
 #include "itemtype.h"
 
 #include <logging/logger.h>
-#include <parser/qmljsastvisitor_p.h>
 
 #include <QtCore/qhash.h>
 #include <QtCore/qstringlist.h>
@@ -57,25 +57,27 @@ class Item;
 class ItemPool;
 class ItemReaderVisitorState;
 
-class ItemReaderASTVisitor : public QbsQmlJS::AST::Visitor
+class ItemReaderASTVisitor
 {
 public:
     ItemReaderASTVisitor(ItemReaderVisitorState &visitorState, FileContextPtr file,
                          ItemPool *itemPool, Logger &logger);
+    void visit(const CompactAst &ast);
     void checkItemTypes() { doCheckItemTypes(rootItem()); }
 
     Item *rootItem() const { return m_item; }
 
 private:
-    bool visit(QbsQmlJS::AST::UiProgram *uiProgram) override;
-    bool visit(QbsQmlJS::AST::UiObjectDefinition *ast) override;
-    bool visit(QbsQmlJS::AST::UiPublicMember *ast) override;
-    bool visit(QbsQmlJS::AST::UiScriptBinding *ast) override;
+    void visitItem(const CompactAst::Item &astItem);
+    void visitMember(const CompactAst::Member &member);
+    void visitPropertyDeclaration(const CompactAst::Member &member);
+    void visitBinding(const CompactAst::Member &member);
+    void visitIdBinding(const CompactAst::Member &member);
 
-    bool handleBindingRhs(QbsQmlJS::AST::Statement *statement, const JSSourceValuePtr &value);
-    CodeLocation toCodeLocation(const QbsQmlJS::AST::SourceLocation &location) const;
+    void handleBindingRhs(const CompactAst::Statement &statement, const JSSourceValuePtr &value);
+    CodeLocation toCodeLocation(const CompactAst::Location &location) const;
     void checkDuplicateBinding(Item *item, const QStringList &bindingName,
-            const QbsQmlJS::AST::SourceLocation &sourceLocation);
+                               const CompactAst::Location &location);
     Item *targetItemForBinding(const QStringList &binding, const JSSourceValueConstPtr &value);
     static void inheritItem(Item *dst, const Item *src);
     void checkDeprecationStatus(ItemType itemType, const QString &itemName,
@@ -86,6 +88,7 @@ private:
     const FileContextPtr m_file;
     ItemPool * const m_itemPool;
     Logger &m_logger;
+    const CompactAst *m_ast = nullptr;
     QHash<QStringList, QString> m_typeNameToFile;
     Item *m_item = nullptr;
     ItemType m_instanceItemType = ItemType::ModuleInstance;
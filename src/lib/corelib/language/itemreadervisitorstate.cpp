@@ -39,6 +39,7 @@
 #include "itemreadervisitorstate.h"
 
 #include "asttools.h"
+#include "compactast.h"
 #include "filecontext.h"
 #include "itemreaderastvisitor.h"
 
@@ -62,14 +63,14 @@ class ASTCacheValueData : public QSharedData
     Q_DISABLE_COPY(ASTCacheValueData)
 public:
     ASTCacheValueData()
-        : ast(nullptr)
+        : valid(false)
         , processing(false)
     {
     }
 
     QString code;
-    QbsQmlJS::Engine engine;
-    QbsQmlJS::AST::UiProgram *ast;
+    CompactAst ast;
+    bool valid;
     bool processing;
 };
 
@@ -89,11 +90,9 @@ public:
     void setCode(const QString &code) { d->code = code; }
     QString code() const { return d->code; }
 
-    QbsQmlJS::Engine *engine() const { return &d->engine; }
-
-    void setAst(QbsQmlJS::AST::UiProgram *ast) { d->ast = ast; }
-    QbsQmlJS::AST::UiProgram *ast() const { return d->ast; }
-    bool isValid() const { return d->ast; }
+    void setAst(CompactAst ast) { d->ast = std::move(ast); d->valid = true; }
+    const CompactAst &ast() const { return d->ast; }
+    bool isValid() const { return d->valid; }
 
 private:
     QExplicitlySharedDataPointer<ASTCacheValueData> d;
@@ -127,23 +126,22 @@ Item *ItemReaderVisitorState::readFile(const QString &filePath, const QStringLis
         QTextStream stream(&file);
         setupDefaultCodec(stream);
         const QString &code = stream.readAll();
-        QbsQmlJS::Lexer lexer(cacheValue.engine());
-        lexer.setCode(code, 1);
-        QbsQmlJS::Parser parser(cacheValue.engine());
-
         file.close();
-        if (!parser.parse()) {
-            const QList<QbsQmlJS::DiagnosticMessage> &parserMessages = parser.diagnosticMessages();
-            if (Q_UNLIKELY(!parserMessages.empty())) {
-                ErrorInfo err;
-                for (const QbsQmlJS::DiagnosticMessage &msg : parserMessages)
-                    err.append(msg.message, toCodeLocation(filePath, msg.loc));
-                throw err;
-            }
+
+        const QByteArray cacheKey = m_parseCache.isEnabled()
+                ? ParseCache::entryKey(ParseCache::FileType::Qbs, code) : QByteArray();
+        QByteArray cachedData;
+        CompactAst ast;
+        if (m_parseCache.lookup(cacheKey, &cachedData)
+                && CompactAst::deserialize(cachedData, code, ast)) {
+            ++m_parseCacheHits;
+        } else {
+            ast = parse(filePath, code);
+            m_parseCache.store(cacheKey, ast.serialize());
         }
 
         cacheValue.setCode(code);
-        cacheValue.setAst(parser.ast());
+        cacheValue.setAst(std::move(ast));
     }
 
     const FileContextPtr file = FileContext::create();
@@ -160,12 +158,30 @@ Item *ItemReaderVisitorState::readFile(const QString &filePath, const QStringLis
         private:
             ASTCacheValue &m_cacheValue;
         } processingFlagManager(cacheValue);
-        cacheValue.ast()->accept(&astVisitor);
+        astVisitor.visit(cacheValue.ast());
     }
     astVisitor.checkItemTypes();
     return astVisitor.rootItem();
 }
 
+CompactAst ItemReaderVisitorState::parse(const QString &filePath, const QString &code)
+{
+    QbsQmlJS::Engine engine;
+    QbsQmlJS::Lexer lexer(&engine);
+    lexer.setCode(code, 1);
+    QbsQmlJS::Parser parser(&engine);
+    if (!parser.parse()) {
+        const QList<QbsQmlJS::DiagnosticMessage> &parserMessages = parser.diagnosticMessages();
+        if (Q_UNLIKELY(!parserMessages.empty())) {
+            ErrorInfo err;
+            for (const QbsQmlJS::DiagnosticMessage &msg : parserMessages)
+                err.append(msg.message, toCodeLocation(filePath, msg.loc));
+            throw err;
+        }
+    }
+    return CompactAst::create(parser.ast(), code);
+}
+
 void ItemReaderVisitorState::cacheDirectoryEntries(const QString &dirPath, const QStringList &entries)
 {
     m_directoryEntries.insert(dirPath, entries);
@@ -39,6 +39,8 @@
 #ifndef QBS_ITEMREADERVISITORSTATE_H
 #define QBS_ITEMREADERVISITORSTATE_H
 
+#include "parsecache.h"
+
 #include <logging/logger.h>
 #include <tools/set.h>
 
@@ -48,6 +50,7 @@
 
 namespace qbs {
 namespace Internal {
+class CompactAst;
 class Item;
 class ItemPool;
 
@@ -61,6 +64,10 @@ public:
 
     Item *readFile(const QString &filePath, const QStringList &searchPaths, ItemPool *itemPool);
 
+    void setParseCacheDirectory(const QString &directory) { m_parseCache.setDirectory(directory); }
+    bool isParseCacheEnabled() const { return m_parseCache.isEnabled(); }
+    int parseCacheHits() const { return m_parseCacheHits; }
+
     void cacheDirectoryEntries(const QString &dirPath, const QStringList &entries);
     bool findDirectoryEntries(const QString &dirPath, QStringList *entries) const;
 
@@ -68,7 +75,11 @@ public:
     void setMostDerivingItem(Item *item);
 
 private:
+    static CompactAst parse(const QString &filePath, const QString &code);
+
     Logger &m_logger;
+    ParseCache m_parseCache;
+    int m_parseCacheHits = 0;
     Set<QString> m_filesRead;
     QHash<QString, QStringList> m_directoryEntries;
     Item *m_mostDerivingItem = nullptr;
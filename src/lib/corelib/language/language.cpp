@@ -66,6 +66,7 @@
 #include <QtCore/qcryptographichash.h>
 #include <QtCore/qdir.h>
 #include <QtCore/qdiriterator.h>
+#include <QtCore/qfileinfo.h>
 #include <QtCore/qmap.h>
 
 #include <QtScript/qscriptvalue.h>
@@ -73,6 +74,7 @@
 #include <algorithm>
 #include <memory>
 #include <mutex>
+#include <unordered_map>
 
 namespace qbs {
 namespace Internal {
@@ -558,18 +560,6 @@ std::vector<ResolvedProductPtr> ResolvedProject::allProducts() const
 void ResolvedProject::load(PersistentPool &pool)
 {
     serializationOp<PersistentPool::Load>(pool);
-    std::for_each(products.cbegin(), products.cend(),
-                  [](const ResolvedProductPtr &p) {
-        if (!p->buildData)
-            return;
-        for (BuildGraphNode * const node : qAsConst(p->buildData->allNodes())) {
-            node->product = p;
-
-            // restore parent links
-            for (BuildGraphNode * const child : qAsConst(node->children))
-                child->parents.insert(node);
-        }
-    });
 }
 
 void ResolvedProject::store(PersistentPool &pool)
@@ -630,7 +620,7 @@ void TopLevelProject::store(Logger logger)
 
     if (!buildData)
         return;
-    if (!buildData->isDirty()) {
+    if (!buildData->isDirty() && !buildData->hasChanges()) {
         qCDebug(lcBuildGraph) << "build graph is unchanged in project" << id();
         return;
     }
@@ -638,15 +628,66 @@ void TopLevelProject::store(Logger logger)
     makeModuleProvidersNonTransient();
 
     const QString fileName = buildGraphFilePath();
+    if (!buildData->isDirty() && storeChanges(fileName, logger))
+        return;
+
+    // All of the build data is needed, and the old file must not be in use anymore.
+    buildData->loadAllProductBuildData();
+
     qCDebug(lcBuildGraph) << "storing:" << fileName;
-    PersistentPool pool(logger);
-    PersistentPool::HeadData headData;
-    headData.projectConfig = buildConfiguration();
-    pool.setHeadData(headData);
-    pool.setupWriteStream(fileName);
-    store(pool);
-    pool.finalizeWriteStream();
+    {
+        PersistentPool pool(logger);
+        PersistentPool::HeadData headData;
+        headData.projectConfig = buildConfiguration();
+        pool.setHeadData(headData);
+        pool.setupWriteStream(fileName);
+        store(pool);
+        pool.finalizeWriteStream();
+    }
     buildData->setClean();
+    buildData->clearChanges();
+    buildData->storedDataSize = QFileInfo(fileName).size();
+    buildData->storedChangesSize = 0;
+}
+
+// If only the state of files and transformers has changed, we append a record of these changes
+// to the build graph file instead of rewriting it. Once the records make up a significant part
+// of the file, we store the complete build graph again, which gets rid of them.
+bool TopLevelProject::storeChanges(const QString &filePath, Logger &logger)
+{
+    if (buildData->storedDataSize <= 0
+            || buildData->storedChangesSize > buildData->storedDataSize / 4
+            || QFileInfo(filePath).size()
+                != buildData->storedDataSize + buildData->storedChangesSize) {
+        return false;
+    }
+    PersistentPool pool(logger);
+    pool.setupRecordWriteStream();
+    if (!buildData->storeChanges(pool))
+        return false;
+    qCDebug(lcBuildGraph) << "appending changes to:" << filePath;
+    buildData->storedChangesSize += pool.appendRecord(filePath);
+    buildData->clearChanges();
+    return true;
+}
+
+void TopLevelProject::loadChanges(PersistentPool &pool, Logger logger)
+{
+    const PersistentPool::LoadedRecords loadedRecords = pool.loadRecords();
+    std::unordered_map<QString, const ResolvedProduct *> productsByName;
+    for (const ResolvedProductPtr &product : allProducts())
+        productsByName.insert(std::make_pair(product->uniqueName(), product.get()));
+    for (const QByteArray &record : loadedRecords.records) {
+        PersistentPool recordPool(logger);
+        recordPool.setupRecordReadStream(record);
+        buildData->loadChanges(recordPool, productsByName);
+    }
+    buildData->storedDataSize = loadedRecords.dataSize;
+    buildData->storedChangesSize = loadedRecords.recordsSize;
+    if (!loadedRecords.complete) {
+        qCDebug(lcBuildGraph) << "ignoring damaged record in build graph file";
+        buildData->setDirty(); // Get rid of it with the next store operation.
+    }
 }
 
 void TopLevelProject::load(PersistentPool &pool)
@@ -654,12 +695,14 @@ void TopLevelProject::load(PersistentPool &pool)
     ResolvedProject::load(pool);
     serializationOp<PersistentPool::Load>(pool);
     QBS_CHECK(buildData);
+    ProductBuildDataLoader::loadProducts(pool);
 }
 
 void TopLevelProject::store(PersistentPool &pool)
 {
     ResolvedProject::store(pool);
     serializationOp<PersistentPool::Store>(pool);
+    ProductBuildDataLoader::store(pool, allProducts());
 }
 
 void TopLevelProject::cleanupModuleProviderOutput()
@@ -45,9 +45,11 @@
 #include "jsimports.h"
 #include "moduleproviderinfo.h"
 #include "propertydeclaration.h"
+#include "qualifiedid.h"
 #include "resolvedfilecontext.h"
 
 #include <buildgraph/forward_decls.h>
+#include <buildgraph/productbuilddataloader.h>
 #include <tools/codelocation.h>
 #include <tools/filetime.h>
 #include <tools/joblimits.h>
@@ -578,7 +580,9 @@ public:
     std::vector<ProbeConstPtr> probes;
     std::vector<ArtifactPropertiesPtr> artifactProperties;
     QStringList missingSourceFiles;
-    std::unique_ptr<ProductBuildData> buildData;
+    PropertyDependencies propertyDependencies; // Among the module properties.
+    Set<QString> buildSystemFiles; // The project files the properties were evaluated from.
+    ProductBuildDataPtr buildData; // Stored separately, see ProductBuildDataLoader.
 
     ExportedModule exportedModule;
 
@@ -628,8 +632,8 @@ private:
                                      missingSourceFiles, location, productProperties,
                                      moduleProperties, rules, dependencies, dependencyParameters,
                                      fileTaggers, modules, moduleParameters, scanners, groups,
-                                     artifactProperties, probes, exportedModule, buildData,
-                                     jobLimits);
+                                     artifactProperties, probes, exportedModule, jobLimits,
+                                     propertyDependencies, buildSystemFiles);
     }
 
     QHash<QString, QString> m_executablePathCache;
@@ -715,10 +719,13 @@ public:
 
     QString buildGraphFilePath() const;
     void store(Logger logger);
+    void loadChanges(PersistentPool &pool, Logger logger);
 
 private:
     TopLevelProject();
 
+    bool storeChanges(const QString &filePath, Logger &logger);
+
     template<PersistentPool::OpType opType> void serializationOp(PersistentPool &pool)
     {
         pool.serializationOp<opType>(m_id, canonicalFilePathResults, fileExistsResults,
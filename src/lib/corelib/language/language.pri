@@ -6,6 +6,7 @@ HEADERS += \
     $$PWD/astpropertiesitemhandler.h \
     $$PWD/asttools.h \
     $$PWD/builtindeclarations.h \
+    $$PWD/compactast.h \
     $$PWD/deprecationinfo.h \
     $$PWD/evaluationdata.h \
     $$PWD/evaluator.h \
@@ -30,7 +31,10 @@ HEADERS += \
     $$PWD/modulemerger.h \
     $$PWD/moduleproviderinfo.h \
     $$PWD/moduleproviderloader.h \
+    $$PWD/modulesearchpathindex.h \
+    $$PWD/parsecache.h \
     $$PWD/preparescriptobserver.h \
+    $$PWD/probecache.h \
     $$PWD/probesresolver.h \
     $$PWD/projectresolver.h \
     $$PWD/property.h \
@@ -49,6 +53,7 @@ SOURCES += \
     $$PWD/astpropertiesitemhandler.cpp \
     $$PWD/asttools.cpp \
     $$PWD/builtindeclarations.cpp \
+    $$PWD/compactast.cpp \
     $$PWD/evaluator.cpp \
     $$PWD/evaluatorscriptclass.cpp \
     $$PWD/filecontext.cpp \
@@ -66,7 +71,10 @@ SOURCES += \
     $$PWD/moduleloader.cpp \
     $$PWD/modulemerger.cpp \
     $$PWD/moduleproviderloader.cpp \
+    $$PWD/modulesearchpathindex.cpp \
+    $$PWD/parsecache.cpp \
     $$PWD/preparescriptobserver.cpp \
+    $$PWD/probecache.cpp \
     $$PWD/scriptpropertyobserver.cpp \
     $$PWD/probesresolver.cpp \
     $$PWD/projectresolver.cpp \
@@ -42,11 +42,13 @@
 #include "evaluator.h"
 #include "language.h"
 #include "moduleloader.h"
+#include "parsecache.h"
 #include "projectresolver.h"
 #include "scriptengine.h"
 
 #include <logging/translator.h>
 #include <tools/fileinfo.h>
+#include <tools/preferences.h>
 #include <tools/profile.h>
 #include <tools/progressobserver.h>
 #include <tools/qbsassert.h>
@@ -99,6 +101,13 @@ void Loader::setOldProductProbes(const QHash<QString, std::vector<ProbeConstPtr>
     m_oldProductProbes = oldProbes;
 }
 
+void Loader::setOldProducts(const std::vector<ResolvedProductPtr> &oldProducts,
+                            const Set<QString> &changedFiles)
+{
+    m_oldProducts = oldProducts;
+    m_changedFiles = changedFiles;
+}
+
 void Loader::setStoredProfiles(const QVariantMap &profiles)
 {
     m_storedProfiles = profiles;
@@ -131,6 +140,7 @@ TopLevelProjectPtr Loader::loadProject(const SetupProjectParameters &_parameters
                         << QDir::toNativeSeparators(parameters.projectFilePath()) << "'.";
 
     m_engine->setEnvironment(parameters.adjustedEnvironment());
+    m_engine->setParseCacheDirectory(parameters.parseCacheDirectory());
     m_engine->clearExceptions();
     m_engine->clearImportsCache();
     m_engine->clearRequestedProperties();
@@ -167,11 +177,15 @@ TopLevelProjectPtr Loader::loadProject(const SetupProjectParameters &_parameters
     moduleLoader.setStoredProfiles(m_storedProfiles);
     moduleLoader.setStoredModuleProviderInfo(m_storedModuleProviderInfo);
     const ModuleLoaderResult loadResult = moduleLoader.load(parameters);
+    const QString parseCacheDirectory = parameters.parseCacheDirectory();
+    Settings settings(parameters.settingsDirectory());
     ProjectResolver resolver(&evaluator, loadResult, std::move(parameters), m_logger);
     resolver.setProgressObserver(m_progressObserver);
+    resolver.setOldProducts(m_oldProducts, m_changedFiles);
     const TopLevelProjectPtr project = resolver.resolve();
     project->lastStartResolveTime = resolveTime;
     project->lastEndResolveTime = FileTime::currentTime();
+    ParseCache::prune(parseCacheDirectory, Preferences(&settings).parseCacheMaxSize());
 
     // E.g. if the top-level project is disabled.
     if (m_progressObserver)
@@ -43,6 +43,7 @@
 #include "moduleproviderinfo.h"
 #include <logging/logger.h>
 #include <tools/filetime.h>
+#include <tools/set.h>
 
 #include <QtCore/qstringlist.h>
 
@@ -63,6 +64,8 @@ public:
     void setSearchPaths(const QStringList &searchPaths);
     void setOldProjectProbes(const std::vector<ProbeConstPtr> &oldProbes);
     void setOldProductProbes(const QHash<QString, std::vector<ProbeConstPtr>> &oldProbes);
+    void setOldProducts(const std::vector<ResolvedProductPtr> &oldProducts,
+                        const Set<QString> &changedFiles);
     void setLastResolveTime(const FileTime &time) { m_lastResolveTime = time; }
     void setStoredProfiles(const QVariantMap &profiles);
     void setStoredModuleProviderInfo(const StoredModuleProviderInfo &providerInfo);
@@ -77,6 +80,8 @@ private:
     QStringList m_searchPaths;
     std::vector<ProbeConstPtr> m_oldProjectProbes;
     QHash<QString, std::vector<ProbeConstPtr>> m_oldProductProbes;
+    std::vector<ResolvedProductPtr> m_oldProducts;
+    Set<QString> m_changedFiles;
     StoredModuleProviderInfo m_storedModuleProviderInfo;
     QVariantMap m_storedProfiles;
     FileTime m_lastResolveTime;
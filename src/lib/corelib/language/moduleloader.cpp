@@ -47,6 +47,7 @@
 #include "language.h"
 #include "modulemerger.h"
 #include "moduleproviderloader.h"
+#include "modulesearchpathindex.h"
 #include "probesresolver.h"
 #include "qualifiedid.h"
 #include "scriptengine.h"
@@ -69,6 +70,7 @@
 #include <tools/settings.h>
 #include <tools/stlutils.h>
 #include <tools/stringconstants.h>
+#include <tools/tracerecorder.h>
 
 #include <QtCore/qdebug.h>
 #include <QtCore/qdir.h>
@@ -244,6 +246,7 @@ ModuleLoader::ModuleLoader(Evaluator *evaluator, Logger &logger)
     , m_moduleProviderLoader(
         std::make_unique<ModuleProviderLoader>(m_reader.get(), m_evaluator, m_probesResolver.get(),
                                                m_logger))
+    , m_moduleSearchPathIndex(std::make_unique<ModuleSearchPathIndex>(m_logger))
 {
 }
 
@@ -292,6 +295,8 @@ ModuleLoaderResult ModuleLoader::load(const SetupProjectParameters &parameters)
     m_disabledItems.clear();
     m_reader->clearExtraSearchPathsStack();
     m_reader->setEnableTiming(parameters.logElapsedTime());
+    m_reader->setParseCacheDirectory(parameters.parseCacheDirectory());
+    m_moduleSearchPathIndex->setCacheDirectory(parameters.parseCacheDirectory());
     m_moduleProviderLoader->setProjectParameters(m_parameters);
     m_probesResolver->setProjectParameters(m_parameters);
     m_elapsedTimePrepareProducts = m_elapsedTimeHandleProducts
@@ -371,6 +376,7 @@ ModuleLoaderResult ModuleLoader::load(const SetupProjectParameters &parameters)
     result.qbsFiles = m_reader->filesRead() - m_moduleProviderLoader->tempQbsFiles();
     for (auto it = m_localProfiles.cbegin(); it != m_localProfiles.cend(); ++it)
         result.profileConfigs.remove(it.key());
+    m_moduleSearchPathIndex->store();
     printProfilingInfo();
     return result;
 }
@@ -1219,6 +1225,7 @@ void ModuleLoader::prepareProduct(ProjectContext *projectContext, Item *productI
 {
     AccumulatingTimer timer(m_parameters.logElapsedTime()
                             ? &m_elapsedTimePrepareProducts : nullptr);
+    TraceScope traceScope("module loading");
     checkCancelation();
     qCDebug(lcModuleLoader) << "prepareProduct" << productItem->file()->filePath();
 
@@ -1227,6 +1234,8 @@ void ModuleLoader::prepareProduct(ProjectContext *projectContext, Item *productI
     productContext.project = projectContext;
     productContext.name = m_evaluator->stringValue(productItem, StringConstants::nameProperty());
     QBS_CHECK(!productContext.name.isEmpty());
+    if (traceScope.isActive())
+        traceScope.setName(Tr::tr("Preparing product '%1'").arg(productContext.name));
     const ItemValueConstPtr qbsItemValue = productItem->itemProperty(StringConstants::qbsModule());
     if (!!qbsItemValue && qbsItemValue->item()->hasProperty(StringConstants::profileProperty())) {
         qbsItemValue->item()->setProperty(StringConstants::nameProperty(),
@@ -1318,6 +1327,11 @@ void ModuleLoader::setupProductDependencies(ProductContext *productContext,
     }
     AccumulatingTimer timer(m_parameters.logElapsedTime()
                             ? &m_elapsedTimeProductDependencies : nullptr);
+    TraceScope traceScope("module loading");
+    if (traceScope.isActive()) {
+        traceScope.setName(Tr::tr("Setting up dependencies of product '%1'")
+                           .arg(productContext->name));
+    }
     checkCancelation();
     Item *item = productContext->item;
     qCDebug(lcModuleLoader) << "setupProductDependencies" << productContext->name
@@ -1410,6 +1424,9 @@ void ModuleLoader::handleProduct(ModuleLoader::ProductContext *productContext)
     AccumulatingTimer timer(m_parameters.logElapsedTime() ? &m_elapsedTimeHandleProducts : nullptr);
     if (productContext->info.delayedError.hasError())
         return;
+    TraceScope traceScope("module loading");
+    if (traceScope.isActive())
+        traceScope.setName(Tr::tr("Loading modules of product '%1'").arg(productContext->name));
 
     Item * const item = productContext->item;
 
@@ -1856,6 +1873,11 @@ void ModuleLoader::printProfilingInfo()
     m_logger.qbsLog(LoggerInfo, true) << "\t"
                                       << Tr::tr("Project file loading and parsing took %1.")
                                          .arg(elapsedTimeString(m_reader->elapsedTime()));
+    if (m_reader->isParseCacheEnabled()) {
+        m_logger.qbsLog(LoggerInfo, true) << "\t\t"
+                << Tr::tr("%1 of %2 files were taken from the parse cache.")
+                   .arg(m_reader->parseCacheHits()).arg(m_reader->filesRead().size());
+    }
     m_logger.qbsLog(LoggerInfo, true) << "\t"
                                       << Tr::tr("Preparing products took %1.")
                                          .arg(elapsedTimeString(m_elapsedTimePrepareProducts));
@@ -3041,6 +3063,7 @@ Item *ModuleLoader::searchAndLoadModuleFile(ProductContext *productContext,
         if (result.providerAddedSearchPaths) {
             qCDebug(lcModuleLoader) << "Re-checking for module" << moduleName.toString()
                                     << "with newly added search paths from module provider";
+            m_moduleSearchPathIndex->recheckDirectories();
             existingPaths = findExistingModulePaths(m_reader->allSearchPaths(), moduleName);
         }
     }
@@ -3105,11 +3128,8 @@ Item *ModuleLoader::searchAndLoadModuleFile(ProductContext *productContext,
 QStringList &ModuleLoader::getModuleFileNames(const QString &dirPath)
 {
     QStringList &moduleFileNames = m_moduleDirListCache[dirPath];
-    if (moduleFileNames.empty()) {
-        QDirIterator dirIter(dirPath, StringConstants::qbsFileWildcards());
-        while (dirIter.hasNext())
-            moduleFileNames += dirIter.next();
-    }
+    if (moduleFileNames.empty())
+        moduleFileNames = m_moduleSearchPathIndex->moduleFiles(dirPath);
     return moduleFileNames;
 }
 
@@ -3508,22 +3528,9 @@ Item *ModuleLoader::wrapInProjectIfNecessary(Item *item)
 QString ModuleLoader::findExistingModulePath(const QString &searchPath,
         const QualifiedId &moduleName)
 {
-    // isFileCaseCorrect is a very expensive call on macOS, so we cache the value for the
-    // modules and search paths we've already processed
-    auto &moduleInfo = m_existingModulePathCache[{searchPath, moduleName}];
-    if (moduleInfo)
-        return *moduleInfo;
-
-    QString dirPath = searchPath + QStringLiteral("/modules");
-
-    for (const QString &moduleNamePart : moduleName) {
-        dirPath = FileInfo::resolvePath(dirPath, moduleNamePart);
-        if (!FileInfo::exists(dirPath) || !FileInfo::isFileCaseCorrect(dirPath)) {
-            return *(moduleInfo = QString());
-        }
-    }
-
-    return *(moduleInfo = dirPath);
+    // The index compares names against directory listings, so the expensive
+    // FileInfo::isFileCaseCorrect() is not needed.
+    return m_moduleSearchPathIndex->moduleDirectory(searchPath, moduleName);
 }
 
 QStringList ModuleLoader::findExistingModulePaths(
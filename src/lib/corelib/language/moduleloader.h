@@ -74,6 +74,7 @@ class Evaluator;
 class Item;
 class ItemReader;
 class ModuleProviderLoader;
+class ModuleSearchPathIndex;
 class ProbesResolver;
 class ProgressObserver;
 class QualifiedId;
@@ -391,8 +392,8 @@ private:
     Evaluator *m_evaluator;
     const std::unique_ptr<ProbesResolver> m_probesResolver;
     const std::unique_ptr<ModuleProviderLoader> m_moduleProviderLoader;
+    const std::unique_ptr<ModuleSearchPathIndex> m_moduleSearchPathIndex;
     QMap<QString, QStringList> m_moduleDirListCache;
-    QHash<std::pair<QString, QualifiedId>, std::optional<QString>> m_existingModulePathCache;
 
     // The keys are file paths, the values are module prototype items accompanied by a profile.
     std::unordered_map<QString, std::vector<std::pair<Item *, QString>>> m_modulePrototypes;
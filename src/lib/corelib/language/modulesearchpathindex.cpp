@@ -0,0 +1,251 @@
+/****************************************************************************
+**
+** Copyright (C) 2022 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of Qbs.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-2.0.html and
+** https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#include "modulesearchpathindex.h"
+
+#include "parsecache.h"
+#include "qualifiedid.h"
+
+#include <api/languageinfo.h>
+#include <logging/categories.h>
+#include <tools/error.h>
+#include <tools/fileinfo.h>
+#include <tools/stringconstants.h>
+#include <tools/version.h>
+
+#include <QtCore/qcryptographichash.h>
+#include <QtCore/qdatastream.h>
+#include <QtCore/qdir.h>
+#include <QtCore/qfile.h>
+#include <QtCore/qfileinfo.h>
+#include <QtCore/qsavefile.h>
+
+namespace qbs {
+namespace Internal {
+
+static const char moduleSearchPathIndexMagic[] = "QBSMODULEINDEX-1";
+
+// In seconds. Enough for all file systems we know of, FAT being the coarsest one.
+static const int timestampGranularity = 2;
+
+static QString modulesDirectory(const QString &searchPath)
+{
+    return searchPath + QStringLiteral("/modules");
+}
+
+/*!
+ * Returns the directory below \a searchPath that contains the files for the module
+ * \a moduleName, or an empty string if there is no such directory. As in the file system
+ * listings, the names are compared case-sensitively.
+ */
+QString ModuleSearchPathIndex::moduleDirectory(const QString &searchPath,
+                                               const QualifiedId &moduleName)
+{
+    QString dirPath = modulesDirectory(searchPath);
+    if (!directory(searchPath, dirPath).lastModified.isValid())
+        return {};
+    for (const QString &moduleNamePart : moduleName) {
+        if (!directory(searchPath, dirPath).subDirectories.contains(moduleNamePart))
+            return {};
+        dirPath = FileInfo::resolvePath(dirPath, moduleNamePart);
+    }
+
+    // Make sure the entry of the module directory itself is up to date.
+    return directory(searchPath, dirPath).lastModified.isValid() ? dirPath : QString();
+}
+
+/*!
+ * Returns the full paths of the .qbs files in \a moduleDirectory, which must have been
+ * returned by moduleDirectory().
+ */
+QStringList ModuleSearchPathIndex::moduleFiles(const QString &moduleDirectory) const
+{
+    const auto it = m_directories.constFind(moduleDirectory);
+    if (it == m_directories.constEnd())
+        return {};
+    QStringList filePaths;
+    filePaths.reserve(it->moduleFiles.size());
+    for (const QString &fileName : it->moduleFiles)
+        filePaths << moduleDirectory + QLatin1Char('/') + fileName;
+    return filePaths;
+}
+
+/*!
+ * Makes the next lookups compare the directory timestamps again. To be called when
+ * something might have created modules in an indexed directory, e.g. a module provider.
+ */
+void ModuleSearchPathIndex::recheckDirectories()
+{
+    for (Directory &dir : m_directories)
+        dir.checked = false;
+}
+
+const ModuleSearchPathIndex::Directory &ModuleSearchPathIndex::directory(
+        const QString &searchPath, const QString &dirPath)
+{
+    if (!m_loadedSearchPaths.contains(searchPath))
+        load(searchPath);
+    Directory &dir = m_directories[dirPath];
+    if (dir.checked)
+        return dir;
+    dir.checked = true;
+    const FileInfo fi(dirPath);
+    const FileTime lastModified = fi.exists() && fi.isDir() ? fi.lastModified() : FileTime();
+    if (lastModified == dir.lastModified && !dir.racy)
+        return dir;
+
+    qCDebug(lcModuleLoader) << "indexing module directory" << dirPath;
+    dir.lastModified = lastModified;
+    dir.subDirectories.clear();
+    dir.moduleFiles.clear();
+    dir.racy = lastModified.isValid()
+            && lastModified.addSeconds(timestampGranularity) >= FileTime::currentTime();
+    if (lastModified.isValid()) {
+        const QFileInfoList entries = QDir(dirPath).entryInfoList(
+                    QDir::AllDirs | QDir::Files | QDir::NoDotAndDotDot, QDir::Name);
+        for (const QFileInfo &entry : entries) {
+            if (entry.isDir())
+                dir.subDirectories << entry.fileName();
+            else if (QDir::match(StringConstants::qbsFileWildcards(), entry.fileName()))
+                dir.moduleFiles << entry.fileName();
+        }
+    }
+    m_changedSearchPaths.insert(searchPath);
+    return dir;
+}
+
+QString ModuleSearchPathIndex::indexFilePath(const QString &searchPath) const
+{
+    QCryptographicHash hash(QCryptographicHash::Sha256);
+    hash.addData(LanguageInfo::qbsVersion().toString().toUtf8());
+    hash.addData(QDir::cleanPath(searchPath).toUtf8());
+    const QString hexKey = QString::fromLatin1(hash.result().toHex());
+    return m_cacheDirectory + QStringLiteral("/module-index/") + hexKey;
+}
+
+void ModuleSearchPathIndex::load(const QString &searchPath)
+{
+    m_loadedSearchPaths.insert(searchPath);
+    if (m_cacheDirectory.isEmpty())
+        return;
+    QFile file(indexFilePath(searchPath));
+    if (!file.open(QIODevice::ReadOnly))
+        return;
+    QDataStream stream(&file);
+    stream.setVersion(QDataStream::Qt_4_8);
+    QByteArray magic;
+    QString storedSearchPath;
+    QByteArray record;
+    QByteArray checksum;
+    stream >> magic >> storedSearchPath >> record >> checksum;
+    if (stream.status() != QDataStream::Ok || magic != moduleSearchPathIndexMagic
+            || storedSearchPath != searchPath
+            || checksum != QCryptographicHash::hash(record, QCryptographicHash::Sha1)) {
+        qCDebug(lcModuleLoader) << "ignoring damaged module index" << file.fileName();
+        return;
+    }
+
+    QHash<QString, Directory> directories;
+    try {
+        PersistentPool pool(m_logger);
+        pool.setupRecordReadStream(record);
+        pool.load(directories);
+    } catch (const ErrorInfo &error) {
+        qCDebug(lcModuleLoader) << "failed to load module index" << error.toString();
+        return;
+    }
+    ParseCache::markUsed(file.fileName());
+    for (auto it = directories.cbegin(); it != directories.cend(); ++it) {
+        if (!m_directories.contains(it.key()))
+            m_directories.insert(it.key(), it.value());
+    }
+}
+
+/*!
+ * Writes the information about the search paths for which something was indexed anew.
+ * Entries are written to a temporary file that is then renamed, so concurrent readers
+ * never see partial data.
+ */
+void ModuleSearchPathIndex::store()
+{
+    if (m_cacheDirectory.isEmpty()) {
+        m_changedSearchPaths.clear();
+        return;
+    }
+    for (const QString &searchPath : qAsConst(m_changedSearchPaths)) {
+        const QString modulesDirPath = modulesDirectory(searchPath);
+        const QString dirPathPrefix = modulesDirPath + QLatin1Char('/');
+        QHash<QString, Directory> directories;
+        for (auto it = m_directories.cbegin(); it != m_directories.cend(); ++it) {
+            if (it->racy)
+                continue; // Makes the next process list it again.
+            if (it.key() == modulesDirPath || it.key().startsWith(dirPathPrefix))
+                directories.insert(it.key(), it.value());
+        }
+        QByteArray record;
+        try {
+            PersistentPool pool(m_logger);
+            pool.setupRecordWriteStream();
+            pool.store(directories);
+            record = pool.takeRecord();
+        } catch (const ErrorInfo &error) {
+            qCDebug(lcModuleLoader) << "failed to serialize module index" << error.toString();
+            continue;
+        }
+
+        const QString filePath = indexFilePath(searchPath);
+        if (!QDir().mkpath(QFileInfo(filePath).path()))
+            continue;
+        QSaveFile file(filePath);
+        if (!file.open(QIODevice::WriteOnly))
+            continue;
+        QDataStream stream(&file);
+        stream.setVersion(QDataStream::Qt_4_8);
+        stream << QByteArray(moduleSearchPathIndexMagic) << searchPath << record
+               << QCryptographicHash::hash(record, QCryptographicHash::Sha1);
+        if (stream.status() != QDataStream::Ok || !file.commit()) {
+            qCDebug(lcModuleLoader) << "failed to write module index" << filePath
+                                    << file.errorString();
+        }
+    }
+    m_changedSearchPaths.clear();
+}
+
+} // namespace Internal
+} // namespace qbs
@@ -0,0 +1,107 @@
+/****************************************************************************
+**
+** Copyright (C) 2022 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of Qbs.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-2.0.html and
+** https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#ifndef QBS_MODULESEARCHPATHINDEX_H
+#define QBS_MODULESEARCHPATHINDEX_H
+
+#include <tools/filetime.h>
+#include <tools/persistence.h>
+#include <tools/set.h>
+
+#include <QtCore/qhash.h>
+#include <QtCore/qstring.h>
+#include <QtCore/qstringlist.h>
+
+namespace qbs {
+namespace Internal {
+class Logger;
+class QualifiedId;
+
+/*
+ * Knows which directories and module files exist below the "modules" directories of
+ * search paths, so that looking up a module does not need to touch the file system
+ * beyond checking the timestamps of the directories involved. A directory is only listed
+ * again if its timestamp has changed, or if it was listed so soon after a change that
+ * a further change might not have touched the timestamp. If a cache directory is set,
+ * the information about each search path is stored there and shared between processes
+ * and build directories, leaving out the directories of the latter kind. Loading and
+ * storing fail silently.
+ */
+class ModuleSearchPathIndex
+{
+public:
+    explicit ModuleSearchPathIndex(Logger &logger) : m_logger(logger) {}
+
+    void setCacheDirectory(const QString &directory) { m_cacheDirectory = directory; }
+
+    QString moduleDirectory(const QString &searchPath, const QualifiedId &moduleName);
+    QStringList moduleFiles(const QString &moduleDirectory) const;
+    void recheckDirectories();
+    void store();
+
+private:
+    struct Directory
+    {
+        template<PersistentPool::OpType opType> void completeSerializationOp(PersistentPool &pool)
+        {
+            pool.serializationOp<opType>(lastModified, subDirectories, moduleFiles);
+        }
+
+        FileTime lastModified; // Invalid if the directory does not exist.
+        QStringList subDirectories;
+        QStringList moduleFiles;
+        bool checked = false; // Whether the timestamp was compared in this process.
+        bool racy = false; // Whether the timestamp is too recent to vouch for the listing.
+    };
+
+    const Directory &directory(const QString &searchPath, const QString &dirPath);
+    void load(const QString &searchPath);
+    QString indexFilePath(const QString &searchPath) const;
+
+    Logger &m_logger;
+    QString m_cacheDirectory;
+    QHash<QString, Directory> m_directories;
+    Set<QString> m_loadedSearchPaths;
+    Set<QString> m_changedSearchPaths;
+};
+
+} // namespace Internal
+} // namespace qbs
+
+#endif // QBS_MODULESEARCHPATHINDEX_H
@@ -0,0 +1,195 @@
+/****************************************************************************
+**
+** Copyright (C) 2022 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of Qbs.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-2.0.html and
+** https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#include "parsecache.h"
+
+#include <api/languageinfo.h>
+#include <logging/categories.h>
+#include <tools/version.h>
+
+#include <QtCore/qcryptographichash.h>
+#include <QtCore/qdatetime.h>
+#include <QtCore/qdir.h>
+#include <QtCore/qdiriterator.h>
+#include <QtCore/qfile.h>
+#include <QtCore/qfileinfo.h>
+#include <QtCore/qlockfile.h>
+#include <QtCore/qsavefile.h>
+
+#include <algorithm>
+#include <vector>
+
+namespace qbs {
+namespace Internal {
+
+// Must be changed whenever the format of the cached data changes, including changes
+// within the same qbs version.
+static const char parseCacheFormatVersion[] = "QBSPARSECACHE-1";
+
+static QString lockFileName() { return QStringLiteral("lock"); }
+static QString pruneStampFileName() { return QStringLiteral("last-pruned"); }
+
+QByteArray ParseCache::entryKey(FileType fileType, const QString &sourceCode)
+{
+    QCryptographicHash hash(QCryptographicHash::Sha256);
+    hash.addData(parseCacheFormatVersion);
+    hash.addData(LanguageInfo::qbsVersion().toString().toUtf8());
+    hash.addData(fileType == FileType::Qbs ? "qbs" : "js");
+    hash.addData(reinterpret_cast<const char *>(sourceCode.constData()),
+                 sourceCode.size() * int(sizeof(QChar)));
+    return hash.result();
+}
+
+QString ParseCache::entryFilePath(const QByteArray &key) const
+{
+    const QString hexKey = QString::fromLatin1(key.toHex());
+    return m_directory + QLatin1Char('/') + hexKey.left(2) + QLatin1Char('/') + hexKey;
+}
+
+bool ParseCache::lookup(const QByteArray &key, QByteArray *data) const
+{
+    if (!isEnabled())
+        return false;
+    QFile entry(entryFilePath(key));
+    if (!entry.open(QIODevice::ReadOnly))
+        return false;
+    *data = entry.readAll();
+    if (entry.error() != QFileDevice::NoError)
+        return false;
+    markUsed(entry.fileName());
+    return true;
+}
+
+/*!
+ * Entries are written to a temporary file that is then renamed, so concurrent readers
+ * never see partial data.
+ */
+void ParseCache::store(const QByteArray &key, const QByteArray &data) const
+{
+    if (!isEnabled())
+        return;
+    const QString filePath = entryFilePath(key);
+    if (!QDir().mkpath(QFileInfo(filePath).path()))
+        return;
+    QSaveFile entry(filePath);
+    if (!entry.open(QIODevice::WriteOnly) || entry.write(data) != data.size()
+            || !entry.commit()) {
+        qCDebug(lcModuleLoader) << "failed to write parse cache entry" << filePath
+                                << entry.errorString();
+    }
+}
+
+/*!
+ * The modification time of an entry serves as its "last used" time for pruning.
+ * It is updated at most once a day, so that lookups do not normally write anything.
+ */
+void ParseCache::markUsed(const QString &filePath)
+{
+    const QDateTime now = QDateTime::currentDateTimeUtc();
+    if (QFileInfo(filePath).lastModified().secsTo(now) < 24 * 60 * 60)
+        return;
+    QFile file(filePath);
+    if (file.open(QIODevice::ReadWrite | QIODevice::ExistingOnly))
+        file.setFileTime(now, QFileDevice::FileModificationTime);
+}
+
+struct ParseCacheEntryInfo
+{
+    QString filePath;
+    QDateTime lastUsed;
+    qint64 size = 0;
+};
+
+/*!
+ * Removes the least recently used files in \a directory until their total size is
+ * comfortably below \a maxSize. This covers the module indexes stored in the same
+ * directory. Collecting the file sizes takes a moment for large caches, so this is done
+ * at most once per hour, and not at all while another process is doing it.
+ */
+void ParseCache::prune(const QString &directory, qint64 maxSize)
+{
+    if (directory.isEmpty() || maxSize <= 0 || !QFileInfo::exists(directory))
+        return;
+    const QString stampFilePath = directory + QLatin1Char('/') + pruneStampFileName();
+    const QDateTime now = QDateTime::currentDateTimeUtc();
+    const QFileInfo stampInfo(stampFilePath);
+    if (stampInfo.exists() && stampInfo.lastModified().secsTo(now) < 60 * 60)
+        return;
+    QLockFile lockFile(directory + QLatin1Char('/') + lockFileName());
+    if (!lockFile.tryLock(0))
+        return;
+    QFile stampFile(stampFilePath);
+    if (!stampFile.open(QIODevice::WriteOnly))
+        return;
+    stampFile.setFileTime(now, QFileDevice::FileModificationTime);
+    stampFile.close();
+
+    const QString cleanDirectory = QDir::cleanPath(directory);
+    std::vector<ParseCacheEntryInfo> entries;
+    qint64 totalSize = 0;
+    QDirIterator it(directory, QDir::Files | QDir::Hidden, QDirIterator::Subdirectories);
+    while (it.hasNext()) {
+        it.next();
+        const QFileInfo &fi = it.fileInfo();
+        if (QDir::cleanPath(fi.path()) == cleanDirectory)
+            continue; // The lock and stamp files.
+        entries.push_back({fi.filePath(), fi.lastModified(), fi.size()});
+        totalSize += fi.size();
+    }
+    if (totalSize <= maxSize)
+        return;
+
+    std::sort(entries.begin(), entries.end(), [](const auto &e1, const auto &e2) {
+        return e1.lastUsed < e2.lastUsed;
+    });
+    const qint64 targetSize = maxSize / 10 * 9;
+    for (const ParseCacheEntryInfo &entry : entries) {
+        if (totalSize <= targetSize)
+            break;
+        if (!QFile::remove(entry.filePath)) {
+            qCDebug(lcModuleLoader) << "cannot remove parse cache entry" << entry.filePath;
+            continue;
+        }
+        totalSize -= entry.size;
+    }
+    qCDebug(lcModuleLoader) << "pruned parse cache to" << totalSize << "bytes";
+}
+
+} // namespace Internal
+} // namespace qbs
@@ -0,0 +1,81 @@
+/****************************************************************************
+**
+** Copyright (C) 2022 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of Qbs.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-2.0.html and
+** https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#ifndef QBS_PARSECACHE_H
+#define QBS_PARSECACHE_H
+
+#include <QtCore/qbytearray.h>
+#include <QtCore/qstring.h>
+
+namespace qbs {
+namespace Internal {
+
+/*
+ * A per-user store for the results of parsing .qbs and .js files, shared between processes
+ * and build directories. Entries are addressed by a hash of the source code, the qbs
+ * version and the version of the entry format, so they never become stale. Lookups and
+ * stores fail silently; the caller simply parses the file in that case. The size of the
+ * cache is bounded by prune(), which removes the entries that were used least recently.
+ */
+class ParseCache
+{
+public:
+    enum class FileType { Qbs, Js };
+
+    void setDirectory(const QString &directory) { m_directory = directory; }
+    QString directory() const { return m_directory; }
+    bool isEnabled() const { return !m_directory.isEmpty(); }
+
+    static QByteArray entryKey(FileType fileType, const QString &sourceCode);
+    bool lookup(const QByteArray &key, QByteArray *data) const;
+    void store(const QByteArray &key, const QByteArray &data) const;
+
+    static void markUsed(const QString &filePath);
+    static void prune(const QString &directory, qint64 maxSize);
+
+private:
+    QString entryFilePath(const QByteArray &key) const;
+
+    QString m_directory;
+};
+
+} // namespace Internal
+} // namespace qbs
+
+#endif // QBS_PARSECACHE_H
@@ -0,0 +1,224 @@
+/****************************************************************************
+**
+** Copyright (C) 2022 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of Qbs.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-2.0.html and
+** https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#include "probecache.h"
+
+#include "language.h"
+#include "scriptengine.h"
+
+#include <api/languageinfo.h>
+#include <logging/categories.h>
+#include <tools/error.h>
+#include <tools/fileinfo.h>
+#include <tools/filetime.h>
+#include <tools/persistence.h>
+#include <tools/version.h>
+
+#include <QtCore/qcryptographichash.h>
+#include <QtCore/qdatastream.h>
+#include <QtCore/qdir.h>
+#include <QtCore/qfile.h>
+#include <QtCore/qfileinfo.h>
+#include <QtCore/qsavefile.h>
+
+namespace qbs {
+namespace Internal {
+
+static const char probeCacheMagic[] = "QBSPROBECACHE-2";
+
+// The same checks that BuildGraphLoader does for the project as a whole.
+static bool haveQueryResultsChanged(const ScriptQueryResults &results,
+                                    const QProcessEnvironment &environment)
+{
+    for (auto it = results.canonicalFilePathResults.cbegin();
+         it != results.canonicalFilePathResults.cend(); ++it) {
+        if (QFileInfo(it.key()).canonicalFilePath() != it.value()) {
+            qCDebug(lcModuleLoader) << "Canonical file path for file" << it.key()
+                                    << "changed, cannot use probe cache entry.";
+            return true;
+        }
+    }
+    for (auto it = results.fileExistsResults.cbegin(); it != results.fileExistsResults.cend();
+         ++it) {
+        if (FileInfo(it.key()).exists() != it.value()) {
+            qCDebug(lcModuleLoader) << "Existence check for file" << it.key()
+                                    << "changed, cannot use probe cache entry.";
+            return true;
+        }
+    }
+    for (auto it = results.directoryEntriesResults.cbegin();
+         it != results.directoryEntriesResults.cend(); ++it) {
+        if (QDir(it.key().first).entryList(static_cast<QDir::Filters>(it.key().second), QDir::Name)
+                != it.value()) {
+            qCDebug(lcModuleLoader) << "Entry list for directory" << it.key().first
+                                    << static_cast<QDir::Filters>(it.key().second)
+                                    << "changed, cannot use probe cache entry.";
+            return true;
+        }
+    }
+    for (auto it = results.fileLastModifiedResults.cbegin();
+         it != results.fileLastModifiedResults.cend(); ++it) {
+        if (FileInfo(it.key()).lastModified() != it.value()) {
+            qCDebug(lcModuleLoader) << "Timestamp for file" << it.key()
+                                    << "changed, cannot use probe cache entry.";
+            return true;
+        }
+    }
+    for (auto it = results.environmentResults.cbegin(); it != results.environmentResults.cend();
+         ++it) {
+        if (environment.value(it.key()) != it.value()) {
+            qCDebug(lcModuleLoader) << "Value of environment variable" << it.key()
+                                    << "changed, cannot use probe cache entry.";
+            return true;
+        }
+    }
+    if (results.environmentComplete) {
+        const QStringList names = environment.keys();
+        for (const QString &name : names) {
+            if (!results.environmentResults.contains(name)) {
+                qCDebug(lcModuleLoader) << "Environment variable" << name
+                                        << "was added, cannot use probe cache entry.";
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+QByteArray ProbeCache::entryKey(const QString &globalId, const CodeLocation &location,
+                                const QString &configureScript,
+                                const QVariantMap &initialProperties) const
+{
+    PersistentPool pool(m_logger);
+    pool.setupRecordWriteStream();
+    pool.store(globalId, location, configureScript, initialProperties);
+    QCryptographicHash hash(QCryptographicHash::Sha256);
+    hash.addData(LanguageInfo::qbsVersion().toString().toUtf8());
+    hash.addData(pool.takeRecord());
+    return hash.result();
+}
+
+QString ProbeCache::entryFilePath(const QByteArray &key) const
+{
+    const QString hexKey = QString::fromLatin1(key.toHex());
+    return m_directory + QLatin1Char('/') + hexKey.left(2) + QLatin1Char('/') + hexKey;
+}
+
+/*!
+ * On success, the file system and environment queries that the configure script made when
+ * the entry was created are stored in \a queryResults.
+ */
+ProbeConstPtr ProbeCache::lookup(const QByteArray &key, const QProcessEnvironment &environment,
+                                 ScriptQueryResults *queryResults) const
+{
+    if (!isEnabled())
+        return {};
+    QFile entry(entryFilePath(key));
+    if (!entry.open(QIODevice::ReadOnly))
+        return {};
+    QDataStream stream(&entry);
+    stream.setVersion(QDataStream::Qt_4_8);
+    QByteArray magic;
+    QByteArray record;
+    QByteArray checksum;
+    stream >> magic >> record >> checksum;
+    if (stream.status() != QDataStream::Ok || magic != probeCacheMagic
+            || checksum != QCryptographicHash::hash(record, QCryptographicHash::Sha1)) {
+        qCDebug(lcModuleLoader) << "ignoring damaged probe cache entry" << entry.fileName();
+        return {};
+    }
+
+    PersistentPool pool(m_logger);
+    pool.setupRecordReadStream(record);
+    ProbeConstPtr probe;
+    FileTime configureTime;
+    ScriptQueryResults results;
+    pool.load(probe, configureTime, results);
+    if (!probe)
+        return {};
+    if (probe->needsReconfigure(configureTime)) {
+        qCDebug(lcModuleLoader) << "file imported by probe changed, cannot use probe cache entry";
+        return {};
+    }
+    if (haveQueryResultsChanged(results, environment))
+        return {};
+    *queryResults = std::move(results);
+    return probe;
+}
+
+/*!
+ * \a configureTime is the point in time at which the configure script started running.
+ * Entries are written to a temporary file that is then renamed, so concurrent readers
+ * never see partial data.
+ */
+void ProbeCache::store(const QByteArray &key, const ProbeConstPtr &probe,
+                       const FileTime &configureTime,
+                       const ScriptQueryResults &queryResults) const
+{
+    if (!isEnabled())
+        return;
+    QByteArray record;
+    try {
+        PersistentPool pool(m_logger);
+        pool.setupRecordWriteStream();
+        pool.store(probe, configureTime, queryResults);
+        record = pool.takeRecord();
+    } catch (const ErrorInfo &error) {
+        qCDebug(lcModuleLoader) << "failed to serialize probe cache entry" << error.toString();
+        return;
+    }
+
+    const QString filePath = entryFilePath(key);
+    if (!QDir().mkpath(QFileInfo(filePath).path()))
+        return;
+    QSaveFile entry(filePath);
+    if (!entry.open(QIODevice::WriteOnly))
+        return;
+    QDataStream stream(&entry);
+    stream.setVersion(QDataStream::Qt_4_8);
+    stream << QByteArray(probeCacheMagic) << record
+           << QCryptographicHash::hash(record, QCryptographicHash::Sha1);
+    if (stream.status() != QDataStream::Ok || !entry.commit()) {
+        qCDebug(lcModuleLoader) << "failed to write probe cache entry" << filePath
+                                << entry.errorString();
+    }
+}
+
+} // namespace Internal
+} // namespace qbs
@@ -0,0 +1,91 @@
+/****************************************************************************
+**
+** Copyright (C) 2022 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of Qbs.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-2.0.html and
+** https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#ifndef QBS_PROBECACHE_H
+#define QBS_PROBECACHE_H
+
+#include "forward_decls.h"
+
+#include <QtCore/qbytearray.h>
+#include <QtCore/qprocess.h>
+#include <QtCore/qstring.h>
+#include <QtCore/qvariant.h>
+
+namespace qbs {
+class CodeLocation;
+
+namespace Internal {
+class FileTime;
+class Logger;
+class ScriptQueryResults;
+
+/*
+ * A per-user store for the results of probes, shared between processes and build directories.
+ * Entries are addressed by a hash of the configure script's inputs, i.e. its source code and
+ * location and the values of the probe's properties. An entry is only used if the files and
+ * environment variables the configure script looked at are unchanged. Lookups and stores
+ * fail silently; the caller simply runs the configure script in that case.
+ */
+class ProbeCache
+{
+public:
+    explicit ProbeCache(Logger &logger) : m_logger(logger) {}
+
+    void setDirectory(const QString &directory) { m_directory = directory; }
+    bool isEnabled() const { return !m_directory.isEmpty(); }
+
+    QByteArray entryKey(const QString &globalId, const CodeLocation &location,
+                        const QString &configureScript,
+                        const QVariantMap &initialProperties) const;
+    ProbeConstPtr lookup(const QByteArray &key, const QProcessEnvironment &environment,
+                         ScriptQueryResults *queryResults) const;
+    void store(const QByteArray &key, const ProbeConstPtr &probe, const FileTime &configureTime,
+               const ScriptQueryResults &queryResults) const;
+
+private:
+    QString entryFilePath(const QByteArray &key) const;
+
+    QString m_directory;
+    Logger &m_logger;
+};
+
+} // namespace Internal
+} // namespace qbs
+
+#endif // QBS_PROBECACHE_H
@@ -47,6 +47,7 @@
 #include "itemreader.h"
 #include "language.h"
 #include "modulemerger.h"
+#include "probecache.h"
 #include "qualifiedid.h"
 #include "scriptengine.h"
 #include "value.h"
@@ -56,8 +57,10 @@
 #include <logging/categories.h>
 #include <logging/logger.h>
 #include <logging/translator.h>
+#include <tools/filetime.h>
 #include <tools/profiling.h>
 #include <tools/stringconstants.h>
+#include <tools/tracerecorder.h>
 
 namespace qbs {
 namespace Internal {
@@ -83,6 +86,7 @@ static QString probeGlobalId(Item *probe)
 ProbesResolver::ProbesResolver(Evaluator *evaluator, Logger &logger)
     : m_evaluator(evaluator)
     , m_logger(logger)
+    , m_probeCache(logger)
 {
 }
 
@@ -90,7 +94,8 @@ void ProbesResolver::setProjectParameters(SetupProjectParameters parameters)
 {
     m_parameters = std::move(parameters);
     m_elapsedTimeProbes = m_probesEncountered = m_probesRun = m_probesCachedCurrent
-            = m_probesCachedOld = 0;
+            = m_probesCachedOld = m_probesCachedPersistent = 0;
+    m_probeCache.setDirectory(m_parameters.probeCacheDirectory());
 }
 
 void ProbesResolver::setOldProjectProbes(const std::vector<ProbeConstPtr> &oldProbes)
@@ -123,6 +128,12 @@ void ProbesResolver::resolveProbe(ModuleLoader::ProductContext *productContext,
     const QString &probeId = probeGlobalId(probe);
     if (Q_UNLIKELY(probeId.isEmpty()))
         throw ErrorInfo(Tr::tr("Probe.id must be set."), probe->location());
+    TraceScope traceScope("probe");
+    if (traceScope.isActive()) {
+        traceScope.setName(productContext
+                           ? Tr::tr("Probe '%1' in product '%2'").arg(probeId, productContext->name)
+                           : Tr::tr("Probe '%1'").arg(probeId));
+    }
     const JSSourceValueConstPtr configureScript
             = probe->sourceProperty(StringConstants::configureProperty());
     QBS_CHECK(configureScript);
@@ -166,7 +177,27 @@ void ProbesResolver::resolveProbe(ModuleLoader::ProductContext *productContext,
         qCDebug(lcModuleLoader) << "probe results cached from earlier run";
         ++m_probesCachedOld;
     }
+    QByteArray probeCacheKey;
+    ScriptQueryResults queryResults;
+    if (!resolvedProbe && condition && m_probeCache.isEnabled()) {
+        probeCacheKey = m_probeCache.entryKey(probeId, probe->location(), sourceCode,
+                                              initialProperties);
+        if (!m_parameters.forceProbeExecution()) {
+            resolvedProbe = m_probeCache.lookup(probeCacheKey, engine->environment(),
+                                                &queryResults);
+        }
+        if (resolvedProbe) {
+            qCDebug(lcModuleLoader) << "probe results taken from probe cache";
+            ++m_probesCachedPersistent;
+
+            // The project must get re-resolved when the circumstances change that the
+            // probe's results depend on.
+            engine->addQueryResults(queryResults);
+            m_currentProbes[probe->location()] << resolvedProbe;
+        }
+    }
     std::vector<QString> importedFilesUsedInConfigure;
+    FileTime configureTime;
     if (!condition) {
         qCDebug(lcModuleLoader) << "Probe disabled; skipping";
     } else if (!resolvedProbe) {
@@ -181,7 +212,13 @@ void ProbesResolver::resolveProbe(ModuleLoader::ProductContext *productContext,
             configureScope.setProperty(b.first, b.second);
         engine->currentContext()->pushScope(configureScope);
         engine->clearRequestedProperties();
-        QScriptValue sv = engine->evaluate(configureScript->sourceCodeForEvaluation());
+        configureTime = FileTime::currentTime();
+        QScriptValue sv;
+        {
+            const QueryResultsRecording recording(
+                        engine, probeCacheKey.isEmpty() ? nullptr : &queryResults);
+            sv = engine->evaluate(configureScript->sourceCodeForEvaluation());
+        }
         engine->currentContext()->popScope();
         engine->currentContext()->popScope();
         engine->currentContext()->popScope();
@@ -219,6 +256,8 @@ void ProbesResolver::resolveProbe(ModuleLoader::ProductContext *productContext,
                                       sourceCode, properties, initialProperties,
                                       importedFilesUsedInConfigure);
         m_currentProbes[probe->location()] << resolvedProbe;
+        if (!probeCacheKey.isEmpty())
+            m_probeCache.store(probeCacheKey, resolvedProbe, configureTime, queryResults);
     }
     productContext->info.probes << resolvedProbe;
 }
@@ -293,6 +332,11 @@ void ProbesResolver::printProfilingInfo()
                       "%3 re-used from current run, %4 re-used from earlier run.")
                .arg(m_probesEncountered).arg(m_probesRun).arg(m_probesCachedCurrent)
                .arg(m_probesCachedOld);
+    if (m_probeCache.isEnabled()) {
+        m_logger.qbsLog(LoggerInfo, true) << "\t\t"
+                << Tr::tr("%1 probes were taken from the probe cache.")
+                   .arg(m_probesCachedPersistent);
+    }
 }
 
 } // namespace Internal
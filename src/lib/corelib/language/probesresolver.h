@@ -42,6 +42,7 @@
 #define PROBESRESOLVER_H
 
 #include "moduleloader.h"
+#include "probecache.h"
 
 namespace qbs {
 namespace Internal {
@@ -76,6 +77,7 @@ private:
     quint64 m_probesRun = 0;
     quint64 m_probesCachedCurrent = 0;
     quint64 m_probesCachedOld = 0;
+    quint64 m_probesCachedPersistent = 0;
 
     SetupProjectParameters m_parameters;
     Evaluator *m_evaluator = nullptr;
@@ -84,6 +86,7 @@ private:
     QHash<QString, std::vector<ProbeConstPtr>> m_oldProductProbes;
     FileTime m_lastResolveTime;
     QHash<CodeLocation, std::vector<ProbeConstPtr>> m_currentProbes;
+    ProbeCache m_probeCache;
 };
 
 } // namespace Internal
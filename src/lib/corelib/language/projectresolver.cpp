@@ -53,9 +53,11 @@
 #include <jsextensions/jsextensions.h>
 #include <jsextensions/moduleproperties.h>
 #include <logging/categories.h>
+#include <logging/ilogsink.h>
 #include <logging/translator.h>
 #include <tools/error.h>
 #include <tools/fileinfo.h>
+#include <tools/functionrunnable.h>
 #include <tools/joblimits.h>
 #include <tools/jsliterals.h>
 #include <tools/profiling.h>
@@ -66,13 +68,18 @@
 #include <tools/setupprojectparameters.h>
 #include <tools/stlutils.h>
 #include <tools/stringconstants.h>
+#include <tools/tracerecorder.h>
 
 #include <QtCore/qdir.h>
 #include <QtCore/qregularexpression.h>
+#include <QtCore/qthreadpool.h>
 
 #include <algorithm>
+#include <atomic>
+#include <functional>
 #include <memory>
 #include <queue>
+#include <unordered_set>
 
 namespace qbs {
 namespace Internal {
@@ -114,6 +121,28 @@ struct ProjectResolver::ModuleContext
 
 class CancelException { };
 
+namespace {
+// Messages must appear in the right order and warnings must be recorded in the project,
+// so products whose evaluation has any output are evaluated again in the normal way.
+class OutputDetectingLogSink : public ILogSink
+{
+public:
+    explicit OutputDetectingLogSink(LoggerLevel level) { setLogLevel(level); }
+
+    bool hasOutput() const { return m_hasOutput; }
+    void clearOutput() { m_hasOutput = false; }
+
+private:
+    void doPrintWarning(const ErrorInfo &) override { m_hasOutput = true; }
+    void doPrintMessage(LoggerLevel, const QString &, const QString &) override
+    {
+        m_hasOutput = true;
+    }
+
+    bool m_hasOutput = false;
+};
+} // namespace
+
 
 ProjectResolver::ProjectResolver(Evaluator *evaluator, ModuleLoaderResult loadResult,
         SetupProjectParameters setupParameters, Logger &logger)
@@ -134,6 +163,21 @@ void ProjectResolver::setProgressObserver(ProgressObserver *observer)
     m_progressObserver = observer;
 }
 
+/*!
+ * Lets the resolver take the evaluated properties of products from \a oldProducts if none
+ * of the project files that the respective product is made of is in \a changedFiles.
+ * The caller must make sure that nothing else that the values of product and module properties
+ * can depend on has changed since \a oldProducts were resolved.
+ */
+void ProjectResolver::setOldProducts(const std::vector<ResolvedProductPtr> &oldProducts,
+                                     const Set<QString> &changedFiles)
+{
+    m_oldProducts.clear();
+    for (const ResolvedProductPtr &product : oldProducts)
+        m_oldProducts.insert(product->uniqueName(), product);
+    m_changedFiles = changedFiles;
+}
+
 static void checkForDuplicateProductNames(const TopLevelProjectConstPtr &project)
 {
     const std::vector<ResolvedProductPtr> allProducts = project->allProducts();
@@ -243,6 +287,8 @@ TopLevelProjectPtr ProjectResolver::resolveTopLevelProject()
     ProjectContext projectContext;
     projectContext.project = project;
 
+    reuseUnchangedProductConfigs();
+    evaluateProductConfigsConcurrently();
     resolveProject(m_loadResult.root, &projectContext);
     ErrorInfo accumulatedErrors;
     for (const ErrorInfo &e : m_queuedErrors)
@@ -258,6 +304,7 @@ TopLevelProjectPtr ProjectResolver::resolveTopLevelProject()
     project->fileLastModifiedResults = m_engine->fileLastModifiedResults();
     project->environment = m_engine->environment();
     project->buildSystemFiles.unite(m_engine->imports());
+    project->buildSystemFiles.unite(m_importsFromOtherEngines);
     makeSubProjectNamesUniqe(project);
     resolveProductDependencies(projectContext);
     collectExportedProductDependencies();
@@ -435,6 +482,9 @@ void ProjectResolver::resolveProductFully(Item *item, ProjectContext *projectCon
     m_productItemMap.insert(product, item);
     projectContext->project->products.push_back(product);
     product->name = m_evaluator->stringValue(item, StringConstants::nameProperty());
+    TraceScope traceScope("resolving");
+    if (traceScope.isActive())
+        traceScope.setName(Tr::tr("Resolving product '%1'").arg(product->name));
 
     // product->buildDirectory() isn't valid yet, because the productProperties map is not ready.
     m_productContext->buildDirectory
@@ -457,7 +507,9 @@ void ProjectResolver::resolveProductFully(Item *item, ProjectContext *projectCon
         pi.delayedError.clear();
         throw errorInfo;
     }
-    gatherProductTypes(product.get(), item);
+    const auto config = m_productConfigs.find(item);
+    product->fileTags = config != m_productConfigs.cend() ? config->second.types
+                                                          : gatherProductTypes(item);
     product->targetName = m_evaluator->stringValue(item, StringConstants::targetNameProperty());
     product->sourceDirectory = m_evaluator->stringValue(
                 item, StringConstants::sourceDirectoryProperty());
@@ -587,17 +639,18 @@ void ProjectResolver::resolveModule(const QualifiedId &moduleName, Item *item, b
     m_moduleContext = oldModuleContext;
 }
 
-void ProjectResolver::gatherProductTypes(ResolvedProduct *product, Item *item)
+FileTags ProjectResolver::gatherProductTypes(Item *item)
 {
-    product->fileTags = m_evaluator->fileTagsValue(item, StringConstants::typeProperty());
+    FileTags types = m_evaluator->fileTagsValue(item, StringConstants::typeProperty());
     for (const Item::Module &m : item->modules()) {
         if (m.item->isPresentModule()) {
-            product->fileTags += m_evaluator->fileTagsValue(m.item,
+            types += m_evaluator->fileTagsValue(m.item,
                     StringConstants::additionalProductTypesProperty());
         }
     }
     item->setProperty(StringConstants::typeProperty(),
-                      VariantValue::create(sorted(product->fileTags.toStringList())));
+                      VariantValue::create(sorted(types.toStringList())));
+    return types;
 }
 
 SourceArtifactPtr ProjectResolver::createSourceArtifact(const ResolvedProductPtr &rproduct,
@@ -1484,6 +1537,12 @@ void ProjectResolver::printProfilingInfo()
                                       << Tr::tr("Resolving groups (without module property "
                                                 "evaluation) took %1.")
                                          .arg(elapsedTimeString(m_elapsedTimeGroups));
+    if (!m_oldProducts.empty()) {
+        m_logger.qbsLog(LoggerInfo, true) << "\t"
+                                          << Tr::tr("The properties of %1 products were taken "
+                                                    "from the stored build graph.")
+                                             .arg(m_reusedProductConfigCount);
+    }
 }
 
 class TempScopeSetter
@@ -1880,14 +1939,323 @@ void ProjectResolver::collectPropertiesForExportItem(const QualifiedId &moduleNa
     }
 }
 
+static void collectFilesOfValue(const ValueConstPtr &value, Set<QString> &filePaths,
+                                std::unordered_set<const Item *> &seenItems);
+
+// Gathers the files that an item, the items it consists of and its property values come from.
+static void collectFilesOfItem(const Item *item, Set<QString> &filePaths,
+                               std::unordered_set<const Item *> &seenItems)
+{
+    if (!item || !seenItems.insert(item).second)
+        return;
+    if (item->file())
+        filePaths.insert(item->file()->filePath());
+    for (const ValuePtr &value : item->properties())
+        collectFilesOfValue(value, filePaths, seenItems);
+    collectFilesOfItem(item->prototype(), filePaths, seenItems);
+    for (const Item * const child : item->children())
+        collectFilesOfItem(child, filePaths, seenItems);
+    for (const Item::Module &module : item->modules())
+        collectFilesOfItem(module.item, filePaths, seenItems);
+}
+
+static void collectFilesOfValue(const ValueConstPtr &value, Set<QString> &filePaths,
+                                std::unordered_set<const Item *> &seenItems)
+{
+    for (ValueConstPtr v = value; v; v = v->next()) {
+        if (v->type() == Value::ItemValueType) {
+            collectFilesOfItem(std::static_pointer_cast<const ItemValue>(v)->item(), filePaths,
+                               seenItems);
+        } else if (v->type() == Value::JSSourceValueType) {
+            const auto sourceValue = std::static_pointer_cast<const JSSourceValue>(v);
+            if (sourceValue->file())
+                filePaths.insert(sourceValue->file()->filePath());
+            collectFilesOfValue(sourceValue->baseValue(), filePaths, seenItems);
+            for (const JSSourceValue::Alternative &alternative : sourceValue->alternatives())
+                collectFilesOfValue(alternative.value, filePaths, seenItems);
+        }
+    }
+}
+
+static Set<QString> filesOfProduct(const Item *productItem)
+{
+    Set<QString> filePaths;
+    std::unordered_set<const Item *> seenItems;
+    collectFilesOfItem(productItem, filePaths, seenItems);
+
+    // Project properties are visible in products, but the products of a project are not
+    // relevant to each other.
+    for (const Item *project = productItem->parent(); project; project = project->parent()) {
+        for (const Item *item = project; item; item = item->prototype()) {
+            if (item->file())
+                filePaths.insert(item->file()->filePath());
+            for (const ValuePtr &value : item->properties())
+                collectFilesOfValue(value, filePaths, seenItems);
+        }
+    }
+    return filePaths;
+}
+
 void ProjectResolver::createProductConfig(ResolvedProduct *product)
 {
+    product->buildSystemFiles = filesOfProduct(m_productContext->item);
+    const auto config = m_productConfigs.find(m_productContext->item);
+    if (config != m_productConfigs.cend()) {
+        product->moduleProperties->setValue(config->second.moduleProperties);
+        product->productProperties = config->second.productProperties;
+        product->propertyDependencies = config->second.propertyDependencies;
+        m_evaluator->addPropertyDependencies(config->second.propertyDependencies);
+        m_productConfigs.erase(config);
+        return;
+    }
+
+    // The dependencies are recorded per product, so the product can be taken over as a whole
+    // when re-resolving later.
+    const PropertyDependencies otherDependencies = m_evaluator->propertyDependencies();
+    m_evaluator->clearPropertyDependencies();
     EvalCacheEnabler cachingEnabler(m_evaluator);
     m_evaluator->setPathPropertiesBaseDir(m_productContext->product->sourceDirectory);
     product->moduleProperties->setValue(evaluateModuleValues(m_productContext->item));
     product->productProperties = evaluateProperties(m_productContext->item, m_productContext->item,
                                                     QVariantMap(), true, true);
     m_evaluator->clearPathPropertiesBaseDir();
+    product->propertyDependencies = m_evaluator->propertyDependencies();
+    m_evaluator->addPropertyDependencies(otherDependencies);
+}
+
+static bool probesHaveSameResults(const std::vector<ProbeConstPtr> &probes,
+                                  const std::vector<ProbeConstPtr> &oldProbes)
+{
+    return probes.size() == oldProbes.size()
+            && std::equal(probes.cbegin(), probes.cend(), oldProbes.cbegin(),
+                          [](const ProbeConstPtr &p1, const ProbeConstPtr &p2) {
+        return p1->globalId() == p2->globalId() && p1->condition() == p2->condition()
+                && p1->initialProperties() == p2->initialProperties()
+                && p1->properties() == p2->properties();
+    });
+}
+
+// When re-resolving because some project files changed, products that are made from the same
+// set of files as before and none of which has changed get the same module and product
+// properties as before, so these are taken from the stored project instead of being evaluated
+// again. Products that depend on a product that is affected by a change are affected as well,
+// as they see its exported properties. The results are picked up by createProductConfig().
+void ProjectResolver::reuseUnchangedProductConfigs()
+{
+    if (m_oldProducts.empty())
+        return;
+
+    struct Candidate
+    {
+        Item *item = nullptr;
+        const ModuleLoaderResult::ProductInfo *productInfo = nullptr;
+        QString name;
+        ResolvedProductConstPtr oldProduct;
+    };
+    std::vector<Candidate> candidates;
+    Set<QString> affectedProducts;
+    for (const auto &[item, productInfo] : m_loadResult.productInfos) {
+        checkCancelation();
+        Candidate candidate;
+        candidate.item = item;
+        candidate.productInfo = &productInfo;
+        try {
+            candidate.name = m_evaluator->stringValue(item, StringConstants::nameProperty());
+            candidate.oldProduct = m_oldProducts.value(ResolvedProduct::uniqueName(
+                    candidate.name, m_evaluator->stringValue(
+                        item, StringConstants::multiplexConfigurationIdProperty())));
+        } catch (const ErrorInfo &) {
+            return; // We cannot tell which products depend on this one.
+        }
+        const bool isAffected = !candidate.oldProduct || !candidate.oldProduct->enabled
+                || productInfo.delayedError.hasError()
+                || !probesHaveSameResults(productInfo.probes, candidate.oldProduct->probes)
+                || candidate.oldProduct->buildSystemFiles != filesOfProduct(item)
+                || candidate.oldProduct->buildSystemFiles.intersects(m_changedFiles);
+        if (isAffected)
+            affectedProducts.insert(candidate.name);
+        else
+            candidates.push_back(std::move(candidate));
+    }
+
+    for (bool newlyAffected = true; newlyAffected;) {
+        newlyAffected = false;
+        for (auto it = candidates.begin(); it != candidates.end();) {
+            const auto dependsOnAffectedProduct
+                    = [&affectedProducts](const ModuleLoaderResult::ProductInfo::Dependency &d) {
+                return affectedProducts.contains(d.name);
+            };
+            if (any_of(it->productInfo->usedProducts, dependsOnAffectedProduct)) {
+                affectedProducts.insert(it->name);
+                it = candidates.erase(it);
+                newlyAffected = true;
+            } else {
+                ++it;
+            }
+        }
+    }
+
+    for (const Candidate &candidate : candidates) {
+        ProductConfig config;
+        try {
+            config.types = gatherProductTypes(candidate.item);
+        } catch (const ErrorInfo &) {
+            continue;
+        }
+        config.moduleProperties = candidate.oldProduct->moduleProperties->value();
+        config.productProperties = candidate.oldProduct->productProperties;
+        config.propertyDependencies = candidate.oldProduct->propertyDependencies;
+        m_productConfigs.insert(std::make_pair(candidate.item, std::move(config)));
+        ++m_reusedProductConfigCount;
+    }
+    qCDebug(lcProjectResolver) << "re-using the properties of" << m_reusedProductConfigCount
+                               << "products, re-evaluating" << affectedProducts.size();
+}
+
+// Evaluating the module and product properties is where most of the time is spent when
+// resolving a product. It does not depend on other products having been resolved, as the
+// item tree is complete at this point, so we can do it for all products at once, using
+// one script engine per thread. The results are picked up by createProductConfig().
+// Products for which anything goes wrong here are handled the normal way later, so that
+// errors and warnings are reported in the usual order and context.
+// Note that imported JavaScript files are not shared between products anymore in this mode.
+void ProjectResolver::evaluateProductConfigsConcurrently()
+{
+    const int maxJobCount = m_setupParams.maxResolverJobCount();
+    if (maxJobCount <= 1)
+        return;
+
+    struct Task
+    {
+        Item *item = nullptr;
+        ProductConfig config;
+        bool done = false;
+    };
+
+    // Modules can refer to the product type, which includes the additional product types
+    // contributed by modules, so we have to set it up on the items first.
+    std::vector<Task> tasks;
+    for (auto &[item, productInfo] : m_loadResult.productInfos) {
+        checkCancelation();
+        if (productInfo.delayedError.hasError() || m_productConfigs.count(item) > 0)
+            continue;
+        Task task;
+        task.item = item;
+        try {
+            task.config.types = gatherProductTypes(item);
+        } catch (const ErrorInfo &) {
+            continue;
+        }
+        tasks.push_back(std::move(task));
+    }
+    if (tasks.size() < 2)
+        return;
+
+    struct EngineResults
+    {
+        QHash<QString, QString> canonicalFilePathResults;
+        QHash<QString, bool> fileExistsResults;
+        QHash<std::pair<QString, quint32>, QStringList> directoryEntriesResults;
+        QHash<QString, FileTime> fileLastModifiedResults;
+        Set<QString> imports;
+        qint64 elapsedTimeModPropEval = 0;
+        qint64 elapsedTimeAllPropEval = 0;
+    };
+
+    const int workerCount = std::min(int(tasks.size()), maxJobCount);
+    std::vector<EngineResults> engineResults(workerCount);
+    std::atomic_size_t nextTask(0);
+
+    // The item tree is not modified while this is going on.
+    const auto evaluateConfigs = [this, &tasks, &nextTask](EngineResults &results) {
+        OutputDetectingLogSink logSink(m_logger.logSink()->logLevel());
+        Logger logger(&logSink);
+        const auto engine = ScriptEngine::create(logger, EvalContext::PropertyEvaluation);
+        engine->setEnvironment(m_setupParams.adjustedEnvironment());
+        engine->setParseCacheDirectory(m_setupParams.parseCacheDirectory());
+        Evaluator evaluator(engine.get());
+        evaluator.disableItemObservation();
+        ProjectResolver resolver(&evaluator, ModuleLoaderResult(), m_setupParams, logger);
+        resolver.m_progressObserver = m_progressObserver;
+        for (std::size_t i = nextTask++; i < tasks.size(); i = nextTask++) {
+            Task &task = tasks.at(i);
+            logSink.clearOutput();
+            try {
+                resolver.evaluateProductConfig(task.item, task.config);
+                task.done = !logSink.hasOutput();
+            } catch (const ErrorInfo &) {
+            } catch (const CancelException &) {
+                break;
+            }
+        }
+        results.canonicalFilePathResults = engine->canonicalFilePathResults();
+        results.fileExistsResults = engine->fileExistsResults();
+        results.directoryEntriesResults = engine->directoryEntriesResults();
+        results.fileLastModifiedResults = engine->fileLastModifiedResults();
+        results.imports = engine->imports();
+        results.elapsedTimeModPropEval = resolver.m_elapsedTimeModPropEval;
+        results.elapsedTimeAllPropEval = resolver.m_elapsedTimeAllPropEval;
+    };
+
+    QThreadPool threadPool;
+    threadPool.setMaxThreadCount(workerCount);
+    for (EngineResults &results : engineResults) {
+        EngineResults * const resultsPtr = &results;
+        threadPool.start(new FunctionRunnable([&evaluateConfigs, resultsPtr] {
+            evaluateConfigs(*resultsPtr);
+        }));
+    }
+    threadPool.waitForDone();
+    checkCancelation();
+
+    // What the other engines found out about the file system is relevant for
+    // the change tracking of the project, so we need it in our engine.
+    for (const EngineResults &results : engineResults) {
+        for (auto it = results.canonicalFilePathResults.cbegin();
+             it != results.canonicalFilePathResults.cend(); ++it) {
+            m_engine->addCanonicalFilePathResult(it.key(), it.value());
+        }
+        for (auto it = results.fileExistsResults.cbegin();
+             it != results.fileExistsResults.cend(); ++it) {
+            m_engine->addFileExistsResult(it.key(), it.value());
+        }
+        for (auto it = results.directoryEntriesResults.cbegin();
+             it != results.directoryEntriesResults.cend(); ++it) {
+            m_engine->addDirectoryEntriesResult(it.key().first,
+                                                static_cast<QDir::Filters>(it.key().second),
+                                                it.value());
+        }
+        for (auto it = results.fileLastModifiedResults.cbegin();
+             it != results.fileLastModifiedResults.cend(); ++it) {
+            m_engine->addFileLastModifiedResult(it.key(), it.value());
+        }
+        m_importsFromOtherEngines.unite(results.imports);
+        m_elapsedTimeModPropEval += results.elapsedTimeModPropEval;
+        m_elapsedTimeAllPropEval += results.elapsedTimeAllPropEval;
+    }
+
+    for (Task &task : tasks) {
+        if (task.done)
+            m_productConfigs.insert(std::make_pair(task.item, std::move(task.config)));
+    }
+}
+
+// Called concurrently for different products, on resolvers that have their own evaluator.
+void ProjectResolver::evaluateProductConfig(Item *item, ProductConfig &config)
+{
+    TraceScope traceScope("resolving");
+    if (traceScope.isActive()) {
+        traceScope.setName(Tr::tr("Evaluating properties of product '%1'")
+                           .arg(m_evaluator->stringValue(item, StringConstants::nameProperty())));
+    }
+    m_evaluator->clearPropertyDependencies();
+    EvalCacheEnabler cachingEnabler(m_evaluator);
+    m_evaluator->setPathPropertiesBaseDir(
+                m_evaluator->stringValue(item, StringConstants::sourceDirectoryProperty()));
+    config.moduleProperties = evaluateModuleValues(item);
+    config.productProperties = evaluateProperties(item, item, QVariantMap(), true, true);
+    m_evaluator->clearPathPropertiesBaseDir();
+    config.propertyDependencies = m_evaluator->propertyDependencies();
 }
 
 void ProjectResolver::callItemFunction(const ItemFuncMap &mappings, Item *item,
@@ -52,6 +52,7 @@
 #include <QtCore/qmap.h>
 #include <QtCore/qstringlist.h>
 
+#include <unordered_map>
 #include <utility>
 #include <vector>
 
@@ -72,6 +73,8 @@ public:
     ~ProjectResolver();
 
     void setProgressObserver(ProgressObserver *observer);
+    void setOldProducts(const std::vector<ResolvedProductPtr> &oldProducts,
+                        const Set<QString> &changedFiles);
     TopLevelProjectPtr resolve();
 
     static void applyFileTaggers(const SourceArtifactPtr &artifact,
@@ -89,6 +92,15 @@ private:
     struct ModuleContext;
     class ProductContextSwitcher;
 
+    // The properties of a product that can be evaluated independently of other products.
+    struct ProductConfig
+    {
+        FileTags types;
+        QVariantMap moduleProperties;
+        QVariantMap productProperties;
+        PropertyDependencies propertyDependencies;
+    };
+
     void checkCancelation() const;
     QString verbatimValue(const ValueConstPtr &value, bool *propertyWasSet = nullptr) const;
     QString verbatimValue(Item *item, const QString &name, bool *propertyWasSet = nullptr) const;
@@ -101,11 +113,13 @@ private:
     void resolveSubProject(Item *item, ProjectContext *projectContext);
     void resolveProduct(Item *item, ProjectContext *projectContext);
     void resolveProductFully(Item *item, ProjectContext *projectContext);
+    void evaluateProductConfigsConcurrently();
+    void evaluateProductConfig(Item *item, ProductConfig &config);
     void resolveModules(const Item *item, ProjectContext *projectContext);
     void resolveModule(const QualifiedId &moduleName, Item *item, bool isProduct,
                        const QVariantMap &parameters, JobLimits &jobLimits,
                        ProjectContext *projectContext);
-    void gatherProductTypes(ResolvedProduct *product, Item *item);
+    FileTags gatherProductTypes(Item *item);
     QVariantMap resolveAdditionalModuleProperties(const Item *group,
                                                   const QVariantMap &currentValues);
     void resolveGroup(Item *item, ProjectContext *projectContext);
@@ -136,6 +150,7 @@ private:
             const QVariant &v, const CodeLocation &loc, const PropertyDeclaration &decl,
             const QString &key) const;
     void createProductConfig(ResolvedProduct *product);
+    void reuseUnchangedProductConfigs();
     ProjectContext createProjectContext(ProjectContext *parentProjectContext) const;
     void adaptExportedPropertyValues(const Item *shadowProductItem);
     void collectExportedProductDependencies();
@@ -184,6 +199,11 @@ private:
     QMap<QString, ResolvedProductPtr> m_productsByName;
     QHash<FileTag, QList<ResolvedProductPtr> > m_productsByType;
     QHash<ResolvedProductPtr, Item *> m_productItemMap;
+    std::unordered_map<const Item *, ProductConfig> m_productConfigs;
+    QHash<QString, ResolvedProductConstPtr> m_oldProducts;
+    Set<QString> m_changedFiles;
+    int m_reusedProductConfigCount = 0;
+    Set<QString> m_importsFromOtherEngines;
     mutable QHash<FileContextConstPtr, ResolvedFileContextPtr> m_fileContextMap;
     mutable QHash<CodeLocation, ScriptFunctionPtr> m_scriptFunctionMap;
     mutable QHash<std::pair<QStringView, QStringList>, QString> m_scriptFunctions;
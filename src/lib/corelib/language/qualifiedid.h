@@ -58,6 +58,9 @@ public:
 
     static QualifiedId fromString(const QString &str);
     QString toString() const;
+
+    void load(PersistentPool &pool) { *this = QualifiedId(pool.load<QStringList>()); }
+    void store(PersistentPool &pool) const { pool.store(static_cast<const QStringList &>(*this)); }
 };
 
 inline auto qHash(const QualifiedId &qid) { return qHash(qid.toString()); }
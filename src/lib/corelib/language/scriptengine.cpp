@@ -371,6 +371,11 @@ void ScriptEngine::setEnvironment(const QProcessEnvironment &env)
     m_environment = env;
 }
 
+void ScriptEngine::setParseCacheDirectory(const QString &directory)
+{
+    m_scriptImporter->setParseCacheDirectory(directory);
+}
+
 void ScriptEngine::importFile(const QString &filePath, QScriptValue &targetObject)
 {
     AccumulatingTimer importTimer(m_elapsedTimeImporting != -1 ? &m_elapsedTimeImporting : nullptr);
@@ -578,28 +583,80 @@ void ScriptEngine::addCanonicalFilePathResult(const QString &filePath,
 {
     if (gatherFileResults())
         m_canonicalFilePathResult.insert(filePath, resultFilePath);
+    if (m_queryResultsRecorder)
+        m_queryResultsRecorder->canonicalFilePathResults.insert(filePath, resultFilePath);
 }
 
 void ScriptEngine::addFileExistsResult(const QString &filePath, bool exists)
 {
     if (gatherFileResults())
         m_fileExistsResult.insert(filePath, exists);
+    if (m_queryResultsRecorder)
+        m_queryResultsRecorder->fileExistsResults.insert(filePath, exists);
 }
 
 void ScriptEngine::addDirectoryEntriesResult(const QString &path, QDir::Filters filters,
                                              const QStringList &entries)
 {
-    if (gatherFileResults()) {
-        m_directoryEntriesResult.insert(
-                    std::pair<QString, quint32>(path, static_cast<quint32>(filters)),
-                    entries);
-    }
+    const std::pair<QString, quint32> key(path, static_cast<quint32>(filters));
+    if (gatherFileResults())
+        m_directoryEntriesResult.insert(key, entries);
+    if (m_queryResultsRecorder)
+        m_queryResultsRecorder->directoryEntriesResults.insert(key, entries);
 }
 
 void ScriptEngine::addFileLastModifiedResult(const QString &filePath, const FileTime &fileTime)
 {
     if (gatherFileResults())
         m_fileLastModifiedResult.insert(filePath, fileTime);
+    if (m_queryResultsRecorder)
+        m_queryResultsRecorder->fileLastModifiedResults.insert(filePath, fileTime);
+}
+
+// The environment is tracked as a whole for the project, so only the recorder is interested.
+void ScriptEngine::addEnvironmentResult(const QString &name, const QString &value)
+{
+    if (m_queryResultsRecorder)
+        m_queryResultsRecorder->environmentResults.insert(name, value);
+}
+
+// Processes see all of our environment, including variables that only get set later.
+void ScriptEngine::addCompleteEnvironmentResult()
+{
+    if (!m_queryResultsRecorder)
+        return;
+    const QProcessEnvironment &env = environment();
+    const QStringList names = env.keys();
+    for (const QString &name : names)
+        m_queryResultsRecorder->environmentResults.insert(name, env.value(name));
+    m_queryResultsRecorder->environmentComplete = true;
+}
+
+void ScriptEngine::addQueryResults(const ScriptQueryResults &results)
+{
+    for (auto it = results.canonicalFilePathResults.cbegin();
+         it != results.canonicalFilePathResults.cend(); ++it) {
+        addCanonicalFilePathResult(it.key(), it.value());
+    }
+    for (auto it = results.fileExistsResults.cbegin(); it != results.fileExistsResults.cend();
+         ++it) {
+        addFileExistsResult(it.key(), it.value());
+    }
+    for (auto it = results.directoryEntriesResults.cbegin();
+         it != results.directoryEntriesResults.cend(); ++it) {
+        addDirectoryEntriesResult(it.key().first, static_cast<QDir::Filters>(it.key().second),
+                                  it.value());
+    }
+    for (auto it = results.fileLastModifiedResults.cbegin();
+         it != results.fileLastModifiedResults.cend(); ++it) {
+        addFileLastModifiedResult(it.key(), it.value());
+    }
+    for (auto it = results.environmentResults.cbegin(); it != results.environmentResults.cend();
+         ++it) {
+        addEnvironmentResult(it.key(), it.value());
+    }
+    if (results.environmentComplete && m_queryResultsRecorder)
+        m_queryResultsRecorder->environmentComplete = true;
 }
 
 Set<QString> ScriptEngine::imports() const
@@ -100,6 +100,30 @@ public:
 
 enum class ObserveMode { Enabled, Disabled };
 
+/*
+ * What a single script, e.g. the configure script of a probe, found out about the file system
+ * and the environment. For environment variables, a null value means the variable was not set.
+ * If environmentComplete is true, the script depended on the environment as a whole, so
+ * environmentResults contains all variables and no others must be set.
+ */
+class ScriptQueryResults
+{
+public:
+    QHash<QString, QString> canonicalFilePathResults;
+    QHash<QString, bool> fileExistsResults;
+    QHash<std::pair<QString, quint32>, QStringList> directoryEntriesResults;
+    QHash<QString, FileTime> fileLastModifiedResults;
+    QHash<QString, QString> environmentResults;
+    bool environmentComplete = false;
+
+    template<PersistentPool::OpType opType> void completeSerializationOp(PersistentPool &pool)
+    {
+        pool.serializationOp<opType>(canonicalFilePathResults, fileExistsResults,
+                                     directoryEntriesResults, fileLastModifiedResults,
+                                     environmentResults, environmentComplete);
+    }
+};
+
 class QBS_AUTOTEST_EXPORT ScriptEngine : public QScriptEngine
 {
     Q_OBJECT
@@ -192,11 +216,22 @@ public:
 
     QProcessEnvironment environment() const;
     void setEnvironment(const QProcessEnvironment &env);
+    void setParseCacheDirectory(const QString &directory);
     void addCanonicalFilePathResult(const QString &filePath, const QString &resultFilePath);
     void addFileExistsResult(const QString &filePath, bool exists);
     void addDirectoryEntriesResult(const QString &path, QDir::Filters filters,
                                    const QStringList &entries);
     void addFileLastModifiedResult(const QString &filePath, const FileTime &fileTime);
+    void addEnvironmentResult(const QString &name, const QString &value);
+    void addCompleteEnvironmentResult();
+    void addQueryResults(const ScriptQueryResults &results);
+
+    // While set, the results of file system and environment queries are also collected in
+    // the given object, regardless of what the engine has already gathered.
+    void setQueryResultsRecorder(ScriptQueryResults *recorder)
+    {
+        m_queryResultsRecorder = recorder;
+    }
     QHash<QString, QString> canonicalFilePathResults() const { return m_canonicalFilePathResult; }
     QHash<QString, bool> fileExistsResults() const { return m_fileExistsResult; }
     QHash<std::pair<QString, quint32>, QStringList> directoryEntriesResults() const
@@ -340,6 +375,7 @@ private:
     QHash<QString, bool> m_fileExistsResult;
     QHash<std::pair<QString, quint32>, QStringList> m_directoryEntriesResult;
     QHash<QString, FileTime> m_fileLastModifiedResult;
+    ScriptQueryResults *m_queryResultsRecorder = nullptr;
     std::stack<QString> m_currentDirPathStack;
     std::stack<QStringList> m_extensionSearchPathsStack;
     QScriptValue m_loadFileFunction;
@@ -382,6 +418,20 @@ private:
     const EvalContext m_oldContext;
 };
 
+class QueryResultsRecording
+{
+public:
+    QueryResultsRecording(ScriptEngine *engine, ScriptQueryResults *recorder) : m_engine(engine)
+    {
+        engine->setQueryResultsRecorder(recorder);
+    }
+
+    ~QueryResultsRecording() { m_engine->setQueryResultsRecorder(nullptr); }
+
+private:
+    ScriptEngine * const m_engine;
+};
+
 } // namespace Internal
 } // namespace qbs
 
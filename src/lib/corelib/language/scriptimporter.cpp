@@ -130,18 +130,26 @@ QScriptValue ScriptImporter::importSourceCode(const QString &sourceCode, const Q
 
     QString &code = m_sourceCodeCache[filePath];
     if (code.isEmpty()) {
-        QbsQmlJS::Engine engine;
-        QbsQmlJS::Lexer lexer(&engine);
-        lexer.setCode(sourceCode, 1, false);
-        QbsQmlJS::Parser parser(&engine);
-        if (!parser.parseProgram()) {
-            throw ErrorInfo(parser.errorMessage(), CodeLocation(filePath, parser.errorLineNumber(),
-                                                                parser.errorColumnNumber()));
+        // Only the suffix depends on the syntax tree, so that is what goes into the parse cache.
+        const QByteArray cacheKey = m_parseCache.isEnabled()
+                ? ParseCache::entryKey(ParseCache::FileType::Js, sourceCode) : QByteArray();
+        QByteArray suffix;
+        if (!m_parseCache.lookup(cacheKey, &suffix)) {
+            QbsQmlJS::Engine engine;
+            QbsQmlJS::Lexer lexer(&engine);
+            lexer.setCode(sourceCode, 1, false);
+            QbsQmlJS::Parser parser(&engine);
+            if (!parser.parseProgram()) {
+                throw ErrorInfo(parser.errorMessage(), CodeLocation(filePath,
+                        parser.errorLineNumber(), parser.errorColumnNumber()));
+            }
+
+            IdentifierExtractor extractor;
+            extractor.start(parser.rootNode());
+            suffix = extractor.suffix().toUtf8();
+            m_parseCache.store(cacheKey, suffix);
         }
-
-        IdentifierExtractor extractor;
-        extractor.start(parser.rootNode());
-        code = QLatin1String("(function(){\n") + sourceCode + extractor.suffix();
+        code = QLatin1String("(function(){\n") + sourceCode + QString::fromUtf8(suffix);
     }
 
     QScriptValue result = m_engine->evaluate(code, filePath, 0);
@@ -40,6 +40,8 @@
 #ifndef SCRIPTIMPORTER_H
 #define SCRIPTIMPORTER_H
 
+#include "parsecache.h"
+
 #include <QtCore/qhash.h>
 
 #include <QtScript/qscriptvalue.h>
@@ -57,8 +59,11 @@ public:
 
     static void copyProperties(const QScriptValue &src, QScriptValue &dst);
 
+    void setParseCacheDirectory(const QString &directory) { m_parseCache.setDirectory(directory); }
+
 private:
     ScriptEngine *m_engine;
+    ParseCache m_parseCache;
     QHash<QString, QString> m_sourceCodeCache;
 };
 
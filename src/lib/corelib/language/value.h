@@ -106,7 +106,6 @@ class JSSourceValue : public Value
         SourceUsesOuter = 0x02,
         SourceUsesOriginal = 0x04,
         HasFunctionForm = 0x08,
-        ExclusiveListValue = 0x10,
         BuiltinDefaultValue = 0x20,
     };
     Q_DECLARE_FLAGS(Flags, Flag)
@@ -139,8 +138,6 @@ public:
     bool sourceUsesOriginal() const { return m_flags.testFlag(SourceUsesOriginal); }
     bool hasFunctionForm() const { return m_flags.testFlag(HasFunctionForm); }
     void setHasFunctionForm(bool b);
-    void setIsExclusiveListValue() { m_flags |= ExclusiveListValue; }
-    bool isExclusiveListValue() { return m_flags.testFlag(ExclusiveListValue); }
     void setIsBuiltinDefaultValue() { m_flags |= BuiltinDefaultValue; }
     bool isBuiltinDefaultValue() const { return m_flags.testFlag(BuiltinDefaultValue); }
 
@@ -0,0 +1,289 @@
+/****************************************************************************
+**
+** Copyright (C) 2022 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of Qbs.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-2.0.html and
+** https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#include "actioncache.h"
+
+#include "fileinfo.h"
+#include "qttools.h"
+
+#include <logging/categories.h>
+
+#include <QtCore/qdatetime.h>
+#include <QtCore/qdir.h>
+#include <QtCore/qdiriterator.h>
+#include <QtCore/qfile.h>
+#include <QtCore/qfileinfo.h>
+#include <QtCore/qjsondocument.h>
+#include <QtCore/qjsonobject.h>
+#include <QtCore/qlockfile.h>
+#include <QtCore/qtemporarydir.h>
+
+#include <algorithm>
+
+namespace qbs {
+namespace Internal {
+
+static QString manifestFileName() { return QStringLiteral("manifest"); }
+static QString statisticsFileName() { return QStringLiteral("statistics.json"); }
+static QString lockFileName() { return QStringLiteral("lock"); }
+
+static QStringList outputNames(const ActionCache::Outputs &outputs)
+{
+    QStringList names;
+    for (const auto &output : outputs)
+        names << output.first;
+    return names;
+}
+
+static QString entryFilePath(const QString &entryDir, int index)
+{
+    return entryDir + QLatin1Char('/') + QString::number(index);
+}
+
+// The modification time of the manifest serves as the "last used" time for eviction.
+// Updating it is best-effort, so that read-only caches can be used too.
+static void markUsed(const QString &manifestFilePath)
+{
+    QFile manifest(manifestFilePath);
+    if (manifest.open(QIODevice::ReadWrite | QIODevice::ExistingOnly))
+        manifest.setFileTime(QDateTime::currentDateTimeUtc(), QFileDevice::FileModificationTime);
+}
+
+ActionCache::ActionCache(QString directory, qint64 maxSize)
+    : m_directory(std::move(directory)), m_maxSize(maxSize)
+{
+}
+
+ActionCache::~ActionCache() = default;
+
+QString ActionCache::entryDirPath(const QByteArray &key) const
+{
+    const QString hexKey = QString::fromLatin1(key.toHex());
+    return m_directory + QLatin1Char('/') + hexKey.left(2) + QLatin1Char('/') + hexKey;
+}
+
+/*!
+ * Replaces the given outputs with the ones stored under \a key.
+ * Returns \c false if there is no such entry or it cannot be restored completely, in which
+ * case the caller is expected to run the commands as usual.
+ */
+bool ActionCache::restore(const QByteArray &key, const Outputs &outputs)
+{
+    const QString entryDir = entryDirPath(key);
+    QFile manifest(entryDir + QLatin1Char('/') + manifestFileName());
+    if (!manifest.open(QIODevice::ReadOnly)) {
+        ++m_sessionStats.misses;
+        return false;
+    }
+    const QStringList storedNames = QString::fromUtf8(manifest.readAll())
+            .split(QLatin1Char('\n'), QBS_SKIP_EMPTY_PARTS);
+    if (storedNames != outputNames(outputs)) {
+        qCDebug(lcExec) << "action cache entry" << entryDir << "does not match the outputs";
+        ++m_sessionStats.misses;
+        return false;
+    }
+
+    for (int i = 0; i < int(outputs.size()); ++i) {
+        const QString &targetFilePath = outputs.at(i).second;
+        if (QFile::exists(targetFilePath) && !QFile::remove(targetFilePath)) {
+            ++m_sessionStats.misses;
+            return false;
+        }
+        if (!QFile::copy(entryFilePath(entryDir, i), targetFilePath)) {
+            qCDebug(lcExec) << "failed to restore" << targetFilePath << "from action cache";
+            ++m_sessionStats.misses;
+            return false;
+        }
+    }
+
+    manifest.close();
+    markUsed(manifest.fileName());
+    ++m_sessionStats.hits;
+    return true;
+}
+
+/*!
+ * Stores copies of the given outputs under \a key.
+ * Entries are assembled in a temporary directory and then renamed into place, so concurrent
+ * readers never see incomplete entries.
+ */
+bool ActionCache::store(const QByteArray &key, const Outputs &outputs)
+{
+    const QString entryDir = entryDirPath(key);
+    if (FileInfo::exists(entryDir))
+        return true;
+    const QString parentDir = FileInfo::path(entryDir);
+    if (!QDir::root().mkpath(parentDir))
+        return false;
+    QTemporaryDir tempDir(m_directory + QStringLiteral("/tmp-XXXXXX"));
+    if (!tempDir.isValid())
+        return false;
+    for (int i = 0; i < int(outputs.size()); ++i) {
+        if (!QFile::copy(outputs.at(i).second, entryFilePath(tempDir.path(), i)))
+            return false;
+    }
+    QFile manifest(tempDir.path() + QLatin1Char('/') + manifestFileName());
+    if (!manifest.open(QIODevice::WriteOnly))
+        return false;
+    manifest.write(outputNames(outputs).join(QLatin1Char('\n')).toUtf8());
+    manifest.close();
+    if (!QDir::root().rename(tempDir.path(), entryDir))
+        return false; // Probably stored concurrently by someone else.
+    tempDir.setAutoRemove(false);
+    ++m_sessionStats.stores;
+    return true;
+}
+
+static ActionCache::Statistics readStatistics(const QString &filePath)
+{
+    ActionCache::Statistics stats;
+    QFile file(filePath);
+    if (!file.open(QIODevice::ReadOnly))
+        return stats;
+    const QJsonObject data = QJsonDocument::fromJson(file.readAll()).object();
+    stats.hits = data.value(QStringLiteral("hits")).toVariant().toLongLong();
+    stats.misses = data.value(QStringLiteral("misses")).toVariant().toLongLong();
+    stats.stores = data.value(QStringLiteral("stores")).toVariant().toLongLong();
+    stats.evictions = data.value(QStringLiteral("evictions")).toVariant().toLongLong();
+    return stats;
+}
+
+static void writeStatistics(const QString &filePath, const ActionCache::Statistics &stats)
+{
+    QFile file(filePath);
+    if (!file.open(QIODevice::WriteOnly))
+        return;
+    QJsonObject data;
+    data.insert(QStringLiteral("hits"), stats.hits);
+    data.insert(QStringLiteral("misses"), stats.misses);
+    data.insert(QStringLiteral("stores"), stats.stores);
+    data.insert(QStringLiteral("evictions"), stats.evictions);
+    file.write(QJsonDocument(data).toJson());
+}
+
+struct CacheEntryInfo
+{
+    QString dirPath;
+    QDateTime lastUsed;
+    qint64 size = 0;
+};
+
+static std::vector<CacheEntryInfo> collectEntries(const QString &cacheDir)
+{
+    std::vector<CacheEntryInfo> entries;
+    const QStringList bucketDirs = QDir(cacheDir).entryList(QDir::Dirs | QDir::NoDotAndDotDot);
+    for (const QString &bucketDir : bucketDirs) {
+        if (bucketDir.size() != 2)
+            continue; // Temporary directory of an ongoing store operation.
+        QDirIterator entryIt(cacheDir + QLatin1Char('/') + bucketDir,
+                             QDir::Dirs | QDir::NoDotAndDotDot);
+        while (entryIt.hasNext()) {
+            CacheEntryInfo info;
+            info.dirPath = entryIt.next();
+            info.lastUsed = QFileInfo(info.dirPath + QLatin1Char('/') + manifestFileName())
+                    .lastModified();
+            QDirIterator fileIt(info.dirPath, QDir::Files);
+            while (fileIt.hasNext()) {
+                fileIt.next();
+                info.size += fileIt.fileInfo().size();
+            }
+            entries.push_back(info);
+        }
+    }
+    return entries;
+}
+
+void ActionCache::evict(Statistics &stats)
+{
+    std::vector<CacheEntryInfo> entries = collectEntries(m_directory);
+    qint64 totalSize = 0;
+    for (const CacheEntryInfo &entry : entries)
+        totalSize += entry.size;
+    if (totalSize <= m_maxSize)
+        return;
+
+    // Remove the least recently used entries until we are comfortably below the limit,
+    // so that we do not have to evict again after the next few stores.
+    std::sort(entries.begin(), entries.end(), [](const auto &e1, const auto &e2) {
+        return e1.lastUsed < e2.lastUsed;
+    });
+    const qint64 targetSize = m_maxSize / 10 * 9;
+    for (const CacheEntryInfo &entry : entries) {
+        if (totalSize <= targetSize)
+            break;
+        QString errorMessage;
+        if (!removeDirectoryWithContents(entry.dirPath, &errorMessage)) {
+            qCDebug(lcExec) << "cannot evict action cache entry:" << errorMessage;
+            continue;
+        }
+        totalSize -= entry.size;
+        ++stats.evictions;
+    }
+}
+
+void ActionCache::finish()
+{
+    if (!QDir::root().mkpath(m_directory))
+        return;
+    QLockFile lockFile(m_directory + QLatin1Char('/') + lockFileName());
+    if (!lockFile.lock())
+        return;
+    const QString statsFilePath = m_directory + QLatin1Char('/') + statisticsFileName();
+    Statistics stats = readStatistics(statsFilePath);
+    stats.hits += m_sessionStats.hits;
+    stats.misses += m_sessionStats.misses;
+    stats.stores += m_sessionStats.stores;
+    if (m_sessionStats.stores > 0 && m_maxSize > 0)
+        evict(stats);
+    writeStatistics(statsFilePath, stats);
+    m_sessionStats = Statistics();
+}
+
+ActionCache::Statistics ActionCache::statistics(const QString &directory)
+{
+    Statistics stats = readStatistics(directory + QLatin1Char('/') + statisticsFileName());
+    const std::vector<CacheEntryInfo> entries = collectEntries(directory);
+    stats.entryCount = int(entries.size());
+    for (const CacheEntryInfo &entry : entries)
+        stats.totalSize += entry.size;
+    return stats;
+}
+
+} // namespace Internal
+} // namespace qbs
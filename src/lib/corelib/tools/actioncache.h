@@ -0,0 +1,100 @@
+/****************************************************************************
+**
+** Copyright (C) 2022 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of Qbs.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-2.0.html and
+** https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#ifndef QBS_ACTIONCACHE_H
+#define QBS_ACTIONCACHE_H
+
+#include "qbs_export.h"
+
+#include <QtCore/qbytearray.h>
+#include <QtCore/qstring.h>
+
+#include <utility>
+#include <vector>
+
+namespace qbs {
+namespace Internal {
+
+/*!
+ * An on-disk store of transformer outputs, addressed by a key that the caller computes
+ * from everything the transformer's commands depend on.
+ * Several processes can use the same cache directory concurrently.
+ */
+class QBS_EXPORT ActionCache
+{
+public:
+    struct Statistics
+    {
+        qint64 hits = 0;
+        qint64 misses = 0;
+        qint64 stores = 0;
+        qint64 evictions = 0;
+        int entryCount = 0;
+        qint64 totalSize = 0;
+    };
+
+    // Pairs of (name of the output in the cache entry, absolute file path in the build tree).
+    using Outputs = std::vector<std::pair<QString, QString>>;
+
+    ActionCache(QString directory, qint64 maxSize);
+    ~ActionCache();
+
+    QString directory() const { return m_directory; }
+
+    bool restore(const QByteArray &key, const Outputs &outputs);
+    bool store(const QByteArray &key, const Outputs &outputs);
+
+    // Writes the statistics of this session and evicts entries if the size limit is exceeded.
+    void finish();
+
+    static Statistics statistics(const QString &directory);
+
+private:
+    QString entryDirPath(const QByteArray &key) const;
+    void evict(Statistics &stats);
+
+    const QString m_directory;
+    const qint64 m_maxSize;
+    Statistics m_sessionStats;
+};
+
+} // namespace Internal
+} // namespace qbs
+
+#endif // QBS_ACTIONCACHE_H
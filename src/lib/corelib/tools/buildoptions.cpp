@@ -63,7 +63,11 @@ public:
     QStringList activeFileTags;
     JobLimits jobLimits;
     QString settingsDir;
+    QString actionCacheDir;
+    QString traceFilePath;
     int maxJobCount;
+    int minJobCount = 0;
+    int memoryBudget = 0;
     bool dryRun;
     bool keepGoing;
     bool forceTimestampCheck;
@@ -74,6 +78,8 @@ public:
     bool removeExistingInstallation;
     bool onlyExecuteRules;
     bool jobLimitsFromProjectTakePrecedence = false;
+    bool changedFilesComplete = false;
+    QStringList watchedDirectories;
 };
 
 } // namespace Internal
@@ -115,6 +121,49 @@ void BuildOptions::setChangedFiles(const QStringList &changedFiles)
     d->changedFiles = changedFiles;
 }
 
+/*!
+ * \brief Returns true iff the list of changed files is known to be complete.
+ * The default is \c false.
+ * \sa setChangedFilesComplete
+ */
+bool BuildOptions::changedFilesComplete() const
+{
+    return d->changedFilesComplete;
+}
+
+/*!
+ * \brief Declares the list of changed files to be authoritative.
+ * If \a complete is \c true, qbs assumes that the files listed in \l changedFiles() are the only
+ * ones that have changed since the last build, even if the list is empty. It then does not
+ * check the timestamps of any other source files or file dependencies. In contrast to the default
+ * mode, the timestamps of the listed files are read from the file system.
+ * This is intended for callers that track file changes themselves, e.g. via a file system watcher.
+ */
+void BuildOptions::setChangedFilesComplete(bool complete)
+{
+    d->changedFilesComplete = complete;
+}
+
+/*!
+ * \brief Returns the directories in which changes are known.
+ * \sa setWatchedDirectories
+ */
+QStringList BuildOptions::watchedDirectories() const
+{
+    return d->watchedDirectories;
+}
+
+/*!
+ * \brief Restricts the effect of \l changedFilesComplete() to files in the given directories.
+ * If \a directories is not empty, qbs still checks the timestamps of source files and
+ * file dependencies that are located elsewhere. Subdirectories are not included.
+ * The default is an empty list, which means that the list of changed files covers all files.
+ */
+void BuildOptions::setWatchedDirectories(const QStringList &directories)
+{
+    d->watchedDirectories = directories;
+}
+
 /*!
  * \brief The list of files to consider.
  * \sa setFilesToConsider.
@@ -186,6 +235,30 @@ void BuildOptions::setMaxJobCount(int jobCount)
     d->maxJobCount = jobCount;
 }
 
+/*!
+ * \brief Returns the minimum number of build commands to run concurrently.
+ * If the value is greater than zero, the number of concurrent build commands is adapted
+ * to the system load during the build, staying between this value and \c maxJobCount.
+ * The default is 0, which means the number of concurrent build commands is fixed.
+ * \sa BuildOptions::maxJobCount
+ */
+int BuildOptions::minJobCount() const
+{
+    return d->minJobCount;
+}
+
+/*!
+ * \brief Makes qbs adapt the number of concurrent build commands to the system load,
+ * never going below \a jobCount.
+ * qbs lowers the number when the load average exceeds the number of processor cores or
+ * processes are stalled waiting for a CPU, and raises it again when the system has capacity
+ * to spare. A value <= 0 disables the adaptation.
+ */
+void BuildOptions::setMinJobCount(int jobCount)
+{
+    d->minJobCount = jobCount;
+}
+
 /*!
  * \brief The base directory for qbs settings.
  * This value is used to locate profiles and preferences.
@@ -322,6 +395,27 @@ void BuildOptions::setLogElapsedTime(bool log)
     d->logElapsedTime = log;
 }
 
+/*!
+ * \brief Returns the file that a trace of the build is written to.
+ * The default is an empty path, which means that no trace is recorded.
+ */
+QString BuildOptions::traceFilePath() const
+{
+    return d->traceFilePath;
+}
+
+/*!
+ * \brief Makes qbs write a trace of the build to the file \a filePath.
+ * The trace uses the Chrome trace event format and contains rule application,
+ * dependency scanning, installation and storing of the build graph, as well as
+ * every command that was run, on one timeline per job slot.
+ * It can be viewed with tools such as \c{chrome://tracing} or Perfetto.
+ */
+void BuildOptions::setTraceFilePath(const QString &filePath)
+{
+    d->traceFilePath = filePath;
+}
+
 /*!
  * \brief The kind of output that is displayed when executing commands.
  */
@@ -395,15 +489,69 @@ void BuildOptions::setExecuteRulesOnly(bool onlyRules)
     d->onlyExecuteRules = onlyRules;
 }
 
+/*!
+ * \brief Returns the directory of the action cache.
+ * If this is empty, which is the default, the action cache is not used.
+ */
+QString BuildOptions::actionCacheDirectory() const
+{
+    return d->actionCacheDir;
+}
+
+/*!
+ * \brief Sets the directory of the action cache.
+ * If \a directory is non-empty, qbs looks up the outputs of commands in this directory before
+ * running them, and stores the outputs of commands that ran successfully there.
+ * The cache can be shared between several build directories.
+ */
+void BuildOptions::setActionCacheDirectory(const QString &directory)
+{
+    d->actionCacheDir = directory;
+}
+
+/*!
+ * \fn int BuildOptions::automaticMemoryBudget()
+ * \brief The memory budget value that makes qbs use the amount of memory that is available
+ * when the build starts.
+ */
+
+/*!
+ * \brief Returns the amount of memory in MiB that the commands running in parallel
+ * are expected to use at most.
+ * The default is 0, which means there is no budget.
+ */
+int BuildOptions::memoryBudget() const
+{
+    return d->memoryBudget;
+}
+
+/*!
+ * \brief Sets the memory budget for the commands running in parallel to \a budgetInMiB.
+ * qbs remembers how much memory the commands of each rule used in the previous build and
+ * delays commands whose expected memory usage does not fit into what is left of the budget.
+ * Commands with unknown memory usage are not delayed, and a command is never delayed when
+ * nothing else with a known memory usage is running.
+ * If \a budgetInMiB is \l automaticMemoryBudget(), the memory that is available when the
+ * build starts is used as the budget.
+ */
+void BuildOptions::setMemoryBudget(int budgetInMiB)
+{
+    d->memoryBudget = budgetInMiB;
+}
+
 
 bool operator==(const BuildOptions &bo1, const BuildOptions &bo2)
 {
     return bo1.changedFiles() == bo2.changedFiles()
+            && bo1.changedFilesComplete() == bo2.changedFilesComplete()
+            && bo1.watchedDirectories() == bo2.watchedDirectories()
             && bo1.dryRun() == bo2.dryRun()
             && bo1.keepGoing() == bo2.keepGoing()
             && bo1.logElapsedTime() == bo2.logElapsedTime()
+            && bo1.traceFilePath() == bo2.traceFilePath()
             && bo1.echoMode() == bo2.echoMode()
             && bo1.maxJobCount() == bo2.maxJobCount()
+            && bo1.minJobCount() == bo2.minJobCount()
             && bo1.install() == bo2.install()
             && bo1.removeExistingInstallation() == bo2.removeExistingInstallation();
 }
@@ -443,20 +591,26 @@ qbs::BuildOptions qbs::BuildOptions::fromJson(const QJsonObject &data)
     using namespace Internal;
     BuildOptions opt;
     setValueFromJson(opt.d->changedFiles, data, "changed-files");
+    setValueFromJson(opt.d->changedFilesComplete, data, "changed-files-complete");
+    setValueFromJson(opt.d->watchedDirectories, data, "watched-directories");
     setValueFromJson(opt.d->filesToConsider, data, "files-to-consider");
     setValueFromJson(opt.d->activeFileTags, data, "active-file-tags");
     setValueFromJson(opt.d->jobLimits, data, "job-limits");
     setValueFromJson(opt.d->maxJobCount, data, "max-job-count");
+    setValueFromJson(opt.d->minJobCount, data, "min-job-count");
     setValueFromJson(opt.d->dryRun, data, "dry-run");
     setValueFromJson(opt.d->keepGoing, data, "keep-going");
     setValueFromJson(opt.d->forceTimestampCheck, data, "check-timestamps");
     setValueFromJson(opt.d->forceOutputCheck, data, "check-outputs");
     setValueFromJson(opt.d->logElapsedTime, data, "log-time");
+    setValueFromJson(opt.d->traceFilePath, data, "trace-file");
     setValueFromJson(opt.d->echoMode, data, "command-echo-mode");
     setValueFromJson(opt.d->install, data, "install");
     setValueFromJson(opt.d->removeExistingInstallation, data, "clean-install-root");
     setValueFromJson(opt.d->onlyExecuteRules, data, "only-execute-rules");
     setValueFromJson(opt.d->jobLimitsFromProjectTakePrecedence, data, "enforce-project-job-limits");
+    setValueFromJson(opt.d->actionCacheDir, data, "action-cache-directory");
+    setValueFromJson(opt.d->memoryBudget, data, "memory-budget");
     return opt;
 }
 
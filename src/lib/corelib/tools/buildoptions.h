@@ -70,6 +70,12 @@ public:
     QStringList changedFiles() const;
     void setChangedFiles(const QStringList &changedFiles);
 
+    bool changedFilesComplete() const;
+    void setChangedFilesComplete(bool complete);
+
+    QStringList watchedDirectories() const;
+    void setWatchedDirectories(const QStringList &directories);
+
     QStringList activeFileTags() const;
     void setActiveFileTags(const QStringList &fileTags);
 
@@ -77,6 +83,9 @@ public:
     int maxJobCount() const;
     void setMaxJobCount(int jobCount);
 
+    int minJobCount() const;
+    void setMinJobCount(int jobCount);
+
     QString settingsDirectory() const;
     void setSettingsDirectory(const QString &settingsBaseDir);
 
@@ -101,6 +110,9 @@ public:
     bool logElapsedTime() const;
     void setLogElapsedTime(bool log);
 
+    QString traceFilePath() const;
+    void setTraceFilePath(const QString &filePath);
+
     CommandEchoMode echoMode() const;
     void setEchoMode(CommandEchoMode echoMode);
 
@@ -113,6 +125,13 @@ public:
     bool executeRulesOnly() const;
     void setExecuteRulesOnly(bool onlyRules);
 
+    QString actionCacheDirectory() const;
+    void setActionCacheDirectory(const QString &directory);
+
+    static int automaticMemoryBudget() { return -1; }
+    int memoryBudget() const;
+    void setMemoryBudget(int budgetInMiB);
+
 private:
     QSharedDataPointer<Internal::BuildOptionsPrivate> d;
 };
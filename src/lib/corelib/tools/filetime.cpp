@@ -108,6 +108,11 @@ FileTime FileTime::oldestTime()
     return result;
 }
 
+FileTime FileTime::addSeconds(int seconds) const
+{
+    return FileTime(m_fileTime + qint64(seconds) * 10000000); // Units of 100 ns.
+}
+
 double FileTime::asDouble() const
 {
     return static_cast<double>(m_fileTime);
@@ -197,6 +202,13 @@ FileTime FileTime::oldestTime()
     return FileTime({1, 0});
 }
 
+FileTime FileTime::addSeconds(int seconds) const
+{
+    InternalType t = m_fileTime;
+    t.tv_sec += seconds;
+    return t;
+}
+
 double FileTime::asDouble() const
 {
     return static_cast<double>(m_fileTime.tv_sec);
@@ -81,6 +81,8 @@ public:
     static FileTime currentTime();
     static FileTime oldestTime();
 
+    FileTime addSeconds(int seconds) const;
+
     double asDouble() const;
 
     template<PersistentPool::OpType opType> void completeSerializationOp(PersistentPool &pool)
@@ -91,8 +91,13 @@ static QString launcherSocketName()
             .arg(QString::number(qApp->applicationPid()));
 }
 
+// A single launcher only serves one request at a time, so with many commands running in
+// parallel, spawning processes and passing on their output becomes a bottleneck.
+static const int maxProcessesPerLauncher = 16;
+static const int maxLauncherCount = 8;
+
 LauncherInterface::LauncherInterface()
-    : m_server(new QLocalServer(this)), m_socket(new LauncherSocket(this))
+    : m_server(new QLocalServer(this)), m_sockets{new LauncherSocket(this)}
 {
     QObject::connect(m_server, &QLocalServer::newConnection,
                      this, &LauncherInterface::handleNewConnection);
@@ -109,7 +114,7 @@ LauncherInterface::~LauncherInterface()
     m_server->disconnect();
 }
 
-void LauncherInterface::doStart()
+void LauncherInterface::doStart(int maxConcurrentProcesses)
 {
     if (++m_startRequests > 1)
         return;
@@ -119,17 +124,27 @@ void LauncherInterface::doStart()
         emit errorOccurred(ErrorInfo(m_server->errorString()));
         return;
     }
-    m_process = new LauncherProcess(this);
-    connect(m_process, &QProcess::errorOccurred, this, &LauncherInterface::handleProcessError);
-    connect(m_process,
-            static_cast<void (QProcess::*)(int, QProcess::ExitStatus)>(&QProcess::finished),
-            this, &LauncherInterface::handleProcessFinished);
-    connect(m_process, &QProcess::readyReadStandardError,
-            this, &LauncherInterface::handleProcessStderr);
-    m_process->start(qApp->applicationDirPath() + QLatin1Char('/')
-                            + QLatin1String(QBS_RELATIVE_LIBEXEC_PATH)
-                            + QLatin1String("/qbs_processlauncher"),
-                           QStringList(m_server->fullServerName()));
+    const int launcherCount = qBound(1, (maxConcurrentProcesses + maxProcessesPerLauncher - 1)
+                                     / maxProcessesPerLauncher, maxLauncherCount);
+    while (int(m_sockets.size()) < launcherCount)
+        m_sockets.push_back(new LauncherSocket(this));
+    m_connectedLaunchers = 0;
+    m_nextSocket = 0;
+    for (int i = 0; i < launcherCount; ++i) {
+        const auto process = new LauncherProcess(this);
+        m_processes.push_back(process);
+        connect(process, &QProcess::errorOccurred,
+                this, [this, process] { handleProcessError(process); });
+        connect(process,
+                static_cast<void (QProcess::*)(int, QProcess::ExitStatus)>(&QProcess::finished),
+                this, [this, process] { handleProcessFinished(process); });
+        connect(process, &QProcess::readyReadStandardError,
+                this, [this, process] { handleProcessStderr(process); });
+        process->start(qApp->applicationDirPath() + QLatin1Char('/')
+                       + QLatin1String(QBS_RELATIVE_LIBEXEC_PATH)
+                       + QLatin1String("/qbs_processlauncher"),
+                       QStringList(m_server->fullServerName()));
+    }
 }
 
 void LauncherInterface::doStop()
@@ -137,43 +152,57 @@ void LauncherInterface::doStop()
     if (--m_startRequests > 0)
         return;
     m_server->close();
-    if (!m_process)
-        return;
-    m_process->disconnect();
-    m_socket->shutdown();
-    m_process->waitForFinished(3000);
-    m_process->deleteLater();
-    m_process = nullptr;
+    for (std::size_t i = 0; i < m_processes.size(); ++i) {
+        LauncherProcess * const process = m_processes.at(i);
+        process->disconnect();
+        m_sockets.at(i)->shutdown();
+    }
+    for (LauncherProcess * const process : m_processes) {
+        process->waitForFinished(3000);
+        process->deleteLater();
+    }
+    m_processes.clear();
+}
+
+LauncherSocket *LauncherInterface::nextSocket()
+{
+    if (m_processes.size() <= 1)
+        return m_sockets.front();
+    return m_sockets.at(std::size_t(m_nextSocket++) % m_processes.size());
 }
 
 void LauncherInterface::handleNewConnection()
 {
-    QLocalSocket * const socket = m_server->nextPendingConnection();
-    if (!socket)
-        return;
-    m_server->close();
-    m_socket->setSocket(socket);
+    // Which launcher connects first does not matter, as they are all the same.
+    while (QLocalSocket * const socket = m_server->nextPendingConnection()) {
+        QBS_ASSERT(m_connectedLaunchers < int(m_processes.size()), return);
+        m_sockets.at(m_connectedLaunchers++)->setSocket(socket);
+        if (m_connectedLaunchers == int(m_processes.size())) {
+            m_server->close();
+            return;
+        }
+    }
 }
 
-void LauncherInterface::handleProcessError()
+void LauncherInterface::handleProcessError(LauncherProcess *process)
 {
-    if (m_process->error() == QProcess::FailedToStart) {
+    if (process->error() == QProcess::FailedToStart) {
         const QString launcherPathForUser
-                = QDir::toNativeSeparators(QDir::cleanPath(m_process->program()));
+                = QDir::toNativeSeparators(QDir::cleanPath(process->program()));
         emit errorOccurred(ErrorInfo(Tr::tr("Failed to start process launcher at '%1': %2")
-                                     .arg(launcherPathForUser, m_process->errorString())));
+                                     .arg(launcherPathForUser, process->errorString())));
     }
 }
 
-void LauncherInterface::handleProcessFinished()
+void LauncherInterface::handleProcessFinished(LauncherProcess *process)
 {
     emit errorOccurred(ErrorInfo(Tr::tr("Process launcher closed unexpectedly: %1")
-                                 .arg(m_process->errorString())));
+                                 .arg(process->errorString())));
 }
 
-void LauncherInterface::handleProcessStderr()
+void LauncherInterface::handleProcessStderr(LauncherProcess *process)
 {
-    qDebug() << "[launcher]" << m_process->readAllStandardError();
+    qDebug() << "[launcher]" << process->readAllStandardError();
 }
 
 } // namespace Internal
@@ -42,6 +42,9 @@
 
 #include <QtCore/qobject.h>
 
+#include <atomic>
+#include <vector>
+
 QT_BEGIN_NAMESPACE
 class QLocalServer;
 QT_END_NAMESPACE
@@ -59,9 +62,15 @@ public:
     static LauncherInterface &instance();
     ~LauncherInterface() override;
 
-    static void startLauncher() { instance().doStart(); }
+    // Starts enough launcher processes for the given number of concurrently running commands.
+    static void startLauncher(int maxConcurrentProcesses = 1)
+    {
+        instance().doStart(maxConcurrentProcesses);
+    }
     static void stopLauncher() { instance().doStop(); }
-    static LauncherSocket *socket() { return instance().m_socket; }
+
+    // Hands out the sockets of the running launchers in turn.
+    static LauncherSocket *socket() { return instance().nextSocket(); }
 
 signals:
     void errorOccurred(const ErrorInfo &error);
@@ -69,16 +78,21 @@ signals:
 private:
     LauncherInterface();
 
-    void doStart();
+    void doStart(int maxConcurrentProcesses);
     void doStop();
+    LauncherSocket *nextSocket();
     void handleNewConnection();
-    void handleProcessError();
-    void handleProcessFinished();
-    void handleProcessStderr();
+    void handleProcessError(LauncherProcess *process);
+    void handleProcessFinished(LauncherProcess *process);
+    void handleProcessStderr(LauncherProcess *process);
 
     QLocalServer * const m_server;
-    LauncherSocket * const m_socket;
-    LauncherProcess * m_process = nullptr;
+
+    // The sockets are never deleted, as QbsProcess objects hold on to them.
+    std::vector<LauncherSocket *> m_sockets;
+    std::vector<LauncherProcess *> m_processes;
+    int m_connectedLaunchers = 0;
+    std::atomic_int m_nextSocket{0};
     int m_startRequests = 0;
 };
 
@@ -97,6 +97,22 @@ void StopProcessPacket::doDeserialize(QDataStream &stream)
 }
 
 
+WriteInputPacket::WriteInputPacket(quintptr token)
+    : LauncherPacket(LauncherPacketType::WriteInput, token)
+{
+}
+
+void WriteInputPacket::doSerialize(QDataStream &stream) const
+{
+    stream << data;
+}
+
+void WriteInputPacket::doDeserialize(QDataStream &stream)
+{
+    stream >> data;
+}
+
+
 ProcessErrorPacket::ProcessErrorPacket(quintptr token)
     : LauncherPacket(LauncherPacketType::ProcessError, token)
 {
@@ -116,6 +132,25 @@ void ProcessErrorPacket::doDeserialize(QDataStream &stream)
 }
 
 
+ProcessOutputPacket::ProcessOutputPacket(quintptr token)
+    : LauncherPacket(LauncherPacketType::ProcessOutput, token)
+{
+}
+
+void ProcessOutputPacket::doSerialize(QDataStream &stream) const
+{
+    stream << static_cast<quint8>(channel) << data;
+}
+
+void ProcessOutputPacket::doDeserialize(QDataStream &stream)
+{
+    quint8 c;
+    stream >> c;
+    channel = static_cast<QProcess::ProcessChannel>(c);
+    stream >> data;
+}
+
+
 ProcessFinishedPacket::ProcessFinishedPacket(quintptr token)
     : LauncherPacket(LauncherPacketType::ProcessFinished, token)
 {
@@ -125,7 +160,9 @@ void ProcessFinishedPacket::doSerialize(QDataStream &stream) const
 {
     stream << errorString << stdOut << stdErr
            << static_cast<quint8>(exitStatus) << static_cast<quint8>(error)
-           << exitCode;
+           << exitCode << resourceUsage.userTime << resourceUsage.systemTime
+           << resourceUsage.peakMemoryUsage << resourceUsage.blockInputOperations
+           << resourceUsage.blockOutputOperations;
 }
 
 void ProcessFinishedPacket::doDeserialize(QDataStream &stream)
@@ -136,7 +173,9 @@ void ProcessFinishedPacket::doDeserialize(QDataStream &stream)
     exitStatus = static_cast<QProcess::ExitStatus>(val);
     stream >> val;
     error = static_cast<QProcess::ProcessError>(val);
-    stream >> exitCode;
+    stream >> exitCode >> resourceUsage.userTime >> resourceUsage.systemTime
+           >> resourceUsage.peakMemoryUsage >> resourceUsage.blockInputOperations
+           >> resourceUsage.blockOutputOperations;
 }
 
 ShutdownPacket::ShutdownPacket() : LauncherPacket(LauncherPacketType::Shutdown, 0) { }
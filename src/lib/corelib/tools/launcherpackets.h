@@ -52,7 +52,8 @@ namespace qbs {
 namespace Internal {
 
 enum class LauncherPacketType {
-    Shutdown, StartProcess, StopProcess, ProcessError, ProcessFinished
+    Shutdown, StartProcess, StopProcess, ProcessError, ProcessFinished, ProcessOutput,
+    WriteInput
 };
 
 class PacketParser
@@ -79,6 +80,17 @@ private:
     int m_sizeOfNextPacket = -1;
 };
 
+// A value of -1 means the information is not available on this platform.
+class ProcessResourceUsage
+{
+public:
+    qint64 userTime = -1; // In milliseconds.
+    qint64 systemTime = -1; // In milliseconds.
+    qint64 peakMemoryUsage = -1; // In bytes.
+    qint64 blockInputOperations = -1;
+    qint64 blockOutputOperations = -1;
+};
+
 class LauncherPacket
 {
 public:
@@ -130,6 +142,19 @@ private:
     void doDeserialize(QDataStream &stream) override;
 };
 
+// Carries data that is to be written to the standard input of a running process.
+class WriteInputPacket : public LauncherPacket
+{
+public:
+    WriteInputPacket(quintptr token);
+
+    QByteArray data;
+
+private:
+    void doSerialize(QDataStream &stream) const override;
+    void doDeserialize(QDataStream &stream) override;
+};
+
 class ShutdownPacket : public LauncherPacket
 {
 public:
@@ -153,6 +178,20 @@ private:
     void doDeserialize(QDataStream &stream) override;
 };
 
+// Carries output that the process has written while it is still running.
+class ProcessOutputPacket : public LauncherPacket
+{
+public:
+    ProcessOutputPacket(quintptr token);
+
+    QProcess::ProcessChannel channel = QProcess::StandardOutput;
+    QByteArray data;
+
+private:
+    void doSerialize(QDataStream &stream) const override;
+    void doDeserialize(QDataStream &stream) override;
+};
+
 class ProcessFinishedPacket : public LauncherPacket
 {
 public:
@@ -164,6 +203,7 @@ public:
     QProcess::ExitStatus exitStatus = QProcess::ExitStatus::NormalExit;
     QProcess::ProcessError error = QProcess::ProcessError::UnknownError;
     int exitCode = 0;
+    ProcessResourceUsage resourceUsage;
 
 private:
     void doSerialize(QDataStream &stream) const override;
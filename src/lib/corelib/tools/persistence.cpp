@@ -43,12 +43,17 @@
 #include <logging/translator.h>
 #include <tools/error.h>
 
+#include <QtCore/qbuffer.h>
+#include <QtCore/qcryptographichash.h>
 #include <QtCore/qdir.h>
 
+#include <limits>
+
 namespace qbs {
 namespace Internal {
 
-static const char QBS_PERSISTENCE_MAGIC[] = "QBSPERSISTENCE-130";
+static const char QBS_PERSISTENCE_MAGIC[] = "QBSPERSISTENCE-140";
+static const char QBS_PERSISTENCE_RECORD_MAGIC[] = "QBSRECORD";
 
 NoBuildGraphError::NoBuildGraphError(const QString &filePath)
     : ErrorInfo(Tr::tr("Build graph not found for configuration '%1'. Expected location was '%2'.")
@@ -60,6 +65,9 @@ PersistentPool::PersistentPool(Logger &logger) : m_logger(logger)
 {
     Q_UNUSED(m_logger);
     m_stream.setVersion(QDataStream::Qt_4_8);
+
+    // Spares us byte swapping of strings and numbers on the usual hosts.
+    m_stream.setByteOrder(QDataStream::LittleEndian);
 }
 
 PersistentPool::~PersistentPool() = default;
@@ -74,7 +82,23 @@ void PersistentPool::load(const QString &filePath)
                     .arg(filePath, file->errorString()));
     }
 
-    m_stream.setDevice(file.get());
+    // Reading from a mapping of the file avoids the system calls and the copying into
+    // QFile's buffer that the many small reads of the deserialization would otherwise cause.
+    std::unique_ptr<QIODevice> device;
+    const qint64 fileSize = file->size();
+    uchar * const mappedData = fileSize > 0 && fileSize <= std::numeric_limits<int>::max()
+            ? file->map(0, fileSize) : nullptr;
+    if (mappedData) {
+        m_mappedData = QByteArray::fromRawData(reinterpret_cast<const char *>(mappedData),
+                                               int(fileSize));
+        device.reset(new QBuffer(&m_mappedData));
+        device->open(QIODevice::ReadOnly);
+        m_mappedFile = std::move(file);
+    } else {
+        device = std::move(file);
+    }
+
+    m_stream.setDevice(device.get());
     QByteArray magic;
     m_stream >> magic;
     if (magic != QBS_PERSISTENCE_MAGIC) {
@@ -85,13 +109,148 @@ void PersistentPool::load(const QString &filePath)
                          QString::fromLatin1(magic)));
     }
 
-    m_stream >> m_headData.projectConfig;
-    m_file = std::move(file);
     m_loadedRaw.clear();
     m_loaded.clear();
     m_storageIndices.clear();
     m_stringStorage.clear();
     m_inverseStringStorage.clear();
+    m_envStorage.clear();
+    m_stringListStorage.clear();
+
+    // The sizes of the id tables let us allocate them up front. Every object and value
+    // takes up at least the bytes of its id, so a count that the file cannot hold comes
+    // from a damaged header.
+    const auto counts = load<StorageCounts>();
+    const qint64 maxCount = fileSize / qint64(sizeof(PersistentObjectId));
+    const auto isValidCount = [maxCount](int count) { return count >= 0 && count <= maxCount; };
+    if (m_stream.status() != QDataStream::Ok || !isValidCount(counts.objectCount)
+            || !isValidCount(counts.stringCount) || !isValidCount(counts.envCount)
+            || !isValidCount(counts.stringListCount)) {
+        m_stream.setDevice(nullptr);
+        throw ErrorInfo(Tr::tr("Build graph is corrupt: Invalid header in '%1'.")
+                        .arg(QDir::toNativeSeparators(filePath)));
+    }
+    m_loadedRaw.reserve(counts.objectCount);
+    m_loaded.reserve(counts.objectCount);
+    m_stringStorage.reserve(counts.stringCount);
+    m_envStorage.reserve(counts.envCount);
+    m_stringListStorage.reserve(counts.stringListCount);
+
+    const auto indexOffset = load<qint64>();
+    m_stream >> m_headData.projectConfig;
+    try {
+        loadSectionIndex(indexOffset, fileSize);
+    } catch (const ErrorInfo &) {
+        m_stream.setDevice(nullptr);
+        throw;
+    }
+    m_file = std::move(device);
+}
+
+// The index follows the data of the last section. Its entries are the offsets of the sections
+// and the lists of sections they reference and have as companions.
+void PersistentPool::loadSectionIndex(qint64 indexOffset, qint64 fileSize)
+{
+    QIODevice * const device = m_stream.device();
+    const qint64 dataStart = device->pos();
+    const auto corruptIndexError = [] {
+        return ErrorInfo(Tr::tr("Build graph is corrupt: Invalid section index."));
+    };
+    if (m_stream.status() != QDataStream::Ok || indexOffset < dataStart
+            || indexOffset > fileSize || !device->seek(indexOffset)) {
+        throw corruptIndexError();
+    }
+
+    // An entry takes up at least the bytes of the offset and of the sizes of the two lists.
+    const qint64 minEntrySize = sizeof(qint64) + 2 * sizeof(int);
+    const auto count = load<int>();
+    if (count < 1 || count > (fileSize - indexOffset) / minEntrySize)
+        throw corruptIndexError();
+    const auto loadSectionList = [this, count](std::vector<int> &list, int minSection,
+                                               int maxSection) {
+        const auto size = load<int>();
+        if (size < 0 || size > count)
+            return false;
+        list.reserve(size);
+        for (int i = 0; i < size; ++i) {
+            const auto section = load<int>();
+            if (section < minSection || section > maxSection)
+                return false;
+            list.push_back(section);
+        }
+        return true;
+    };
+    m_sections.clear();
+    m_sections.resize(count);
+    for (int i = 0; i < count; ++i) {
+        Section &section = m_sections[i];
+        section.offset = load<qint64>();
+
+        // Sections can only reference the ones stored before them.
+        if (section.offset < dataStart || section.offset > indexOffset
+                || (i == 0 && section.offset != dataStart)
+                || !loadSectionList(section.references, 1, i - 1)
+                || !loadSectionList(section.companions, 1, count - 1)) {
+            throw corruptIndexError();
+        }
+    }
+    if (m_stream.status() != QDataStream::Ok)
+        throw corruptIndexError();
+    m_dataEnd = device->pos();
+    device->seek(dataStart);
+}
+
+void PersistentPool::storeSectionIndex()
+{
+    store(int(m_sections.size()));
+    for (const Section &section : qAsConst(m_sections))
+        store(section.offset, section.references, section.companions);
+}
+
+int PersistentPool::beginSection()
+{
+    m_sections.emplace_back();
+    m_sections.back().offset = m_stream.device()->pos();
+    m_currentSection = int(m_sections.size()) - 1;
+    return m_currentSection;
+}
+
+// Objects belonging to the companion were stored in the section, so loading the
+// section without the companion would leave these objects incomplete.
+void PersistentPool::addSectionCompanion(int section, int companion)
+{
+    std::vector<int> &companions = m_sections.at(section).companions;
+    if (section != companion
+            && std::find(companions.cbegin(), companions.cend(), companion) == companions.cend()) {
+        companions.push_back(companion);
+    }
+}
+
+const std::vector<int> &PersistentPool::sectionReferences(int section) const
+{
+    return m_sections.at(section).references;
+}
+
+const std::vector<int> &PersistentPool::sectionCompanions(int section) const
+{
+    return m_sections.at(section).companions;
+}
+
+void PersistentPool::loadSection(int section)
+{
+    QBS_CHECK(section > 0 && section < sectionCount());
+    m_stream.resetStatus(); // Reading the records might have ended at a damaged one.
+    m_stream.device()->seek(m_sections.at(section).offset);
+}
+
+void PersistentPool::clearSections()
+{
+    m_sections.clear();
+    m_currentSection = 0;
+    m_objectSections.clear();
+    m_stringSections.clear();
+    m_envSections.clear();
+    m_stringListSections.clear();
 }
 
 void PersistentPool::setupWriteStream(const QString &filePath)
@@ -115,19 +274,31 @@ void PersistentPool::setupWriteStream(const QString &filePath)
 
     m_stream.setDevice(file.get());
     m_file = std::move(file);
-    m_stream << QByteArray(qstrlen(QBS_PERSISTENCE_MAGIC), 0) << m_headData.projectConfig;
+    m_stream << QByteArray(qstrlen(QBS_PERSISTENCE_MAGIC), 0);
+    store(StorageCounts(), qint64(0)); // Placeholders, see finalizeWriteStream().
+    m_stream << m_headData.projectConfig;
     m_lastStoredObjectId = 0;
     m_lastStoredStringId = 0;
     m_lastStoredEnvId = 0;
     m_lastStoredStringListId = 0;
+    clearSections();
+    beginSection();
 }
 
 void PersistentPool::finalizeWriteStream()
 {
     if (m_stream.status() != QDataStream::Ok)
         throw ErrorInfo(Tr::tr("Failure serializing build graph."));
+    const qint64 indexOffset = m_stream.device()->pos();
+    storeSectionIndex();
     m_stream.device()->seek(0);
     m_stream << QByteArray(QBS_PERSISTENCE_MAGIC);
+    StorageCounts counts;
+    counts.objectCount = m_lastStoredObjectId;
+    counts.stringCount = m_lastStoredStringId;
+    counts.envCount = m_lastStoredEnvId;
+    counts.stringListCount = m_lastStoredStringListId;
+    store(counts, indexOffset);
     if (m_stream.status() != QDataStream::Ok)
         throw ErrorInfo(Tr::tr("Failure serializing build graph."));
     const auto file = static_cast<QFile *>(m_stream.device());
@@ -138,6 +309,89 @@ void PersistentPool::finalizeWriteStream()
     }
 }
 
+PersistentPool::LoadedRecords PersistentPool::loadRecords()
+{
+    LoadedRecords result;
+    QIODevice * const device = m_stream.device();
+    device->seek(m_dataEnd);
+    result.dataSize = device->pos();
+    while (!m_stream.atEnd()) {
+        QByteArray magic;
+        QByteArray record;
+        QByteArray checksum;
+        m_stream >> magic >> record >> checksum;
+        if (m_stream.status() != QDataStream::Ok || magic != QBS_PERSISTENCE_RECORD_MAGIC
+                || checksum != QCryptographicHash::hash(record, QCryptographicHash::Sha1)) {
+            result.complete = false;
+            break;
+        }
+        result.records.push_back(record);
+        result.recordsSize = device->pos() - result.dataSize;
+    }
+    return result;
+}
+
+void PersistentPool::setupRecordReadStream(const QByteArray &record)
+{
+    m_recordData = record;
+    std::unique_ptr<QBuffer> buffer(new QBuffer(&m_recordData));
+    buffer->open(QIODevice::ReadOnly);
+    m_stream.setDevice(buffer.get());
+    m_file = std::move(buffer);
+}
+
+void PersistentPool::setupRecordWriteStream()
+{
+    m_recordData.clear();
+    std::unique_ptr<QBuffer> buffer(new QBuffer(&m_recordData));
+    buffer->open(QIODevice::WriteOnly);
+    m_stream.setDevice(buffer.get());
+    m_file = std::move(buffer);
+    m_lastStoredObjectId = 0;
+    m_lastStoredStringId = 0;
+    m_lastStoredEnvId = 0;
+    m_lastStoredStringListId = 0;
+    clearSections();
+}
+
+// Returns the number of bytes added to the file.
+qint64 PersistentPool::appendRecord(const QString &filePath)
+{
+    if (m_stream.status() != QDataStream::Ok)
+        throw ErrorInfo(Tr::tr("Failure serializing build graph."));
+    m_stream.setDevice(nullptr);
+    m_file.reset();
+
+    QFile file(filePath);
+    if (!file.open(QFile::WriteOnly | QFile::Append)) {
+        throw ErrorInfo(Tr::tr("Failure storing build graph: "
+                "Cannot open file '%1' for writing: %2").arg(filePath, file.errorString()));
+    }
+    const qint64 oldSize = file.size();
+    QDataStream stream(&file);
+    stream.setVersion(m_stream.version());
+    stream.setByteOrder(QDataStream::LittleEndian);
+    stream << QByteArray(QBS_PERSISTENCE_RECORD_MAGIC) << m_recordData
+           << QCryptographicHash::hash(m_recordData, QCryptographicHash::Sha1);
+    if (stream.status() != QDataStream::Ok || !file.flush()) {
+        const QString errorString = file.errorString();
+        file.resize(oldSize); // A torn record would hide the ones appended after it.
+        throw ErrorInfo(Tr::tr("Failure serializing build graph: %1").arg(errorString));
+    }
+    return file.size() - oldSize;
+}
+
+QByteArray PersistentPool::takeRecord()
+{
+    if (m_stream.status() != QDataStream::Ok)
+        throw ErrorInfo(Tr::tr("Failure serializing data."));
+    m_stream.setDevice(nullptr);
+    m_file.reset();
+    QByteArray record;
+    std::swap(record, m_recordData);
+    return record;
+}
+
 void PersistentPool::storeVariant(const QVariant &variant)
 {
     const auto type = static_cast<quint32>(variant.userType());
@@ -191,6 +445,16 @@ void PersistentPool::clear()
     m_inverseStringStorage.clear();
 }
 
+void PersistentPool::StorageCounts::load(PersistentPool &pool)
+{
+    pool.load(objectCount, stringCount, envCount, stringListCount);
+}
+
+void PersistentPool::StorageCounts::store(PersistentPool &pool)
+{
+    pool.store(objectCount, stringCount, envCount, stringListCount);
+}
+
 void PersistentPool::doLoadValue(QString &s)
 {
     m_stream >> s;
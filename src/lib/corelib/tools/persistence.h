@@ -45,6 +45,7 @@
 #include <tools/qbsassert.h>
 #include <tools/qttools.h>
 
+#include <QtCore/qbytearray.h>
 #include <QtCore/qdatastream.h>
 #include <QtCore/qflags.h>
 #include <QtCore/qprocess.h>
@@ -53,6 +54,7 @@
 #include <QtCore/qstringlist.h>
 #include <QtCore/qvariant.h>
 
+#include <algorithm>
 #include <memory>
 #include <type_traits>
 #include <unordered_map>
@@ -116,12 +118,71 @@ public:
     void finalizeWriteStream();
     void clear();
 
+    // Records are self-contained serializations that get appended to an existing
+    // build graph file. A damaged record at the end of the file, as left behind by a crash
+    // while appending, is detected by loadRecords() and ignored along with everything after it.
+    class LoadedRecords
+    {
+    public:
+        std::vector<QByteArray> records;
+        qint64 dataSize = 0; // Of the data in front of the records.
+        qint64 recordsSize = 0; // Of the valid records.
+        bool complete = true; // False if reading stopped at a damaged record.
+    };
+
+    LoadedRecords loadRecords();
+    void setupRecordReadStream(const QByteArray &record);
+    void setupRecordWriteStream();
+    qint64 appendRecord(const QString &filePath);
+    QByteArray takeRecord(); // For records that are kept elsewhere.
+
+    // The data following the header can be split into sections. Section 0 is loaded by load().
+    // The others can be loaded later via loadSection(), in any order, provided that the
+    // sections they reference have been loaded before. A section references another one if
+    // it uses objects or values that were stored in the other section first.
+    int beginSection();
+    template<typename T> int sectionOfStoredObject(const T *object) const;
+    void addSectionCompanion(int section, int companion);
+    int sectionCount() const { return int(m_sections.size()); }
+    const std::vector<int> &sectionReferences(int section) const;
+    const std::vector<int> &sectionCompanions(int section) const;
+    void loadSection(int section);
+
     const HeadData &headData() const { return m_headData; }
     void setHeadData(const HeadData &hd) { m_headData = hd; }
 
 private:
     using PersistentObjectId = int;
 
+    class Section
+    {
+    public:
+        qint64 offset = 0;
+        std::vector<int> references;
+
+        // Sections that the caller wants to get loaded along with this one,
+        // see addSectionCompanion().
+        std::vector<int> companions;
+    };
+
+    void loadSectionIndex(qint64 indexOffset, qint64 fileSize);
+    void storeSectionIndex();
+    void addSectionReference(int section);
+    void clearSections();
+
+    // Stored in the file header, so that the id tables can be allocated up front when loading.
+    class StorageCounts
+    {
+    public:
+        void load(PersistentPool &pool);
+        void store(PersistentPool &pool);
+
+        int objectCount = 0;
+        int stringCount = 0;
+        int envCount = 0;
+        int stringListCount = 0;
+    };
+
     template <typename T> T *idLoad();
     template <class T> std::shared_ptr<T> idLoadS();
     template <typename T> T idLoadValue();
@@ -144,10 +205,14 @@ private:
     template<typename T> std::vector<T> &idStorage();
     template<typename T> QHash<T, PersistentObjectId> &idMap();
     template<typename T> PersistentObjectId &lastStoredId();
+    template<typename T> std::vector<int> &idSections();
 
     static const PersistentObjectId ValueNotFoundId = -1;
     static const PersistentObjectId EmptyValueId = -2;
 
+    std::unique_ptr<QIODevice> m_mappedFile;
+    QByteArray m_mappedData;
+    QByteArray m_recordData;
     std::unique_ptr<QIODevice> m_file;
     QDataStream m_stream;
     HeadData m_headData;
@@ -155,6 +220,15 @@ private:
     std::vector<std::shared_ptr<void>> m_loaded;
     std::unordered_map<const void*, int> m_storageIndices;
     PersistentObjectId m_lastStoredObjectId = 0;
+    std::vector<Section> m_sections;
+    int m_currentSection = 0;
+    qint64 m_dataEnd = 0;
+
+    // The sections in which the objects and values were stored first, indexed by id.
+    std::vector<int> m_objectSections;
+    std::vector<int> m_stringSections;
+    std::vector<int> m_envSections;
+    std::vector<int> m_stringListSections;
 
     std::vector<QString> m_stringStorage;
     QHash<QString, int> m_inverseStringStorage;
@@ -173,6 +247,15 @@ private:
 
 template<typename T> inline const void *uniqueAddress(const T *t) { return t; }
 
+inline void PersistentPool::addSectionReference(int section)
+{
+    if (section == 0 || section == m_currentSection)
+        return;
+    std::vector<int> &references = m_sections.at(m_currentSection).references;
+    if (std::find(references.cbegin(), references.cend(), section) == references.cend())
+        references.push_back(section);
+}
+
 template<typename T> inline void PersistentPool::storeSharedObject(const T *object)
 {
     if (!object) {
@@ -184,13 +267,22 @@ template<typename T> inline void PersistentPool::storeSharedObject(const T *obje
     if (found == m_storageIndices.end()) {
         PersistentObjectId id = m_lastStoredObjectId++;
         m_storageIndices[addr] = id;
+        m_objectSections.push_back(m_currentSection);
         m_stream << id;
         store(*object);
     } else {
+        addSectionReference(m_objectSections.at(found->second));
         m_stream << found->second;
     }
 }
 
+template<typename T> inline int PersistentPool::sectionOfStoredObject(const T *object) const
+{
+    const auto found = m_storageIndices.find(uniqueAddress(object));
+    QBS_CHECK(found != m_storageIndices.end());
+    return m_objectSections.at(found->second);
+}
+
 template <typename T> inline T *PersistentPool::idLoad()
 {
     PersistentObjectId id;
@@ -199,13 +291,17 @@ template <typename T> inline T *PersistentPool::idLoad()
     if (id < 0)
         return nullptr;
 
-    if (id < static_cast<PersistentObjectId>(m_loadedRaw.size()))
-        return static_cast<T *>(m_loadedRaw.at(id));
-
-    auto i = m_loadedRaw.size();
-    m_loadedRaw.resize(id + 1);
-    for (; i < m_loadedRaw.size(); ++i)
-        m_loadedRaw[i] = nullptr;
+    // With sections being loaded out of order, an id below the size of the table
+    // can belong to an object that has not been loaded yet.
+    if (id < static_cast<PersistentObjectId>(m_loadedRaw.size())) {
+        if (void * const object = m_loadedRaw.at(id))
+            return static_cast<T *>(object);
+    } else {
+        auto i = m_loadedRaw.size();
+        m_loadedRaw.resize(id + 1);
+        for (; i < m_loadedRaw.size(); ++i)
+            m_loadedRaw[i] = nullptr;
+    }
 
     const auto t = new T;
     m_loadedRaw[id] = t;
@@ -248,6 +344,18 @@ template<> inline PersistentPool::PersistentObjectId
 {
     return m_lastStoredEnvId;
 }
+template<> inline std::vector<int> &PersistentPool::idSections<QString>()
+{
+    return m_stringSections;
+}
+template<> inline std::vector<int> &PersistentPool::idSections<QStringList>()
+{
+    return m_stringListSections;
+}
+template<> inline std::vector<int> &PersistentPool::idSections<QProcessEnvironment>()
+{
+    return m_envSections;
+}
 
 template <class T> inline std::shared_ptr<T> PersistentPool::idLoadS()
 {
@@ -257,10 +365,12 @@ template <class T> inline std::shared_ptr<T> PersistentPool::idLoadS()
     if (id < 0)
         return std::shared_ptr<T>();
 
-    if (id < static_cast<PersistentObjectId>(m_loaded.size()))
-        return std::static_pointer_cast<T>(m_loaded.at(id));
-
-    m_loaded.resize(id + 1);
+    if (id < static_cast<PersistentObjectId>(m_loaded.size())) {
+        if (const auto &object = m_loaded.at(id))
+            return std::static_pointer_cast<T>(object);
+    } else {
+        m_loaded.resize(id + 1);
+    }
     const std::shared_ptr<T> t = T::create();
     m_loaded[id] = t;
     load(*t);
@@ -274,14 +384,16 @@ template<typename T> inline T PersistentPool::idLoadValue()
     if (id == EmptyValueId)
         return T();
     QBS_CHECK(id >= 0);
-    if (id >= static_cast<int>(idStorage<T>().size())) {
-        T value;
-        doLoadValue(value);
+
+    // Stored values are never empty, so an empty entry is one that has not been loaded yet.
+    if (id < static_cast<int>(idStorage<T>().size()) && !idStorage<T>().at(id).isEmpty())
+        return idStorage<T>().at(id);
+    T value;
+    doLoadValue(value);
+    if (id >= static_cast<int>(idStorage<T>().size()))
         idStorage<T>().resize(id + 1);
-        idStorage<T>()[id] = value;
-        return value;
-    }
-    return idStorage<T>().at(id);
+    idStorage<T>()[id] = value;
+    return value;
 }
 
 template<typename T>
@@ -295,9 +407,11 @@ void PersistentPool::idStoreValue(const T &value)
     if (id < 0) {
         id = lastStoredId<T>()++;
         idMap<T>().insert(value, id);
+        idSections<T>().push_back(m_currentSection);
         m_stream << id;
         doStoreValue(value);
     } else {
+        addSectionReference(idSections<T>().at(id));
         m_stream << id;
     }
 }
@@ -408,6 +522,12 @@ template<> struct PPHelper<QVariant>
     static void load(QVariant &v, PersistentPool *pool) { v = pool->loadVariant(); }
 };
 
+template<> struct PPHelper<QByteArray>
+{
+    static void store(const QByteArray &v, PersistentPool *pool) { pool->m_stream << v; }
+    static void load(QByteArray &v, PersistentPool *pool) { pool->m_stream >> v; }
+};
+
 template<> struct PPHelper<QRegularExpression>
 {
     static void store(const QRegularExpression &re, PersistentPool *pool)
@@ -45,6 +45,8 @@
 #include "profile.h"
 #include "stringconstants.h"
 
+#include <QtCore/qstandardpaths.h>
+
 namespace qbs {
 
 /*!
@@ -153,6 +155,85 @@ JobLimits Preferences::jobLimits() const
     return limits;
 }
 
+/*!
+ * \brief Returns the directory of the action cache used by default.
+ * If this is empty, no action cache is used unless one is specified explicitly.
+ */
+QString Preferences::actionCacheDirectory() const
+{
+    return getPreference(QStringLiteral("actionCacheDirectory")).toString();
+}
+
+/*!
+ * \brief Returns the maximum size of the action cache in bytes.
+ * The preference itself is given in MiB. The default is 10 GiB.
+ */
+qint64 Preferences::actionCacheMaxSize() const
+{
+    return getPreference(QStringLiteral("actionCacheMaxSize"), 10 * 1024).toLongLong()
+            * 1024 * 1024;
+}
+
+/*!
+ * \brief Returns the directory in which the parsed forms of project files are cached.
+ * The default is the directory "qbs/parse-cache" in the user's cache location.
+ * If this is set to an empty string, no parse cache is used.
+ */
+QString Preferences::parseCacheDirectory() const
+{
+    const QString cacheLocation
+            = QStandardPaths::writableLocation(QStandardPaths::GenericCacheLocation);
+    const QString defaultDir = cacheLocation.isEmpty()
+            ? QString() : cacheLocation + QStringLiteral("/qbs/parse-cache");
+    return getPreference(QStringLiteral("parseCacheDirectory"), defaultDir).toString();
+}
+
+/*!
+ * \brief Returns the maximum size of the parse cache in bytes.
+ * The preference itself is given in MiB. The default is 1 GiB.
+ */
+qint64 Preferences::parseCacheMaxSize() const
+{
+    return getPreference(QStringLiteral("parseCacheMaxSize"), 1024).toLongLong() * 1024 * 1024;
+}
+
+/*!
+ * \brief Returns the directory in which the results of probes are cached.
+ * The default is an empty string, which means that no probe cache is used.
+ */
+QString Preferences::probeCacheDirectory() const
+{
+    return getPreference(QStringLiteral("probeCacheDirectory")).toString();
+}
+
+/*!
+ * \brief Returns how many bytes of each output channel of a command are kept in memory.
+ * Older output is discarded. The preference itself is given in KiB. The default is 16 MiB.
+ * A value of zero means there is no limit.
+ */
+qint64 Preferences::maxProcessOutputSize() const
+{
+    return getPreference(QStringLiteral("maxProcessOutputSize"), 16 * 1024).toLongLong() * 1024;
+}
+
+/*!
+ * \brief Returns true if qbs should act as a GNU make job server for the commands it runs.
+ * The default is false.
+ */
+bool Preferences::useJobServer() const
+{
+    return getPreference(QStringLiteral("useJobServer"), false).toBool();
+}
+
+/*!
+ * \brief Returns true if the prepare scripts of a rule may run concurrently.
+ * The default is false.
+ */
+bool Preferences::parallelPrepareScripts() const
+{
+    return getPreference(QStringLiteral("parallelPrepareScripts"), false).toBool();
+}
+
 QVariant Preferences::getPreference(const QString &key, const QVariant &defaultValue) const
 {
     static const QString keyPrefix = QStringLiteral("preferences");
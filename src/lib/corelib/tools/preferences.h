@@ -65,6 +65,14 @@ public:
     QStringList searchPaths(const QString &baseDir = QString()) const;
     QStringList pluginPaths(const QString &baseDir = QString()) const;
     JobLimits jobLimits() const;
+    QString actionCacheDirectory() const;
+    qint64 actionCacheMaxSize() const;
+    QString parseCacheDirectory() const;
+    qint64 parseCacheMaxSize() const;
+    QString probeCacheDirectory() const;
+    qint64 maxProcessOutputSize() const;
+    bool useJobServer() const;
+    bool parallelPrepareScripts() const;
 
 private:
     QVariant getPreference(const QString &key, const QVariant &defaultValue = QVariant()) const;
@@ -124,6 +124,61 @@ QStringList ProcessResult::stdErr() const
     return d->stdErr;
 }
 
+/*!
+ * \brief Returns true if the output in stdOut() and stdErr() was already reported line by line
+ *        via BuildJob::reportCommandOutput() while the command was running.
+ */
+bool ProcessResult::outputForwarded() const
+{
+    return d->outputForwarded;
+}
+
+/*!
+ * \brief Returns the CPU time in milliseconds that the command spent in user mode.
+ *        The value is -1 if it is not known.
+ */
+qint64 ProcessResult::userTime() const
+{
+    return d->userTime;
+}
+
+/*!
+ * \brief Returns the CPU time in milliseconds that the command spent in kernel mode.
+ *        The value is -1 if it is not known.
+ */
+qint64 ProcessResult::systemTime() const
+{
+    return d->systemTime;
+}
+
+/*!
+ * \brief Returns the peak amount of physical memory in bytes that the command used.
+ *        On Unix, this is the largest resident set size of the command or one of
+ *        its sub-processes. The value is -1 if it is not known.
+ */
+qint64 ProcessResult::peakMemoryUsage() const
+{
+    return d->peakMemoryUsage;
+}
+
+/*!
+ * \brief Returns how many times the command had to read from a block device.
+ *        On Windows, all read operations are counted. The value is -1 if it is not known.
+ */
+qint64 ProcessResult::blockInputOperations() const
+{
+    return d->blockInputOperations;
+}
+
+/*!
+ * \brief Returns how many times the command had to write to a block device.
+ *        On Windows, all write operations are counted. The value is -1 if it is not known.
+ */
+qint64 ProcessResult::blockOutputOperations() const
+{
+    return d->blockOutputOperations;
+}
+
 static QJsonValue processErrorToJson(QProcess::ProcessError error)
 {
     switch (error) {
@@ -139,7 +194,7 @@ static QJsonValue processErrorToJson(QProcess::ProcessError error)
 
 QJsonObject qbs::ProcessResult::toJson() const
 {
-    return QJsonObject{
+    QJsonObject result{
         {QStringLiteral("success"), success()},
         {QStringLiteral("executable-file-path"), executableFilePath()},
         {QStringLiteral("arguments"), QJsonArray::fromStringList(arguments())},
@@ -147,8 +202,19 @@ QJsonObject qbs::ProcessResult::toJson() const
         {QStringLiteral("error"), processErrorToJson(error())},
         {QStringLiteral("exit-code"), exitCode()},
         {QStringLiteral("stdout"), QJsonArray::fromStringList(stdOut())},
-        {QStringLiteral("stderr"), QJsonArray::fromStringList(stdErr())}
+        {QStringLiteral("stderr"), QJsonArray::fromStringList(stdErr())},
+        {QStringLiteral("output-forwarded"), outputForwarded()}
+    };
+    const auto insertIfKnown = [&result](const QString &key, qint64 value) {
+        if (value >= 0)
+            result.insert(key, value);
     };
+    insertIfKnown(QStringLiteral("user-time"), userTime());
+    insertIfKnown(QStringLiteral("system-time"), systemTime());
+    insertIfKnown(QStringLiteral("peak-memory-usage"), peakMemoryUsage());
+    insertIfKnown(QStringLiteral("block-input-operations"), blockInputOperations());
+    insertIfKnown(QStringLiteral("block-output-operations"), blockOutputOperations());
+    return result;
 }
 
 } // namespace qbs
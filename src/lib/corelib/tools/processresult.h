@@ -75,6 +75,13 @@ public:
     int exitCode() const;
     QStringList stdOut() const;
     QStringList stdErr() const;
+    bool outputForwarded() const;
+
+    qint64 userTime() const;
+    qint64 systemTime() const;
+    qint64 peakMemoryUsage() const;
+    qint64 blockInputOperations() const;
+    qint64 blockOutputOperations() const;
 
 private:
     QExplicitlySharedDataPointer<Internal::ProcessResultPrivate> d;
@@ -39,6 +39,8 @@
 
 #include "profiling.h"
 
+#include "tracerecorder.h"
+
 #include <logging/logger.h>
 #include <logging/translator.h>
 
@@ -53,17 +55,25 @@ public:
     Logger logger;
     QString activity;
     QElapsedTimer timer;
+    qint64 traceStartTime = -1;
+    bool logTime = false;
 };
 
 TimedActivityLogger::TimedActivityLogger(const Logger &logger, const QString &activity,
         bool enabled)
     : d(nullptr)
 {
-    if (!enabled)
+    const bool tracing = TraceScope::isTracing();
+    if (!enabled && !tracing)
         return;
     d = std::make_unique<TimedActivityLoggerPrivate>();
     d->logger = logger;
     d->activity = activity;
+    d->logTime = enabled;
+    if (tracing)
+        d->traceStartTime = TraceRecorder::instance().currentTime();
+    if (!enabled)
+        return;
     d->logger.qbsLog(LoggerInfo, true) << Tr::tr("Starting activity '%2'.").arg(activity);
     d->timer.start();
 }
@@ -72,9 +82,16 @@ void TimedActivityLogger::finishActivity()
 {
     if (!d)
         return;
-    const QString timeString = elapsedTimeString(d->timer.elapsed());
-    d->logger.qbsLog(LoggerInfo, true)
-            << Tr::tr("Activity '%2' took %3.").arg(d->activity, timeString);
+    if (d->traceStartTime >= 0) {
+        TraceRecorder &recorder = TraceRecorder::instance();
+        recorder.addEvent("activity", d->activity, d->traceStartTime,
+                          recorder.currentTime() - d->traceStartTime);
+    }
+    if (d->logTime) {
+        const QString timeString = elapsedTimeString(d->timer.elapsed());
+        d->logger.qbsLog(LoggerInfo, true)
+                << Tr::tr("Activity '%2' took %3.").arg(d->activity, timeString);
+    }
     d.reset();
 }
 
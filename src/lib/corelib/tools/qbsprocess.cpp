@@ -51,14 +51,12 @@
 namespace qbs {
 namespace Internal {
 
-QbsProcess::QbsProcess(QObject *parent) : QObject(parent)
+QbsProcess::QbsProcess(QObject *parent)
+    : QObject(parent), m_socket(LauncherInterface::socket())
 {
-    connect(LauncherInterface::socket(), &LauncherSocket::ready,
-            this, &QbsProcess::handleSocketReady);
-    connect(LauncherInterface::socket(), &LauncherSocket::errorOccurred,
-            this, &QbsProcess::handleSocketError);
-    connect(LauncherInterface::socket(), &LauncherSocket::packetArrived,
-            this, &QbsProcess::handlePacket);
+    connect(m_socket, &LauncherSocket::ready, this, &QbsProcess::handleSocketReady);
+    connect(m_socket, &LauncherSocket::errorOccurred, this, &QbsProcess::handleSocketError);
+    connect(m_socket, &LauncherSocket::packetArrived, this, &QbsProcess::handlePacket);
 }
 
 void QbsProcess::start(const QString &command, const QStringList &arguments)
@@ -70,8 +68,12 @@ void QbsProcess::start(const QString &command, const QStringList &arguments)
     }
     m_command = command;
     m_arguments = arguments;
+    m_stdout.clear();
+    m_stderr.clear();
+    m_pendingInput.clear();
+    m_resourceUsage = ProcessResourceUsage();
     m_state = QProcess::Starting;
-    if (LauncherInterface::socket()->isReady())
+    if (m_socket->isReady())
         doStart();
 }
 
@@ -84,6 +86,8 @@ void QbsProcess::doStart()
     p.env = m_environment.toStringList();
     p.workingDir = m_workingDirectory;
     sendPacket(p);
+    if (!m_pendingInput.isEmpty())
+        write(readAndClear(m_pendingInput));
 }
 
 void QbsProcess::cancel()
@@ -103,6 +107,23 @@ void QbsProcess::cancel()
     }
 }
 
+void QbsProcess::write(const QByteArray &data)
+{
+    switch (m_state) {
+    case QProcess::NotRunning:
+        break;
+    case QProcess::Starting:
+        m_pendingInput += data;
+        break;
+    case QProcess::Running: {
+        WriteInputPacket p(token());
+        p.data = data;
+        sendPacket(p);
+        break;
+    }
+    }
+}
+
 QByteArray QbsProcess::readAllStandardOutput()
 {
     return readAndClear(m_stdout);
@@ -115,7 +136,7 @@ QByteArray QbsProcess::readAllStandardError()
 
 void QbsProcess::sendPacket(const LauncherPacket &packet)
 {
-    LauncherInterface::socket()->sendData(packet.serialize());
+    m_socket->sendData(packet.serialize());
 }
 
 QByteArray QbsProcess::readAndClear(QByteArray &data)
@@ -133,6 +154,9 @@ void QbsProcess::handlePacket(LauncherPacketType type, quintptr token, const QBy
     case LauncherPacketType::ProcessError:
         handleErrorPacket(payload);
         break;
+    case LauncherPacketType::ProcessOutput:
+        handleOutputPacket(payload);
+        break;
     case LauncherPacketType::ProcessFinished:
         handleFinishedPacket(payload);
         break;
@@ -169,15 +193,29 @@ void QbsProcess::handleErrorPacket(const QByteArray &packetData)
     emit errorOccurred(m_error);
 }
 
+void QbsProcess::handleOutputPacket(const QByteArray &packetData)
+{
+    QBS_ASSERT(m_state == QProcess::Running, return);
+    const auto packet = LauncherPacket::extractPacket<ProcessOutputPacket>(token(), packetData);
+    if (packet.channel == QProcess::StandardOutput) {
+        m_stdout += packet.data;
+        emit readyReadStandardOutput();
+    } else {
+        m_stderr += packet.data;
+        emit readyReadStandardError();
+    }
+}
+
 void QbsProcess::handleFinishedPacket(const QByteArray &packetData)
 {
     QBS_ASSERT(m_state == QProcess::Running, return);
     m_state = QProcess::NotRunning;
     const auto packet = LauncherPacket::extractPacket<ProcessFinishedPacket>(token(), packetData);
     m_exitCode = packet.exitCode;
-    m_stdout = packet.stdOut;
-    m_stderr = packet.stdErr;
+    m_stdout += packet.stdOut;
+    m_stderr += packet.stdErr;
     m_errorString = packet.errorString;
+    m_resourceUsage = packet.resourceUsage;
     emit finished(m_exitCode);
 }
 
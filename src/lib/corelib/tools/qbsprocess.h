@@ -49,6 +49,7 @@
 
 namespace qbs {
 namespace Internal {
+class LauncherSocket;
 
 class QbsProcess : public QObject
 {
@@ -62,14 +63,18 @@ public:
     QString workingDirectory() const { return m_workingDirectory; }
     void start(const QString &command, const QStringList &arguments);
     void cancel();
+    void write(const QByteArray &data);
     QByteArray readAllStandardOutput();
     QByteArray readAllStandardError();
     int exitCode() const { return m_exitCode; }
     QProcess::ProcessError error() const { return m_error; }
     QString errorString() const { return m_errorString; }
+    ProcessResourceUsage resourceUsage() const { return m_resourceUsage; }
 
 signals:
     void errorOccurred(QProcess::ProcessError error);
+    void readyReadStandardOutput();
+    void readyReadStandardError();
     void finished(int exitCode);
 
 private:
@@ -81,18 +86,22 @@ private:
     void handlePacket(qbs::Internal::LauncherPacketType type, quintptr token,
                       const QByteArray &payload);
     void handleErrorPacket(const QByteArray &packetData);
+    void handleOutputPacket(const QByteArray &packetData);
     void handleFinishedPacket(const QByteArray &packetData);
     void handleSocketReady();
 
     quintptr token() const { return reinterpret_cast<quintptr>(this); }
 
+    LauncherSocket * const m_socket;
     QString m_command;
     QStringList m_arguments;
     QProcessEnvironment m_environment;
     QString m_workingDirectory;
     QByteArray m_stdout;
     QByteArray m_stderr;
+    QByteArray m_pendingInput; // Written before the launcher was ready.
     QString m_errorString;
+    ProcessResourceUsage m_resourceUsage;
     QProcess::ProcessError m_error = QProcess::UnknownError;
     QProcess::ProcessState m_state = QProcess::NotRunning;
     int m_exitCode = 0;
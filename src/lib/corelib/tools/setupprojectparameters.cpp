@@ -84,6 +84,10 @@ public:
     QStringList pluginPaths;
     QString libexecPath;
     QString settingsBaseDir;
+    QString traceFilePath;
+    int maxResolverJobCount = 1;
+    QString parseCacheDir;
+    QString probeCacheDir;
     QVariantMap overriddenValues;
     QVariantMap buildConfiguration;
     mutable QVariantMap buildConfigurationTree;
@@ -148,6 +152,10 @@ SetupProjectParameters SetupProjectParameters::fromJson(const QJsonObject &data)
     setValueFromJson(params.d->overriddenValues, data, "overridden-properties");
     setValueFromJson(params.d->dryRun, data, "dry-run");
     setValueFromJson(params.d->logElapsedTime, data, "log-time");
+    setValueFromJson(params.d->traceFilePath, data, "trace-file");
+    setValueFromJson(params.d->maxResolverJobCount, data, "max-resolver-job-count");
+    setValueFromJson(params.d->parseCacheDir, data, "parse-cache-directory");
+    setValueFromJson(params.d->probeCacheDir, data, "probe-cache-directory");
     setValueFromJson(params.d->forceProbeExecution, data, "force-probe-execution");
     setValueFromJson(params.d->waitLockBuildGraph, data, "wait-lock-build-graph");
     setValueFromJson(params.d->fallbackProviderEnabled, data, "fallback-provider-enabled");
@@ -510,6 +518,84 @@ void SetupProjectParameters::setLogElapsedTime(bool logElapsedTime)
     d->logElapsedTime = logElapsedTime;
 }
 
+/*!
+ * \brief Returns the file that a trace of the operation is written to.
+ * If the path is empty, no trace is recorded.
+ */
+QString SetupProjectParameters::traceFilePath() const
+{
+    return d->traceFilePath;
+}
+
+/*!
+ * Makes qbs record when module loading, probes, resolving and build graph loading
+ * and storing take place, and write this information to the file \a filePath
+ * in the Chrome trace event format.
+ * If a build job uses the same trace file, its events are appended to those recorded here.
+ * The default is an empty path, which means that no trace is recorded.
+ */
+void SetupProjectParameters::setTraceFilePath(const QString &filePath)
+{
+    d->traceFilePath = filePath;
+}
+
+/*!
+ * \brief Returns the maximum number of threads used for evaluating the properties of products.
+ */
+int SetupProjectParameters::maxResolverJobCount() const
+{
+    return d->maxResolverJobCount;
+}
+
+/*!
+ * Makes qbs evaluate the module and product properties of up to \a jobCount products
+ * concurrently when resolving the project. Each thread uses its own JavaScript engine.
+ * The default is 1, which means that all products are resolved one after the other.
+ */
+void SetupProjectParameters::setMaxResolverJobCount(int jobCount)
+{
+    d->maxResolverJobCount = jobCount;
+}
+
+/*!
+ * \brief Returns the directory in which the results of parsing project files are cached.
+ */
+QString SetupProjectParameters::parseCacheDirectory() const
+{
+    return d->parseCacheDir;
+}
+
+/*!
+ * Makes qbs store the parsed form of .qbs and .js files in \a directory and take it from
+ * there instead of parsing files whose contents it has seen before.
+ * The directory can be shared by several build directories and processes.
+ * The default is an empty path, which means that no parse cache is used.
+ */
+void SetupProjectParameters::setParseCacheDirectory(const QString &directory)
+{
+    d->parseCacheDir = directory;
+}
+
+/*!
+ * \brief Returns the directory in which the results of probes are cached.
+ */
+QString SetupProjectParameters::probeCacheDirectory() const
+{
+    return d->probeCacheDir;
+}
+
+/*!
+ * Makes qbs store the results of probes in \a directory and take them from there instead of
+ * running a probe's configure script again for the same inputs, even in other build
+ * directories. An entry is only used if the files and environment variables that the
+ * configure script looked at have not changed since.
+ * The default is an empty path, which means that no probe cache is used.
+ */
+void SetupProjectParameters::setProbeCacheDirectory(const QString &directory)
+{
+    d->probeCacheDir = directory;
+}
+
 
 /*!
  * \brief Returns true iff probes should be re-run.
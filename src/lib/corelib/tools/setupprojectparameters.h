@@ -121,6 +121,18 @@ public:
     bool logElapsedTime() const;
     void setLogElapsedTime(bool logElapsedTime);
 
+    QString traceFilePath() const;
+    void setTraceFilePath(const QString &filePath);
+
+    int maxResolverJobCount() const;
+    void setMaxResolverJobCount(int jobCount);
+
+    QString parseCacheDirectory() const;
+    void setParseCacheDirectory(const QString &directory);
+
+    QString probeCacheDirectory() const;
+    void setProbeCacheDirectory(const QString &directory);
+
     bool forceProbeExecution() const;
     void setForceProbeExecution(bool force);
 
@@ -0,0 +1,137 @@
+/****************************************************************************
+**
+** Copyright (C) 2022 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of Qbs.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-2.0.html and
+** https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#include "systemresources.h"
+
+#if defined(Q_OS_WIN)
+#   include <QtCore/qt_windows.h>
+#elif defined(Q_OS_DARWIN)
+#   include <mach/mach.h>
+#elif defined(Q_OS_LINUX)
+#   include <QtCore/qfile.h>
+#endif
+
+#if defined(Q_OS_UNIX)
+#   include <stdlib.h>
+#endif
+
+namespace qbs {
+namespace Internal {
+
+qint64 availablePhysicalMemory()
+{
+#if defined(Q_OS_WIN)
+    MEMORYSTATUSEX status;
+    status.dwLength = sizeof status;
+    if (!GlobalMemoryStatusEx(&status))
+        return -1;
+    return qint64(status.ullAvailPhys);
+#elif defined(Q_OS_DARWIN)
+    vm_statistics64_data_t stats;
+    mach_msg_type_number_t count = HOST_VM_INFO64_COUNT;
+    const mach_port_t host = mach_host_self();
+    if (host_statistics64(host, HOST_VM_INFO64, reinterpret_cast<host_info64_t>(&stats),
+                          &count) != KERN_SUCCESS) {
+        return -1;
+    }
+    vm_size_t pageSize;
+    if (host_page_size(host, &pageSize) != KERN_SUCCESS)
+        return -1;
+    return qint64(stats.free_count + stats.inactive_count) * qint64(pageSize);
+#elif defined(Q_OS_LINUX)
+    QFile memInfo(QStringLiteral("/proc/meminfo"));
+    if (!memInfo.open(QIODevice::ReadOnly))
+        return -1;
+    static const QByteArray key = "MemAvailable:";
+    const QByteArray content = memInfo.readAll();
+    const int keyPos = content.indexOf(key);
+    if (keyPos == -1)
+        return -1; // Kernels before 3.14 do not provide this value.
+    const int lineEnd = content.indexOf('\n', keyPos);
+    QByteArray value = content.mid(keyPos + key.size(),
+                                   lineEnd == -1 ? -1 : lineEnd - keyPos - key.size()).trimmed();
+    if (value.endsWith(" kB"))
+        value.chop(3);
+    bool ok;
+    const qint64 kiB = value.toLongLong(&ok);
+    return ok ? kiB * 1024 : -1;
+#else
+    return -1;
+#endif
+}
+
+double systemLoadAverage()
+{
+#if defined(Q_OS_UNIX)
+    double loadAverage;
+    if (getloadavg(&loadAverage, 1) != 1)
+        return -1;
+    return loadAverage;
+#else
+    return -1;
+#endif
+}
+
+double cpuPressure()
+{
+#if defined(Q_OS_LINUX)
+    // The first line looks like this: "some avg10=1.23 avg60=0.50 avg300=0.10 total=12345"
+    QFile pressureFile(QStringLiteral("/proc/pressure/cpu"));
+    if (!pressureFile.open(QIODevice::ReadOnly))
+        return -1; // Kernels before 4.20 or without CONFIG_PSI.
+    const QByteArray line = pressureFile.readLine();
+    if (!line.startsWith("some "))
+        return -1;
+    static const QByteArray key = "avg10=";
+    const int keyPos = line.indexOf(key);
+    if (keyPos == -1)
+        return -1;
+    const int valueEnd = line.indexOf(' ', keyPos);
+    bool ok;
+    const double pressure = line.mid(keyPos + key.size(),
+                                     valueEnd == -1 ? -1 : valueEnd - keyPos - key.size())
+            .toDouble(&ok);
+    return ok ? pressure : -1;
+#else
+    return -1;
+#endif
+}
+
+} // namespace Internal
+} // namespace qbs
@@ -0,0 +1,64 @@
+/****************************************************************************
+**
+** Copyright (C) 2022 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of Qbs.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-2.0.html and
+** https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#ifndef QBS_SYSTEMRESOURCES_H
+#define QBS_SYSTEMRESOURCES_H
+
+#include <QtCore/qglobal.h>
+
+namespace qbs {
+namespace Internal {
+
+// Returns the amount of physical memory in bytes that can be used by new processes
+// without swapping, or -1 if it cannot be determined on this platform.
+qint64 availablePhysicalMemory();
+
+// Returns the number of runnable processes averaged over the last minute,
+// or -1 if it cannot be determined on this platform.
+double systemLoadAverage();
+
+// Returns the percentage of the last ten seconds in which at least one runnable task
+// was stalled waiting for a CPU, as reported by the Linux pressure stall information,
+// or -1 if it is not available.
+double cpuPressure();
+
+} // namespace Internal
+} // namespace qbs
+
+#endif // QBS_SYSTEMRESOURCES_H
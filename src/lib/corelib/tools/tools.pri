@@ -8,6 +8,7 @@ QBS_SYSTEM_SETTINGS_DIR = $$(QBS_SYSTEM_SETTINGS_DIR)
 }
 
 HEADERS += \
+    $$PWD/actioncache.h \
     $$PWD/architectures.h \
     $$PWD/buildgraphlocker.h \
     $$PWD/clangclinfo.h \
@@ -19,6 +20,7 @@ HEADERS += \
     $$PWD/fileinfo.h \
     $$PWD/filesaver.h \
     $$PWD/filetime.h \
+    $$PWD/functionrunnable.h \
     $$PWD/generateoptions.h \
     $$PWD/id.h \
     $$PWD/iosutils.h \
@@ -51,12 +53,14 @@ HEADERS += \
     $$PWD/shellutils.h \
     $$PWD/stlutils.h \
     $$PWD/stringutils.h \
+    $$PWD/systemresources.h \
     $$PWD/toolchains.h \
     $$PWD/hostosinfo.h \
     $$PWD/buildoptions.h \
     $$PWD/installoptions.h \
     $$PWD/cleanoptions.h \
     $$PWD/setupprojectparameters.h \
+    $$PWD/tracerecorder.h \
     $$PWD/weakpointer.h \
     $$PWD/qbs_export.h \
     $$PWD/qbsassert.h \
@@ -68,6 +72,7 @@ HEADERS += \
     $$PWD/vsenvironmentdetector.h
 
 SOURCES += \
+    $$PWD/actioncache.cpp \
     $$PWD/architectures.cpp \
     $$PWD/buildgraphlocker.cpp \
     $$PWD/clangclinfo.cpp \
@@ -109,7 +114,9 @@ SOURCES += \
     $$PWD/qbsassert.cpp \
     $$PWD/qttools.cpp \
     $$PWD/settingscreator.cpp \
+    $$PWD/systemresources.cpp \
     $$PWD/toolchains.cpp \
+    $$PWD/tracerecorder.cpp \
     $$PWD/version.cpp \
     $$PWD/visualstudioversioninfo.cpp \
     $$PWD/vsenvironmentdetector.cpp
@@ -0,0 +1,215 @@
+/****************************************************************************
+**
+** Copyright (C) 2022 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of Qbs.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-2.0.html and
+** https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#include "tracerecorder.h"
+
+#include "fileinfo.h"
+
+#include <logging/translator.h>
+
+#include <QtCore/qcoreapplication.h>
+#include <QtCore/qdir.h>
+#include <QtCore/qfile.h>
+#include <QtCore/qjsonarray.h>
+#include <QtCore/qjsondocument.h>
+#include <QtCore/qjsonobject.h>
+#include <QtCore/qthread.h>
+
+namespace qbs {
+namespace Internal {
+
+static std::atomic_int recordingGeneration{0};
+
+TraceRecorder &TraceRecorder::instance()
+{
+    static TraceRecorder recorder;
+    return recorder;
+}
+
+// A setup job and the subsequent build job share one recording if they use the same file.
+void TraceRecorder::start(const QString &filePath)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_active && filePath == m_filePath)
+        return;
+    m_filePath = filePath;
+    m_events.clear();
+    m_laneNames.clear();
+    ++recordingGeneration;
+    m_timer.start();
+    m_active = true;
+}
+
+void TraceRecorder::stop()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_active = false;
+    m_events.clear();
+    m_laneNames.clear();
+    m_filePath.clear();
+}
+
+QString TraceRecorder::filePath() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_filePath;
+}
+
+qint64 TraceRecorder::currentTime() const
+{
+    return m_timer.nsecsElapsed() / 1000;
+}
+
+int TraceRecorder::threadLane()
+{
+    struct LaneData { int generation = -1; int lane = -1; };
+    static thread_local LaneData laneData;
+    const int generation = recordingGeneration;
+    if (laneData.generation == generation)
+        return laneData.lane;
+    const QThread * const thread = QThread::currentThread();
+    const QCoreApplication * const app = QCoreApplication::instance();
+    std::lock_guard<std::mutex> lock(m_mutex);
+    QString name = thread->objectName();
+    if (name.isEmpty()) {
+        name = app && app->thread() == thread
+                ? QStringLiteral("Main thread")
+                : QStringLiteral("Thread %1").arg(m_laneNames.size() + 1);
+    }
+    laneData.lane = addLane(name);
+    laneData.generation = generation;
+    return laneData.lane;
+}
+
+int TraceRecorder::namedLane(const QString &name)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    for (std::size_t i = 0; i < m_laneNames.size(); ++i) {
+        if (m_laneNames.at(i) == name)
+            return int(i);
+    }
+    return addLane(name);
+}
+
+int TraceRecorder::addLane(const QString &name)
+{
+    m_laneNames.push_back(name);
+    return int(m_laneNames.size()) - 1;
+}
+
+void TraceRecorder::addEvent(const char *category, const QString &name, qint64 startTime,
+                             qint64 duration, int lane)
+{
+    if (!isActive())
+        return;
+    if (lane < 0)
+        lane = threadLane();
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_events.push_back({category, name, startTime, duration, lane});
+}
+
+bool TraceRecorder::writeFile(QString *errorMessage)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (!m_active)
+        return true;
+    QJsonArray events;
+    const auto metaDataEvent = [](const QString &type, int lane, const QString &name) {
+        return QJsonObject{{QStringLiteral("ph"), QStringLiteral("M")},
+                           {QStringLiteral("name"), type},
+                           {QStringLiteral("pid"), 1},
+                           {QStringLiteral("tid"), lane},
+                           {QStringLiteral("args"),
+                            QJsonObject{{QStringLiteral("name"), name}}}};
+    };
+    events.append(metaDataEvent(QStringLiteral("process_name"), 0, QStringLiteral("qbs")));
+    for (std::size_t i = 0; i < m_laneNames.size(); ++i) {
+        events.append(metaDataEvent(QStringLiteral("thread_name"), int(i), m_laneNames.at(i)));
+        events.append(QJsonObject{{QStringLiteral("ph"), QStringLiteral("M")},
+                                  {QStringLiteral("name"), QStringLiteral("thread_sort_index")},
+                                  {QStringLiteral("pid"), 1},
+                                  {QStringLiteral("tid"), int(i)},
+                                  {QStringLiteral("args"),
+                                   QJsonObject{{QStringLiteral("sort_index"), int(i)}}}});
+    }
+    for (const Event &event : m_events) {
+        events.append(QJsonObject{{QStringLiteral("ph"), QStringLiteral("X")},
+                                  {QStringLiteral("cat"), QLatin1String(event.category)},
+                                  {QStringLiteral("name"), event.name},
+                                  {QStringLiteral("ts"), double(event.startTime)},
+                                  {QStringLiteral("dur"), double(event.duration)},
+                                  {QStringLiteral("pid"), 1},
+                                  {QStringLiteral("tid"), event.lane}});
+    }
+    const QJsonObject trace{{QStringLiteral("traceEvents"), events},
+                            {QStringLiteral("displayTimeUnit"), QStringLiteral("ms")}};
+
+    const QString dirPath = FileInfo::path(m_filePath);
+    if (!dirPath.isEmpty())
+        QDir().mkpath(dirPath);
+    QFile file(m_filePath);
+    if (!file.open(QIODevice::WriteOnly) || file.write(QJsonDocument(trace).toJson(
+                                                           QJsonDocument::Compact)) == -1) {
+        if (errorMessage) {
+            *errorMessage = Tr::tr("Failed to write trace file '%1': %2")
+                    .arg(QDir::toNativeSeparators(m_filePath), file.errorString());
+        }
+        return false;
+    }
+    return true;
+}
+
+TraceScope::TraceScope(const char *category, const QString &name, int lane)
+    : m_category(category), m_name(name), m_lane(lane)
+{
+    if (isTracing())
+        m_startTime = TraceRecorder::instance().currentTime();
+}
+
+TraceScope::~TraceScope()
+{
+    if (!isActive())
+        return;
+    TraceRecorder &recorder = TraceRecorder::instance();
+    recorder.addEvent(m_category, m_name, m_startTime, recorder.currentTime() - m_startTime,
+                      m_lane);
+}
+
+} // namespace Internal
+} // namespace qbs
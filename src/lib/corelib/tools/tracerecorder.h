@@ -0,0 +1,120 @@
+/****************************************************************************
+**
+** Copyright (C) 2022 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of Qbs.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-2.0.html and
+** https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#ifndef QBS_TRACERECORDER_H
+#define QBS_TRACERECORDER_H
+
+#include <QtCore/qelapsedtimer.h>
+#include <QtCore/qstring.h>
+
+#include <atomic>
+#include <mutex>
+#include <vector>
+
+namespace qbs {
+namespace Internal {
+
+// Collects timed events of a qbs run and writes them in the Chrome trace event format,
+// which can be viewed with chrome://tracing or https://ui.perfetto.dev.
+// Events are recorded on "lanes". By default, the lane is the calling thread, but callers
+// can use named lanes for things that are not bound to a thread, such as job slots.
+class TraceRecorder
+{
+public:
+    static TraceRecorder &instance();
+
+    void start(const QString &filePath);
+    void stop();
+    bool isActive() const { return m_active.load(std::memory_order_relaxed); }
+    QString filePath() const;
+
+    qint64 currentTime() const; // Microseconds since the start of the recording.
+
+    int threadLane();
+    int namedLane(const QString &name);
+
+    void addEvent(const char *category, const QString &name, qint64 startTime,
+                  qint64 duration, int lane = -1);
+
+    bool writeFile(QString *errorMessage);
+
+private:
+    TraceRecorder() = default;
+
+    struct Event
+    {
+        const char *category;
+        QString name;
+        qint64 startTime;
+        qint64 duration;
+        int lane;
+    };
+
+    int addLane(const QString &name);
+
+    mutable std::mutex m_mutex;
+    std::atomic_bool m_active{false};
+    QString m_filePath;
+    QElapsedTimer m_timer;
+    std::vector<Event> m_events;
+    std::vector<QString> m_laneNames;
+};
+
+// Records an event spanning the lifetime of the object, if tracing is active.
+class TraceScope
+{
+public:
+    TraceScope(const char *category, const QString &name = QString(), int lane = -1);
+    ~TraceScope();
+
+    static bool isTracing() { return TraceRecorder::instance().isActive(); }
+    bool isActive() const { return m_startTime >= 0; }
+    void setName(const QString &name) { m_name = name; }
+
+private:
+    const char * const m_category;
+    QString m_name;
+    const int m_lane;
+    qint64 m_startTime = -1;
+};
+
+} // namespace Internal
+} // namespace qbs
+
+#endif // QBS_TRACERECORDER_H
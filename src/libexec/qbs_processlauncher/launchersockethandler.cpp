@@ -40,6 +40,8 @@
 #include "launchersockethandler.h"
 
 #include "launcherlogging.h"
+#include "resourceusagemonitor.h"
+#include "spawnedprocess.h"
 
 #include <QtCore/qcoreapplication.h>
 #include <QtCore/qprocess.h>
@@ -49,15 +51,26 @@
 namespace qbs {
 namespace Internal {
 
-class Process : public QProcess
+#ifdef QBS_LAUNCHER_USE_POSIX_SPAWN
+using ProcessBase = SpawnedProcess;
+#else
+using ProcessBase = QProcess;
+#endif
+
+class Process : public ProcessBase
 {
     Q_OBJECT
 public:
     Process(quintptr token, QObject *parent = nullptr) :
-        QProcess(parent), m_token(token), m_stopTimer(new QTimer(this))
+        ProcessBase(parent), m_token(token), m_stopTimer(new QTimer(this))
     {
         m_stopTimer->setSingleShot(true);
         connect(m_stopTimer, &QTimer::timeout, this, &Process::cancel);
+#ifndef QBS_LAUNCHER_USE_POSIX_SPAWN
+        connect(this, &QProcess::started, this, [this] {
+            m_resourceUsageMonitor.processStarted(processId());
+        });
+#endif
     }
 
     void cancel()
@@ -88,12 +101,24 @@ public:
 
     quintptr token() const { return m_token; }
 
+    ProcessResourceUsage takeResourceUsage()
+    {
+#ifdef QBS_LAUNCHER_USE_POSIX_SPAWN
+        return resourceUsage();
+#else
+        return m_resourceUsageMonitor.processFinished();
+#endif
+    }
+
 signals:
     void failedToStop();
 
 private:
     const quintptr m_token;
     QTimer * const m_stopTimer;
+#ifndef QBS_LAUNCHER_USE_POSIX_SPAWN
+    ResourceUsageMonitor m_resourceUsageMonitor;
+#endif
     enum class StopState { Inactive, Terminating, Killing } m_stopState = StopState::Inactive;
 };
 
@@ -148,6 +173,9 @@ void LauncherSocketHandler::handleSocketData()
     case LauncherPacketType::StopProcess:
         handleStopPacket();
         break;
+    case LauncherPacketType::WriteInput:
+        handleWriteInputPacket();
+        break;
     case LauncherPacketType::Shutdown:
         handleShutdownPacket();
         return;
@@ -192,6 +220,17 @@ void LauncherSocketHandler::handleProcessError()
     sendPacket(packet);
 }
 
+void LauncherSocketHandler::handleProcessOutput(Process *process,
+                                                QProcess::ProcessChannel channel)
+{
+    ProcessOutputPacket packet(process->token());
+    packet.channel = channel;
+    packet.data = channel == QProcess::StandardOutput ? process->readAllStandardOutput()
+                                                      : process->readAllStandardError();
+    if (!packet.data.isEmpty())
+        sendPacket(packet);
+}
+
 void LauncherSocketHandler::handleProcessFinished()
 {
     Process * proc = senderProcess();
@@ -203,6 +242,7 @@ void LauncherSocketHandler::handleProcessFinished()
     packet.exitStatus = proc->exitStatus();
     packet.stdErr = proc->readAllStandardError();
     packet.stdOut = proc->readAllStandardOutput();
+    packet.resourceUsage = proc->takeResourceUsage();
     sendPacket(packet);
 }
 
@@ -255,6 +295,23 @@ void LauncherSocketHandler::handleStopPacket()
     process->cancel();
 }
 
+void LauncherSocketHandler::handleWriteInputPacket()
+{
+    Process * const process = m_processes.value(m_packetParser.token());
+    if (!process) {
+        logWarn("got input for unknown process");
+        return;
+    }
+    if (process->state() == QProcess::NotRunning) {
+        logDebug("got input when process was not running");
+        return;
+    }
+    const auto packet = LauncherPacket::extractPacket<WriteInputPacket>(
+                m_packetParser.token(),
+                m_packetParser.packetData());
+    process->write(packet.data);
+}
+
 void LauncherSocketHandler::handleShutdownPacket()
 {
     logDebug("got shutdown request, closing down");
@@ -277,8 +334,15 @@ void LauncherSocketHandler::sendPacket(const LauncherPacket &packet)
 Process *LauncherSocketHandler::setupProcess(quintptr token)
 {
     const auto p = new Process(token, this);
-    connect(p, &QProcess::errorOccurred, this, &LauncherSocketHandler::handleProcessError);
-    connect(p, static_cast<void (QProcess::*)(int, QProcess::ExitStatus)>(&QProcess::finished),
+    connect(p, &ProcessBase::errorOccurred, this, &LauncherSocketHandler::handleProcessError);
+    connect(p, &ProcessBase::readyReadStandardOutput, this, [this, p] {
+        handleProcessOutput(p, QProcess::StandardOutput);
+    });
+    connect(p, &ProcessBase::readyReadStandardError, this, [this, p] {
+        handleProcessOutput(p, QProcess::StandardError);
+    });
+    connect(p,
+            static_cast<void (ProcessBase::*)(int, QProcess::ExitStatus)>(&ProcessBase::finished),
             this, &LauncherSocketHandler::handleProcessFinished);
     connect(p, &Process::failedToStop, this, &LauncherSocketHandler::handleStopFailure);
     return p;
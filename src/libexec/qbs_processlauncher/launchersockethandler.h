@@ -45,6 +45,7 @@
 #include <QtCore/qbytearray.h>
 #include <QtCore/qhash.h>
 #include <QtCore/qobject.h>
+#include <QtCore/qprocess.h>
 
 QT_BEGIN_NAMESPACE
 class QLocalSocket;
@@ -68,11 +69,13 @@ private:
     void handleSocketError();
     void handleSocketClosed();
     void handleProcessError();
+    void handleProcessOutput(Process *process, QProcess::ProcessChannel channel);
     void handleProcessFinished();
     void handleStopFailure();
 
     void handleStartPacket();
     void handleStopPacket();
+    void handleWriteInputPacket();
     void handleShutdownPacket();
 
     void sendPacket(const LauncherPacket &packet);
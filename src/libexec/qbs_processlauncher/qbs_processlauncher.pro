@@ -4,6 +4,7 @@ TARGET = qbs_processlauncher
 CONFIG += console c++17
 CONFIG -= app_bundle
 QT = core network
+win32:LIBS += -lpsapi
 
 TOOLS_DIR = $$PWD/../../lib/corelib/tools
 
@@ -12,10 +13,14 @@ INCLUDEPATH += $$TOOLS_DIR
 HEADERS += \
     launcherlogging.h \
     launchersockethandler.h \
+    resourceusagemonitor.h \
+    spawnedprocess.h \
     $$TOOLS_DIR/launcherpackets.h
 
 SOURCES += \
     launcherlogging.cpp \
     launchersockethandler.cpp \
     processlauncher-main.cpp \
+    resourceusagemonitor.cpp \
+    spawnedprocess.cpp \
     $$TOOLS_DIR/launcherpackets.cpp
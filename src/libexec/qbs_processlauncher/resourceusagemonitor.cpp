@@ -0,0 +1,176 @@
+/****************************************************************************
+**
+** Copyright (C) 2022 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of Qbs.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-2.0.html and
+** https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#include "resourceusagemonitor.h"
+
+#if defined(Q_OS_WIN)
+#include <qt_windows.h>
+#include <psapi.h>
+#elif defined(Q_OS_UNIX)
+#include <sys/resource.h>
+#include <sys/time.h>
+#endif
+
+namespace qbs {
+namespace Internal {
+
+#if defined(Q_OS_UNIX)
+// Processes that have been started but not yet reported as finished.
+static int runningProcessCount = 0;
+
+// Increased with every process start, so a process can tell whether others started after it.
+static quint64 processStartCount = 0;
+#endif
+
+ResourceUsageMonitor::~ResourceUsageMonitor()
+{
+#ifdef Q_OS_WIN
+    if (m_processHandle)
+        CloseHandle(m_processHandle);
+#endif
+}
+
+void ResourceUsageMonitor::processStarted(qint64 pid)
+{
+    m_pid = pid;
+#if defined(Q_OS_WIN)
+    if (m_processHandle)
+        CloseHandle(m_processHandle);
+
+    // Keeping a handle open lets us query the process after it has exited.
+    m_processHandle = OpenProcess(PROCESS_QUERY_LIMITED_INFORMATION, FALSE, DWORD(pid));
+#elif defined(Q_OS_UNIX)
+    m_ranAlone = runningProcessCount == 0;
+    ++runningProcessCount;
+    m_startCount = ++processStartCount;
+#endif
+}
+
+#if defined(Q_OS_WIN)
+static qint64 toMilliseconds(const FILETIME &fileTime)
+{
+    const quint64 hundredNanoSeconds = (quint64(fileTime.dwHighDateTime) << 32)
+            | fileTime.dwLowDateTime;
+    return qint64(hundredNanoSeconds / 10000);
+}
+#elif defined(Q_OS_UNIX)
+static qint64 toMilliseconds(const timeval &time)
+{
+    return qint64(time.tv_sec) * 1000 + time.tv_usec / 1000;
+}
+#endif
+
+ProcessResourceUsage ResourceUsageMonitor::processFinished()
+{
+    ProcessResourceUsage usage;
+#if defined(Q_OS_WIN)
+    if (!m_processHandle)
+        return usage;
+    FILETIME creationTime, exitTime, kernelTime, userTime;
+    if (GetProcessTimes(m_processHandle, &creationTime, &exitTime, &kernelTime, &userTime)) {
+        usage.userTime = toMilliseconds(userTime);
+        usage.systemTime = toMilliseconds(kernelTime);
+    }
+    PROCESS_MEMORY_COUNTERS memoryCounters;
+    if (GetProcessMemoryInfo(m_processHandle, &memoryCounters, sizeof memoryCounters))
+        usage.peakMemoryUsage = qint64(memoryCounters.PeakWorkingSetSize);
+    IO_COUNTERS ioCounters;
+    if (GetProcessIoCounters(m_processHandle, &ioCounters)) {
+        usage.blockInputOperations = qint64(ioCounters.ReadOperationCount);
+        usage.blockOutputOperations = qint64(ioCounters.WriteOperationCount);
+    }
+    CloseHandle(m_processHandle);
+    m_processHandle = nullptr;
+#elif defined(Q_OS_UNIX)
+    // QProcess reaps its children itself, so wait4() is not available to us, and all we get
+    // is the accumulated usage of all terminated children. The growth of that value since the
+    // last time we looked only belongs to this process if no other process ran at the same
+    // time; otherwise, another child might have been reaped before we got here, or this one
+    // before the previous process was reported. The peak memory usage is the maximum over all
+    // children, so it is only known if this process set a new maximum.
+    // Processes whose stop procedure failed are never reported, so they stay "running" and
+    // prevent any further attribution, which is what we want.
+    if (m_pid == 0)
+        return usage;
+    static rusage previousUsage{};
+    rusage currentUsage;
+    const bool ranAlone = m_ranAlone && m_startCount == processStartCount;
+    --runningProcessCount;
+    if (getrusage(RUSAGE_CHILDREN, &currentUsage) == 0) {
+        if (ranAlone) {
+            usage.userTime = toMilliseconds(currentUsage.ru_utime)
+                    - toMilliseconds(previousUsage.ru_utime);
+            usage.systemTime = toMilliseconds(currentUsage.ru_stime)
+                    - toMilliseconds(previousUsage.ru_stime);
+            usage.blockInputOperations = currentUsage.ru_inblock - previousUsage.ru_inblock;
+            usage.blockOutputOperations = currentUsage.ru_oublock - previousUsage.ru_oublock;
+            if (currentUsage.ru_maxrss > previousUsage.ru_maxrss) {
+#ifdef Q_OS_MACOS
+                usage.peakMemoryUsage = currentUsage.ru_maxrss;
+#else
+                usage.peakMemoryUsage = qint64(currentUsage.ru_maxrss) * 1024;
+#endif
+            }
+        }
+        previousUsage = currentUsage;
+    }
+#endif
+    m_pid = 0;
+    return usage;
+}
+
+#ifdef Q_OS_UNIX
+ProcessResourceUsage resourceUsageFromRusage(const rusage &usage)
+{
+    ProcessResourceUsage result;
+    result.userTime = toMilliseconds(usage.ru_utime);
+    result.systemTime = toMilliseconds(usage.ru_stime);
+#ifdef Q_OS_MACOS
+    result.peakMemoryUsage = usage.ru_maxrss;
+#else
+    result.peakMemoryUsage = qint64(usage.ru_maxrss) * 1024;
+#endif
+    result.blockInputOperations = usage.ru_inblock;
+    result.blockOutputOperations = usage.ru_oublock;
+    return result;
+}
+#endif
+
+} // namespace Internal
+} // namespace qbs
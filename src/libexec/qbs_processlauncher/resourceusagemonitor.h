@@ -0,0 +1,88 @@
+/****************************************************************************
+**
+** Copyright (C) 2022 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of Qbs.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-2.0.html and
+** https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#ifndef QBS_RESOURCEUSAGEMONITOR_H
+#define QBS_RESOURCEUSAGEMONITOR_H
+
+#include <launcherpackets.h>
+
+#include <QtCore/qglobal.h>
+
+#ifdef Q_OS_UNIX
+struct rusage;
+#endif
+
+namespace qbs {
+namespace Internal {
+
+// Collects CPU time, peak memory usage and I/O statistics of one child process.
+class ResourceUsageMonitor
+{
+public:
+    ResourceUsageMonitor() = default;
+    ~ResourceUsageMonitor();
+
+    ResourceUsageMonitor(const ResourceUsageMonitor &) = delete;
+    ResourceUsageMonitor &operator=(const ResourceUsageMonitor &) = delete;
+
+    void processStarted(qint64 pid);
+
+    // Must be called right after QProcess has reaped the child.
+    // Figures that cannot be attributed to the process are reported as -1.
+    ProcessResourceUsage processFinished();
+
+private:
+    qint64 m_pid = 0;
+#if defined(Q_OS_WIN)
+    void *m_processHandle = nullptr;
+#elif defined(Q_OS_UNIX)
+    bool m_ranAlone = false;
+    quint64 m_startCount = 0;
+#endif
+};
+
+#ifdef Q_OS_UNIX
+// For processes that we have reaped ourselves via wait4().
+ProcessResourceUsage resourceUsageFromRusage(const struct rusage &usage);
+#endif
+
+} // namespace Internal
+} // namespace qbs
+
+#endif // Include guard
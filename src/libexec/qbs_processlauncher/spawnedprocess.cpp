@@ -0,0 +1,398 @@
+/****************************************************************************
+**
+** Copyright (C) 2022 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of Qbs.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-2.0.html and
+** https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#include "spawnedprocess.h"
+
+#ifdef QBS_LAUNCHER_USE_POSIX_SPAWN
+
+#include "resourceusagemonitor.h"
+
+#include <QtCore/qcoreapplication.h>
+#include <QtCore/qfile.h>
+#include <QtCore/qsocketnotifier.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <csignal>
+#include <cstring>
+#include <vector>
+
+#include <fcntl.h>
+#include <spawn.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+extern char **environ;
+
+namespace qbs {
+namespace Internal {
+
+static int sigchldPipe[2] = {-1, -1};
+
+static void handleSigchld(int)
+{
+    const int savedErrno = errno;
+    const char c = 0;
+    const ssize_t written = ::write(sigchldPipe[1], &c, 1);
+    Q_UNUSED(written);
+    errno = savedErrno;
+}
+
+static std::vector<SpawnedProcess *> &runningProcesses()
+{
+    static std::vector<SpawnedProcess *> processes;
+    return processes;
+}
+
+// Child exits are reported via a SIGCHLD handler that wakes up the event loop via a pipe.
+static bool setupChildHandling()
+{
+    static const bool success = [] {
+        if (::pipe2(sigchldPipe, O_CLOEXEC | O_NONBLOCK) != 0)
+            return false;
+        struct sigaction action{};
+        action.sa_handler = handleSigchld;
+        sigemptyset(&action.sa_mask);
+        action.sa_flags = SA_RESTART | SA_NOCLDSTOP;
+        if (sigaction(SIGCHLD, &action, nullptr) != 0)
+            return false;
+
+        // Writing to a process that has closed its standard input must not kill us.
+        std::signal(SIGPIPE, SIG_IGN);
+
+        const auto notifier = new QSocketNotifier(sigchldPipe[0], QSocketNotifier::Read, qApp);
+        QObject::connect(notifier, &QSocketNotifier::activated, [] {
+            char buffer[64];
+            while (::read(sigchldPipe[0], buffer, sizeof buffer) > 0)
+                ;
+            SpawnedProcess::reapChildren();
+        });
+        return true;
+    }();
+    return success;
+}
+
+static void closeFd(int &fd)
+{
+    if (fd != -1) {
+        ::close(fd);
+        fd = -1;
+    }
+}
+
+static void setNonBlocking(int fd)
+{
+    ::fcntl(fd, F_SETFL, ::fcntl(fd, F_GETFL) | O_NONBLOCK);
+}
+
+SpawnedProcess::SpawnedProcess(QObject *parent) : QObject(parent)
+{
+}
+
+SpawnedProcess::~SpawnedProcess()
+{
+    if (m_state == QProcess::Running) {
+        ::kill(m_pid, SIGKILL);
+        ::waitpid(m_pid, nullptr, 0);
+        auto &processes = runningProcesses();
+        processes.erase(std::remove(processes.begin(), processes.end(), this), processes.end());
+    }
+    closeChannels();
+}
+
+void SpawnedProcess::start(const QString &program, const QStringList &arguments)
+{
+    if (m_state != QProcess::NotRunning)
+        return;
+    m_error = QProcess::UnknownError;
+    m_errorString.clear();
+    m_exitCode = 0;
+    m_exitStatus = QProcess::NormalExit;
+    m_resourceUsage = ProcessResourceUsage();
+    m_stdout.buffer.clear();
+    m_stderr.buffer.clear();
+    m_stdin.buffer.clear();
+    if (!setupChildHandling()) {
+        setStartError(errno, "sigaction");
+        return;
+    }
+
+    int pipes[3][2] = {{-1, -1}, {-1, -1}, {-1, -1}};
+    for (auto &p : pipes) {
+        if (::pipe2(p, O_CLOEXEC) != 0) {
+            const int errorNumber = errno;
+            for (auto &q : pipes) {
+                closeFd(q[0]);
+                closeFd(q[1]);
+            }
+            setStartError(errorNumber, "pipe2");
+            return;
+        }
+    }
+
+    std::vector<QByteArray> argumentStorage;
+    argumentStorage.reserve(arguments.size() + 1);
+    argumentStorage.push_back(QFile::encodeName(program));
+    for (const QString &argument : arguments)
+        argumentStorage.push_back(argument.toLocal8Bit());
+    std::vector<char *> argv;
+    for (QByteArray &argument : argumentStorage)
+        argv.push_back(argument.data());
+    argv.push_back(nullptr);
+
+    // An empty list means that the child inherits our environment, as with QProcess.
+    std::vector<QByteArray> environmentStorage;
+    std::vector<char *> envp;
+    for (const QString &variable : qAsConst(m_environment))
+        environmentStorage.push_back(variable.toLocal8Bit());
+    for (QByteArray &variable : environmentStorage)
+        envp.push_back(variable.data());
+    envp.push_back(nullptr);
+
+    posix_spawn_file_actions_t fileActions;
+    posix_spawn_file_actions_init(&fileActions);
+    posix_spawn_file_actions_adddup2(&fileActions, pipes[0][0], STDIN_FILENO);
+    posix_spawn_file_actions_adddup2(&fileActions, pipes[1][1], STDOUT_FILENO);
+    posix_spawn_file_actions_adddup2(&fileActions, pipes[2][1], STDERR_FILENO);
+    const QByteArray workingDir = QFile::encodeName(m_workingDirectory);
+    if (!workingDir.isEmpty())
+        posix_spawn_file_actions_addchdir_np(&fileActions, workingDir.constData());
+
+    // Undo what we did to the signal handling for ourselves.
+    posix_spawnattr_t attributes;
+    posix_spawnattr_init(&attributes);
+    sigset_t signals;
+    sigemptyset(&signals);
+    posix_spawnattr_setsigmask(&attributes, &signals);
+    sigaddset(&signals, SIGPIPE);
+    posix_spawnattr_setsigdefault(&attributes, &signals);
+    posix_spawnattr_setflags(&attributes, POSIX_SPAWN_SETSIGMASK | POSIX_SPAWN_SETSIGDEF);
+
+    pid_t pid = 0;
+    const int spawnResult = posix_spawnp(&pid, argv.front(), &fileActions, &attributes,
+                                         argv.data(),
+                                         m_environment.isEmpty() ? environ : envp.data());
+    posix_spawnattr_destroy(&attributes);
+    posix_spawn_file_actions_destroy(&fileActions);
+    closeFd(pipes[0][0]);
+    closeFd(pipes[1][1]);
+    closeFd(pipes[2][1]);
+    if (spawnResult != 0) {
+        closeFd(pipes[0][1]);
+        closeFd(pipes[1][0]);
+        closeFd(pipes[2][0]);
+        setStartError(spawnResult, "posix_spawn");
+        return;
+    }
+
+    m_pid = pid;
+    m_state = QProcess::Running;
+    runningProcesses().push_back(this);
+    const auto setupChannel = [this](Channel &channel, int fd, QSocketNotifier::Type type) {
+        channel.fd = fd;
+        setNonBlocking(fd);
+        channel.notifier = new QSocketNotifier(fd, type, this);
+        channel.notifier->setEnabled(type == QSocketNotifier::Read);
+    };
+    setupChannel(m_stdin, pipes[0][1], QSocketNotifier::Write);
+    setupChannel(m_stdout, pipes[1][0], QSocketNotifier::Read);
+    setupChannel(m_stderr, pipes[2][0], QSocketNotifier::Read);
+    connect(m_stdin.notifier, &QSocketNotifier::activated,
+            this, &SpawnedProcess::writePendingInput);
+    connect(m_stdout.notifier, &QSocketNotifier::activated,
+            this, [this] { readChannel(m_stdout, true); });
+    connect(m_stderr.notifier, &QSocketNotifier::activated,
+            this, [this] { readChannel(m_stderr, true); });
+    emit started();
+}
+
+void SpawnedProcess::terminate()
+{
+    if (m_state == QProcess::Running)
+        ::kill(m_pid, SIGTERM);
+}
+
+void SpawnedProcess::kill()
+{
+    if (m_state == QProcess::Running)
+        ::kill(m_pid, SIGKILL);
+}
+
+qint64 SpawnedProcess::write(const QByteArray &data)
+{
+    if (m_state != QProcess::Running || m_stdin.fd == -1)
+        return -1;
+    m_stdin.buffer += data;
+    writePendingInput();
+    return data.size();
+}
+
+QByteArray SpawnedProcess::readAllStandardOutput()
+{
+    QByteArray data;
+    std::swap(data, m_stdout.buffer);
+    return data;
+}
+
+QByteArray SpawnedProcess::readAllStandardError()
+{
+    QByteArray data;
+    std::swap(data, m_stderr.buffer);
+    return data;
+}
+
+void SpawnedProcess::reapChildren()
+{
+    const std::vector<SpawnedProcess *> processes = runningProcesses();
+    for (SpawnedProcess * const process : processes) {
+        const auto &current = runningProcesses();
+        if (std::find(current.cbegin(), current.cend(), process) != current.cend())
+            process->tryReap();
+    }
+}
+
+void SpawnedProcess::setStartError(int errorNumber, const char *function)
+{
+    m_state = QProcess::NotRunning;
+    m_error = QProcess::FailedToStart;
+    m_errorString = QStringLiteral("%1: %2").arg(QLatin1String(function),
+                                                 QString::fromLocal8Bit(std::strerror(errorNumber)));
+    emit errorOccurred(m_error);
+}
+
+void SpawnedProcess::readChannel(Channel &channel, bool emitSignal)
+{
+    const int oldSize = channel.buffer.size();
+    char buffer[65536];
+    while (channel.fd != -1) {
+        const ssize_t count = ::read(channel.fd, buffer, sizeof buffer);
+        if (count > 0) {
+            channel.buffer.append(buffer, int(count));
+        } else if (count == -1 && errno == EINTR) {
+            continue;
+        } else {
+            if (count == 0 || errno != EAGAIN)
+                closeChannel(channel);
+            break;
+        }
+    }
+    if (emitSignal && channel.buffer.size() > oldSize) {
+        if (&channel == &m_stdout)
+            emit readyReadStandardOutput();
+        else
+            emit readyReadStandardError();
+    }
+}
+
+void SpawnedProcess::writePendingInput()
+{
+    while (m_stdin.fd != -1 && !m_stdin.buffer.isEmpty()) {
+        const ssize_t count = ::write(m_stdin.fd, m_stdin.buffer.constData(),
+                                      size_t(m_stdin.buffer.size()));
+        if (count >= 0) {
+            m_stdin.buffer.remove(0, int(count));
+        } else if (errno == EAGAIN) {
+            break;
+        } else if (errno != EINTR) {
+            // The process does not read its input anymore.
+            m_stdin.buffer.clear();
+            closeChannel(m_stdin);
+        }
+    }
+    if (m_stdin.notifier)
+        m_stdin.notifier->setEnabled(!m_stdin.buffer.isEmpty());
+}
+
+void SpawnedProcess::closeChannel(Channel &channel)
+{
+    delete channel.notifier;
+    channel.notifier = nullptr;
+    closeFd(channel.fd);
+}
+
+void SpawnedProcess::closeChannels()
+{
+    closeChannel(m_stdin);
+    closeChannel(m_stdout);
+    closeChannel(m_stderr);
+}
+
+bool SpawnedProcess::tryReap()
+{
+    int status = 0;
+    struct rusage usage{};
+    pid_t result;
+    do {
+        result = ::wait4(m_pid, &status, WNOHANG, &usage);
+    } while (result == -1 && errno == EINTR);
+    if (result == 0)
+        return false;
+
+    auto &processes = runningProcesses();
+    processes.erase(std::remove(processes.begin(), processes.end(), this), processes.end());
+
+    // Whatever is still in the pipes belongs to the output. Grandchildren that keep them open
+    // after the process has exited are not waited for.
+    readChannel(m_stdout, false);
+    readChannel(m_stderr, false);
+    closeChannels();
+    m_state = QProcess::NotRunning;
+    m_pid = 0;
+    const bool reaped = result > 0;
+    if (reaped)
+        m_resourceUsage = resourceUsageFromRusage(usage);
+    if (reaped && WIFEXITED(status)) {
+        m_exitCode = WEXITSTATUS(status);
+        m_exitStatus = QProcess::NormalExit;
+    } else {
+        m_exitCode = reaped && WIFSIGNALED(status) ? WTERMSIG(status) : -1;
+        m_exitStatus = QProcess::CrashExit;
+        m_error = QProcess::Crashed;
+        m_errorString = QStringLiteral("Process crashed");
+        emit errorOccurred(m_error);
+    }
+    emit finished(m_exitCode, m_exitStatus);
+    return true;
+}
+
+} // namespace Internal
+} // namespace qbs
+
+#endif // QBS_LAUNCHER_USE_POSIX_SPAWN
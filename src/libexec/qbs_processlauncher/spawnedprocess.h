@@ -0,0 +1,140 @@
+/****************************************************************************
+**
+** Copyright (C) 2022 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of Qbs.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-2.0.html and
+** https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#ifndef QBS_SPAWNEDPROCESS_H
+#define QBS_SPAWNEDPROCESS_H
+
+#include <launcherpackets.h>
+
+#include <QtCore/qbytearray.h>
+#include <QtCore/qobject.h>
+#include <QtCore/qprocess.h>
+#include <QtCore/qstringlist.h>
+
+// posix_spawn() can only be used if it lets us set the working directory of the child.
+#if defined(Q_OS_LINUX) && defined(__GLIBC__) \
+    && (__GLIBC__ > 2 || (__GLIBC__ == 2 && __GLIBC_MINOR__ >= 29))
+#define QBS_LAUNCHER_USE_POSIX_SPAWN
+#endif
+
+#ifdef QBS_LAUNCHER_USE_POSIX_SPAWN
+
+#include <sys/types.h>
+
+QT_BEGIN_NAMESPACE
+class QSocketNotifier;
+QT_END_NAMESPACE
+
+namespace qbs {
+namespace Internal {
+
+// A lightweight replacement for QProcess that starts the child via posix_spawn() instead of
+// forking the launcher, and that reaps it with wait4(), which tells us the exact resource
+// usage of that one process. It provides the parts of the QProcess interface that the launcher
+// needs, so the two can be used interchangeably.
+// Only one event loop thread may use this class, as exits are handled via a SIGCHLD handler.
+class SpawnedProcess : public QObject
+{
+    Q_OBJECT
+public:
+    explicit SpawnedProcess(QObject *parent = nullptr);
+    ~SpawnedProcess() override;
+
+    void setEnvironment(const QStringList &environment) { m_environment = environment; }
+    void setWorkingDirectory(const QString &workingDir) { m_workingDirectory = workingDir; }
+    void start(const QString &program, const QStringList &arguments);
+    void terminate();
+    void kill();
+    qint64 write(const QByteArray &data);
+
+    QProcess::ProcessState state() const { return m_state; }
+    qint64 processId() const { return m_pid; }
+    QProcess::ProcessError error() const { return m_error; }
+    QString errorString() const { return m_errorString; }
+    int exitCode() const { return m_exitCode; }
+    QProcess::ExitStatus exitStatus() const { return m_exitStatus; }
+    QByteArray readAllStandardOutput();
+    QByteArray readAllStandardError();
+    ProcessResourceUsage resourceUsage() const { return m_resourceUsage; }
+
+    static void reapChildren();
+
+signals:
+    void started();
+    void errorOccurred(QProcess::ProcessError error);
+    void readyReadStandardOutput();
+    void readyReadStandardError();
+    void finished(int exitCode, QProcess::ExitStatus exitStatus);
+
+private:
+    class Channel
+    {
+    public:
+        int fd = -1;
+        QSocketNotifier *notifier = nullptr;
+        QByteArray buffer;
+    };
+
+    void setStartError(int errorNumber, const char *function);
+    void readChannel(Channel &channel, bool emitSignal);
+    void writePendingInput();
+    void closeChannel(Channel &channel);
+    void closeChannels();
+    bool tryReap();
+
+    QStringList m_environment;
+    QString m_workingDirectory;
+    Channel m_stdin;
+    Channel m_stdout;
+    Channel m_stderr;
+    QString m_errorString;
+    ProcessResourceUsage m_resourceUsage;
+    pid_t m_pid = 0;
+    QProcess::ProcessState m_state = QProcess::NotRunning;
+    QProcess::ProcessError m_error = QProcess::UnknownError;
+    QProcess::ExitStatus m_exitStatus = QProcess::NormalExit;
+    int m_exitCode = 0;
+};
+
+} // namespace Internal
+} // namespace qbs
+
+#endif // QBS_LAUNCHER_USE_POSIX_SPAWN
+
+#endif // Include guard
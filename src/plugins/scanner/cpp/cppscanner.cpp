@@ -60,12 +60,22 @@ using namespace CPlusPlus;
 #include <QtCore/qlist.h>
 #include <QtCore/qstring.h>
 
+#include <cctype>
 #include <cstring>
+#include <initializer_list>
 #include <memory>
 
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define QBS_CPPSCANNER_USE_SSE2
+#include <emmintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+#endif
+
 struct ScanResult
 {
-    char *fileName = nullptr;
+    const char *fileName = nullptr;
     int size = 0;
     int flags = 0;
 };
@@ -117,6 +127,87 @@ struct Opaq
     int currentResultIndex;
 };
 
+// The functions below find the places in a file that need the attention of the lexer
+// without lexing the file as a whole, which is slow for large files. They mimic the lexer's
+// treatment of comments, string literals and line starts, and let the lexer itself
+// handle the preprocessor directives they find.
+
+namespace {
+
+// A set of up to eight characters to look for.
+class CharSet
+{
+public:
+    CharSet(std::initializer_list<char> chars)
+    {
+        Q_ASSERT(chars.size() <= maxCount);
+        std::memset(m_contains, 0, sizeof m_contains);
+        for (const char c : chars) {
+            m_contains[static_cast<unsigned char>(c)] = true;
+#ifdef QBS_CPPSCANNER_USE_SSE2
+            m_needles[m_count] = _mm_set1_epi8(c);
+#endif
+            ++m_count;
+        }
+    }
+
+    const char *findFirstIn(const char *begin, const char *end) const
+    {
+#ifdef QBS_CPPSCANNER_USE_SSE2
+        while (end - begin >= 16) {
+            const __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i *>(begin));
+            __m128i matches = _mm_cmpeq_epi8(chunk, m_needles[0]);
+            for (int i = 1; i < m_count; ++i)
+                matches = _mm_or_si128(matches, _mm_cmpeq_epi8(chunk, m_needles[i]));
+            const int mask = _mm_movemask_epi8(matches);
+            if (mask != 0)
+                return begin + countTrailingZeros(mask);
+            begin += 16;
+        }
+#endif
+        for (; begin < end; ++begin) {
+            if (m_contains[static_cast<unsigned char>(*begin)])
+                return begin;
+        }
+        return end;
+    }
+
+private:
+    static const size_t maxCount = 8;
+
+#ifdef QBS_CPPSCANNER_USE_SSE2
+    static int countTrailingZeros(int mask)
+    {
+#ifdef _MSC_VER
+        unsigned long index;
+        _BitScanForward(&index, static_cast<unsigned long>(mask));
+        return static_cast<int>(index);
+#else
+        return __builtin_ctz(static_cast<unsigned int>(mask));
+#endif
+    }
+
+    __m128i m_needles[maxCount];
+#endif
+    bool m_contains[256];
+    int m_count = 0;
+};
+
+bool isIdentifierChar(char c)
+{
+    return std::isalnum(static_cast<unsigned char>(c)) || c == '_' || c == '$';
+}
+
+bool isSpace(char c)
+{
+    return std::isspace(static_cast<unsigned char>(c));
+}
+
+bool textEquals(const char *begin, const char *end, const QLatin1String &literal)
+{
+    return end - begin == literal.size() && std::memcmp(begin, literal.data(), literal.size()) == 0;
+}
+
 class TokenComparator
 {
     const char * const m_fileContent;
@@ -128,76 +219,217 @@ public:
 
     bool equals(const Token &tk, const QLatin1String &literal) const
     {
-        return static_cast<int>(tk.length()) == literal.size()
-                && memcmp(m_fileContent + tk.begin(), literal.data(), literal.size()) == 0;
+        return textEquals(m_fileContent + tk.begin(), m_fileContent + tk.end(), literal);
     }
 };
 
-static void scanCppFile(void *opaq, CPlusPlus::Lexer &yylex, bool scanForFileTags,
-                        bool scanForDependencies)
+} // namespace
+
+// Lets the lexer handle what follows a '#' at the start of a line. Returns the position
+// after the last token the lexer consumed.
+static const char *scanDirective(Opaq *opaque, const char *pound, const char *end,
+                                 bool scanForDependencies)
 {
     const QLatin1String includeLiteral("include");
     const QLatin1String importLiteral("import");
+    const TokenComparator tc(pound);
+    CPlusPlus::Lexer yylex(pound, end);
+    Token tk;
+    yylex(&tk);
+    if (tk.isNot(T_POUND))
+        return yylex.tokenEnd();
+    yylex(&tk);
+    if (scanForDependencies && !tk.newline() && tk.is(T_IDENTIFIER)
+            && (tc.equals(tk, includeLiteral) || tc.equals(tk, importLiteral))) {
+        yylex.setScanAngleStringLiteralTokens(true);
+        yylex(&tk);
+        yylex.setScanAngleStringLiteralTokens(false);
+
+        if (!tk.newline() && (tk.is(T_STRING_LITERAL) || tk.is(T_ANGLE_STRING_LITERAL))) {
+            ScanResult scanResult;
+            scanResult.size = int(tk.length() - 2);
+            if (tk.is(T_STRING_LITERAL))
+                scanResult.flags = SC_LOCAL_INCLUDE_FLAG;
+            else
+                scanResult.flags = SC_GLOBAL_INCLUDE_FLAG;
+            scanResult.fileName = pound + tk.begin() + 1;
+            opaque->includedFiles.push_back(scanResult);
+        }
+    }
+    return yylex.tokenEnd();
+}
+
+// The lexer treats stray backslashes like white space.
+static const char *skipSpaceBackwards(const char *begin, const char *p)
+{
+    while (p > begin && (isSpace(p[-1]) || p[-1] == '\\'))
+        --p;
+    return p;
+}
+
+// Someone was clever and redefined Q_OBJECT or Q_PLUGIN_METADATA.
+// Example: iplugin.h in Qt Creator.
+// [commentsBegin, commentsEnd) is the most recent sequence of comments that are separated only
+// by white space, and literalEnd is the end of the most recent string or character literal,
+// which might lack its closing quote.
+static bool isPrecededByDefine(const char *begin, const char *identifier,
+                               const char *commentsBegin, const char *commentsEnd,
+                               const char *literalEnd)
+{
     const QLatin1String defineLiteral("define");
+    const char *p = skipSpaceBackwards(commentsEnd ? commentsEnd : begin, identifier);
+    if (p == commentsEnd)
+        p = skipSpaceBackwards(begin, commentsBegin);
+    const char * const tokenEnd = p;
+    if (literalEnd && tokenEnd <= literalEnd)
+        return false;
+    while (p > begin && isIdentifierChar(p[-1]))
+        --p;
+    return textEquals(p, tokenEnd, defineLiteral);
+}
+
+static void scanCppFile(Opaq *opaque, const char *begin, const char *end, bool scanForFileTags,
+                        bool scanForDependencies)
+{
     const QLatin1String qobjectLiteral("Q_OBJECT");
     const QLatin1String qgadgetLiteral("Q_GADGET");
     const QLatin1String qnamespaceLiteral("Q_NAMESPACE");
     const QLatin1String pluginMetaDataLiteral("Q_PLUGIN_METADATA");
-    const auto opaque = static_cast<Opaq *>(opaq);
-    const TokenComparator tc(opaque->fileContent);
-    Token tk;
-    Token oldTk;
-    ScanResult scanResult;
+    static const CharSet codeChars{'\0', '\n', '"', '#', '\'', '/', '\\'};
+    static const CharSet codeCharsForFileTags{'\0', '\n', '"', '#', '\'', '/', '\\', 'Q'};
+    static const CharSet lineCommentChars{'\0', '\n'};
+    static const CharSet blockCommentChars{'\0', '*'};
+    static const CharSet stringChars{'\0', '\n', '"', '\\'};
+    static const CharSet wideStringChars{'\0', '"', '\\'};
+    static const CharSet charChars{'\0', '\n', '\'', '\\'};
+    static const CharSet wideCharChars{'\0', '\'', '\\'};
+    const CharSet &interestingChars = scanForFileTags ? codeCharsForFileTags : codeChars;
+
+    // Corresponds to the lexer's newline flag: No token has been seen yet on the current line.
+    bool atLineStart = true;
+
+    // The text between these two positions has not been checked for tokens yet.
+    const char *uncheckedBegin = begin;
+    const auto checkForTokens = [&](const char *uncheckedEnd) {
+        for (const char *p = uncheckedBegin; atLineStart && p < uncheckedEnd; ++p)
+            atLineStart = isSpace(*p);
+    };
 
-    yylex(&tk);
+    const char *literalEnd = nullptr;
+    const char *commentsBegin = nullptr;
+    const char *commentsEnd = nullptr;
+    const auto skippedComment = [&](const char *commentBegin, const char *commentEnd) {
+        if (!commentsEnd || skipSpaceBackwards(commentsEnd, commentBegin) != commentsEnd)
+            commentsBegin = commentBegin;
+        commentsEnd = commentEnd;
+    };
 
-    while (tk.isNot(T_EOF_SYMBOL)) {
-        if (tk.newline() && tk.is(T_POUND)) {
-            yylex(&tk);
-
-            if (scanForDependencies && !tk.newline() && tk.is(T_IDENTIFIER)) {
-                if (tc.equals(tk, includeLiteral) || tc.equals(tk, importLiteral))
-                {
-                    yylex.setScanAngleStringLiteralTokens(true);
-                    yylex(&tk);
-                    yylex.setScanAngleStringLiteralTokens(false);
-
-                    if (!tk.newline() && (tk.is(T_STRING_LITERAL) || tk.is(T_ANGLE_STRING_LITERAL))) {
-                        scanResult.size = int(tk.length() - 2);
-                        if (tk.is(T_STRING_LITERAL))
-                            scanResult.flags = SC_LOCAL_INCLUDE_FLAG;
-                        else
-                            scanResult.flags = SC_GLOBAL_INCLUDE_FLAG;
-                        scanResult.fileName = opaque->fileContent + tk.begin() + 1;
-                        opaque->includedFiles.push_back(scanResult);
+    const char *p = begin;
+    while (true) {
+        p = interestingChars.findFirstIn(p, end);
+        if (p == end)
+            return;
+        checkForTokens(p);
+        switch (*p) {
+        case '\0': // The lexer stops at null bytes.
+            return;
+        case '\n':
+            atLineStart = true;
+            ++p;
+            break;
+        case '\\':
+            ++p;
+            while (p < end && *p != '\n' && isSpace(*p))
+                ++p;
+            if (p < end && *p == '\n') { // Line continuation.
+                atLineStart = false;
+                ++p;
+            }
+            break;
+        case '/':
+            if (p + 1 < end && p[1] == '/') {
+                const char * const commentBegin = p;
+                p = lineCommentChars.findFirstIn(p + 2, end);
+                if (p == end || *p == '\0')
+                    return;
+                skippedComment(commentBegin, p);
+            } else if (p + 1 < end && p[1] == '*') {
+                const char * const commentBegin = p;
+                for (p += 2; ; ++p) {
+                    p = blockCommentChars.findFirstIn(p, end);
+                    if (p == end || *p == '\0')
+                        return;
+                    if (p + 1 < end && p[1] == '/') {
+                        p += 2;
+                        break;
                     }
                 }
+                skippedComment(commentBegin, p);
+            } else {
+                atLineStart = false;
+                ++p;
             }
-        } else if (tk.is(T_IDENTIFIER)) {
-            if (scanForFileTags) {
-                if (oldTk.is(T_IDENTIFIER) && tc.equals(oldTk, defineLiteral)) {
-                    // Someone was clever and redefined Q_OBJECT or Q_PLUGIN_METADATA.
-                    // Example: iplugin.h in Qt Creator.
-                } else {
-                    if (tc.equals(tk, qobjectLiteral) || tc.equals(tk, qgadgetLiteral)  ||
-                        tc.equals(tk, qnamespaceLiteral))
-                    {
-                        opaque->hasQObjectMacro = true;
-                    } else if (tc.equals(tk, pluginMetaDataLiteral))
-                    {
-                        opaque->hasPluginMetaDataMacro = true;
-                    }
-                    if (!scanForDependencies && opaque->hasQObjectMacro
-                        && (opaque->hasPluginMetaDataMacro
-                            || opaque->fileType == Opaq::FT_CPP
-                            || opaque->fileType == Opaq::FT_OBJCPP))
-                        break;
+            break;
+        case '"':
+        case '\'': {
+            atLineStart = false;
+            const char quote = *p;
+            const bool isWide = p > begin && p[-1] == 'L'
+                    && (p - 1 == begin || !isIdentifierChar(p[-2]));
+            const CharSet &literalChars = quote == '"' ? (isWide ? wideStringChars : stringChars)
+                                                       : (isWide ? wideCharChars : charChars);
+            for (++p; ; ) {
+                p = literalChars.findFirstIn(p, end);
+                if (p == end || *p == '\0')
+                    return;
+                if (*p == '\\') {
+                    if (p + 1 == end || p[1] == '\0')
+                        return;
+                    p += 2;
+                    continue;
                 }
+                if (*p == quote)
+                    ++p;
+                break; // The literal ends here, or, unless it is wide, at the end of the line.
             }
-
+            literalEnd = p;
+            break;
         }
-        oldTk = tk;
-        yylex(&tk);
+        case '#':
+            if (atLineStart)
+                p = scanDirective(opaque, p, end, scanForDependencies);
+            else
+                ++p;
+            atLineStart = false;
+            break;
+        case 'Q': {
+            atLineStart = false;
+            if (p > begin && isIdentifierChar(p[-1])) {
+                ++p;
+                break;
+            }
+            const char * const identifier = p;
+            while (p < end && isIdentifierChar(*p))
+                ++p;
+            if (isPrecededByDefine(begin, identifier, commentsBegin, commentsEnd, literalEnd))
+                break;
+            if (textEquals(identifier, p, qobjectLiteral)
+                    || textEquals(identifier, p, qgadgetLiteral)
+                    || textEquals(identifier, p, qnamespaceLiteral)) {
+                opaque->hasQObjectMacro = true;
+            } else if (textEquals(identifier, p, pluginMetaDataLiteral)) {
+                opaque->hasPluginMetaDataMacro = true;
+            }
+            if (!scanForDependencies && opaque->hasQObjectMacro
+                    && (opaque->hasPluginMetaDataMacro
+                        || opaque->fileType == Opaq::FT_CPP
+                        || opaque->fileType == Opaq::FT_OBJCPP)) {
+                return;
+            }
+            break;
+        }
+        }
+        uncheckedBegin = p;
     }
 }
 
@@ -258,8 +490,8 @@ static void *openScanner(const unsigned short *filePath, const char *fileTags, i
         mapl -= 3;
     }
 
-    CPlusPlus::Lexer lex(opaque->fileContent, opaque->fileContent + mapl);
-    scanCppFile(opaque.get(), lex, flags & ScanForFileTagsFlag, flags & ScanForDependenciesFlag);
+    scanCppFile(opaque.get(), opaque->fileContent, opaque->fileContent + mapl,
+                flags & ScanForFileTagsFlag, flags & ScanForDependenciesFlag);
     return opaque.release();
 }
 
@@ -316,7 +548,7 @@ ScannerPlugin includeScanner =
     closeScanner,
     next,
     additionalFileTags,
-    ScannerUsesCppIncludePaths | ScannerRecursiveDependencies
+    ScannerUsesCppIncludePaths | ScannerRecursiveDependencies | ScannerReentrant
 };
 
 ScannerPlugin *cppScanners[] = { &includeScanner, nullptr };
@@ -176,7 +176,7 @@ ScannerPlugin qrcScanner =
     closeScannerQrc,
     nextQrc,
     additionalFileTagsQrc,
-    NoScannerFlags
+    ScannerReentrant
 };
 
 ScannerPlugin *qtScanners[] = {&qrcScanner, nullptr};
@@ -85,7 +85,14 @@ enum ScannerFlags
 {
     NoScannerFlags = 0x00,
     ScannerUsesCppIncludePaths = 0x01,
-    ScannerRecursiveDependencies = 0x02
+    ScannerRecursiveDependencies = 0x02,
+
+    /**
+      * The scanner does not keep any state outside of its handles, so open, next and close
+      * may be called concurrently from different threads, as long as each handle is only
+      * used by one thread at a time.
+      */
+    ScannerReentrant = 0x04
 };
 
 class ScannerPlugin
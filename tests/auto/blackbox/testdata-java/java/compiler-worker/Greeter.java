@@ -0,0 +1,5 @@
+public class Greeter {
+    public static String greet(String greeting) {
+        return greeting;
+    }
+}
@@ -0,0 +1,15 @@
+#ifndef FAKEOBJECT_H
+#define FAKEOBJECT_H
+
+// Q_OBJECT
+/* Q_GADGET */
+static const char fakeObjectString[] = "Q_OBJECT";
+static const char fakeGadgetChars[] = {'Q', '_', 'G', 'A', 'D', 'G', 'E', 'T'};
+
+// Someone was clever and redefined the macros.
+#define Q_OBJECT
+#define /* comment */ Q_GADGET
+#define \
+    Q_NAMESPACE
+
+#endif
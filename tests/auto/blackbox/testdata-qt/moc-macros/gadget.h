@@ -0,0 +1,13 @@
+#ifndef GADGET_H
+#define GADGET_H
+
+#include <QtCore/qobjectdefs.h>
+
+struct Gadget
+{
+    Q_GADGET
+public:
+    int value = 0;
+};
+
+#endif
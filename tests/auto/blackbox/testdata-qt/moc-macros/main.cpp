@@ -0,0 +1,9 @@
+#include "gadget.h"
+#include "namespace.h"
+#include "object.h"
+
+int main()
+{
+    Object object;
+    return Gadget().value + int(Space::Color::Red);
+}
@@ -0,0 +1,12 @@
+#ifndef NAMESPACE_H
+#define NAMESPACE_H
+
+#include <QtCore/qobjectdefs.h>
+
+namespace Space {
+Q_NAMESPACE
+enum class Color { Red };
+Q_ENUM_NS(Color)
+}
+
+#endif
@@ -0,0 +1,11 @@
+#ifndef OBJECT_H
+#define OBJECT_H
+
+#include <QtCore/qobject.h>
+
+class Object : public QObject
+{
+    Q_OBJECT
+};
+
+#endif
@@ -0,0 +1 @@
+#error "This header must not be included."
@@ -0,0 +1,9 @@
+#include "header.h"
+#if 0
+#include "inactive.h"
+#endif
+
+int main(void)
+{
+    return HEADER_VALUE;
+}
@@ -0,0 +1,7 @@
+#ifndef A_H
+#define A_H
+#include "nested.h"
+
+inline int a() { return 0; }
+
+#endif
@@ -0,0 +1,6 @@
+#ifndef B_H
+#define B_H
+
+inline int b() { return 0; }
+
+#endif
@@ -0,0 +1,6 @@
+#ifndef C_H
+#define C_H
+
+inline int c() { return 0; }
+
+#endif
@@ -0,0 +1,6 @@
+#ifndef D_H
+#define D_H
+
+inline int d() { return 0; }
+
+#endif
@@ -0,0 +1,6 @@
+#ifndef FROM_GENERATED_H
+#define FROM_GENERATED_H
+
+inline int fromGenerated() { return 0; }
+
+#endif
@@ -0,0 +1,11 @@
+#include "a.h"
+#include "b.h"
+#include "c.h"
+#include "d.h"
+#include "gen-a.h"
+#include "gen-b.h"
+
+int main()
+{
+    return a() + b() + c() + d() + genA() + genB();
+}
@@ -0,0 +1,6 @@
+#ifndef NESTED_H
+#define NESTED_H
+
+inline int nested() { return 0; }
+
+#endif
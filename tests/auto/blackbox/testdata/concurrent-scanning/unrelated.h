@@ -0,0 +1,6 @@
+#ifndef UNRELATED_H
+#define UNRELATED_H
+
+inline int unrelated() { return 0; }
+
+#endif
@@ -0,0 +1,25 @@
+// #include "in-line-comment.h"
+/*
+#include "in-block-comment.h"
+*/
+#include "real.h" // A comment after the directive.
+#  include "with-spaces.h"
+#include \
+    "continued-directive.h"
+
+static const char *string = "#include \"in-string.h\"";
+static const char *continuedString = "text\
+#include \"in-continued-string.h\"";
+static const wchar_t *continuedWideString = L"text\
+#include \"in-continued-wide-string.h\"";
+static const char quote = '"';
+#include "after-char-literal.h"
+static const char escapedQuote = '\'';
+#include "after-escaped-char-literal.h"
+#include "sizes.h"
+#include "tiny.h"
+
+int main()
+{
+    return string && continuedString && continuedWideString && quote && escapedQuote ? 0 : 1;
+}
@@ -0,0 +1,2 @@
+// This header is longer than sixteen bytes.
+#include "tail.h"
\ No newline at end of file
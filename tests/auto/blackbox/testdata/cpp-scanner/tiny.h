@@ -0,0 +1 @@
+#include "t.h"
\ No newline at end of file
@@ -0,0 +1,3 @@
+#include <myheader.h>
+
+int main() { return 0; }
@@ -0,0 +1 @@
+#define OTHER_VALUE 0
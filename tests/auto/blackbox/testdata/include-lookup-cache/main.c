@@ -0,0 +1,7 @@
+#include <header.h>
+#include <other.h>
+
+int main(void)
+{
+    return VALUE + OTHER_VALUE;
+}
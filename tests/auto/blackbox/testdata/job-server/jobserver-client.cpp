@@ -0,0 +1,52 @@
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <thread>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+// Behaves like a GNU make that wants to run more jobs than its implicit token allows.
+int main(int argc, char *argv[])
+{
+    if (argc != 3)
+        return 1;
+    const char * const label = argv[1];
+    FILE * const output = std::fopen(argv[2], "w");
+    if (!output)
+        return 1;
+    std::fclose(output);
+
+    const char * const makeFlags = std::getenv("MAKEFLAGS");
+    const char * const authOption = "--jobserver-auth=fifo:";
+    const char * const auth = makeFlags ? std::strstr(makeFlags, authOption) : nullptr;
+    if (!auth) {
+        std::printf("%s found no job server\n", label);
+        return 0;
+    }
+    std::string fifoPath(auth + std::strlen(authOption));
+    fifoPath = fifoPath.substr(0, fifoPath.find(' '));
+    const int fd = open(fifoPath.c_str(), O_RDWR | O_NONBLOCK);
+    if (fd == -1) {
+        std::printf("%s cannot open job server\n", label);
+        return 1;
+    }
+
+    // Take all tokens that are available, waiting a while for the first one.
+    std::string tokens;
+    for (int i = 0; i < 100 && tokens.empty(); ++i) {
+        char token;
+        while (read(fd, &token, 1) == 1)
+            tokens += token;
+        if (tokens.empty())
+            std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    }
+    std::printf("%s took %d token(s)\n", label, int(tokens.size()));
+    std::this_thread::sleep_for(std::chrono::milliseconds(500));
+    if (write(fd, tokens.data(), tokens.size()) != ssize_t(tokens.size()))
+        return 1;
+    close(fd);
+    return 0;
+}
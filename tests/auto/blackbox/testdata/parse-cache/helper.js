@@ -0,0 +1,4 @@
+function greeting()
+{
+    return "from js";
+}
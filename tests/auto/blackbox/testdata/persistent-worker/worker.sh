@@ -0,0 +1,13 @@
+#!/bin/sh
+# Handles requests of the form {"arguments":["<mode>","<output file>"],"requestId":<id>}.
+while read -r request; do
+    mode=$(echo "$request" | sed 's/.*"arguments":\["\([^"]*\)".*/\1/')
+    output=$(echo "$request" | sed 's/.*"arguments":\["[^"]*","\([^"]*\)".*/\1/')
+    id=$(echo "$request" | sed 's/.*"requestId":\([0-9]*\).*/\1/')
+    if [ "$mode" = crash ]; then
+        echo "worker crashed" >&2
+        exit 1
+    fi
+    echo "worker $$" > "$output"
+    echo "{\"exitCode\":0,\"output\":\"handled by worker $$\",\"requestId\":$id}"
+done
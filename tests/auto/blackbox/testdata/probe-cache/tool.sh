@@ -0,0 +1,2 @@
+#!/bin/sh
+echo "$PROBE_CACHE_TEST_VALUE 1"
@@ -0,0 +1,9 @@
+#!/bin/sh
+# Handles requests of the form {"arguments":["<output file>"],"requestId":<id>},
+# which arrive on its standard input.
+while read -r request; do
+    output=$(echo "$request" | sed 's/.*"arguments":\["\([^"]*\)".*/\1/')
+    id=$(echo "$request" | sed 's/.*"requestId":\([0-9]*\).*/\1/')
+    echo "worker $$" > "$output"
+    echo "{\"exitCode\":0,\"output\":\"handled by worker $$\",\"requestId\":$id}"
+done
@@ -0,0 +1 @@
+inline int nestedValue() { return 0; }
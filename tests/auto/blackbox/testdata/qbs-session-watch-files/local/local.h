@@ -0,0 +1 @@
+inline int localValue() { return 0; }
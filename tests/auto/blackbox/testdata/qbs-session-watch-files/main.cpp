@@ -0,0 +1,7 @@
+#include <sub/nested.h>
+#include "local/local.h"
+
+int main()
+{
+    return nestedValue() + localValue();
+}
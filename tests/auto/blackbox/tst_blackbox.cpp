@@ -42,7 +42,9 @@
 #include <tools/stlutils.h>
 #include <tools/version.h>
 
+#include <QtCore/qdatastream.h>
 #include <QtCore/qdebug.h>
+#include <QtCore/qdiriterator.h>
 #include <QtCore/qelapsedtimer.h>
 #include <QtCore/qjsonarray.h>
 #include <QtCore/qjsondocument.h>
@@ -50,6 +52,8 @@
 #include <QtCore/qjsonvalue.h>
 #include <QtCore/qlocale.h>
 #include <QtCore/qregularexpression.h>
+#include <QtCore/qscopeguard.h>
+#include <QtCore/qset.h>
 #include <QtCore/qsettings.h>
 #include <QtCore/qtemporarydir.h>
 #include <QtCore/qtemporaryfile.h>
@@ -363,6 +367,118 @@ TestBlackbox::TestBlackbox() : TestBlackboxBase (SRCDIR "/testdata", "blackbox")
 {
 }
 
+void TestBlackbox::actionCache()
+{
+    if (HostOsInfo::isWindowsHost())
+        QSKIP("Test uses a shell script.");
+    QDir::setCurrent(testDataDir + "/action-cache");
+    const QString cacheDir = QDir::currentPath() + "/action-cache-dir";
+    qbs::Settings settings(QDir::currentPath() + "/settings-dir");
+    settings.setValue("preferences.actionCacheDirectory", cacheDir);
+    settings.setValue("preferences.actionCacheMaxSize", 1);
+    settings.sync();
+    QbsRunParameters params;
+    params.settingsDir = settings.baseDirectory();
+    params.profile.clear();
+    QbsRunParameters cleanParams("clean");
+    cleanParams.settingsDir = settings.baseDirectory();
+    QbsRunParameters statisticsParams("action-cache");
+    statisticsParams.settingsDir = settings.baseDirectory();
+    const QString outputA = relativeProductBuildDir("theProduct") + "/a.out";
+    const QString outputB = relativeProductBuildDir("theProduct") + "/b.out";
+    const auto fileContents = [](const QString &filePath) {
+        QFile file(filePath);
+        return file.open(QIODevice::ReadOnly) ? file.readAll() : QByteArray();
+    };
+
+    // Nothing is in the cache yet.
+    QCOMPARE(runQbs(params), 0);
+    QVERIFY2(m_qbsStdout.contains("running a.in"), m_qbsStdout.constData());
+    QVERIFY2(m_qbsStdout.contains("running b.in"), m_qbsStdout.constData());
+    QVERIFY2(!m_qbsStdout.contains("(cached)"), m_qbsStdout.constData());
+
+    // The outputs of a clean build directory come from the cache.
+    QCOMPARE(runQbs(cleanParams), 0);
+    QVERIFY(!QFile::exists(outputA));
+    QCOMPARE(runQbs(params), 0);
+    QVERIFY2(m_qbsStdout.contains("generating a.out (cached)"), m_qbsStdout.constData());
+    QVERIFY2(m_qbsStdout.contains("generating b.out (cached)"), m_qbsStdout.constData());
+    QVERIFY2(!m_qbsStdout.contains("running"), m_qbsStdout.constData());
+    QCOMPARE(fileContents(outputA), QByteArray("contents of a\n"));
+    QCOMPARE(fileContents(outputB), QByteArray("contents of b\n"));
+
+    // So do the ones of a different build directory.
+    params.arguments = QStringList("config:other");
+    QCOMPARE(runQbs(params), 0);
+    QVERIFY2(m_qbsStdout.contains("generating a.out (cached)"), m_qbsStdout.constData());
+    QVERIFY2(m_qbsStdout.contains("generating b.out (cached)"), m_qbsStdout.constData());
+    QVERIFY2(!m_qbsStdout.contains("running"), m_qbsStdout.constData());
+    QCOMPARE(fileContents(relativeProductBuildDir("theProduct", "other") + "/a.out"),
+             QByteArray("contents of a\n"));
+
+    // Changed inputs and command lines are cache misses.
+    params.arguments.clear();
+    WAIT_FOR_NEW_TIMESTAMP();
+    REPLACE_IN_FILE("a.in", "contents", "new contents");
+    QCOMPARE(runQbs(params), 0);
+    QVERIFY2(m_qbsStdout.contains("running a.in"), m_qbsStdout.constData());
+    QVERIFY2(!m_qbsStdout.contains("generating b.out"), m_qbsStdout.constData());
+    QCOMPARE(fileContents(outputA), QByteArray("new contents of a\n"));
+    params.arguments = QStringList("products.theProduct.suffix:x");
+    QCOMPARE(runQbs(params), 0);
+    QVERIFY2(m_qbsStdout.contains("running a.in"), m_qbsStdout.constData());
+    QVERIFY2(m_qbsStdout.contains("running b.in"), m_qbsStdout.constData());
+    QVERIFY2(!m_qbsStdout.contains("(cached)"), m_qbsStdout.constData());
+    QCOMPARE(fileContents(outputB), QByteArray("contents of b\nx"));
+
+    QCOMPARE(runQbs(statisticsParams), 0);
+    QVERIFY2(m_qbsStdout.contains("Entries: 5"), m_qbsStdout.constData());
+    QVERIFY2(m_qbsStdout.contains("Hits: 4, misses: 5, hit rate: 44.4%"),
+             m_qbsStdout.constData());
+    QVERIFY2(m_qbsStdout.contains("Stores: 5, evictions: 0"), m_qbsStdout.constData());
+
+    // Two entries of 400 KiB each stay below the limit of 1 MiB.
+    params.arguments << "products.theProduct.big:true";
+    QCOMPARE(runQbs(params), 0);
+    QVERIFY2(m_qbsStdout.contains("running a.in"), m_qbsStdout.constData());
+    QVERIFY2(m_qbsStdout.contains("running b.in"), m_qbsStdout.constData());
+    QCOMPARE(runQbs(statisticsParams), 0);
+    QVERIFY2(m_qbsStdout.contains("Entries: 7"), m_qbsStdout.constData());
+
+    // Using the entry for a.out makes it more recent than the one for b.out.
+    WAIT_FOR_NEW_TIMESTAMP();
+    QVERIFY(QFile::remove(outputA));
+    QCOMPARE(runQbs(params), 0);
+    QVERIFY2(m_qbsStdout.contains("generating a.out (cached)"), m_qbsStdout.constData());
+    QVERIFY2(!m_qbsStdout.contains("generating b.out"), m_qbsStdout.constData());
+
+    // A third big entry exceeds the limit, so the least recently used entries get evicted.
+    WAIT_FOR_NEW_TIMESTAMP();
+    REPLACE_IN_FILE("b.in", "contents", "new contents");
+    QCOMPARE(runQbs(params), 0);
+    QVERIFY2(m_qbsStdout.contains("running b.in"), m_qbsStdout.constData());
+    QCOMPARE(runQbs(statisticsParams), 0);
+    QVERIFY2(m_qbsStdout.contains("Entries: 2"), m_qbsStdout.constData());
+    QVERIFY2(m_qbsStdout.contains("Stores: 8, evictions: 6"), m_qbsStdout.constData());
+    QVERIFY(QFile::remove(outputA));
+    QCOMPARE(runQbs(params), 0);
+    QVERIFY2(m_qbsStdout.contains("generating a.out (cached)"), m_qbsStdout.constData());
+    WAIT_FOR_NEW_TIMESTAMP();
+    REPLACE_IN_FILE("b.in", "new contents", "contents");
+    QCOMPARE(runQbs(params), 0);
+    QVERIFY2(m_qbsStdout.contains("running b.in"), m_qbsStdout.constData());
+
+    // Entries that cannot be written to can still be restored.
+    QDirIterator manifestIt(cacheDir, QStringList("manifest"), QDir::Files,
+                            QDirIterator::Subdirectories);
+    while (manifestIt.hasNext())
+        QVERIFY(QFile::setPermissions(manifestIt.next(), QFile::ReadOwner));
+    QVERIFY(QFile::remove(outputA));
+    QCOMPARE(runQbs(params), 0);
+    QVERIFY2(m_qbsStdout.contains("generating a.out (cached)"), m_qbsStdout.constData());
+    QVERIFY(QFile::exists(outputA));
+}
+
 void TestBlackbox::allowedValues()
 {
     QFETCH(QString, property);
@@ -1735,6 +1851,40 @@ void TestBlackbox::concurrentExecutor()
     QVERIFY2(!m_qbsStderr.contains("ASSERT"), m_qbsStderr.constData());
 }
 
+void TestBlackbox::concurrentScanning()
+{
+    QDir::setCurrent(testDataDir + "/concurrent-scanning");
+    QbsRunParameters params(QStringList{"-j", "8", "-vv"});
+    QCOMPARE(runQbs(params), 0);
+    QVERIFY2(!m_qbsStderr.contains("ASSERT"), m_qbsStderr.constData());
+    const QStringList includedHeaders{"a.h", "b.h", "c.h", "d.h", "gen-a.h", "gen-b.h",
+                                      "nested.h", "from-generated.h"};
+    for (const QString &header : includedHeaders) {
+        QVERIFY2(m_qbsStderr.count(("scanning \"" + header + '"').toUtf8()) == 1,
+                 qPrintable(header));
+    }
+    QVERIFY2(!m_qbsStderr.contains("scanning \"unrelated.h\""), m_qbsStderr.constData());
+
+    // The dependencies found in the source directory, in the build directory and via the
+    // generated headers must all be in the build graph.
+    const QStringList dependencies{"nested.h", "c.h", "from-generated.h"};
+    for (const QString &dependency : dependencies) {
+        WAIT_FOR_NEW_TIMESTAMP();
+        touch(dependency);
+        QCOMPARE(runQbs(params), 0);
+        QVERIFY2(m_qbsStdout.contains("compiling main.cpp"), qPrintable(dependency));
+    }
+    WAIT_FOR_NEW_TIMESTAMP();
+    REPLACE_IN_FILE("gen-b.h.in", "return nested();", "return nested() + 1;");
+    QCOMPARE(runQbs(params), 0);
+    QVERIFY2(m_qbsStdout.contains("generating gen-b.h"), m_qbsStdout.constData());
+    QVERIFY2(m_qbsStdout.contains("compiling main.cpp"), m_qbsStdout.constData());
+    WAIT_FOR_NEW_TIMESTAMP();
+    touch("unrelated.h");
+    QCOMPARE(runQbs(params), 0);
+    QVERIFY2(!m_qbsStdout.contains("compiling main.cpp"), m_qbsStdout.constData());
+}
+
 void TestBlackbox::conditionalExport()
 {
     QDir::setCurrent(testDataDir + "/conditional-export");
@@ -1914,6 +2064,51 @@ void TestBlackbox::conanfileProbe()
     QCOMPARE(actualResults, expectedResults);
 }
 
+void TestBlackbox::corruptBuildGraphHeader()
+{
+    QDir::setCurrent(testDataDir + "/corrupt-build-graph-header");
+    QCOMPARE(runQbs(), 0);
+    QVERIFY2(m_qbsStdout.contains("generating p.out"), m_qbsStdout.constData());
+
+    // The object count follows the magic token. A huge one must not make us
+    // try to allocate memory for it.
+    QFile bgFile(relativeBuildGraphFilePath());
+    QVERIFY2(bgFile.open(QIODevice::ReadWrite), qPrintable(bgFile.errorString()));
+    QDataStream stream(&bgFile);
+    stream.setByteOrder(QDataStream::LittleEndian);
+    QByteArray magic;
+    stream >> magic;
+    QVERIFY(!magic.isEmpty());
+    QCOMPARE(bgFile.write(QByteArray("\xff\xff\xff\x7f", 4)), qint64(4));
+    bgFile.close();
+    QbsRunParameters params;
+    params.expectFailure = true;
+    QVERIFY(runQbs(params) != 0);
+    QVERIFY2(m_qbsStderr.contains("Build graph is corrupt"), m_qbsStderr.constData());
+}
+
+void TestBlackbox::cppScanner()
+{
+    QDir::setCurrent(testDataDir + "/cpp-scanner");
+    QVERIFY(QFileInfo("sizes.h").size() % 16 != 0);
+    QVERIFY(QFileInfo("tiny.h").size() < 16);
+    QCOMPARE(runQbs(QbsRunParameters(QStringList("-vv"))), 0);
+    const QStringList includedHeaders{"real.h", "with-spaces.h", "continued-directive.h",
+                                      "after-char-literal.h", "after-escaped-char-literal.h",
+                                      "sizes.h", "tail.h", "tiny.h", "t.h"};
+    for (const QString &header : includedHeaders) {
+        QVERIFY2(m_qbsStderr.contains(("scanning \"" + header + '"').toUtf8()),
+                 qPrintable(header));
+    }
+    const QStringList notIncludedHeaders{"in-line-comment.h", "in-block-comment.h",
+                                         "in-string.h", "in-continued-string.h",
+                                         "in-continued-wide-string.h"};
+    for (const QString &header : notIncludedHeaders) {
+        QVERIFY2(!m_qbsStderr.contains(("scanning \"" + header + '"').toUtf8()),
+                 qPrintable(header));
+    }
+}
+
 void TestBlackbox::cpuFeatures()
 {
     QDir::setCurrent(testDataDir + "/cpu-features");
@@ -2085,6 +2280,58 @@ void TestBlackbox::separateDebugInfo()
     }
 }
 
+void TestBlackbox::traceFile()
+{
+    QDir::setCurrent(testDataDir + "/trace-file");
+    QCOMPARE(runQbs(QbsRunParameters(QStringList{"-j", "2", "--trace-file", "trace.json"})), 0);
+    QFile traceFile("trace.json");
+    QVERIFY2(traceFile.open(QIODevice::ReadOnly), qPrintable(traceFile.errorString()));
+    QJsonParseError parseError;
+    const QJsonDocument trace = QJsonDocument::fromJson(traceFile.readAll(), &parseError);
+    QVERIFY2(parseError.error == QJsonParseError::NoError,
+             qPrintable(parseError.errorString()));
+    const QJsonArray events = trace.object().value("traceEvents").toArray();
+    QVERIFY(!events.isEmpty());
+
+    QHash<int, QString> laneNames;
+    QSet<QString> categories;
+    QStringList commandNames;
+    QSet<int> commandLanes;
+    for (const QJsonValue &v : events) {
+        const QJsonObject event = v.toObject();
+        const QString phase = event.value("ph").toString();
+        const int lane = event.value("tid").toInt();
+        if (phase == "M") {
+            if (event.value("name").toString() == "thread_name")
+                laneNames.insert(lane, event.value("args").toObject().value("name").toString());
+            continue;
+        }
+        QCOMPARE(phase, QString("X"));
+        QVERIFY(event.value("dur").toDouble() >= 0);
+        const QString category = event.value("cat").toString();
+        categories << category;
+        if (category == "command") {
+            commandNames << event.value("name").toString();
+            commandLanes << lane;
+        }
+    }
+    for (const QString &category : {"module loading", "probe", "resolving", "activity",
+                                     "rule", "command"}) {
+        QVERIFY2(categories.contains(category), qPrintable(category));
+    }
+    commandNames.sort();
+    QCOMPARE(commandNames, QStringList({"generating file1.out", "generating file2.out"}));
+    for (const int lane : qAsConst(commandLanes)) {
+        QVERIFY2(laneNames.value(lane).startsWith("Job slot "),
+                 qPrintable(laneNames.value(lane)));
+    }
+
+    // Without the option, no trace is written.
+    QVERIFY(traceFile.remove());
+    QCOMPARE(runQbs(QbsRunParameters("resolve")), 0);
+    QVERIFY(!QFile::exists("trace.json"));
+}
+
 void TestBlackbox::trackAddFile()
 {
     QList<QByteArray> output;
@@ -3015,6 +3262,164 @@ void TestBlackbox::overrideProjectProperties()
     QCOMPARE(runQbs(params), 0);
 }
 
+void TestBlackbox::parallelPrepareScripts()
+{
+    QDir::setCurrent(testDataDir + "/parallel-prepare-scripts");
+    qbs::Settings settings(QDir::currentPath() + "/settings-dir");
+    settings.setValue("preferences.parallelPrepareScripts", true);
+    settings.sync();
+    QbsRunParameters params(QStringList{"-j", "4"});
+    params.settingsDir = settings.baseDirectory();
+    params.profile.clear();
+    QCOMPARE(runQbs(params), 0);
+    QCOMPARE(m_qbsStdout.count("creating file"), 8);
+    const QString outputFilePath = relativeProductBuildDir("p") + "/file5.out";
+    QVERIFY(regularFileExists(outputFilePath));
+    QFile outputFile(outputFilePath);
+    QVERIFY2(outputFile.open(QIODevice::ReadOnly), qPrintable(outputFile.errorString()));
+    QCOMPARE(outputFile.readAll(), QByteArray("file5.in-x"));
+    outputFile.close();
+
+    QCOMPARE(runQbs(params), 0);
+    QVERIFY2(!m_qbsStdout.contains("creating file"), m_qbsStdout.constData());
+
+    params.arguments << "products.p.suffix:y";
+    QCOMPARE(runQbs(params), 0);
+    QCOMPARE(m_qbsStdout.count("creating file"), 8);
+    QVERIFY2(outputFile.open(QIODevice::ReadOnly), qPrintable(outputFile.errorString()));
+    QCOMPARE(outputFile.readAll(), QByteArray("file5.in-y"));
+}
+
+void TestBlackbox::parallelResolving()
+{
+    QDir::setCurrent(testDataDir + "/parallel-resolving");
+    QCOMPARE(runQbs(QbsRunParameters("resolve")), 0);
+    const int messageCount = m_qbsStdout.count("evaluating content of p4");
+    QVERIFY2(messageCount > 0, m_qbsStdout.constData());
+
+    // Output from property evaluation must appear exactly as in the serial case.
+    QCOMPARE(runQbs(QbsRunParameters("resolve", QStringList{"--resolver-jobs", "4"})), 0);
+    QCOMPARE(m_qbsStdout.count("evaluating content of p4"), messageCount);
+
+    QCOMPARE(runQbs(), 0);
+    QCOMPARE(m_qbsStdout.count("creating p"), 4);
+    const std::pair<QString, QByteArray> expectedContents[] = {
+        {"p1", "p1-one-m-output"}, {"p2", "p2-two-m-output"},
+        {"p3", "p3-three-m-output"}, {"p4", "p4-four-m-output"}};
+    for (const auto &[productName, content] : expectedContents) {
+        QFile outputFile(relativeProductBuildDir(productName) + '/' + productName + ".txt");
+        QVERIFY2(outputFile.open(QIODevice::ReadOnly), qPrintable(outputFile.errorString()));
+        QCOMPARE(outputFile.readAll(), content);
+    }
+}
+
+void TestBlackbox::parseCache()
+{
+    QDir::setCurrent(testDataDir + "/parse-cache");
+    const QString cacheDir = QDir::currentPath() + "/parse-cache-dir";
+    QDir(cacheDir).removeRecursively();
+    qbs::Settings settings(QDir::currentPath() + "/settings-dir");
+    settings.setValue("preferences.parseCacheDirectory", cacheDir);
+    settings.sync();
+    QbsRunParameters params("resolve", QStringList("--log-time"));
+    params.settingsDir = settings.baseDirectory();
+    params.profile.clear();
+    const QRegularExpression statsPattern("(\\d+) of (\\d+) files were taken from the parse cache");
+
+    QCOMPARE(runQbs(params), 0);
+    QVERIFY2(m_qbsStdout.contains("greeting: hello, from js"), m_qbsStdout.constData());
+    QRegularExpressionMatch match = statsPattern.match(QString::fromLocal8Bit(m_qbsStdout));
+    QVERIFY2(match.hasMatch(), m_qbsStdout.constData());
+    const int fileCount = match.captured(2).toInt();
+    QVERIFY(match.captured(1).toInt() < fileCount);
+    QVERIFY(directoryExists(cacheDir));
+
+    // A new build directory does not need to parse anything.
+    rmDirR(relativeBuildDir());
+    QCOMPARE(runQbs(params), 0);
+    QVERIFY2(m_qbsStdout.contains("greeting: hello, from js"), m_qbsStdout.constData());
+    match = statsPattern.match(QString::fromLocal8Bit(m_qbsStdout));
+    QVERIFY2(match.hasMatch(), m_qbsStdout.constData());
+    QCOMPARE(match.captured(1).toInt(), fileCount);
+    QCOMPARE(match.captured(2).toInt(), fileCount);
+
+    // Entries are found by content, so a changed file gets parsed again.
+    REPLACE_IN_FILE("MyProduct.qbs", "\"hello\"", "\"hi\"");
+    QCOMPARE(runQbs(params), 0);
+    QVERIFY2(m_qbsStdout.contains("greeting: hi, from js"), m_qbsStdout.constData());
+    match = statsPattern.match(QString::fromLocal8Bit(m_qbsStdout));
+    QVERIFY2(match.hasMatch(), m_qbsStdout.constData());
+    QCOMPARE(match.captured(1).toInt(), fileCount - 1);
+}
+
+void TestBlackbox::parseCachePruning()
+{
+    QDir::setCurrent(testDataDir + "/parse-cache-pruning");
+    const QString cacheDir = QDir::currentPath() + "/parse-cache-dir";
+    QDir(cacheDir).removeRecursively();
+    qbs::Settings settings(QDir::currentPath() + "/settings-dir");
+    settings.setValue("preferences.parseCacheDirectory", cacheDir);
+    settings.setValue("preferences.parseCacheMaxSize", 1);
+    settings.sync();
+    QbsRunParameters params("resolve", QStringList("--log-time"));
+    params.settingsDir = settings.baseDirectory();
+    params.profile.clear();
+    const QRegularExpression statsPattern("(\\d+) of (\\d+) files were taken from the parse cache");
+    QCOMPARE(runQbs(params), 0);
+    QVERIFY(QFile::exists(cacheDir + "/last-pruned"));
+
+    // Add two big entries that were last used a while ago, so the cache exceeds its limit
+    // of 1 MiB. Only the older one has to go to get below the limit again.
+    const auto addOldEntry = [&cacheDir](const QString &name, int ageInDays) {
+        QDir(cacheDir).mkpath("00");
+        QFile entry(cacheDir + "/00/" + name);
+        if (!entry.open(QIODevice::WriteOnly) || !entry.resize(600 * 1024))
+            return false;
+        return entry.setFileTime(QDateTime::currentDateTimeUtc().addDays(-ageInDays),
+                                 QFileDevice::FileModificationTime);
+    };
+    QVERIFY(addOldEntry("00older", 3));
+    QVERIFY(addOldEntry("00newer", 2));
+    QFile::remove(cacheDir + "/last-pruned");
+    rmDirR(relativeBuildDir());
+    QCOMPARE(runQbs(params), 0);
+    QVERIFY(!QFile::exists(cacheDir + "/00/00older"));
+    QVERIFY(QFile::exists(cacheDir + "/00/00newer"));
+
+    // The entries that were just used are still there.
+    rmDirR(relativeBuildDir());
+    QCOMPARE(runQbs(params), 0);
+    const QRegularExpressionMatch match = statsPattern.match(QString::fromLocal8Bit(m_qbsStdout));
+    QVERIFY2(match.hasMatch(), m_qbsStdout.constData());
+    QCOMPARE(match.captured(1), match.captured(2));
+}
+
+void TestBlackbox::partialReResolving()
+{
+    QDir::setCurrent(testDataDir + "/partial-re-resolving");
+    QbsRunParameters params("resolve", QStringList("--log-time"));
+    QCOMPARE(runQbs(params), 0);
+    QVERIFY2(m_qbsStdout.contains("evaluating a"), m_qbsStdout.constData());
+    QVERIFY2(m_qbsStdout.contains("evaluating c, b is original"), m_qbsStdout.constData());
+
+    // Products depending on a changed product get evaluated again, the others do not.
+    WAIT_FOR_NEW_TIMESTAMP();
+    REPLACE_IN_FILE("b.qbs", "original", "changed");
+    QCOMPARE(runQbs(params), 0);
+    QVERIFY2(!m_qbsStdout.contains("evaluating a"), m_qbsStdout.constData());
+    QVERIFY2(m_qbsStdout.contains("evaluating c, b is changed"), m_qbsStdout.constData());
+    QVERIFY2(m_qbsStdout.contains("The properties of 1 products were taken from the stored "
+                                  "build graph."), m_qbsStdout.constData());
+
+    WAIT_FOR_NEW_TIMESTAMP();
+    touch("a.qbs");
+    QCOMPARE(runQbs(params), 0);
+    QVERIFY2(m_qbsStdout.contains("evaluating a"), m_qbsStdout.constData());
+    QVERIFY2(!m_qbsStdout.contains("evaluating c"), m_qbsStdout.constData());
+    QVERIFY2(m_qbsStdout.contains("The properties of 2 products were taken from the stored "
+                                  "build graph."), m_qbsStdout.constData());
+}
+
 void TestBlackbox::pathProbe_data()
 {
     QTest::addColumn<QString>("projectFile");
@@ -3074,6 +3479,31 @@ void TestBlackbox::perGroupDefineInExportItem()
     QCOMPARE(runQbs(), 0);
 }
 
+void TestBlackbox::persistentWorker()
+{
+    if (HostOsInfo::isWindowsHost())
+        QSKIP("The worker in this test is a shell script.");
+    QDir::setCurrent(testDataDir + "/persistent-worker");
+    QCOMPARE(runQbs(QbsRunParameters(QStringList{"-j", "1"})), 0);
+    QCOMPARE(m_qbsStdout.count("handled by worker"), 3);
+    QByteArray workerId;
+    for (const QString &fileName : QStringList{"file1.out", "file2.out", "file3.out"}) {
+        QFile outputFile(relativeProductBuildDir("p") + '/' + fileName);
+        QVERIFY2(outputFile.open(QIODevice::ReadOnly), qPrintable(outputFile.errorString()));
+        const QByteArray content = outputFile.readAll().trimmed();
+        QVERIFY2(content.startsWith("worker "), content.constData());
+        if (workerId.isEmpty())
+            workerId = content;
+        QCOMPARE(content, workerId);
+    }
+
+    QbsRunParameters params(QStringList("products.p.crash:true"));
+    params.expectFailure = true;
+    QVERIFY(runQbs(params) != 0);
+    QVERIFY2(m_qbsStderr.contains("worker crashed"), m_qbsStderr.constData());
+    QVERIFY2(m_qbsStderr.contains("exited unexpectedly"), m_qbsStderr.constData());
+}
+
 void TestBlackbox::pkgConfigProbe()
 {
     const QString exe = findExecutable(QStringList() << "pkg-config");
@@ -3210,6 +3640,88 @@ void TestBlackbox::preventFloatingPointValues()
     QVERIFY2(m_qbsStdout.contains("version: 1.50"), m_qbsStdout.constData());
 }
 
+void TestBlackbox::probeCache()
+{
+    QDir::setCurrent(testDataDir + "/probe-cache");
+    const QString cacheDir = QDir::currentPath() + "/probe-cache-dir";
+    QDir(cacheDir).removeRecursively();
+    QFile::remove("marker.txt");
+    qbs::Settings settings(QDir::currentPath() + "/settings-dir");
+    settings.setValue("preferences.probeCacheDirectory", cacheDir);
+    settings.sync();
+    QbsRunParameters params("resolve");
+    params.settingsDir = settings.baseDirectory();
+    params.profile.clear();
+
+    QCOMPARE(runQbs(params), 0);
+    QVERIFY2(m_qbsStdout.contains("running probe"), m_qbsStdout.constData());
+    QVERIFY2(m_qbsStdout.contains("probe result: no marker a"), m_qbsStdout.constData());
+    QVERIFY(directoryExists(cacheDir));
+
+    // A new build directory takes the result from the cache.
+    rmDirR(relativeBuildDir());
+    QCOMPARE(runQbs(params), 0);
+    QVERIFY2(!m_qbsStdout.contains("running probe"), m_qbsStdout.constData());
+    QVERIFY2(m_qbsStdout.contains("probe result: no marker a"), m_qbsStdout.constData());
+
+    // Different property values mean a different entry.
+    rmDirR(relativeBuildDir());
+    params.arguments = QStringList("products.theProduct.suffix:b");
+    QCOMPARE(runQbs(params), 0);
+    QVERIFY2(m_qbsStdout.contains("running probe"), m_qbsStdout.constData());
+    QVERIFY2(m_qbsStdout.contains("probe result: no marker b"), m_qbsStdout.constData());
+    rmDirR(relativeBuildDir());
+    QCOMPARE(runQbs(params), 0);
+    QVERIFY2(!m_qbsStdout.contains("running probe"), m_qbsStdout.constData());
+    QVERIFY2(m_qbsStdout.contains("probe result: no marker b"), m_qbsStdout.constData());
+
+    // An entry is not used if a file check the probe did has a different outcome now.
+    rmDirR(relativeBuildDir());
+    params.arguments.clear();
+    touch("marker.txt");
+    QCOMPARE(runQbs(params), 0);
+    QVERIFY2(m_qbsStdout.contains("running probe"), m_qbsStdout.constData());
+    QVERIFY2(m_qbsStdout.contains("probe result: marker a"), m_qbsStdout.constData());
+
+    // Forced probe execution bypasses the cache.
+    rmDirR(relativeBuildDir());
+    params.arguments = QStringList("--force-probe-execution");
+    QCOMPARE(runQbs(params), 0);
+    QVERIFY2(m_qbsStdout.contains("running probe"), m_qbsStdout.constData());
+    QFile::remove("marker.txt");
+
+    // Probes that start processes depend on the executable and on the whole environment.
+    if (HostOsInfo::isWindowsHost())
+        return;
+    QFile tool("tool.sh");
+    QVERIFY(tool.setPermissions(tool.permissions() | QFile::ExeOwner));
+    params.arguments = QStringList("products.theProduct.runTool:true");
+    params.environment.insert("PROBE_CACHE_TEST_VALUE", "hello");
+    rmDirR(relativeBuildDir());
+    QCOMPARE(runQbs(params), 0);
+    QVERIFY2(m_qbsStdout.contains("running tool probe"), m_qbsStdout.constData());
+    QVERIFY2(m_qbsStdout.contains("tool result: hello 1"), m_qbsStdout.constData());
+    rmDirR(relativeBuildDir());
+    QCOMPARE(runQbs(params), 0);
+    QVERIFY2(!m_qbsStdout.contains("running tool probe"), m_qbsStdout.constData());
+    QVERIFY2(m_qbsStdout.contains("tool result: hello 1"), m_qbsStdout.constData());
+    rmDirR(relativeBuildDir());
+    params.environment.insert("PROBE_CACHE_TEST_VALUE", "bye");
+    QCOMPARE(runQbs(params), 0);
+    QVERIFY2(m_qbsStdout.contains("running tool probe"), m_qbsStdout.constData());
+    QVERIFY2(m_qbsStdout.contains("tool result: bye 1"), m_qbsStdout.constData());
+    rmDirR(relativeBuildDir());
+    params.environment.insert("PROBE_CACHE_TEST_OTHER_VALUE", "new");
+    QCOMPARE(runQbs(params), 0);
+    QVERIFY2(m_qbsStdout.contains("running tool probe"), m_qbsStdout.constData());
+    rmDirR(relativeBuildDir());
+    WAIT_FOR_NEW_TIMESTAMP();
+    REPLACE_IN_FILE("tool.sh", " 1", " 2");
+    QCOMPARE(runQbs(params), 0);
+    QVERIFY2(m_qbsStdout.contains("running tool probe"), m_qbsStdout.constData());
+    QVERIFY2(m_qbsStdout.contains("tool result: bye 2"), m_qbsStdout.constData());
+}
+
 void TestBlackbox::probeChangeTracking()
 {
     QDir::setCurrent(testDataDir + "/probe-change-tracking");
@@ -3709,6 +4221,27 @@ void TestBlackbox::dynamicRuleOutputs()
     QVERIFY(!QFile::exists(sourceFile2));
 }
 
+void TestBlackbox::earlyCutoff()
+{
+    QDir::setCurrent(testDataDir + "/early-cutoff");
+    QCOMPARE(runQbs(), 0);
+    QVERIFY2(m_qbsStdout.contains("generating myheader.h"), m_qbsStdout.constData());
+    QVERIFY2(m_qbsStdout.contains("compiling main.c"), m_qbsStdout.constData());
+
+    // The header gets re-generated with the same contents, so main.c is still up to date.
+    WAIT_FOR_NEW_TIMESTAMP();
+    touch("header.txt");
+    QCOMPARE(runQbs(), 0);
+    QVERIFY2(m_qbsStdout.contains("generating myheader.h"), m_qbsStdout.constData());
+    QVERIFY2(!m_qbsStdout.contains("compiling main.c"), m_qbsStdout.constData());
+
+    WAIT_FOR_NEW_TIMESTAMP();
+    REPLACE_IN_FILE("header.txt", "VALUE 1", "VALUE 2");
+    QCOMPARE(runQbs(), 0);
+    QVERIFY2(m_qbsStdout.contains("generating myheader.h"), m_qbsStdout.constData());
+    QVERIFY2(m_qbsStdout.contains("compiling main.c"), m_qbsStdout.constData());
+}
+
 void TestBlackbox::emptyProfile()
 {
     QDir::setCurrent(testDataDir + "/empty-profile");
@@ -4539,6 +5072,71 @@ void TestBlackbox::compilerDefinesByLanguage()
     QCOMPARE(runQbs(params), 0);
 }
 
+void TestBlackbox::compilerDependencies()
+{
+    QDir::setCurrent(testDataDir + "/compiler-dependencies");
+    QCOMPARE(runQbs(QbsRunParameters("resolve")), 0);
+    const bool isGcc = m_qbsStdout.contains("is gcc: true");
+    const bool isMsvc = m_qbsStdout.contains("is msvc: true");
+    if (!isGcc && !isMsvc) {
+        QVERIFY2(m_qbsStdout.contains("is gcc: false") && m_qbsStdout.contains("is msvc: false"),
+                 m_qbsStdout.constData());
+        QSKIP("Neither GCC nor MSVC");
+    }
+    QCOMPARE(runQbs(), 0);
+    QVERIFY2(m_qbsStdout.contains("compiling main.c"), m_qbsStdout.constData());
+    QVERIFY2(!m_qbsStdout.contains("including file"), m_qbsStdout.constData());
+
+    // The dependency files are not left behind.
+    QStringList depFiles;
+    QDirIterator depFileIt(relativeProductBuildDir("app"), QStringList("*.d"), QDir::Files,
+                           QDirIterator::Subdirectories);
+    while (depFileIt.hasNext())
+        depFiles << depFileIt.next();
+    QVERIFY2(depFiles.isEmpty(), qPrintable(depFiles.join(',')));
+
+    WAIT_FOR_NEW_TIMESTAMP();
+    touch("nested.h");
+    QCOMPARE(runQbs(), 0);
+    QVERIFY2(m_qbsStdout.contains("compiling main.c"), m_qbsStdout.constData());
+
+    // Headers in inactive preprocessor branches are not dependencies.
+    WAIT_FOR_NEW_TIMESTAMP();
+    touch("inactive.h");
+    QCOMPARE(runQbs(), 0);
+    QVERIFY2(!m_qbsStdout.contains("compiling main.c"), m_qbsStdout.constData());
+}
+
+void TestBlackbox::jobServer()
+{
+    if (HostOsInfo::isWindowsHost())
+        QSKIP("Job server is only supported on Unix hosts.");
+    QDir::setCurrent(testDataDir + "/job-server");
+
+    // The job server is opt-in.
+    QCOMPARE(runQbs(QbsRunParameters(QStringList{"-j", "2"})), 0);
+    QVERIFY2(m_qbsStdout.contains("client 1 found no job server"), m_qbsStdout.constData());
+    QVERIFY2(m_qbsStdout.contains("client 2 found no job server"), m_qbsStdout.constData());
+
+    const SettingsPtr s = settings();
+    s->setValue("preferences.useJobServer", true);
+    s->sync();
+    const auto settingsRestorer = qScopeGuard([&s] {
+        s->remove("preferences.useJobServer");
+        s->sync();
+    });
+
+    // With two jobs, there is exactly one token in the pipe. The second client can only
+    // take it if we gave back the one we used to run the two sleepers in parallel, and
+    // it finds no more than one if we did not give back too many.
+    QCOMPARE(runQbs(QbsRunParameters(QStringLiteral("clean"))), 0);
+    QCOMPARE(runQbs(QbsRunParameters(QStringList{"-j", "2"})), 0);
+    QVERIFY2(m_qbsStdout.contains("client 1 took 1 token(s)"), m_qbsStdout.constData());
+    QVERIFY2(m_qbsStdout.contains("running sleeper a"), m_qbsStdout.constData());
+    QVERIFY2(m_qbsStdout.contains("running sleeper b"), m_qbsStdout.constData());
+    QVERIFY2(m_qbsStdout.contains("client 2 took 1 token(s)"), m_qbsStdout.constData());
+}
+
 void TestBlackbox::jsExtensionsFile()
 {
     QDir::setCurrent(testDataDir + "/jsextensions-file");
@@ -4755,6 +5353,37 @@ void TestBlackbox::lastModuleCandidateBroken()
     QVERIFY2(m_qbsStderr.contains("Module Foo could not be loaded"), m_qbsStderr);
 }
 
+void TestBlackbox::lazyBuildGraphLoading()
+{
+    QDir::setCurrent(testDataDir + "/lazy-build-graph-loading");
+    QCOMPARE(runQbs(), 0);
+    QVERIFY2(m_qbsStdout.contains("generating a.out"), m_qbsStdout.constData());
+    QVERIFY2(m_qbsStdout.contains("generating b.out"), m_qbsStdout.constData());
+    const QString bgFilePath = relativeBuildGraphFilePath();
+    const qint64 completeSize = QFileInfo(bgFilePath).size();
+
+    // The build data of products that are not built does not get loaded,
+    // so their changes go unnoticed.
+    WAIT_FOR_NEW_TIMESTAMP();
+    touch("b.in");
+    QbsRunParameters params(QStringList{"-p", "a"});
+    QCOMPARE(runQbs(params), 0);
+    QVERIFY2(!m_qbsStdout.contains("generating"), m_qbsStdout.constData());
+    WAIT_FOR_NEW_TIMESTAMP();
+    touch("a.in");
+    QCOMPARE(runQbs(params), 0);
+    QVERIFY2(m_qbsStdout.contains("generating a.out"), m_qbsStdout.constData());
+    QVERIFY2(!m_qbsStdout.contains("generating b.out"), m_qbsStdout.constData());
+    QVERIFY(QFileInfo(bgFilePath).size() > completeSize);
+
+    // The changes recorded for the product that was built get applied when it is loaded.
+    QCOMPARE(runQbs(), 0);
+    QVERIFY2(!m_qbsStdout.contains("generating a.out"), m_qbsStdout.constData());
+    QVERIFY2(m_qbsStdout.contains("generating b.out"), m_qbsStdout.constData());
+    QCOMPARE(runQbs(), 0);
+    QVERIFY2(!m_qbsStdout.contains("generating"), m_qbsStdout.constData());
+}
+
 void TestBlackbox::ld()
 {
     QDir::setCurrent(testDataDir + "/ld");
@@ -6281,6 +6910,15 @@ static QJsonObject getNextSessionPacket(QProcess &session, QByteArray &data)
     return QJsonDocument::fromJson(QByteArray::fromBase64(msg)).object();
 }
 
+static QJsonObject envToJson(const QProcessEnvironment &env)
+{
+    QJsonObject envObj;
+    const QStringList keys = env.keys();
+    for (const QString &key : keys)
+        envObj.insert(key, env.value(key));
+    return envObj;
+}
+
 void TestBlackbox::qbsSession()
 {
     QDir::setCurrent(testDataDir + "/qbs-session");
@@ -6304,14 +6942,6 @@ void TestBlackbox::qbsSession()
         sessionProc.write(data);
     };
 
-    static const auto envToJson = [](const QProcessEnvironment &env) {
-        QJsonObject envObj;
-        const QStringList keys = env.keys();
-        for (const QString &key : keys)
-            envObj.insert(key, env.value(key));
-        return envObj;
-    };
-
     static const auto envFromJson = [](const QJsonValue &v) {
         const QJsonObject obj = v.toObject();
         QProcessEnvironment env;
@@ -6445,6 +7075,7 @@ void TestBlackbox::qbsSession()
     receivedStartedSignal = false;
     receivedProgressData = false;
     bool receivedCommandDescription = false;
+    bool receivedProcessOutput = false;
     bool receivedProcessResult = false;
     while (!receivedReply) {
         receivedMessage = getNextSessionPacket(sessionProc, incomingData);
@@ -6468,8 +7099,13 @@ void TestBlackbox::qbsSession()
         } else if (msgType == "command-description") {
             if (receivedMessage.value("message").toString().contains("compiling main.cpp"))
                 receivedCommandDescription = true;
+        } else if (msgType == "process-output") {
+            QVERIFY(receivedMessage.value("stdout").toArray().size()
+                    + receivedMessage.value("stderr").toArray().size() > 0);
+            receivedProcessOutput = true;
         } else if (msgType == "process-result") {
             QCOMPARE(receivedMessage.value("exit-code").toInt(), 0);
+            QCOMPARE(receivedMessage.value("output-forwarded").toBool(), receivedProcessOutput);
             receivedProcessResult = true;
         } else if (msgType != "new-max-progress") {
             QVERIFY2(false, qPrintable(QString("Unexpected message type '%1'").arg(msgType)));
@@ -6926,6 +7562,114 @@ void TestBlackbox::qbsSession()
     QVERIFY(sessionProc.waitForFinished(3000));
 }
 
+void TestBlackbox::qbsSessionWatchFiles()
+{
+    if (!HostOsInfo::isLinuxHost())
+        QSKIP("file watching is only supported on Linux");
+    QDir::setCurrent(testDataDir + "/qbs-session-watch-files");
+    QProcess sessionProc;
+    sessionProc.start(qbsExecutableFilePath, QStringList("session"));
+    QVERIFY(sessionProc.waitForStarted());
+
+    const auto sendPacket = [&sessionProc](const QJsonObject &message) {
+        const QByteArray data = QJsonDocument(message).toJson().toBase64();
+        sessionProc.write("qbsmsg:");
+        sessionProc.write(QByteArray::number(data.length()));
+        sessionProc.write("\n");
+        sessionProc.write(data);
+    };
+
+    QByteArray incomingData;
+    QJsonObject receivedMessage = getNextSessionPacket(sessionProc, incomingData);
+    QCOMPARE(receivedMessage.value("type"), "hello");
+
+    QJsonObject resolveMessage;
+    resolveMessage.insert("type", "resolve-project");
+    resolveMessage.insert("top-level-profile", profileName());
+    resolveMessage.insert("configuration-name", "watch-config");
+    resolveMessage.insert("project-file-path",
+                          QDir::currentPath() + "/qbs-session-watch-files.qbs");
+    resolveMessage.insert("build-root", QDir::currentPath());
+    resolveMessage.insert("settings-directory", settings()->baseDirectory());
+    resolveMessage.insert("environment", envToJson(QbsRunParameters::defaultEnvironment()));
+    resolveMessage.insert("watch-files", true);
+    sendPacket(resolveMessage);
+    while (true) {
+        receivedMessage = getNextSessionPacket(sessionProc, incomingData);
+        QVERIFY(!receivedMessage.isEmpty());
+        if (receivedMessage.value("type").toString() == "project-resolved") {
+            const QJsonObject error = receivedMessage.value("error").toObject();
+            QVERIFY2(error.isEmpty(), qPrintable(QJsonDocument(error).toJson()));
+            break;
+        }
+    }
+
+    // Returns the command descriptions of the build.
+    const auto buildProject = [&](bool *success) {
+        QJsonObject buildRequest;
+        buildRequest.insert("type", "build-project");
+        buildRequest.insert("install", false);
+        sendPacket(buildRequest);
+        QString descriptions;
+        while (true) {
+            const QJsonObject message = getNextSessionPacket(sessionProc, incomingData);
+            const QString msgType = message.value("type").toString();
+            if (msgType == "command-description") {
+                descriptions += message.value("message").toString() + '\n';
+            } else if (msgType == "project-built" || message.isEmpty()) {
+                *success = !message.isEmpty() && message.value("error").toObject().isEmpty();
+                return descriptions;
+            }
+        }
+    };
+
+    bool success = false;
+    QString descriptions = buildProject(&success);
+    QVERIFY(success);
+    QVERIFY2(descriptions.contains("compiling main.cpp"), qPrintable(descriptions));
+    descriptions = buildProject(&success);
+    QVERIFY(success);
+    QVERIFY2(!descriptions.contains("compiling main.cpp"), qPrintable(descriptions));
+
+    // Headers in subdirectories of include paths and of the source directory are watched too.
+    WAIT_FOR_NEW_TIMESTAMP();
+    REPLACE_IN_FILE("include/sub/nested.h", "return 0", "return 1");
+    descriptions = buildProject(&success);
+    QVERIFY(success);
+    QVERIFY2(descriptions.contains("compiling main.cpp"), qPrintable(descriptions));
+    descriptions = buildProject(&success);
+    QVERIFY(success);
+    QVERIFY2(!descriptions.contains("compiling main.cpp"), qPrintable(descriptions));
+    WAIT_FOR_NEW_TIMESTAMP();
+    REPLACE_IN_FILE("local/local.h", "return 0", "return 1");
+    descriptions = buildProject(&success);
+    QVERIFY(success);
+    QVERIFY2(descriptions.contains("compiling main.cpp"), qPrintable(descriptions));
+
+    // A directory that got removed and re-created is watched again.
+    WAIT_FOR_NEW_TIMESTAMP();
+    QVERIFY(QDir().rename("local", "local-old"));
+    QVERIFY(QDir().mkdir("local"));
+    QVERIFY(QFile::copy("local-old/local.h", "local/local.h"));
+    QVERIFY(QDir("local-old").removeRecursively());
+    descriptions = buildProject(&success);
+    QVERIFY(success);
+    QVERIFY2(descriptions.contains("compiling main.cpp"), qPrintable(descriptions));
+    descriptions = buildProject(&success);
+    QVERIFY(success);
+    QVERIFY2(!descriptions.contains("compiling main.cpp"), qPrintable(descriptions));
+    WAIT_FOR_NEW_TIMESTAMP();
+    REPLACE_IN_FILE("local/local.h", "return 1", "return 2");
+    descriptions = buildProject(&success);
+    QVERIFY(success);
+    QVERIFY2(descriptions.contains("compiling main.cpp"), qPrintable(descriptions));
+
+    QJsonObject quitRequest;
+    quitRequest.insert("type", "quit");
+    sendPacket(quitRequest);
+    QVERIFY(sessionProc.waitForFinished(3000));
+}
+
 void TestBlackbox::radAfterIncompleteBuild_data()
 {
     QTest::addColumn<QString>("projectFileName");
@@ -7766,6 +8510,79 @@ void TestBlackbox::includeLookup()
     QVERIFY2(m_qbsStdout.contains("definition.."), m_qbsStdout.constData());
 }
 
+void TestBlackbox::includeLookupCache()
+{
+    QDir::setCurrent(testDataDir + "/include-lookup-cache");
+    QCOMPARE(runQbs(), 0);
+    QVERIFY2(m_qbsStdout.contains("compiling main.c"), m_qbsStdout.constData());
+
+    // A header appearing in an earlier include path must win over the cached look-up result.
+    WAIT_FOR_NEW_TIMESTAMP();
+    copyFileAndUpdateTimestamp("header.h.in", "dir1/header.h");
+    touch("main.c");
+    QCOMPARE(runQbs(), 0);
+    QVERIFY2(m_qbsStdout.contains("compiling main.c"), m_qbsStdout.constData());
+
+    WAIT_FOR_NEW_TIMESTAMP();
+    touch("dir2/header.h");
+    QCOMPARE(runQbs(), 0);
+    QVERIFY2(!m_qbsStdout.contains("compiling main.c"), m_qbsStdout.constData());
+
+    WAIT_FOR_NEW_TIMESTAMP();
+    touch("dir1/header.h");
+    QCOMPARE(runQbs(), 0);
+    QVERIFY2(m_qbsStdout.contains("compiling main.c"), m_qbsStdout.constData());
+}
+
+void TestBlackbox::incrementalBuildGraphStorage()
+{
+    QDir::setCurrent(testDataDir + "/incremental-build-graph-storage");
+    QCOMPARE(runQbs(), 0);
+    QVERIFY2(m_qbsStdout.contains("generating file1.out"), m_qbsStdout.constData());
+    QVERIFY2(m_qbsStdout.contains("generating file2.out"), m_qbsStdout.constData());
+    const QString bgFilePath = relativeBuildGraphFilePath();
+    const qint64 completeSize = QFileInfo(bgFilePath).size();
+    QVERIFY(completeSize > 0);
+
+    // Re-running a command does not change the structure of the build graph,
+    // so the new state gets appended to the file.
+    WAIT_FOR_NEW_TIMESTAMP();
+    touch("file1.in");
+    QCOMPARE(runQbs(), 0);
+    QVERIFY2(m_qbsStdout.contains("generating file1.out"), m_qbsStdout.constData());
+    QVERIFY2(!m_qbsStdout.contains("generating file2.out"), m_qbsStdout.constData());
+    const qint64 sizeWithChanges = QFileInfo(bgFilePath).size();
+    QVERIFY(sizeWithChanges > completeSize);
+    QVERIFY(sizeWithChanges - completeSize < completeSize / 4);
+
+    // The appended state is taken into account when loading the build graph.
+    QCOMPARE(runQbs(), 0);
+    QVERIFY2(!m_qbsStdout.contains("generating"), m_qbsStdout.constData());
+    QCOMPARE(QFileInfo(bgFilePath).size(), sizeWithChanges);
+    WAIT_FOR_NEW_TIMESTAMP();
+    touch("file2.in");
+    QCOMPARE(runQbs(), 0);
+    QVERIFY2(!m_qbsStdout.contains("generating file1.out"), m_qbsStdout.constData());
+    QVERIFY2(m_qbsStdout.contains("generating file2.out"), m_qbsStdout.constData());
+
+    // A damaged record, as left behind by a crash, is ignored and removed.
+    QFile bgFile(bgFilePath);
+    QVERIFY(bgFile.open(QIODevice::Append));
+    bgFile.write(QByteArray(20, 'x'));
+    bgFile.close();
+    const qint64 sizeWithDamagedRecord = QFileInfo(bgFilePath).size();
+    QCOMPARE(runQbs(), 0);
+    QVERIFY2(!m_qbsStdout.contains("generating"), m_qbsStdout.constData());
+    QVERIFY(QFileInfo(bgFilePath).size() < sizeWithDamagedRecord - 20);
+
+    // Structural changes make us store the complete build graph.
+    WAIT_FOR_NEW_TIMESTAMP();
+    QFile::remove("file2.in");
+    REPLACE_IN_FILE("incremental-build-graph-storage.qbs", ", \"file2.in\"", "");
+    QCOMPARE(runQbs(), 0);
+    QVERIFY(QFileInfo(bgFilePath).size() < completeSize);
+}
+
 void TestBlackbox::inputTagsChangeTracking_data()
 {
     QTest::addColumn<QString>("generateInput");
@@ -7823,6 +8640,147 @@ void TestBlackbox::outputRedirection()
     TEXT_FILE_COMPARE("output.bin", relativeProductBuildDir("the-product") + "/output.bin");
 }
 
+void TestBlackbox::processLauncher()
+{
+    if (HostOsInfo::isWindowsHost())
+        QSKIP("The commands in this test are shell commands.");
+    QDir::setCurrent(testDataDir + "/process-launcher");
+    const auto outputFileContent = [](const QString &productName, const QString &fileName) {
+        QFile outputFile(relativeProductBuildDir(productName) + '/' + fileName);
+        return outputFile.open(QIODevice::ReadOnly) ? outputFile.readAll().trimmed()
+                                                    : QByteArray();
+    };
+    const int jobCount = 48;
+
+    // Enough jobs to start several launchers, each of which is the parent of some commands.
+    QbsRunParameters params(QStringList{"-j", QString::number(jobCount)});
+    QCOMPARE(runQbs(params), 0);
+    QCOMPARE(m_qbsStdout.count("running job"), jobCount);
+    QSet<QByteArray> launchers;
+    for (int i = 0; i < jobCount; ++i) {
+        const QByteArray content = outputFileContent("many-jobs",
+                                                     QStringLiteral("job%1.out").arg(i));
+        QVERIFY2(content.startsWith("launcher "), content.constData());
+        launchers << content;
+    }
+    QVERIFY2(launchers.size() > 1, QByteArray::number(launchers.size()).constData());
+
+    // Commands run in the working directory they ask for.
+    QCOMPARE(outputFileContent("working-dir", "pwd.txt"),
+             QFileInfo("work-dir").canonicalFilePath().toLocal8Bit());
+    QCOMPARE(outputFileContent("crasher", "crash.txt"), QByteArray("survived"));
+
+    // Persistent workers get their requests on their standard input.
+    params.arguments << "products.many-jobs.useWorker:true";
+    QCOMPARE(runQbs(params), 0);
+    QCOMPARE(m_qbsStdout.count("handled by worker"), jobCount);
+    for (int i = 0; i < jobCount; ++i) {
+        const QByteArray content = outputFileContent("many-jobs",
+                                                     QStringLiteral("job%1.out").arg(i));
+        QVERIFY2(content.startsWith("worker "), content.constData());
+    }
+
+    // A command that gets killed by a signal fails the build.
+    params.arguments << "products.crasher.crash:true";
+    params.expectFailure = true;
+    QVERIFY(runQbs(params) != 0);
+    QVERIFY2(m_qbsStderr.contains("Process crashed"), m_qbsStderr.constData());
+    QVERIFY2(!m_qbsStdout.contains("running job"), m_qbsStdout.constData());
+}
+
+void TestBlackbox::processOutputLimit()
+{
+    QDir::setCurrent(testDataDir + "/process-output-limit");
+    qbs::Settings settings(QDir::currentPath() + "/settings-dir");
+    settings.setValue("preferences.maxProcessOutputSize", 1);
+    settings.sync();
+    QbsRunParameters params;
+    params.settingsDir = settings.baseDirectory();
+    params.profile.clear();
+    QCOMPARE(runQbs(params), 0);
+    QVERIFY2(m_qbsStdout.contains("bytes of earlier output were discarded"),
+             m_qbsStdout.constData());
+    QVERIFY2(m_qbsStdout.contains("line 300"), m_qbsStdout.constData());
+    QVERIFY2(!m_qbsStdout.contains("line 001"), m_qbsStdout.constData());
+}
+
+void TestBlackbox::processResourceUsage()
+{
+    if (HostOsInfo::isWindowsHost())
+        QSKIP("Test uses a shell script.");
+    QDir::setCurrent(testDataDir + "/process-resource-usage");
+    QProcess sessionProc;
+    sessionProc.start(qbsExecutableFilePath, QStringList("session"));
+    QVERIFY(sessionProc.waitForStarted());
+
+    const auto sendPacket = [&sessionProc](const QJsonObject &message) {
+        const QByteArray data = QJsonDocument(message).toJson().toBase64();
+        sessionProc.write("qbsmsg:");
+        sessionProc.write(QByteArray::number(data.length()));
+        sessionProc.write("\n");
+        sessionProc.write(data);
+    };
+
+    QByteArray incomingData;
+    QJsonObject receivedMessage = getNextSessionPacket(sessionProc, incomingData);
+    QCOMPARE(receivedMessage.value("type"), "hello");
+
+    QJsonObject resolveMessage;
+    resolveMessage.insert("type", "resolve-project");
+    resolveMessage.insert("top-level-profile", profileName());
+    resolveMessage.insert("configuration-name", "usage-config");
+    resolveMessage.insert("project-file-path",
+                          QDir::currentPath() + "/process-resource-usage.qbs");
+    resolveMessage.insert("build-root", QDir::currentPath());
+    resolveMessage.insert("settings-directory", settings()->baseDirectory());
+    resolveMessage.insert("environment", envToJson(QbsRunParameters::defaultEnvironment()));
+    sendPacket(resolveMessage);
+    while (true) {
+        receivedMessage = getNextSessionPacket(sessionProc, incomingData);
+        QVERIFY(!receivedMessage.isEmpty());
+        if (receivedMessage.value("type").toString() == "project-resolved") {
+            const QJsonObject error = receivedMessage.value("error").toObject();
+            QVERIFY2(error.isEmpty(), qPrintable(QJsonDocument(error).toJson()));
+            break;
+        }
+    }
+
+    // With only one job, the figures can be attributed on all platforms.
+    QJsonObject buildRequest;
+    buildRequest.insert("type", "build-project");
+    buildRequest.insert("max-job-count", 1);
+    sendPacket(buildRequest);
+    QJsonObject processResult;
+    while (true) {
+        receivedMessage = getNextSessionPacket(sessionProc, incomingData);
+        QVERIFY(!receivedMessage.isEmpty());
+        const QString msgType = receivedMessage.value("type").toString();
+        if (msgType == "process-result") {
+            processResult = receivedMessage;
+        } else if (msgType == "project-built") {
+            const QJsonObject error = receivedMessage.value("error").toObject();
+            QVERIFY2(error.isEmpty(), qPrintable(QJsonDocument(error).toJson()));
+            break;
+        }
+    }
+    const QByteArray resultString = QJsonDocument(processResult).toJson();
+    QVERIFY2(processResult.value("stdout").toArray().contains("busy loop done"),
+             resultString.constData());
+    const qint64 userTime = processResult.value("user-time").toVariant().toLongLong();
+    const qint64 systemTime = processResult.value("system-time").toVariant().toLongLong();
+    const qint64 peakMemoryUsage
+            = processResult.value("peak-memory-usage").toVariant().toLongLong();
+    QVERIFY2(userTime > 0 && userTime < 10 * 60 * 1000, resultString.constData());
+    QVERIFY2(processResult.contains("system-time") && systemTime >= 0, resultString.constData());
+    QVERIFY2(peakMemoryUsage > 100 * 1024 && peakMemoryUsage < 1024 * 1024 * 1024,
+             resultString.constData());
+
+    QJsonObject quitRequest;
+    quitRequest.insert("type", "quit");
+    sendPacket(quitRequest);
+    QVERIFY(sessionProc.waitForFinished(3000));
+}
+
 void TestBlackbox::wildCardsAndRules()
 {
     QDir::setCurrent(testDataDir + "/wildcards-and-rules");
@@ -8250,6 +9208,58 @@ void TestBlackbox::moduleConditions()
     QCOMPARE(m_qbsStdout.count("loaded m4"), 1);
 }
 
+void TestBlackbox::moduleSearchPathIndex()
+{
+    QDir::setCurrent(testDataDir + "/module-search-path-index");
+    const QString cacheDir = QDir::currentPath() + "/parse-cache-dir";
+    QDir(cacheDir).removeRecursively();
+    const QString secondModuleDir = QDir::currentPath() + "/search-path/modules/second";
+    QDir(secondModuleDir).removeRecursively();
+    qbs::Settings settings(QDir::currentPath() + "/settings-dir");
+    settings.setValue("preferences.parseCacheDirectory", cacheDir);
+    settings.sync();
+    QbsRunParameters params("resolve");
+    params.settingsDir = settings.baseDirectory();
+    params.profile.clear();
+
+    QCOMPARE(runQbs(params), 0);
+    QVERIFY2(m_qbsStdout.contains("first present: true"), m_qbsStdout.constData());
+    QVERIFY2(m_qbsStdout.contains("second present: false"), m_qbsStdout.constData());
+    QVERIFY(directoryExists(cacheDir + "/module-index"));
+
+    // A new build directory uses the stored index.
+    rmDirR(relativeBuildDir());
+    QCOMPARE(runQbs(params), 0);
+    QVERIFY2(m_qbsStdout.contains("first present: true"), m_qbsStdout.constData());
+    QVERIFY2(m_qbsStdout.contains("second present: false"), m_qbsStdout.constData());
+
+    // A module added later is found, as the directory timestamps have changed.
+    const auto addSecondModule = [&secondModuleDir] {
+        QVERIFY(QDir().mkpath(secondModuleDir));
+        QFile moduleFile(secondModuleDir + "/second.qbs");
+        QVERIFY2(moduleFile.open(QIODevice::WriteOnly), qPrintable(moduleFile.errorString()));
+        moduleFile.write("Module {\n}\n");
+    };
+    WAIT_FOR_NEW_TIMESTAMP();
+    addSecondModule();
+    rmDirR(relativeBuildDir());
+    QCOMPARE(runQbs(params), 0);
+    QVERIFY2(m_qbsStdout.contains("first present: true"), m_qbsStdout.constData());
+    QVERIFY2(m_qbsStdout.contains("second present: true"), m_qbsStdout.constData());
+
+    // A module added right after the directory was indexed is found as well, even if the
+    // timestamp of the directory is too coarse to reflect the change.
+    QVERIFY(QDir(secondModuleDir).removeRecursively());
+    rmDirR(relativeBuildDir());
+    QCOMPARE(runQbs(params), 0);
+    QVERIFY2(m_qbsStdout.contains("second present: false"), m_qbsStdout.constData());
+    addSecondModule();
+    rmDirR(relativeBuildDir());
+    QCOMPARE(runQbs(params), 0);
+    QVERIFY2(m_qbsStdout.contains("second present: true"), m_qbsStdout.constData());
+    QVERIFY(QDir(secondModuleDir).removeRecursively());
+}
+
 void TestBlackbox::movedFileDependency()
 {
     QDir::setCurrent(testDataDir + "/moved-file-dependency");
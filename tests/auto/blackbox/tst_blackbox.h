@@ -40,6 +40,7 @@ public:
     TestBlackbox();
 
 private slots:
+    void actionCache();
     void allowedValues();
     void allowedValues_data();
     void addFileTagToGeneratedArtifact();
@@ -82,7 +83,9 @@ private slots:
     void combinedSources();
     void commandFile();
     void compilerDefinesByLanguage();
+    void compilerDependencies();
     void concurrentExecutor();
+    void concurrentScanning();
     void conditionalExport();
     void conditionalFileTagger();
     void configure();
@@ -91,6 +94,8 @@ private slots:
     void cxxLanguageVersion_data();
     void conanfileProbe_data();
     void conanfileProbe();
+    void corruptBuildGraphHeader();
+    void cppScanner();
     void cpuFeatures();
     void dependenciesProperty();
     void dependencyScanningLoop();
@@ -104,6 +109,7 @@ private slots:
     void dynamicMultiplexRule();
     void dynamicProject();
     void dynamicRuleOutputs();
+    void earlyCutoff();
     void emptyProfile();
     void enableExceptions();
     void enableExceptions_data();
@@ -144,6 +150,8 @@ private slots:
     void importingProduct();
     void importsConflict();
     void includeLookup();
+    void includeLookupCache();
+    void incrementalBuildGraphStorage();
     void inputTagsChangeTracking_data();
     void inputTagsChangeTracking();
     void inputsFromDependencies();
@@ -166,6 +174,7 @@ private slots:
     void invalidInstallDir();
     void invalidLibraryNames();
     void invalidLibraryNames_data();
+    void jobServer();
     void jsExtensionsFile();
     void jsExtensionsFileInfo();
     void jsExtensionsHost();
@@ -175,6 +184,7 @@ private slots:
     void jsExtensionsTextFile();
     void jsExtensionsBinaryFile();
     void lastModuleCandidateBroken();
+    void lazyBuildGraphLoading();
     void ld();
     void linkerMode();
     void linkerVariant_data();
@@ -205,6 +215,7 @@ private slots:
     void missingProjectFile();
     void missingOverridePrefix();
     void moduleConditions();
+    void moduleSearchPathIndex();
     void movedFileDependency();
     void multipleChanges();
     void multipleConfigurations();
@@ -226,10 +237,16 @@ private slots:
     void outputArtifactAutoTagging();
     void outputRedirection();
     void overrideProjectProperties();
+    void parallelPrepareScripts();
+    void parallelResolving();
+    void parseCache();
+    void parseCachePruning();
+    void partialReResolving();
     void pathProbe_data();
     void pathProbe();
     void pchChangeTracking();
     void perGroupDefineInExportItem();
+    void persistentWorker();
     void pkgConfigProbe();
     void pkgConfigProbe_data();
     void pkgConfigProbeSysroot();
@@ -237,6 +254,7 @@ private slots:
     void precompiledAndPrefixHeaders();
     void precompiledHeaderAndRedefine();
     void preventFloatingPointValues();
+    void probeCache();
     void probeChangeTracking();
     void probeProperties();
     void probesAndShadowProducts();
@@ -244,6 +262,9 @@ private slots:
     void probeInModuleProvider();
     void probesAndArrayProperties();
     void probesInNestedModules();
+    void processLauncher();
+    void processOutputLimit();
+    void processResourceUsage();
     void productDependenciesByType();
     void productInExportedModule();
     void productProperties();
@@ -270,6 +291,7 @@ private slots:
     void qbsModuleProvidersCompatibility_data();
     void qbspkgconfigModuleProvider();
     void qbsSession();
+    void qbsSessionWatchFiles();
     void qbsVersion();
     void qtBug51237();
     void radAfterIncompleteBuild();
@@ -322,6 +344,7 @@ private slots:
     void textTemplate();
     void toolLookup();
     void topLevelSearchPath();
+    void traceFile();
     void trackAddFile();
     void trackAddFileTag();
     void trackAddProduct();
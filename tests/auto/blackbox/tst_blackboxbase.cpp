@@ -53,7 +53,7 @@ static QString initQbsExecutableFilePath()
 }
 
 static bool supportsBuildDirectoryOption(const QString &command) {
-    return !(QStringList() << "help" << "config" << "config-ui"
+    return !(QStringList() << "help" << "config" << "config-ui" << "action-cache"
              << "setup-android" << "setup-qt" << "setup-toolchains" << "create-project")
             .contains(command);
 }
@@ -34,8 +34,11 @@
 #include <tools/qttools.h>
 
 #include <QtCore/qjsondocument.h>
+#include <QtCore/qregularexpression.h>
 #include <QtCore/qtemporarydir.h>
 
+#define WAIT_FOR_NEW_TIMESTAMP() waitForNewTimestamp(testDataDir)
+
 using qbs::Internal::HostOsInfo;
 using qbs::Profile;
 
@@ -140,6 +143,58 @@ static QString dpkgArch(const QString &prefix = QString())
     return {};
 }
 
+void TestBlackboxJava::javaCompilerWorker()
+{
+    const SettingsPtr s = settings();
+    Profile p(profileName(), s.get());
+
+    QDir::setCurrent(testDataDir + "/java/compiler-worker");
+    QbsRunParameters params(QStringList{"--command-echo-mode", "command-line"});
+    int status = runQbs(params);
+    if (p.value("java.jdkPath").toString().isEmpty()
+            && status != 0 && m_qbsStderr.contains("jdkPath")) {
+        QSKIP("java.jdkPath not set and automatic detection failed");
+    }
+    QCOMPARE(status, 0);
+    const QString classFilePath = relativeProductBuildDir("classes") + "/classes/Greeter.class";
+    QVERIFY2(regularFileExists(classFilePath), qPrintable(classFilePath));
+
+    // The sources are compiled by the helper tool running in the Java interpreter as
+    // a persistent worker, not by javac.
+    const QRegularExpression workerInvocation("java(\\.exe)?\"? -classpath .*Greeter\\.java");
+    QVERIFY2(QString::fromLocal8Bit(m_qbsStdout).contains(workerInvocation),
+             m_qbsStdout.constData());
+
+    // The compiler's diagnostics are passed on by the worker.
+    WAIT_FOR_NEW_TIMESTAMP();
+    REPLACE_IN_FILE("Greeter.java", "return greeting;", "return greeting");
+    params.expectFailure = true;
+    QVERIFY(runQbs(params) != 0);
+    const QByteArray output = m_qbsStdout + m_qbsStderr;
+    QVERIFY2(output.contains("Greeter.java") && output.contains("';' expected"),
+             output.constData());
+
+    // Options for the compiler's JVM require the javac executable.
+    WAIT_FOR_NEW_TIMESTAMP();
+    REPLACE_IN_FILE("Greeter.java", "return greeting", "return greeting;");
+    params.expectFailure = false;
+    params.arguments << "modules.java.additionalCompilerFlags:[\"-J-Xmx256m\"]";
+    QCOMPARE(runQbs(params), 0);
+    QVERIFY2(m_qbsStdout.contains("-J-Xmx256m"), m_qbsStdout.constData());
+    QVERIFY2(!QString::fromLocal8Bit(m_qbsStdout).contains(workerInvocation),
+             m_qbsStdout.constData());
+
+    // The worker is opt-in.
+    WAIT_FOR_NEW_TIMESTAMP();
+    touch("Greeter.java");
+    params.arguments = QStringList{"--command-echo-mode", "command-line",
+                                   "modules.java.usePersistentWorker:false"};
+    QCOMPARE(runQbs(params), 0);
+    QVERIFY2(m_qbsStdout.contains("Greeter.java"), m_qbsStdout.constData());
+    QVERIFY2(!QString::fromLocal8Bit(m_qbsStdout).contains(workerInvocation),
+             m_qbsStdout.constData());
+}
+
 void TestBlackboxJava::javaDependencyTracking()
 {
     QFETCH(QString, jdkPath);
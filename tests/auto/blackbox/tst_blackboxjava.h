@@ -40,6 +40,7 @@ public:
 
 private slots:
     void java();
+    void javaCompilerWorker();
     void javaDependencyTracking();
     void javaDependencyTracking_data();
     void javaDependencyTrackingInnerClass();
@@ -272,6 +272,16 @@ void TestBlackboxQt::mocFlags()
     QVERIFY(runQbs(params) != 0);
 }
 
+void TestBlackboxQt::mocMacros()
+{
+    QDir::setCurrent(testDataDir + "/moc-macros");
+    QCOMPARE(runQbs(), 0);
+    QVERIFY2(m_qbsStdout.contains("moc object.h"), m_qbsStdout.constData());
+    QVERIFY2(m_qbsStdout.contains("moc gadget.h"), m_qbsStdout.constData());
+    QVERIFY2(m_qbsStdout.contains("moc namespace.h"), m_qbsStdout.constData());
+    QVERIFY2(!m_qbsStdout.contains("moc fakeobject.h"), m_qbsStdout.constData());
+}
+
 void TestBlackboxQt::mocCompilerDefines()
 {
     QDir::setCurrent(testDataDir + "/moc-compiler-defines");
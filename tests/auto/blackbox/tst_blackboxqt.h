@@ -55,6 +55,7 @@ private slots:
     void mixedBuildVariants();
     void mocAndCppCombining();
     void mocFlags();
+    void mocMacros();
     void mocCompilerDefines();
     void mocSameFileName();
     void noRelinkOnQDebug();
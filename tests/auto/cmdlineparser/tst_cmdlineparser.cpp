@@ -83,6 +83,29 @@ private slots:
         QVERIFY(parser.parseCommandLine(QStringList() << "-t" << m_fileArgs));
         QVERIFY(parser.logTime());
 
+        QCOMPARE(parser.buildOptions(QString()).memoryBudget(), 0);
+        QVERIFY(parser.parseCommandLine(QStringList() << "--memory-budget" << "2048"
+                                        << m_fileArgs));
+        QCOMPARE(parser.buildOptions(QString()).memoryBudget(), 2048);
+        QVERIFY(parser.parseCommandLine(QStringList() << "--memory-budget" << "auto"
+                                        << m_fileArgs));
+        QCOMPARE(parser.buildOptions(QString()).memoryBudget(),
+                 BuildOptions::automaticMemoryBudget());
+
+        QCOMPARE(parser.buildOptions(QString()).minJobCount(), 0);
+        QVERIFY(parser.parseCommandLine(QStringList() << "-j" << "8" << "--min-jobs" << "2"
+                                        << m_fileArgs));
+        QCOMPARE(parser.buildOptions(QString()).maxJobCount(), 8);
+        QCOMPARE(parser.buildOptions(QString()).minJobCount(), 2);
+
+        QVERIFY(parser.traceFilePath().isEmpty());
+        QVERIFY(parser.parseCommandLine(QStringList() << "--trace-file" << "trace.json"
+                                        << m_fileArgs));
+        const QString traceFilePath
+                = QDir::fromNativeSeparators(QDir::current().absoluteFilePath("trace.json"));
+        QCOMPARE(parser.traceFilePath(), traceFilePath);
+        QCOMPARE(parser.buildOptions(QString()).traceFilePath(), traceFilePath);
+
         // Note: We cannot just check for !parser.logTime() here, because if the test is not
         // run in a terminal, "--show-progress" is ignored, in which case "--log-time"
         // takes effect.
@@ -169,6 +192,12 @@ private slots:
 
         QVERIFY(parser.parseCommandLine(QStringList{"run", "--setup-run-env-config", "x,y,z"}));
         QCOMPARE(parser.runEnvConfig(), QStringList({"x", "y", "z"}));
+
+        QVERIFY(parser.parseCommandLine(QStringList(m_fileArgs) << "--action-cache" << "/cache"));
+        QCOMPARE(parser.buildOptions(QString()).actionCacheDirectory(),
+                 QDir::fromNativeSeparators(QDir::current().absoluteFilePath("/cache")));
+        QVERIFY(parser.parseCommandLine(QStringList{"action-cache", "--action-cache", "/cache"}));
+        QCOMPARE(parser.command(), ActionCacheCommandType);
     }
 
     void testInvalidCommandLine()
@@ -186,7 +215,16 @@ private slots:
         QTest::newRow("Invalid position") << (QStringList() << m_fileArgs << "-vjv");
         QTest::newRow("Missing jobs argument") << (QStringList() << m_fileArgs << "-j");
         QTest::newRow("Missing products argument") << (QStringList() << m_fileArgs << "--products");
+        QTest::newRow("Missing action cache argument")
+                << (QStringList() << m_fileArgs << "--action-cache");
+        QTest::newRow("Argument for action-cache") << (QStringList("action-cache") << "blubb");
         QTest::newRow("Wrong argument") << (QStringList() << "-j" << "0" << m_fileArgs);
+        QTest::newRow("Invalid memory budget")
+                << (QStringList() << "--memory-budget" << "lots" << m_fileArgs);
+        QTest::newRow("Missing trace file argument")
+                << (QStringList() << m_fileArgs << "--trace-file");
+        QTest::newRow("Wrong min jobs argument")
+                << (QStringList() << "--min-jobs" << "0" << m_fileArgs);
         QTest::newRow("Invalid list argument")
                 << (QStringList() << "--changed-files" << "," << m_fileArgs);
         QTest::newRow("Invalid log level")